@@ -33,6 +33,24 @@ limitations under the License.
 
 namespace tensorflow {
 
+struct BFCAllocator::CacheShard {
+  mutex mu;
+  // Pointers freed by clients of this shard, whose chunks have not been looked
+  // up yet.
+  std::vector<void*> pending_frees GUARDED_BY(mu);
+  // Free chunks by bin, as (ptr, size) pairs. The global bins consider these
+  // chunks to be in use.
+  std::vector<std::pair<void*, size_t>> free_chunks[kMaxCachedBinNum + 1]
+      GUARDED_BY(mu);
+  // Total size of `free_chunks`.
+  size_t cached_bytes GUARDED_BY(mu) = 0;
+};
+
+struct BFCAllocator::UncachedChunkShard {
+  mutex mu;
+  absl::flat_hash_set<const void*> ptrs GUARDED_BY(mu);
+};
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
                            bool garbage_collection)
@@ -373,6 +391,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
+  // Allocations restricted to chunks freed before a given count bypass the
+  // thread-local cache, which does not track when its chunks were freed.
+  if (cache_shards_ != nullptr && bin_num <= kMaxCachedBinNum &&
+      freed_before == 0) {
+    void* ptr = AllocateFromCache(GetCacheShard(), bin_num, rounded_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   mutex_lock l(lock_);
   if (!timestamped_chunks_.empty()) {
     // Merge timestamped chunks whose counts have become safe for general use.
@@ -383,6 +411,14 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     return ptr;
   }
 
+  // Return the chunks held by the thread-local cache before growing.
+  if (cache_shards_ != nullptr && DrainThreadLocalCacheLocked()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
@@ -477,6 +513,11 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
 
+        if (cache_shards_ != nullptr &&
+            BinNumForSize(chunk->size) > kMaxCachedBinNum) {
+          RecordUncachedChunk(chunk->ptr);
+        }
+
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
           if (pending_op_name != nullptr) {
@@ -548,10 +589,154 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  // Chunks too large to be cached skip the pending frees, so that they can
+  // be reused right away.
+  if (cache_shards_ != nullptr && ptr != nullptr && !EraseUncachedChunk(ptr)) {
+    DeallocateToCache(ptr);
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
 
+void BFCAllocator::EnableThreadLocalCache(int num_shards,
+                                          size_t max_cached_bytes_per_shard) {
+  CHECK_GT(num_shards, 0);
+  CHECK(cache_shards_ == nullptr) << "Thread-local cache already enabled";
+  cache_shards_.reset(new CacheShard[num_shards]);
+  uncached_chunk_shards_.reset(new UncachedChunkShard[kNumUncachedChunkShards]);
+  num_cache_shards_ = num_shards;
+  max_cached_bytes_per_shard_ = max_cached_bytes_per_shard;
+}
+
+void BFCAllocator::DrainThreadLocalCache() {
+  if (cache_shards_ == nullptr) return;
+  bool drained;
+  {
+    mutex_lock l(lock_);
+    drained = DrainThreadLocalCacheLocked();
+  }
+  if (drained) {
+    retry_helper_.NotifyDealloc();
+  }
+}
+
+BFCAllocator::CacheShard* BFCAllocator::GetCacheShard() {
+  static std::atomic<int> next_thread_index{0};
+  static thread_local const int thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return &cache_shards_[thread_index % num_cache_shards_];
+}
+
+void* BFCAllocator::AllocateFromCache(CacheShard* shard, int bin_num,
+                                      size_t rounded_bytes) {
+  mutex_lock l(shard->mu);
+  auto& free_chunks = shard->free_chunks[bin_num];
+  // Prefer the most recently freed chunks, which are more likely to be hot in
+  // cache.
+  for (size_t i = free_chunks.size(); i-- > 0;) {
+    if (free_chunks[i].second >= rounded_bytes) {
+      void* ptr = free_chunks[i].first;
+      const size_t size = free_chunks[i].second;
+      free_chunks[i] = free_chunks.back();
+      free_chunks.pop_back();
+      shard->cached_bytes -= size;
+      cached_bytes_.fetch_sub(size, std::memory_order_relaxed);
+      cached_num_allocs_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+  }
+  return nullptr;
+}
+
+void BFCAllocator::DeallocateToCache(void* ptr) {
+  CacheShard* shard = GetCacheShard();
+  {
+    mutex_lock l(shard->mu);
+    shard->pending_frees.push_back(ptr);
+    if (shard->pending_frees.size() < kPendingFreeBatchSize) return;
+  }
+  FlushPendingFrees(shard);
+}
+
+void BFCAllocator::RecordUncachedChunk(const void* ptr) {
+  UncachedChunkShard* shard =
+      &uncached_chunk_shards_[absl::Hash<const void*>()(ptr) %
+                              kNumUncachedChunkShards];
+  mutex_lock l(shard->mu);
+  shard->ptrs.insert(ptr);
+}
+
+bool BFCAllocator::EraseUncachedChunk(const void* ptr) {
+  UncachedChunkShard* shard =
+      &uncached_chunk_shards_[absl::Hash<const void*>()(ptr) %
+                              kNumUncachedChunkShards];
+  mutex_lock l(shard->mu);
+  return shard->ptrs.erase(ptr) > 0;
+}
+
+void BFCAllocator::FlushPendingFrees(CacheShard* shard) {
+  std::vector<void*> pending_frees;
+  {
+    mutex_lock l(shard->mu);
+    pending_frees.swap(shard->pending_frees);
+  }
+  if (pending_frees.empty()) return;
+
+  bool freed_to_bins = false;
+  {
+    mutex_lock l(lock_);
+    mutex_lock shard_lock(shard->mu);
+    for (void* ptr : pending_frees) {
+      ChunkHandle h = region_manager_.get_handle(ptr);
+      CHECK(h != kInvalidChunkHandle);
+      Chunk* c = ChunkFromHandle(h);
+      const BinNum bin_num = BinNumForSize(c->size);
+      if (bin_num <= kMaxCachedBinNum &&
+          shard->cached_bytes + c->size <= max_cached_bytes_per_shard_) {
+        // The chunk stays in use as far as the global bins are concerned. It
+        // gets the id of its next allocation now, since a cache hit does not
+        // take `lock_`.
+        c->requested_size = c->size;
+        c->allocation_id = next_allocation_id_++;
+        shard->free_chunks[bin_num].emplace_back(ptr, c->size);
+        shard->cached_bytes += c->size;
+        cached_bytes_.fetch_add(c->size, std::memory_order_relaxed);
+      } else {
+        FreeAndMaybeCoalesce(h);
+        freed_to_bins = true;
+      }
+    }
+  }
+  if (freed_to_bins) {
+    retry_helper_.NotifyDealloc();
+  }
+}
+
+bool BFCAllocator::DrainThreadLocalCacheLocked() {
+  bool drained = false;
+  for (int i = 0; i < num_cache_shards_; ++i) {
+    CacheShard* shard = &cache_shards_[i];
+    mutex_lock l(shard->mu);
+    for (void* ptr : shard->pending_frees) {
+      FreeAndMaybeCoalesce(region_manager_.get_handle(ptr));
+      drained = true;
+    }
+    shard->pending_frees.clear();
+    for (auto& free_chunks : shard->free_chunks) {
+      for (const auto& ptr_and_size : free_chunks) {
+        FreeAndMaybeCoalesce(region_manager_.get_handle(ptr_and_size.first));
+        cached_bytes_.fetch_sub(ptr_and_size.second,
+                                std::memory_order_relaxed);
+        drained = true;
+      }
+      free_chunks.clear();
+    }
+    shard->cached_bytes = 0;
+  }
+  return drained;
+}
+
 void BFCAllocator::DeallocateRawInternal(void* ptr) {
   if (ptr == nullptr) {
     VLOG(2) << "tried to deallocate nullptr";
@@ -563,6 +748,14 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
 
+  FreeAndMaybeCoalesce(h);
+
+  if (VLOG_IS_ON(4)) {
+    LOG(INFO) << "F: " << RenderOccupancy();
+  }
+}
+
+void BFCAllocator::FreeAndMaybeCoalesce(BFCAllocator::ChunkHandle h) {
   MarkFree(h);
 
   // Consider coalescing it.
@@ -572,10 +765,6 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   } else {
     InsertFreeChunkIntoBin(TryToCoalesce(h, false));
   }
-
-  if (VLOG_IS_ON(4)) {
-    LOG(INFO) << "F: " << RenderOccupancy();
-  }
 }
 
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
@@ -705,6 +894,9 @@ void BFCAllocator::SetSafeFrontier(uint64 count) {
   uint64 current = safe_frontier_.load(std::memory_order_relaxed);
   while (count > current) {
     if (safe_frontier_.compare_exchange_strong(current, count)) {
+      // Make the cached chunks available to allocations that need chunks
+      // freed before the new frontier.
+      DrainThreadLocalCache();
       retry_helper_.NotifyDealloc();
       return;
     } else {
@@ -1001,7 +1193,8 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
   // Record the general stats
   MemAllocatorStats* mas = md.mutable_stats();
-  mas->set_num_allocs(stats_.num_allocs);
+  mas->set_num_allocs(stats_.num_allocs +
+                      cached_num_allocs_.load(std::memory_order_relaxed));
   mas->set_bytes_in_use(stats_.bytes_in_use);
   mas->set_peak_bytes_in_use(stats_.peak_bytes_in_use);
   mas->set_largest_alloc_size(stats_.largest_alloc_size);
@@ -1075,12 +1268,16 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.bytes_in_use -= cached_bytes_.load(std::memory_order_relaxed);
+  stats.num_allocs += cached_num_allocs_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
+  cached_num_allocs_.store(0, std::memory_order_relaxed);
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
 }
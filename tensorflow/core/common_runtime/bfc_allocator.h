@@ -81,6 +81,24 @@ class BFCAllocator : public Allocator {
 
   void SetSafeFrontier(uint64 count) override;
 
+  // Enables a cache of recently freed small chunks in front of the global
+  // bins, so that most small allocations and deallocations do not take the
+  // allocator-wide lock. The cache is split into `num_shards` shards, and each
+  // thread allocates from and frees to the shard selected by its thread index.
+  // Each shard holds at most `max_cached_bytes_per_shard` bytes of free chunks.
+  //
+  // Cached chunks are returned to the global bins when an allocation cannot be
+  // satisfied otherwise, on SetSafeFrontier(), and on DrainThreadLocalCache().
+  // While the cache is enabled, RequestedSize() of an allocation served from
+  // the cache is the size of the underlying chunk.
+  //
+  // Must be called before the first allocation.
+  void EnableThreadLocalCache(int num_shards,
+                              size_t max_cached_bytes_per_shard);
+
+  // Returns all chunks held by the thread-local cache to the global bins.
+  void DrainThreadLocalCache();
+
   virtual bool ShouldRecordOpName() const { return false; }
 
   MemoryDump RecordMemoryMap();
@@ -98,6 +116,40 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // A shard of the thread-local cache enabled by EnableThreadLocalCache().
+  struct CacheShard;
+
+  // Returns the cache shard of the calling thread.
+  CacheShard* GetCacheShard();
+
+  // Returns a free chunk of at least `rounded_bytes` bytes from bin `bin_num`
+  // of `shard`, or nullptr if there is none.
+  void* AllocateFromCache(CacheShard* shard, int bin_num, size_t rounded_bytes);
+
+  // Queues `ptr` for deallocation through the cache shard of the calling
+  // thread.
+  void DeallocateToCache(void* ptr);
+
+  // A shard of the set of in-use chunks that are too large to be cached.
+  struct UncachedChunkShard;
+
+  // Records that the chunk at `ptr`, which is being allocated, is too large
+  // to be cached, so that its deallocation bypasses the cache.
+  void RecordUncachedChunk(const void* ptr) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns true, and forgets `ptr`, if it was recorded by
+  // RecordUncachedChunk().
+  bool EraseUncachedChunk(const void* ptr) LOCKS_EXCLUDED(lock_);
+
+  // Moves the pointers queued for deallocation in `shard` into its free
+  // lists, or into the global bins when they are too large or the shard is
+  // full.
+  void FlushPendingFrees(CacheShard* shard) LOCKS_EXCLUDED(lock_);
+
+  // Returns all chunks held by the cache shards to the global bins. Returns
+  // true if any chunk was returned.
+  bool DrainThreadLocalCacheLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -519,6 +571,34 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Only chunks of the bins up to and including this one, i.e. chunks smaller
+  // than 128KiB, are kept in the thread-local cache.
+  static const int kMaxCachedBinNum = 8;
+
+  // Number of deallocations a cache shard queues before it takes `lock_` to
+  // sort them into its free lists.
+  static const int kPendingFreeBatchSize = 32;
+
+  // Shards of the thread-local cache. Empty if the cache is disabled. A
+  // shard's mutex may be acquired while holding `lock_`, but not vice versa.
+  std::unique_ptr<CacheShard[]> cache_shards_;
+  int num_cache_shards_ = 0;
+  size_t max_cached_bytes_per_shard_ = 0;
+
+  // In-use chunks above kMaxCachedBinNum, sharded by address. Only allocated
+  // when the cache is enabled. A shard's mutex may be acquired while holding
+  // `lock_`, but not vice versa.
+  static const int kNumUncachedChunkShards = 16;
+  std::unique_ptr<UncachedChunkShard[]> uncached_chunk_shards_;
+
+  // Number of allocations served from the cache shards, which GetStats() adds
+  // to the number of allocations served from the global bins.
+  std::atomic<int64> cached_num_allocs_ = {0};
+
+  // Total size of the free chunks held by the cache shards. These chunks are
+  // accounted as in use by the global bins, so GetStats() subtracts them.
+  std::atomic<int64> cached_bytes_ = {0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ GUARDED_BY(lock_);
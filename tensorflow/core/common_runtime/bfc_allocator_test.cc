@@ -0,0 +1,234 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+BFCAllocator* NewCPUBFCAllocator(int cache_shards) {
+  BFCAllocator* a = new BFCAllocator(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), 1LL << 30,
+      true /*allow_growth*/, "cpu_bfc");
+  if (cache_shards > 0) {
+    a->EnableThreadLocalCache(cache_shards, 1 << 20);
+  }
+  return a;
+}
+
+void CheckNoOverlap(BFCAllocator* a, std::vector<void*> ptrs) {
+  std::sort(ptrs.begin(), ptrs.end());
+  for (size_t i = 1; i < ptrs.size(); i++) {
+    ASSERT_NE(ptrs[i], ptrs[i - 1]);  // No dups
+    size_t req_size = a->RequestedSize(ptrs[i - 1]);
+    ASSERT_GT(req_size, 0);
+    ASSERT_GE(static_cast<char*>(ptrs[i]) - static_cast<char*>(ptrs[i - 1]),
+              req_size);
+  }
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheNoDups) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(2));
+  for (int round = 0; round < 3; ++round) {
+    std::vector<void*> ptrs;
+    for (int s = 1; s < 1024; s++) {
+      ptrs.push_back(a->AllocateRaw(1, s));
+    }
+    CheckNoOverlap(a.get(), ptrs);
+    // Free every other pointer so that the next round reuses cached chunks
+    // while the rest are still in use.
+    std::vector<void*> kept;
+    for (size_t i = 0; i < ptrs.size(); ++i) {
+      if (i % 2 == 0) {
+        a->DeallocateRaw(ptrs[i]);
+      } else {
+        kept.push_back(ptrs[i]);
+      }
+    }
+    std::vector<void*> reused;
+    for (int s = 1; s < 512; s++) {
+      reused.push_back(a->AllocateRaw(1, s));
+    }
+    kept.insert(kept.end(), reused.begin(), reused.end());
+    CheckNoOverlap(a.get(), kept);
+    for (void* p : kept) {
+      a->DeallocateRaw(p);
+    }
+  }
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheDrain) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1));
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    ptrs.push_back(a->AllocateRaw(64, 256));
+  }
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  a->DrainThreadLocalCache();
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(100, stats->num_allocs);
+
+  // Every chunk is back in the bins, so one large allocation can reuse the
+  // coalesced region.
+  void* p = a->AllocateRaw(64, 100 * 256);
+  EXPECT_NE(nullptr, p);
+  a->DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheStatsExcludeCachedChunks) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1));
+  std::vector<void*> ptrs;
+  // Enough frees to flush the pending batch into the cache.
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a->AllocateRaw(64, 256));
+  }
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheFreesLargeChunksImmediately) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1));
+  // Larger than the chunks of any cached bin.
+  const size_t kLargeSize = 1 << 20;
+  void* p = a->AllocateRaw(64, kLargeSize);
+  const int64 allocation_id = a->AllocationId(p);
+  a->DeallocateRaw(p);
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+
+  // The freed chunk is back in the bins, rather than queued in the cache, so
+  // the next allocation reuses it instead of growing the pool.
+  void* q = a->AllocateRaw(64, kLargeSize);
+  EXPECT_EQ(p, q);
+  EXPECT_NE(allocation_id, a->AllocationId(q));
+  a->DeallocateRaw(q);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheHitsCountAsAllocations) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1));
+  std::vector<void*> ptrs;
+  std::vector<int64> allocation_ids;
+  // Enough frees to flush the pending batch into the cache.
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a->AllocateRaw(64, 256));
+    allocation_ids.push_back(a->AllocationId(ptrs.back()));
+  }
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  ptrs.clear();
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a->AllocateRaw(64, 256));
+    allocation_ids.push_back(a->AllocationId(ptrs.back()));
+  }
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(128, stats->num_allocs);
+  EXPECT_EQ(64 * 256, stats->bytes_in_use);
+  // Every allocation, cached or not, has its own id.
+  std::sort(allocation_ids.begin(), allocation_ids.end());
+  EXPECT_EQ(allocation_ids.end(),
+            std::adjacent_find(allocation_ids.begin(), allocation_ids.end()));
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheMultiThreaded) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(4));
+  thread::ThreadPool pool(Env::Default(), "test", 8);
+  const int kClosures = 32;
+  BlockingCounter done(kClosures);
+  for (int c = 0; c < kClosures; ++c) {
+    pool.Schedule([&a, &done, c]() {
+      std::vector<void*> ptrs;
+      for (int i = 0; i < 1000; ++i) {
+        const size_t size = 16 + ((i * 37 + c) % 2048);
+        char* p = static_cast<char*>(a->AllocateRaw(16, size));
+        // Touch both ends to catch chunks handed out twice.
+        p[0] = static_cast<char>(c);
+        p[size - 1] = static_cast<char>(c);
+        ptrs.push_back(p);
+        if (ptrs.size() > 16) {
+          char* q = static_cast<char*>(ptrs.front());
+          EXPECT_EQ(static_cast<char>(c), q[0]);
+          a->DeallocateRaw(q);
+          ptrs.erase(ptrs.begin());
+        }
+      }
+      for (void* p : ptrs) {
+        a->DeallocateRaw(p);
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  a->DrainThreadLocalCache();
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+}
+
+static void BM_AllocationThreaded(int iters, int num_threads,
+                                  int cache_shards) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(cache_shards));
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+  BlockingCounter done(num_threads);
+  for (int t = 0; t < num_threads; t++) {
+    pool.Schedule([&a, &done, iters, t]() {
+      void* ptrs[8] = {};
+      for (int i = 0; i < iters; i++) {
+        const int slot = i % 8;
+        if (ptrs[slot] != nullptr) a->DeallocateRaw(ptrs[slot]);
+        ptrs[slot] = a->AllocateRaw(32, 64 + ((i + t) % 16) * 64);
+      }
+      for (void* p : ptrs) {
+        if (p != nullptr) a->DeallocateRaw(p);
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+}
+BENCHMARK(BM_AllocationThreaded)
+    ->ArgPair(1, 0)
+    ->ArgPair(1, 8)
+    ->ArgPair(8, 0)
+    ->ArgPair(8, 8)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 16);
+
+}  // namespace
+}  // namespace tensorflow
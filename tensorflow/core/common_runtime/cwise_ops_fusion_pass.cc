@@ -0,0 +1,284 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cwise_ops_fusion_pass.h"
+
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+enum class OpKind {
+  kUnary,
+  // A binary op whose scalar operand must be its right operand.
+  kBinary,
+  // A binary op whose scalar operand may be either operand.
+  kCommutativeBinary,
+};
+
+struct SupportedOp {
+  OpKind kind;
+  std::set<DataType> types;
+};
+
+const std::unordered_map<string, SupportedOp>& SupportedOps() {
+  // WARN: This should be consistent with unary_ops_composition.cc.
+  static const auto* supported_ops = new std::unordered_map<
+      string, SupportedOp>(
+      // clang-format off
+      {// Ops defined via Eigen scalar ops.
+       {"Abs",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Acos",       {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Acosh",      {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Asin",       {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Asinh",      {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Atan",       {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Atanh",      {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Ceil",       {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Cos",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Cosh",       {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Expm1",      {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Exp",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Floor",      {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Inv",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Log",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Log1p",      {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Neg",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Reciprocal", {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Rint",       {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Round",      {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Rsqrt",      {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Sigmoid",    {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Sin",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Sinh",       {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Sqrt",       {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Square",     {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Tan",        {OpKind::kUnary, {DT_FLOAT,          DT_DOUBLE}}},
+       {"Tanh",       {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       // Additional ops that are not part of the Eigen.
+       {"Elu",        {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Relu",       {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Relu6",      {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Selu",       {OpKind::kUnary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       // Binary ops with a scalar operand.
+       {"Add",     {OpKind::kCommutativeBinary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"AddV2",   {OpKind::kCommutativeBinary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Mul",     {OpKind::kCommutativeBinary, {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Div",     {OpKind::kBinary,            {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"RealDiv", {OpKind::kBinary,            {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Sub",     {OpKind::kBinary,            {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       // Not commutative for NaN operands.
+       {"Maximum", {OpKind::kBinary,            {DT_FLOAT, DT_HALF, DT_DOUBLE}}},
+       {"Minimum", {OpKind::kBinary,            {DT_FLOAT, DT_HALF, DT_DOUBLE}}}});
+  // clang-format on
+  return *supported_ops;
+}
+
+// A node of a chain.
+struct ChainLink {
+  Node* node;
+  DataType dtype;
+  // The input of `node` that the previous node of the chain feeds.
+  int chain_input;
+  // The edge of the scalar operand of a binary op, or nullptr.
+  const Edge* scalar_edge;
+};
+
+bool IsOnCpu(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name(), &parsed) &&
+         parsed.type == DEVICE_CPU;
+}
+
+// Returns true if `n` is a Const node holding a scalar of type `dtype`.
+bool IsScalarConst(const Node* n, DataType dtype) {
+  if (n->type_string() != "Const") return false;
+  DataType const_dtype;
+  const TensorProto* value = nullptr;
+  return GetNodeAttr(n->attrs(), "dtype", &const_dtype).ok() &&
+         const_dtype == dtype &&
+         GetNodeAttr(n->attrs(), "value", &value).ok() &&
+         value->tensor_shape().dim_size() == 0 &&
+         !value->tensor_shape().unknown_rank();
+}
+
+// Returns true if `n` may be part of a chain, and fills in `link`.
+bool GetChainLink(Node* n, ChainLink* link) {
+  if (!n->IsOp()) return false;
+  const auto& supported_ops = SupportedOps();
+  auto it = supported_ops.find(n->type_string());
+  if (it == supported_ops.end()) return false;
+  DataType dtype;
+  if (!GetNodeAttr(n->attrs(), "T", &dtype).ok() ||
+      it->second.types.count(dtype) == 0 || !IsOnCpu(n)) {
+    return false;
+  }
+  link->node = n;
+  link->dtype = dtype;
+  link->chain_input = 0;
+  link->scalar_edge = nullptr;
+  if (it->second.kind == OpKind::kUnary) return true;
+
+  const Edge* input_edges[2];
+  if (!n->input_edge(0, &input_edges[0]).ok() ||
+      !n->input_edge(1, &input_edges[1]).ok()) {
+    return false;
+  }
+  if (IsScalarConst(input_edges[1]->src(), dtype)) {
+    link->scalar_edge = input_edges[1];
+    return true;
+  }
+  if (it->second.kind == OpKind::kCommutativeBinary &&
+      IsScalarConst(input_edges[0]->src(), dtype)) {
+    link->chain_input = 1;
+    link->scalar_edge = input_edges[0];
+    return true;
+  }
+  return false;
+}
+
+bool HasControlInputs(const Node* n) {
+  for (const Edge* e : n->in_edges()) {
+    if (e->IsControlEdge()) return true;
+  }
+  return false;
+}
+
+// Returns the only output edge of `n` if it is a data edge, or nullptr.
+const Edge* GetSingleDataOutput(const Node* n) {
+  if (n->out_edges().size() != 1) return nullptr;
+  const Edge* e = *n->out_edges().begin();
+  return e->IsControlEdge() ? nullptr : e;
+}
+
+Status FuseChain(Graph* graph, const std::vector<ChainLink>& chain) {
+  Node* head = chain.front().node;
+  Node* tail = chain.back().node;
+  std::vector<string> op_names;
+  std::vector<NodeBuilder::NodeOut> scalars;
+  for (const ChainLink& link : chain) {
+    op_names.push_back(link.node->type_string());
+    if (link.scalar_edge != nullptr) {
+      scalars.emplace_back(link.scalar_edge->src(),
+                           link.scalar_edge->src_output());
+    }
+  }
+  VLOG(2) << "Fuse cwise ops: tail=" << tail->name() << " op_names=["
+          << absl::StrJoin(op_names, ", ") << "]";
+
+  const Edge* input_edge;
+  TF_RETURN_IF_ERROR(head->input_edge(chain.front().chain_input, &input_edge));
+  Node* fused_node;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder(
+          graph->NewName(strings::StrCat(tail->name(), "/cwise_ops_composition")),
+          "_CwiseOpsComposition")
+          .Input(input_edge->src(), input_edge->src_output())
+          .Input(scalars)
+          .Attr("T", chain.front().dtype)
+          .Attr("op_names", op_names)
+          .Device(tail->requested_device())
+          .Finalize(graph, &fused_node));
+  fused_node->set_assigned_device_name(tail->assigned_device_name());
+
+  for (const Edge* e : head->in_edges()) {
+    if (e->IsControlEdge()) {
+      graph->AddControlEdge(e->src(), fused_node);
+    }
+  }
+  for (const Edge* e : tail->out_edges()) {
+    if (e->IsControlEdge()) {
+      graph->AddControlEdge(fused_node, e->dst());
+    } else {
+      graph->AddEdge(fused_node, 0, e->dst(), e->dst_input());
+    }
+  }
+  for (const ChainLink& link : chain) {
+    graph->RemoveNode(link.node);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status CwiseOpsFusionPass::Run(const GraphOptimizationPassOptions& options) {
+  bool enabled;
+  TF_RETURN_IF_ERROR(
+      ReadBoolFromEnvVar("TF_EXECUTOR_CWISE_FUSION", false, &enabled));
+  if (!enabled || options.partition_graphs == nullptr) {
+    return Status::OK();
+  }
+  for (auto& partition : *options.partition_graphs) {
+    TF_RETURN_IF_ERROR(FuseChains(partition.second.get()));
+  }
+  return Status::OK();
+}
+
+Status CwiseOpsFusionPass::FuseChains(Graph* graph) {
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+
+  // Find the chains before rewriting the graph: nodes are visited in
+  // topological order, so each chain is found from its first node.
+  std::vector<std::vector<ChainLink>> chains;
+  std::unordered_set<const Node*> in_chain;
+  for (Node* n : order) {
+    if (in_chain.count(n) > 0) continue;
+    ChainLink link;
+    if (!GetChainLink(n, &link)) continue;
+    std::vector<ChainLink> chain = {link};
+    for (const Edge* e = GetSingleDataOutput(n); e != nullptr;
+         e = GetSingleDataOutput(chain.back().node)) {
+      Node* next = e->dst();
+      ChainLink next_link;
+      if (!GetChainLink(next, &next_link) || next_link.dtype != link.dtype ||
+          next_link.chain_input != e->dst_input() ||
+          next->assigned_device_name() != n->assigned_device_name() ||
+          HasControlInputs(next)) {
+        break;
+      }
+      chain.push_back(next_link);
+    }
+    if (chain.size() < 2) continue;
+    for (const ChainLink& chain_link : chain) {
+      in_chain.insert(chain_link.node);
+    }
+    chains.push_back(std::move(chain));
+  }
+
+  for (const std::vector<ChainLink>& chain : chains) {
+    TF_RETURN_IF_ERROR(FuseChain(graph, chain));
+  }
+  return Status::OK();
+}
+
+// Runs after the MKL layout passes, whose ops are not fused.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PARTITIONING, 3,
+                      CwiseOpsFusionPass);
+
+}  // namespace tensorflow
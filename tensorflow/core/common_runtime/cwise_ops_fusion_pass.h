@@ -0,0 +1,56 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CWISE_OPS_FUSION_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_CWISE_OPS_FUSION_PASS_H_
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Replaces chains of elementwise ops placed on CPU with a single
+// _CwiseOpsComposition node, which runs the whole chain on each block of its
+// input without materializing the intermediate tensors.
+//
+// A chain is a path of nodes where each node's only output edge feeds the
+// next node. The supported nodes are the type and shape preserving unary ops
+// of _UnaryOpsComposition, and Add, Sub, Mul, Div, Maximum and Minimum whose
+// other operand is a scalar Const. For example
+//
+//      x     c0 (Const)         x
+//      |    /                   |
+//     Mul                       |     c0   c1
+//      |     c1 (Const)   =>    |    /    /
+//     Add                     _CwiseOpsComposition
+//      |                        |   op_names = [Mul, Add, Relu]
+//     Relu                      |
+//      |                        y
+//      y
+//
+// Unlike grappler's UnaryOpsComposition stage, this pass runs on the
+// partition graphs just before executors are created, so it also applies to
+// graphs that are not optimized by grappler. It is enabled by setting the
+// TF_EXECUTOR_CWISE_FUSION environment variable to true.
+class CwiseOpsFusionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override;
+
+  // Fuses the chains of `graph`.
+  static Status FuseChains(Graph* graph);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_CWISE_OPS_FUSION_PASS_H_
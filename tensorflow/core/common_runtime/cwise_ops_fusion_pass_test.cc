@@ -0,0 +1,170 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cwise_ops_fusion_pass.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const char* const kCpu = "/job:a/replica:0/task:0/device:CPU:0";
+const char* const kGpu = "/job:a/replica:0/task:0/device:GPU:0";
+
+Tensor Scalar(float value) {
+  Tensor t(DT_FLOAT, TensorShape({}));
+  t.scalar<float>()() = value;
+  return t;
+}
+
+// Places every node of `g` on `device`, and fuses its chains.
+void PlaceAndFuse(Graph* g, const string& device) {
+  for (Node* n : g->op_nodes()) {
+    n->set_assigned_device_name(device);
+  }
+  TF_ASSERT_OK(CwiseOpsFusionPass::FuseChains(g));
+}
+
+std::vector<Node*> FusedNodes(Graph* g) {
+  std::vector<Node*> nodes;
+  for (Node* n : g->op_nodes()) {
+    if (n->type_string() == "_CwiseOpsComposition") {
+      nodes.push_back(n);
+    }
+  }
+  return nodes;
+}
+
+float ConstValue(const Node* n) {
+  Tensor value;
+  TF_CHECK_OK(GetNodeAttr(n->attrs(), "value", &value));
+  return value.scalar<float>()();
+}
+
+std::vector<string> OpNames(const Node* n) {
+  std::vector<string> op_names;
+  TF_CHECK_OK(GetNodeAttr(n->attrs(), "op_names", &op_names));
+  return op_names;
+}
+
+TEST(CwiseOpsFusionPassTest, FusesUnaryAndScalarBinaryOps) {
+  // y = Relu(0.5 + x * 2.0)
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* mul = test::graph::Binary(&g, "Mul", x,
+                                  test::graph::Constant(&g, Scalar(2.0)));
+  Node* add = test::graph::Binary(
+      &g, "AddV2", test::graph::Constant(&g, Scalar(0.5)), mul);
+  Node* relu = test::graph::Unary(&g, "Relu", add);
+  Node* y = test::graph::Retval(&g, 0, relu);
+  PlaceAndFuse(&g, kCpu);
+
+  std::vector<Node*> fused = FusedNodes(&g);
+  ASSERT_EQ(1, fused.size());
+  EXPECT_EQ(std::vector<string>({"Mul", "AddV2", "Relu"}), OpNames(fused[0]));
+  EXPECT_EQ(kCpu, fused[0]->assigned_device_name());
+  ASSERT_EQ(3, fused[0]->num_inputs());
+  const Edge* e;
+  TF_ASSERT_OK(fused[0]->input_edge(0, &e));
+  EXPECT_EQ(x, e->src());
+  TF_ASSERT_OK(fused[0]->input_edge(1, &e));
+  EXPECT_EQ(2.0, ConstValue(e->src()));
+  TF_ASSERT_OK(fused[0]->input_edge(2, &e));
+  EXPECT_EQ(0.5, ConstValue(e->src()));
+  TF_ASSERT_OK(y->input_edge(0, &e));
+  EXPECT_EQ(fused[0], e->src());
+  // The chain is gone, and its Const operands are kept.
+  for (Node* n : g.op_nodes()) {
+    EXPECT_NE("Relu", n->type_string());
+  }
+}
+
+TEST(CwiseOpsFusionPassTest, ChainEndsAtSharedOutput) {
+  // The output of Tanh is used twice, so only Sigmoid -> Tanh is fused.
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* tanh = test::graph::Unary(
+      &g, "Tanh", test::graph::Unary(&g, "Sigmoid", x));
+  test::graph::Retval(&g, 0, test::graph::Unary(&g, "Exp", tanh));
+  test::graph::Retval(&g, 1, test::graph::Unary(&g, "Neg", tanh));
+  PlaceAndFuse(&g, kCpu);
+
+  std::vector<Node*> fused = FusedNodes(&g);
+  ASSERT_EQ(1, fused.size());
+  EXPECT_EQ(std::vector<string>({"Sigmoid", "Tanh"}), OpNames(fused[0]));
+  EXPECT_EQ(2, fused[0]->out_edges().size());
+}
+
+TEST(CwiseOpsFusionPassTest, DoesNotFuseNonScalarOperands) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Tensor vector(DT_FLOAT, TensorShape({2}));
+  vector.flat<float>().setZero();
+  Node* add =
+      test::graph::Binary(&g, "Add", x, test::graph::Constant(&g, vector));
+  // Sub is not commutative: the scalar must be its right operand.
+  Node* sub = test::graph::Binary(&g, "Sub",
+                                  test::graph::Constant(&g, Scalar(1.0)), add);
+  test::graph::Retval(&g, 0, test::graph::Unary(&g, "Relu", sub));
+  PlaceAndFuse(&g, kCpu);
+  EXPECT_TRUE(FusedNodes(&g).empty());
+}
+
+TEST(CwiseOpsFusionPassTest, DoesNotFuseOnGpu) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  test::graph::Retval(
+      &g, 0,
+      test::graph::Unary(&g, "Tanh", test::graph::Unary(&g, "Relu", x)));
+  PlaceAndFuse(&g, kGpu);
+  EXPECT_TRUE(FusedNodes(&g).empty());
+}
+
+TEST(CwiseOpsFusionPassTest, KeepsControlEdges) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* before = test::graph::NoOp(&g, {});
+  Node* relu = test::graph::Unary(&g, "Relu", x);
+  g.AddControlEdge(before, relu);
+  Node* tanh = test::graph::Unary(&g, "Tanh", relu);
+  test::graph::Retval(&g, 0, tanh);
+  Node* after = test::graph::NoOp(&g, {});
+  g.AddControlEdge(tanh, after);
+  PlaceAndFuse(&g, kCpu);
+
+  // The control edges of the chain are moved to the fused node.
+  std::vector<Node*> fused = FusedNodes(&g);
+  ASSERT_EQ(1, fused.size());
+  bool has_input = false;
+  for (const Edge* e : fused[0]->in_edges()) {
+    has_input |= e->IsControlEdge() && e->src() == before;
+  }
+  EXPECT_TRUE(has_input);
+  bool has_output = false;
+  for (const Edge* e : fused[0]->out_edges()) {
+    has_output |= e->IsControlEdge() && e->dst() == after;
+  }
+  EXPECT_TRUE(has_output);
+}
+
+}  // namespace
+}  // namespace tensorflow
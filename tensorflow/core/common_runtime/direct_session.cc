@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -133,9 +134,19 @@ Status NewThreadPoolFromThreadPoolOptions(
   return Status::OK();
 }
 
+NumaThreadPool* GlobalNumaThreadPool(const SessionOptions& options) {
+  static NumaThreadPool* const numa_thread_pool =
+      NewNumaThreadPoolFromSessionOptions(options).release();
+  return numa_thread_pool;
+}
+
 thread::ThreadPool* GlobalThreadPool(const SessionOptions& options) {
-  static thread::ThreadPool* const thread_pool =
-      NewThreadPoolFromSessionOptions(options);
+  static thread::ThreadPool* const thread_pool = [&options]() {
+    NumaThreadPool* numa_thread_pool = GlobalNumaThreadPool(options);
+    return numa_thread_pool != nullptr
+               ? new thread::ThreadPool(numa_thread_pool)
+               : NewThreadPoolFromSessionOptions(options);
+  }();
   return thread_pool;
 }
 
@@ -323,10 +334,18 @@ DirectSession::DirectSession(const SessionOptions& options,
       thread_pools_.emplace_back(pool, owned);
     }
   } else if (options_.config.use_per_session_threads()) {
-    thread_pools_.emplace_back(NewThreadPoolFromSessionOptions(options_),
-                               true /* owned */);
+    owned_numa_thread_pool_ = NewNumaThreadPoolFromSessionOptions(options_);
+    if (owned_numa_thread_pool_ != nullptr) {
+      numa_thread_pool_ = owned_numa_thread_pool_.get();
+      thread_pools_.emplace_back(new thread::ThreadPool(numa_thread_pool_),
+                                 true /* owned */);
+    } else {
+      thread_pools_.emplace_back(NewThreadPoolFromSessionOptions(options_),
+                                 true /* owned */);
+    }
   } else {
     thread_pools_.emplace_back(GlobalThreadPool(options), false /* owned */);
+    numa_thread_pool_ = GlobalNumaThreadPool(options);
     // Run locally if environment value of TF_NUM_INTEROP_THREADS is negative
     // and config.inter_op_parallelism_threads is unspecified or negative.
     static const int env_num_threads = NumInterOpThreadsFromEnvironment();
@@ -660,7 +679,8 @@ Status DirectSession::RunInternal(
   if (ShouldUseRunHandlerPool(run_options) &&
       run_options.experimental().use_run_handler_pool()) {
     VLOG(1) << "Using RunHandler to scheduler inter-op closures.";
-    handler = GetOrCreateRunHandlerPool(options_)->Get(step_id);
+    handler = GetOrCreateRunHandlerPool(options_)->Get(
+        step_id, run_options.experimental().run_handler_pool_options());
   }
   auto* handler_ptr = handler.get();
 
@@ -678,6 +698,7 @@ Status DirectSession::RunInternal(
     };
   }
 
+  std::vector<PlannedStepAllocator*> step_allocators;
   for (const auto& item : executors_and_keys->items) {
     // TODO(azaks): support partial run.
     // TODO(azaks): if the device picks its own threadpool, we need to assign
@@ -688,6 +709,21 @@ Status DirectSession::RunInternal(
     // thread pool(s).
     if (!device_thread_pool) {
       args.runner = default_runner;
+      // Keep the ops of a NUMA-local CPU device on the threads of its node,
+      // which is where the device allocates its tensors.
+      if (handler_ptr == nullptr && pool != nullptr &&
+          numa_thread_pool_ != nullptr &&
+          pool->AsEigenThreadPool() == numa_thread_pool_ &&
+          options_.config.experimental().use_numa_affinity()) {
+        const int numa_node = item.device->attributes().locality().numa_node();
+        if (numa_node >= 0 && numa_node < numa_thread_pool_->NumNumaNodes()) {
+          NumaThreadPool* numa_thread_pool = numa_thread_pool_;
+          args.runner = [numa_thread_pool,
+                         numa_node](Executor::Args::Closure c) {
+            numa_thread_pool->ScheduleOnNode(numa_node, std::move(c));
+          };
+        }
+      }
     } else {
       args.runner = [this, device_thread_pool](Executor::Args::Closure c) {
         device_thread_pool->Schedule(std::move(c));
@@ -696,6 +732,11 @@ Status DirectSession::RunInternal(
     if (handler != nullptr) {
       args.user_intra_op_threadpool = handler->AsIntraThreadPoolInterface();
     }
+    args.step_allocator = nullptr;
+    if (item.memory_planner != nullptr) {
+      step_allocators.push_back(item.memory_planner->BeginStep());
+      args.step_allocator = step_allocators.back();
+    }
 
     item.executor->RunAsync(args, barrier->Get());
   }
@@ -704,6 +745,10 @@ Status DirectSession::RunInternal(
                       run_options.timeout_in_ms() > 0
                           ? run_options.timeout_in_ms()
                           : operation_timeout_in_ms_);
+  // The fetched tensors keep their step allocator alive until they are freed.
+  for (PlannedStepAllocator* step_allocator : step_allocators) {
+    step_allocator->Release();
+  }
 
   if (!cancellation_manager_->DeregisterCallback(cancellation_token)) {
     // The step has been cancelled: make sure we don't attempt to receive the
@@ -1362,6 +1407,12 @@ Status DirectSession::CreateExecutors(
 
     item->executor = nullptr;
     item->device = device;
+    if (callable_options.use_static_memory_plan() &&
+        !run_state_args->is_partial_run &&
+        device->device_type() == DEVICE_CPU) {
+      item->memory_planner = std::make_shared<MemoryPlanner>(
+          device->GetAllocator(AllocatorAttributes()));
+    }
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
@@ -1812,14 +1863,21 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
 
 class DirectSession::RunCallableCallFrame : public CallFrameInterface {
  public:
+  // If `consumable_feed_tensors` is not null, it must be `feed_tensors`, and
+  // the arguments are moved out of it. If `use_fetch_buffers` is true, the
+  // return values are written into the buffers of `*fetch_tensors`.
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
+                       std::vector<Tensor>* fetch_tensors,
+                       std::vector<Tensor>* consumable_feed_tensors = nullptr,
+                       bool use_fetch_buffers = false)
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        consumable_feed_tensors_(consumable_feed_tensors),
+        use_fetch_buffers_(use_fetch_buffers) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1840,19 +1898,52 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return Status::OK();
   }
 
+  bool CanConsumeArg(int index) const override {
+    return consumable_feed_tensors_ != nullptr && index >= 0 &&
+           index < consumable_feed_tensors_->size() &&
+           executors_and_keys_->input_types[index] != DT_RESOURCE;
+  }
+
+  void ConsumeArg(int index, Tensor* val) override {
+    *val = std::move((*consumable_feed_tensors_)[index]);
+  }
+
   Status SetRetval(int index, const Tensor& val) override {
     if (index > fetch_tensors_->size()) {
       return errors::Internal("RetVal index out of bounds: ", index);
     }
-    (*fetch_tensors_)[index] = val;
+    if (!use_fetch_buffers_) {
+      (*fetch_tensors_)[index] = val;
+      return Status::OK();
+    }
+    Tensor* buffer = &(*fetch_tensors_)[index];
+    if (val.SharesBufferWith(*buffer)) {
+      // The producer of `val` allocated it in the buffer.
+      return Status::OK();
+    }
+    if (val.shape() != buffer->shape()) {
+      return errors::InvalidArgument(
+          "Fetch ", index, " has shape ", val.shape().DebugString(),
+          ", but its buffer has shape ", buffer->shape().DebugString());
+    }
+    if (val.NumElements() > 0) {
+      std::memcpy(const_cast<char*>(buffer->tensor_data().data()),
+                  val.tensor_data().data(), val.tensor_data().size());
+    }
     return Status::OK();
   }
 
+  const Tensor* GetRetvalBuffer(int index) const override {
+    return use_fetch_buffers_ ? &(*fetch_tensors_)[index] : nullptr;
+  }
+
  private:
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  std::vector<Tensor>* const consumable_feed_tensors_;  // Not owned.
+  const bool use_fetch_buffers_;
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -1866,6 +1957,66 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
     const thread::ThreadPoolOptions& threadpool_options) {
+  return RunCallableInternal(handle, feed_tensors, fetch_tensors,
+                             /*consumable_feed_tensors=*/nullptr,
+                             /*use_fetch_buffers=*/false, run_metadata,
+                             threadpool_options);
+}
+
+::tensorflow::Status DirectSession::RunCallableWithBuffers(
+    CallableHandle handle, std::vector<Tensor>* feed_tensors,
+    std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options) {
+  if (feed_tensors == nullptr || fetch_tensors == nullptr) {
+    return errors::InvalidArgument(
+        "RunCallableWithBuffers() requires feed and fetch tensors.");
+  }
+  return RunCallableInternal(handle, *feed_tensors, fetch_tensors,
+                             feed_tensors, /*use_fetch_buffers=*/true,
+                             run_metadata, threadpool_options);
+}
+
+Status DirectSession::CheckFetchBuffers(
+    const ExecutorsAndKeys& executors_and_keys,
+    const std::vector<Tensor>& fetch_tensors) {
+  const CallableOptions& callable_options = executors_and_keys.callable_options;
+  for (const auto& fetch_device : callable_options.fetch_devices()) {
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::ParseFullName(fetch_device.second, &parsed) ||
+        parsed.type != DEVICE_CPU) {
+      return errors::InvalidArgument("Fetch ", fetch_device.first,
+                                     " is on device ", fetch_device.second,
+                                     ", but fetch buffers must be on the CPU.");
+    }
+  }
+  if (fetch_tensors.size() != executors_and_keys.output_types.size()) {
+    return errors::InvalidArgument(
+        "Expected ", executors_and_keys.output_types.size(),
+        " fetch buffers, but got ", fetch_tensors.size());
+  }
+  for (int i = 0; i < fetch_tensors.size(); ++i) {
+    const DataType dtype = executors_and_keys.output_types[i];
+    if (!fetch_tensors[i].IsInitialized() ||
+        fetch_tensors[i].dtype() != dtype) {
+      return errors::InvalidArgument("Fetch buffer ", i,
+                                     " must be an initialized tensor of type ",
+                                     DataTypeString(dtype));
+    }
+    if (!DataTypeCanUseMemcpy(dtype)) {
+      return errors::InvalidArgument("Fetch ", i, " of type ",
+                                     DataTypeString(dtype),
+                                     " cannot be written into a buffer.");
+    }
+  }
+  return Status::OK();
+}
+
+::tensorflow::Status DirectSession::RunCallableInternal(
+    CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors,
+    std::vector<Tensor>* consumable_feed_tensors, bool use_fetch_buffers,
+    RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
   direct_session_runs->GetCell()->IncrementBy(1);
@@ -1899,7 +2050,10 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Expected ", executors_and_keys->input_types.size(),
         " feed tensors, but got ", feed_tensors.size());
   }
-  if (fetch_tensors != nullptr) {
+  if (use_fetch_buffers) {
+    TF_RETURN_IF_ERROR(
+        CheckFetchBuffers(*executors_and_keys, *fetch_tensors));
+  } else if (fetch_tensors != nullptr) {
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
     return errors::InvalidArgument(
@@ -1917,7 +2071,8 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   // optimized RunCallable interface.
 
   RunCallableCallFrame call_frame(this, executors_and_keys.get(), &feed_tensors,
-                                  fetch_tensors);
+                                  fetch_tensors, consumable_feed_tensors,
+                                  use_fetch_buffers);
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
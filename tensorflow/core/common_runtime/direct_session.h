@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
+#include "tensorflow/core/common_runtime/memory_planner.h"
+#include "tensorflow/core/common_runtime/numa_thread_pool.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
@@ -123,6 +125,11 @@ class DirectSession : public Session {
       std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options) override;
 
+  ::tensorflow::Status RunCallableWithBuffers(
+      CallableHandle handle, std::vector<Tensor>* feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) override;
+
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
   ::tensorflow::Status Finalize() override;
@@ -140,6 +147,9 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // Plans the memory of the partition's steps, if
+    // CallableOptions.use_static_memory_plan is set.
+    std::shared_ptr<MemoryPlanner> memory_planner;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -264,6 +274,20 @@ class DirectSession : public Session {
   ::tensorflow::Status ExtendLocked(GraphDef graph)
       EXCLUSIVE_LOCKS_REQUIRED(graph_state_lock_);
 
+  // Shared implementation of RunCallable() and RunCallableWithBuffers(). If
+  // `consumable_feed_tensors` is not null, it must point to `feed_tensors`,
+  // whose tensors are then moved into the step.
+  ::tensorflow::Status RunCallableInternal(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors,
+      std::vector<Tensor>* consumable_feed_tensors, bool use_fetch_buffers,
+      RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options);
+
+  // Checks that `fetch_tensors` can hold the outputs of a callable.
+  static Status CheckFetchBuffers(const ExecutorsAndKeys& executors_and_keys,
+                                  const std::vector<Tensor>& fetch_tensors);
+
   ::tensorflow::Status ResourceHandleToInputTensor(
       const Tensor& resource_tensor, Tensor* retrieved_tensor);
 
@@ -336,6 +360,12 @@ class DirectSession : public Session {
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // If non-null, the NUMA-aware implementation of the default inter-op thread
+  // pool thread_pools_[0]. Owned by `owned_numa_thread_pool_` for per-session
+  // pools, and process-wide otherwise.
+  NumaThreadPool* numa_thread_pool_ = nullptr;
+  std::unique_ptr<NumaThreadPool> owned_numa_thread_pool_;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
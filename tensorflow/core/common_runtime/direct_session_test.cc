@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
@@ -196,6 +197,34 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_StaticMemoryPlan) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {y_ + ":0", z_ + ":0"}, {});
+  callable_options.set_use_static_memory_plan(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  // The first step records the plan; the others run from it, with the
+  // fetched tensors of earlier steps still alive.
+  std::vector<std::vector<Tensor>> all_outputs;
+  for (int i = 0; i < 5; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(2, outputs.size());
+    all_outputs.push_back(outputs);
+  }
+  for (const auto& outputs : all_outputs) {
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+  }
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -548,6 +577,63 @@ TEST_F(DirectSessionMinusAXTest, TestFeed_Callable) {
   EXPECT_FLOAT_EQ(39.0, mat(1, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, TestFeed_CallableWithBuffers) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(MakeCallableOptions({x_}, {y_ + ":0"}, {}),
+                                     &handle));
+  Tensor y(DT_FLOAT, TensorShape({2, 1}));
+  const char* y_data = y.tensor_data().data();
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Tensor> inputs = {test::AsTensor<float>({5, 6}, {2, 1})};
+    std::vector<Tensor> outputs = {y};
+    TF_ASSERT_OK(session->RunCallableWithBuffers(
+        handle, &inputs, &outputs, nullptr, thread::ThreadPoolOptions()));
+    // MatMul computes the fetch directly in the caller's buffer.
+    EXPECT_EQ(y_data, outputs[0].tensor_data().data());
+    test::ExpectTensorEqual<float>(test::AsTensor<float>({17, 39}, {2, 1}),
+                                   y);
+  }
+
+  // Wrong buffers are rejected.
+  std::vector<Tensor> inputs = {test::AsTensor<float>({5, 6}, {2, 1})};
+  std::vector<Tensor> outputs = {Tensor(DT_INT32, TensorShape({2, 1}))};
+  EXPECT_TRUE(errors::IsInvalidArgument(session->RunCallableWithBuffers(
+      handle, &inputs, &outputs, nullptr, thread::ThreadPoolOptions())));
+  inputs = {test::AsTensor<float>({5, 6}, {2, 1})};
+  outputs = {Tensor(DT_FLOAT, TensorShape({3}))};
+  EXPECT_TRUE(errors::IsInvalidArgument(session->RunCallableWithBuffers(
+      handle, &inputs, &outputs, nullptr, thread::ThreadPoolOptions())));
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST_F(DirectSessionMinusAXTest, TestFeed_CallableWithBuffersCopiesShared) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The output of MatMul is also consumed by Neg, and the output of Identity
+  // is forwarded from its input, so both fetches are copied into the buffers.
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({x_}, {y_ + ":0", z_ + ":0"}, {}), &handle));
+  Tensor y(DT_FLOAT, TensorShape({2, 1}));
+  Tensor z(DT_FLOAT, TensorShape({2, 1}));
+  std::vector<Tensor> inputs = {test::AsTensor<float>({5, 6}, {2, 1})};
+  std::vector<Tensor> outputs = {y, z};
+  TF_ASSERT_OK(session->RunCallableWithBuffers(
+      handle, &inputs, &outputs, nullptr, thread::ThreadPoolOptions()));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({17, 39}, {2, 1}), y);
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({-17, -39}, {2, 1}),
+                                 z);
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestConcurrency) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -49,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -67,6 +69,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/internal/traceme_recorder.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
 namespace tensorflow {
@@ -172,6 +175,8 @@ struct NodeItem {
   bool is_initialization_op : 1;  // True iff IsInitializationOp(node)
   bool is_recv_or_switch : 1;     // True iff IsRecv(node) || IsSwitch(node)
   bool is_next_iteration : 1;     // True iff IsNextIteration(node)
+  // True iff an output of this node is only consumed by a _Retval node.
+  bool feeds_retval : 1;
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
@@ -312,7 +317,12 @@ class GraphView {
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : params_(p), gview_() {
+  // If `lock_free_propagation` is true and the graph has no control flow,
+  // outputs are propagated using atomic pending counts instead of the frame
+  // mutex. See ExecutorState::ActivateNodesLockFree().
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool lock_free_propagation = false)
+      : params_(p), gview_(), lock_free_propagation_(lock_free_propagation) {
     CHECK(p.create_kernel != nullptr);
     CHECK(p.delete_kernel != nullptr);
   }
@@ -341,6 +351,37 @@ class ExecutorImpl : public Executor {
  private:
   friend class ExecutorState;
 
+  // Returns the running average of the compute time of `item`, in CPU cycles.
+  // Only valid when `cost_aware_scheduling_` is true.
+  uint64 NodeCost(const NodeItem& item) const {
+    return node_costs_[item.node_id].load(std::memory_order_relaxed);
+  }
+
+  // Returns true if this execution of `item` should be timed. Expensive nodes
+  // are timed on every execution, and inexpensive ones once every
+  // kCostSampleInterval executions, so that either can be reclassified.
+  bool ShouldMeasureNodeCost(const NodeItem& item) const {
+    if (NodeCost(item) > OpKernel::kOpIsExpensiveThresholdCycles) {
+      return true;
+    }
+    return node_run_counts_[item.node_id].fetch_add(
+               1, std::memory_order_relaxed) %
+               kCostSampleInterval ==
+           0;
+  }
+
+  // Folds `elapsed_cycles` into the running average cost of `item`, using the
+  // same decay as OpKernel::UpdateCostEstimate(). Concurrent updates may drop
+  // samples, which only slows down convergence.
+  void UpdateNodeCost(const NodeItem& item, uint64 elapsed_cycles) const {
+    std::atomic<uint64>* cost = &node_costs_[item.node_id];
+    cost->store((OpKernel::kCostDecay - 1) *
+                        cost->load(std::memory_order_relaxed) /
+                        OpKernel::kCostDecay +
+                    (elapsed_cycles / OpKernel::kCostDecay),
+                std::memory_order_relaxed);
+  }
+
   struct ControlFlowInfo {
     gtl::FlatSet<string> unique_frame_names;
     std::vector<string> frame_names;
@@ -395,6 +436,40 @@ class ExecutorImpl : public Executor {
   // A cached value of params_
   bool device_record_tensor_accesses_ = false;
 
+  // If true, ready nodes are dispatched based on their measured costs in
+  // `node_costs_` instead of OpKernel::IsExpensive(), and inexpensive ready
+  // nodes are batched into a single threadpool closure. Controlled by the
+  // TF_EXECUTOR_COST_AWARE_SCHEDULING environment variable.
+  bool cost_aware_scheduling_ = false;
+
+  // Running average of each node's compute time in CPU cycles, indexed by
+  // node id. Only allocated when `cost_aware_scheduling_` is true.
+  std::unique_ptr<std::atomic<uint64>[]> node_costs_;
+
+  // Number of unmeasured executions of each inexpensive node, indexed by node
+  // id. Only allocated when `cost_aware_scheduling_` is true.
+  std::unique_ptr<std::atomic<uint32>[]> node_run_counts_;
+  static const uint32 kCostSampleInterval = 16;
+
+  // True if the graph has no Enter, Exit, NextIteration or Merge nodes and the
+  // executor was created as a "SINGLE_FRAME" executor.
+  bool lock_free_propagation_;
+
+  // The initial pending count of each node, indexed by node id. Only
+  // populated when `lock_free_propagation_` is true.
+  std::vector<int32> initial_pending_counts_;
+
+  // If true, each step allocates the temporaries of its kernels from a
+  // StepArenaAllocator. Controlled by the TF_EXECUTOR_STEP_ARENA environment
+  // variable, and only supported on CPU devices.
+  bool use_step_arena_ = false;
+
+  // For each node whose item has `feeds_retval` set, the index of the
+  // return value that each of its outputs feeds, or -1. Only populated on
+  // CPU devices, where the producer of a return value may allocate it in the
+  // caller's buffer. See CallFrameInterface::GetRetvalBuffer().
+  gtl::FlatMap<int, gtl::InlinedVector<int, 4>> retval_indices_;
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const NodeItem*> root_nodes_;
 
@@ -630,6 +705,26 @@ Status ExecutorImpl::Initialize(const Graph& graph) {
   device_record_tensor_accesses_ =
       params_.device->RequiresRecordingAccessedTensors();
 
+  Status s = ReadBoolFromEnvVar("TF_EXECUTOR_COST_AWARE_SCHEDULING",
+                                /*default_val=*/false, &cost_aware_scheduling_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_EXECUTOR_COST_AWARE_SCHEDULING: " << s;
+    cost_aware_scheduling_ = false;
+  }
+  if (cost_aware_scheduling_) {
+    node_costs_.reset(new std::atomic<uint64>[graph.num_node_ids()]);
+    node_run_counts_.reset(new std::atomic<uint32>[graph.num_node_ids()]);
+  }
+
+  s = ReadBoolFromEnvVar("TF_EXECUTOR_STEP_ARENA", /*default_val=*/false,
+                         &use_step_arena_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_EXECUTOR_STEP_ARENA: " << s;
+    use_step_arena_ = false;
+  }
+  use_step_arena_ =
+      use_step_arena_ && params_.device->device_type() == DEVICE_CPU;
+
   for (auto& it : cf_info.unique_frame_names) {
     EnsureFrameInfo(it)->nodes = new std::vector<const NodeItem*>;
   }
@@ -656,6 +751,15 @@ Status ExecutorImpl::Initialize(const Graph& graph) {
     }
     CHECK(item->kernel);
     item->kernel_is_async = (item->kernel->AsAsync() != nullptr);
+    if (cost_aware_scheduling_) {
+      // Like OpKernel, assume that a node is expensive until it has been
+      // measured, unless its kernel declares itself inexpensive.
+      node_costs_[id].store(item->kernel->IsExpensive()
+                                ? OpKernel::kInitialCostEstimateCycles
+                                : 0,
+                            std::memory_order_relaxed);
+      node_run_counts_[id].store(0, std::memory_order_relaxed);
+    }
     item->is_merge = IsMerge(n);
     item->is_enter = IsEnter(n);
     if (item->is_enter) {
@@ -676,6 +780,7 @@ Status ExecutorImpl::Initialize(const Graph& graph) {
     item->is_initialization_op = IsInitializationOp(n);
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
+    item->feeds_retval = false;
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -700,10 +805,49 @@ Status ExecutorImpl::Initialize(const Graph& graph) {
     }
   }
 
+  if (params_.device->device_type() == DEVICE_CPU) {
+    for (const Node* n : graph.nodes()) {
+      if (!n->IsRetval()) continue;
+      const Edge* e;
+      TF_RETURN_IF_ERROR(n->input_edge(0, &e));
+      int num_consumers = 0;
+      for (const Edge* out_edge : e->src()->out_edges()) {
+        if (out_edge->src_output() == e->src_output()) ++num_consumers;
+      }
+      if (num_consumers != 1) continue;
+      int index;
+      TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+      auto& indices = retval_indices_[e->src()->id()];
+      indices.resize(e->src()->num_outputs(), -1);
+      indices[e->src_output()] = index;
+      gview_.node(e->src()->id())->feeds_retval = true;
+    }
+  }
+
   // Initialize PendingCounts only after item->pending_id is initialized for
   // all nodes.
   InitializePending(&graph, cf_info);
 
+  if (lock_free_propagation_) {
+    for (const Node* n : graph.nodes()) {
+      const NodeItem* item = gview_.node(n->id());
+      if (item->is_enter_exit_or_next_iter || item->is_merge) {
+        VLOG(1) << "Graph has control flow node " << n->name()
+                << ": propagating outputs under the frame lock";
+        lock_free_propagation_ = false;
+        break;
+      }
+    }
+  }
+  if (lock_free_propagation_) {
+    initial_pending_counts_.resize(graph.num_node_ids(), 0);
+    for (const Node* n : graph.nodes()) {
+      size_t max_pending, max_dead;
+      GetMaxPendingCounts(n, &max_pending, &max_dead);
+      initial_pending_counts_[n->id()] = max_pending;
+    }
+  }
+
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -1303,6 +1447,12 @@ class ExecutorState {
   // QUESTION: Make it a checkpoint::TensorSliceReaderCacheWrapper
   // instead of a pointer?  (avoids having to delete).
   checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
+  // Allocator for the temporaries of this step, or nullptr. Released when
+  // the step is done.
+  StepArenaAllocator* step_arena_ = nullptr;
+  // Allocator for the temporaries and outputs of this step, or nullptr. Not
+  // owned.
+  Allocator* const step_allocator_;
   CallFrameInterface* call_frame_;
   const ExecutorImpl* impl_;
   CancellationManager* cancellation_manager_;
@@ -1320,6 +1470,16 @@ class ExecutorState {
   // The root frame in which the execution of this step is started.
   FrameState* root_frame_;
 
+  // True if outputs are propagated with ActivateNodesLockFree(). The frame
+  // state is not maintained in that case, so it is disabled when dumping the
+  // state for debugging.
+  const bool lock_free_propagation_;
+  // The input tensors of the root frame's only iteration, and the atomic
+  // pending and dead counts of its nodes, indexed by node id. Only used when
+  // `lock_free_propagation_` is true.
+  Entry* root_input_tensors_ = nullptr;
+  std::unique_ptr<std::atomic<int64>[]> atomic_counts_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -1362,12 +1522,21 @@ class ExecutorState {
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_nsec);
 
+  // Process a batch of ready nodes, and any inexpensive nodes they make
+  // ready, in current thread.
+  void ProcessBatch(gtl::ArraySlice<TaggedNode> nodes, int64 scheduled_nsec);
+
   // Before invoking item->kernel, fills in its "inputs".
   Status PrepareInputs(const NodeItem& item, Entry* first_input,
                        TensorValueVec* inputs,
                        AllocatorAttributeVec* input_alloc_attrs,
                        bool* is_input_dead);
 
+  // Fills in the caller-owned buffers of the return values that the outputs
+  // of `item` feed. Returns false if the call frame has none.
+  bool GetOutputBuffers(const NodeItem& item,
+                        gtl::InlinedVector<const Tensor*, 4>* output_buffers);
+
   // After item->kernel computation is done, processes its outputs.
   Status ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
                         EntryVector* outputs, NodeExecStatsInterface* stats);
@@ -1378,6 +1547,19 @@ class ExecutorState {
   void PropagateOutputs(const TaggedNode& tagged_node, const NodeItem* item,
                         EntryVector* outputs, TaggedNodeSeq* ready);
 
+  // The equivalent of FrameState::ActivateNodes() for graphs without control
+  // flow, where every node runs once, in the root frame. Decrements the
+  // atomic pending counts of the successors of `item` without taking the
+  // frame mutex: the input slot written by each edge is only ever read by the
+  // thread that observes its destination's pending count drop to zero.
+  void ActivateNodesLockFree(const NodeItem* item, const bool is_dead,
+                             EntryVector* outputs, TaggedNodeSeq* ready);
+
+  // The atomic counts of ActivateNodesLockFree() hold the dead count in their
+  // upper 32 bits, and the pending count in their lower 32 bits.
+  static const int64 kDeadCountIncrement = 1LL << 32;
+  static const int64 kPendingCountMask = kDeadCountIncrement - 1;
+
   // Called after each node finishes. Takes ownership of "stats". Returns true
   // if execution has completed.
   bool NodeDone(const Status& s, const TaggedNodeSeq& ready,
@@ -1389,6 +1571,22 @@ class ExecutorState {
   void ScheduleReady(const TaggedNodeSeq& ready,
                      TaggedNodeReadyQueue* inline_ready);
 
+  // Variant of ScheduleReady() used when the executor performs cost-aware
+  // scheduling. Expensive nodes are dispatched individually, and inexpensive
+  // nodes are grouped into batches whose total estimated cost is bounded by
+  // kMaxBatchCostCycles. The last such batch is run inline if possible.
+  void ScheduleReadyByCost(const TaggedNodeSeq& ready,
+                           TaggedNodeReadyQueue* inline_ready,
+                           int64 scheduled_nsec);
+
+  // Maximum estimated cost of the inexpensive nodes that cost-aware
+  // scheduling runs in a single threadpool closure.
+  static const uint64 kMaxBatchCostCycles =
+      8 * OpKernel::kOpIsExpensiveThresholdCycles;
+
+  // Size of the blocks that `step_arena_` obtains from the device allocator.
+  static const size_t kStepArenaBlockSize = 256 << 10;
+
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter,
                                  const NodeItem& item);
@@ -1437,17 +1635,24 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
       context_(ContextKind::kThread),
       slice_reader_cache_(new checkpoint::TensorSliceReaderCacheWrapper),
+      step_allocator_(args.step_allocator),
       call_frame_(args.call_frame),
       impl_(impl),
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
+      lock_free_propagation_(impl->lock_free_propagation_ && !vlog_),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = impl_->params_.device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (args.step_allocator == nullptr && impl_->use_step_arena_) {
+    step_arena_ = new StepArenaAllocator(
+        impl_->params_.device->GetAllocator(AllocatorAttributes()),
+        kStepArenaBlockSize);
+  }
 
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
@@ -1462,6 +1667,15 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
                             root_frame_->total_input_tensors));
 
   outstanding_frames_.insert({root_frame_->frame_name, root_frame_});
+
+  if (lock_free_propagation_) {
+    root_input_tensors_ = GetInputTensors(root_frame_, 0);
+    const std::vector<int32>& initial_counts = impl_->initial_pending_counts_;
+    atomic_counts_.reset(new std::atomic<int64>[initial_counts.size()]);
+    for (size_t i = 0; i < initial_counts.size(); ++i) {
+      atomic_counts_[i].store(initial_counts[i], std::memory_order_relaxed);
+    }
+  }
 }
 
 ExecutorState::~ExecutorState() {
@@ -1472,6 +1686,10 @@ ExecutorState::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_ != nullptr) {
+    // Deletes the arena once the tensors that escaped the step are freed.
+    step_arena_->Release();
+  }
 }
 
 Status ExecutorImpl::BuildControlFlowInfo(const Graph* g,
@@ -1653,6 +1871,11 @@ bool MightTrace(const NodeItem& item,
 }
 
 void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
+  ProcessBatch({tagged_node}, scheduled_nsec);
+}
+
+void ExecutorState::ProcessBatch(gtl::ArraySlice<TaggedNode> nodes,
+                                 int64 scheduled_nsec) {
   profiler::TraceMe activity(
       [&] {
         int64 id = step_id_;
@@ -1694,6 +1917,12 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
   params.slice_reader_cache = slice_reader_cache_;
+  if (step_allocator_ != nullptr) {
+    params.step_allocator = step_allocator_;
+    params.step_allocator_for_outputs = true;
+  } else {
+    params.step_allocator = step_arena_;
+  }
   params.inputs = &inputs;
   params.input_alloc_attrs = &input_alloc_attrs;
   params.runner = &runner_;
@@ -1724,10 +1953,13 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
   NodeExecStatsInterface* stats = nullptr;
 
   EntryVector outputs;
+  gtl::InlinedVector<const Tensor*, 4> output_buffers;
   bool completed = false;
-  inline_ready.push_back(tagged_node);
+  for (const TaggedNode& node : nodes) {
+    inline_ready.push_back(node);
+  }
   while (!inline_ready.empty()) {
-    tagged_node = inline_ready.front();
+    TaggedNode tagged_node = inline_ready.front();
     inline_ready.pop_front();
     const NodeItem& item = *tagged_node.node_item;
     FrameState* input_frame = tagged_node.input_frame;
@@ -1795,6 +2027,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
+      params.output_buffers = nullptr;
 
       if (item.kernel_is_async) {
         // Asynchronous computes.
@@ -1864,6 +2097,10 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
         }
       } else {
         // Synchronous computes.
+        if (item.feeds_retval && call_frame_ != nullptr &&
+            GetOutputBuffers(item, &output_buffers)) {
+          params.output_buffers = output_buffers.data();
+        }
         OpKernelContext ctx(&params, item.num_outputs);
         nodestats::SetOpStart(stats);
 
@@ -1887,7 +2124,16 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
           device->Compute(op_kernel, &ctx);
         } else {
           // In the common case, avoid creating any tracing objects.
-          if (op_kernel->IsExpensive()) {
+          if (impl_->cost_aware_scheduling_ &&
+              impl_->ShouldMeasureNodeCost(item)) {
+            KernelTimer timer;
+            device->Compute(op_kernel, &ctx);
+            const uint64 elapsed_cycles = timer.ElapsedCycles();
+            impl_->UpdateNodeCost(item, elapsed_cycles);
+            if (op_kernel->IsExpensive()) {
+              op_kernel->UpdateCostEstimate(elapsed_cycles);
+            }
+          } else if (op_kernel->IsExpensive()) {
             KernelTimer timer;
             device->Compute(op_kernel, &ctx);
             op_kernel->UpdateCostEstimate(timer.ElapsedCycles());
@@ -2031,6 +2277,21 @@ Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
   return Status::OK();
 }
 
+bool ExecutorState::GetOutputBuffers(
+    const NodeItem& item,
+    gtl::InlinedVector<const Tensor*, 4>* output_buffers) {
+  const auto& indices = impl_->retval_indices_.at(item.node_id);
+  output_buffers->assign(indices.size(), nullptr);
+  bool found = false;
+  for (int i = 0; i < indices.size(); ++i) {
+    if (indices[i] >= 0) {
+      (*output_buffers)[i] = call_frame_->GetRetvalBuffer(indices[i]);
+      found |= (*output_buffers)[i] != nullptr;
+    }
+  }
+  return found;
+}
+
 Status ExecutorState::ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
                                      EntryVector* outputs,
                                      NodeExecStatsInterface* stats) {
@@ -2146,6 +2407,12 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
   // Propagates outputs along out edges, and puts newly ready nodes
   // into the ready queue.
   ready->clear();
+  if (lock_free_propagation_) {
+    // The root frame never completes before the step does, so there is no
+    // frame bookkeeping to do.
+    ActivateNodesLockFree(item, is_dead, outputs, ready);
+    return;
+  }
   bool is_frame_done = false;
   FrameState* output_frame = input_frame;
   int64 output_iter = input_iter;
@@ -2236,6 +2503,46 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
   }
 }
 
+void ExecutorState::ActivateNodesLockFree(const NodeItem* item,
+                                          const bool is_dead,
+                                          EntryVector* outputs,
+                                          TaggedNodeSeq* ready) {
+  const GraphView& gview = impl_->gview_;
+  const size_t num_output_edges = item->num_output_edges;
+  const EdgeInfo* edges = item->output_edge_list();
+  for (size_t out_index = 0; out_index < num_output_edges; out_index++) {
+    const EdgeInfo& e = edges[out_index];
+    const int dst_id = e.dst_id;
+    const NodeItem* dst_item = gview.node(dst_id);
+    if (dst_item->is_sink) continue;
+
+    const int src_slot = e.output_slot;
+    const bool is_control_edge = (src_slot == Graph::kControlSlot);
+    const bool increment_dead =
+        (is_dead || (!is_control_edge && !(*outputs)[src_slot].has_value));
+    if (!is_control_edge) {
+      const int dst_loc = dst_item->input_start + e.input_slot;
+      if (e.is_last) {
+        root_input_tensors_[dst_loc] = std::move((*outputs)[src_slot]);
+      } else {
+        root_input_tensors_[dst_loc] = (*outputs)[src_slot];
+      }
+    }
+
+    // Releases the input written above to the thread that makes `dst` ready,
+    // and acquires the inputs written by the other predecessors of `dst`.
+    const int64 delta = increment_dead ? kDeadCountIncrement - 1 : -1;
+    const int64 counts =
+        atomic_counts_[dst_id].fetch_add(delta, std::memory_order_acq_rel) +
+        delta;
+    if ((counts & kPendingCountMask) == 0) {
+      const bool dst_dead =
+          !dst_item->is_control_trigger && counts >= kDeadCountIncrement;
+      ready->emplace_back(dst_item, root_frame_, 0, dst_dead);
+    }
+  }
+}
+
 bool ExecutorState::NodeDone(const Status& s, const TaggedNodeSeq& ready,
                              NodeExecStatsInterface* stats,
                              TaggedNodeReadyQueue* inline_ready) {
@@ -2311,6 +2618,11 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  if (impl_->cost_aware_scheduling_) {
+    ScheduleReadyByCost(ready, inline_ready, scheduled_nsec);
+    return;
+  }
+
   if (inline_ready == nullptr) {
     // Schedule to run all the ready ops in thread pool.
     for (auto& tagged_node : ready) {
@@ -2347,6 +2659,64 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
   }
 }
 
+void ExecutorState::ScheduleReadyByCost(const TaggedNodeSeq& ready,
+                                        TaggedNodeReadyQueue* inline_ready,
+                                        int64 scheduled_nsec) {
+  TaggedNodeSeq batch;
+  uint64 batch_cost = 0;
+  auto dispatch_batch = [this, &batch, &batch_cost, scheduled_nsec]() {
+    runner_([this, nodes = std::move(batch), scheduled_nsec]() {
+      ProcessBatch(nodes, scheduled_nsec);
+    });
+    batch.clear();
+    batch_cost = 0;
+  };
+
+  const TaggedNode* curr_expensive_node = nullptr;
+  for (auto& tagged_node : ready) {
+    // Dead nodes do not invoke their kernel, so they are always inexpensive.
+    const uint64 cost =
+        tagged_node.is_dead ? 0 : impl_->NodeCost(*tagged_node.node_item);
+    if (cost > OpKernel::kOpIsExpensiveThresholdCycles) {
+      if (inline_ready == nullptr) {
+        runner_(std::bind(&ExecutorState::Process, this, tagged_node,
+                          scheduled_nsec));
+      } else {
+        if (curr_expensive_node) {
+          runner_(std::bind(&ExecutorState::Process, this,
+                            *curr_expensive_node, scheduled_nsec));
+        }
+        curr_expensive_node = &tagged_node;
+      }
+      continue;
+    }
+    if (!batch.empty() && batch_cost + cost > kMaxBatchCostCycles) {
+      dispatch_batch();
+    }
+    batch.push_back(tagged_node);
+    batch_cost += cost;
+  }
+
+  if (!batch.empty()) {
+    if (inline_ready == nullptr) {
+      dispatch_batch();
+    } else {
+      // Keep the last batch of inexpensive nodes on this thread.
+      for (const TaggedNode& tagged_node : batch) {
+        inline_ready->push_back(tagged_node);
+      }
+    }
+  }
+  if (curr_expensive_node) {
+    if (inline_ready->empty()) {
+      inline_ready->push_back(*curr_expensive_node);
+    } else {
+      runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
+                        scheduled_nsec));
+    }
+  }
+}
+
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
                                               const NodeItem& item) {
   // TODO(misard) Replace with a finer-grain enabling flag once we
@@ -2962,6 +3332,29 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers an executor that propagates outputs without taking the frame
+// mutex when its graph has no control flow, and behaves like the default
+// executor otherwise.
+class SingleFrameExecutorRegistrar {
+ public:
+  SingleFrameExecutorRegistrar() {
+    ExecutorFactory::Register("SINGLE_FRAME", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      std::unique_ptr<ExecutorImpl> impl(
+          new ExecutorImpl(params, /*lock_free_propagation=*/true));
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return Status::OK();
+    }
+  };
+};
+static SingleFrameExecutorRegistrar single_frame_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -100,6 +100,11 @@ class Executor {
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
 
+    // If not null, the allocator for the temporaries and outputs of the
+    // step's kernels that request no special allocator attributes. Not owned;
+    // it must outlive the step.
+    Allocator* step_allocator = nullptr;
+
     // If true, calls Sync() on the device.
     bool sync_on_finish = false;
 
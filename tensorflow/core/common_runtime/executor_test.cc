@@ -16,13 +16,17 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -56,8 +60,10 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. An empty
+  // `executor_type` selects the default executor.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -77,7 +83,9 @@ class ExecutorTest : public ::testing::Test {
       return Status::OK();
     };
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    std::unique_ptr<Executor> executor;
+    TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+    exec_ = executor.release();
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -170,6 +178,95 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, CostAwareSchedulingWideAdd) {
+  // v_i = a + a for i in [0, 64), and c = sum(v_i), computed as a tree.
+  setenv("TF_EXECUTOR_COST_AWARE_SCHEDULING", "1", 1);
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  std::vector<Node*> level;
+  for (int i = 0; i < 64; ++i) {
+    level.push_back(test::graph::Add(g.get(), in0, in0));
+  }
+  while (level.size() > 1) {
+    std::vector<Node*> next;
+    for (size_t i = 0; i < level.size(); i += 2) {
+      next.push_back(test::graph::Add(g.get(), level[i], level[i + 1]));
+    }
+    level.swap(next);
+  }
+  test::graph::Send(g.get(), level[0], "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  unsetenv("TF_EXECUTOR_COST_AWARE_SCHEDULING");
+  // Run several steps so that later steps schedule using measured costs.
+  for (int step = 0; step < 10; ++step) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(128.0, V(out));
+  }
+}
+
+// Sleeps for 2ms before forwarding its input, although its kernel declares
+// itself inexpensive.
+class SlowInexpensiveOp : public OpKernel {
+ public:
+  explicit SlowInexpensiveOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override {
+    Env::Default()->SleepForMicroseconds(2000);
+    ctx->set_output(0, ctx->input(0));
+  }
+  bool IsExpensive() override { return false; }
+};
+
+REGISTER_OP("SlowInexpensive")
+    .Input("x: float")
+    .Output("y: float")
+    .SetShapeFn(shape_inference::UnchangedShape);
+REGISTER_KERNEL_BUILDER(Name("SlowInexpensive").Device(DEVICE_CPU),
+                        SlowInexpensiveOp);
+
+TEST_F(ExecutorTest, CostAwareSchedulingReclassifiesInexpensiveNodes) {
+  // c fans out to kWidth nodes whose kernel declares them inexpensive, so the
+  // first step runs them all on the thread that ran c. Once they have been
+  // measured, all but one of them are dispatched to the thread pool.
+  const int kWidth = 8;
+  setenv("TF_EXECUTOR_COST_AWARE_SCHEDULING", "1", 1);
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  Node* c = test::graph::Constant(g.get(), V(1.0));
+  for (int i = 0; i < kWidth; ++i) {
+    test::graph::Unary(g.get(), "SlowInexpensive", c);
+  }
+  Create(std::move(g));
+  unsetenv("TF_EXECUTOR_COST_AWARE_SCHEDULING");
+
+  std::atomic<int> num_closures(0);
+  Executor::Args::Runner pool_runner = runner_;
+  runner_ = [&num_closures, pool_runner](std::function<void()> fn) {
+    ++num_closures;
+    pool_runner(std::move(fn));
+  };
+  auto run_step = [this, &num_closures]() {
+    num_closures = 0;
+    TF_EXPECT_OK(Run(rendez_));
+    return num_closures.load();
+  };
+
+  const int first_step_closures = run_step();
+  EXPECT_LT(first_step_closures, kWidth - 1);
+  // Inexpensive nodes are measured at least once every 16 executions.
+  int closures = first_step_closures;
+  for (int step = 0;
+       step < 16 && closures < first_step_closures + kWidth - 1; ++step) {
+    closures = run_step();
+  }
+  EXPECT_GE(closures, first_step_closures + kWidth - 1);
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -250,6 +347,23 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, SingleFrameRandomTree) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "SINGLE_FRAME");
+  for (int step = 0; step < 3; ++step) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -324,6 +438,26 @@ TEST_F(ExecutorTest, SimpleSwitchDead) {
   EXPECT_TRUE(is_dead);
 }
 
+TEST_F(ExecutorTest, SingleFrameSwitchDead) {
+  // The dead output of the switch is propagated through the add.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  auto sum = test::graph::Add(g.get(), tmp, in0);
+  test::graph::Send(g.get(), sum, "c", BOB, 1, ALICE);
+  Create(std::move(g), "SINGLE_FRAME");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 TEST_F(ExecutorTest, Abort) {
   // e = a + b + c + d
   auto g = absl::make_unique<Graph>(OpRegistry::Global());
@@ -470,6 +604,68 @@ BENCHMARK(BM_executor)->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->ArgPair(1024, 1024);
 
+// Create a graph with 'width' independent chains of 'depth' scalar additions,
+// and compare the default scheduler (cost_aware == 0) with cost-aware
+// scheduling (cost_aware == 1), which batches the cheap ready nodes that the
+// default scheduler dispatches one closure at a time.
+static void BM_executor_wide(int iters, int width, int cost_aware) {
+#ifdef PLATFORM_GOOGLE
+  BenchmarkUseRealTime();
+#endif  // PLATFORM_GOOGLE
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+  Node* c = test::graph::Constant(g, one);
+  const int kDepth = 8;
+  for (int i = 0; i < width; ++i) {
+    Node* n = c;
+    for (int j = 0; j < kDepth; ++j) {
+      n = test::graph::Add(g, n, c);
+    }
+  }
+#ifdef PLATFORM_GOOGLE
+  SetBenchmarkLabel(cost_aware ? "cost_aware" : "default");
+  SetBenchmarkItemsProcessed(static_cast<int64>(width) * kDepth * iters);
+#endif  // PLATFORM_GOOGLE
+  setenv("TF_EXECUTOR_COST_AWARE_SCHEDULING", cost_aware ? "1" : "0", 1);
+  test::Benchmark("cpu", g).Run(iters);
+  unsetenv("TF_EXECUTOR_COST_AWARE_SCHEDULING");
+}
+
+BENCHMARK(BM_executor_wide)->ArgPair(64, 0)->ArgPair(64, 1);
+BENCHMARK(BM_executor_wide)->ArgPair(1024, 0)->ArgPair(1024, 1);
+
+// Compare the default executor (single_frame == 0) with the "SINGLE_FRAME"
+// executor (single_frame == 1) on the tall fat NoOp graph of BM_executor
+// shape, where output propagation dominates the step time.
+static void BM_executor_single_frame(int iters, int width, int single_frame) {
+#ifdef PLATFORM_GOOGLE
+  BenchmarkUseRealTime();
+#endif  // PLATFORM_GOOGLE
+  Graph* g = new Graph(OpRegistry::Global());
+  const int kDepth = 64;
+  std::vector<Node*> level;
+  for (int i = 0; i < width; ++i) {
+    level.push_back(test::graph::NoOp(g, {}));
+  }
+  for (int i = 0; i < kDepth; ++i) {
+    Node* join = test::graph::NoOp(g, level);
+    for (int j = 0; j < width; ++j) {
+      level[j] = test::graph::NoOp(g, {join});
+    }
+  }
+#ifdef PLATFORM_GOOGLE
+  SetBenchmarkLabel(single_frame ? "single_frame" : "default");
+  SetBenchmarkItemsProcessed(static_cast<int64>(width + 1) * kDepth * iters);
+#endif  // PLATFORM_GOOGLE
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
+                  single_frame ? "SINGLE_FRAME" : "")
+      .Run(iters);
+}
+
+BENCHMARK(BM_executor_single_frame)->ArgPair(16, 0)->ArgPair(16, 1);
+BENCHMARK(BM_executor_single_frame)->ArgPair(256, 0)->ArgPair(256, 1);
+
 static void BM_FeedInputFetchOutput(int iters) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
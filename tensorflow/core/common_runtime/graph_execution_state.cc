@@ -54,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/util/util.h"
 
 #ifndef IS_MOBILE_PLATFORM
+#include "tensorflow/core/common_runtime/graph_optimization_cache.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
@@ -730,10 +731,34 @@ Status GraphExecutionState::OptimizeGraph(
         cpu_device = device;
       }
     }
-    grappler::VirtualCluster cluster(device_set_);
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
-        item, session_options_->config, cpu_device, &cluster, &new_graph));
+    // Reuse the result of an identical optimization, possibly by another
+    // process, if there is an on-disk cache.
+    GraphOptimizationCache* cache = GraphOptimizationCache::Global();
+    uint64 cache_key = 0;
+    if (cache != nullptr) {
+      std::vector<DeviceAttributes> devices;
+      for (const Device* d : device_set_->devices()) {
+        devices.push_back(d->attributes());
+      }
+      if (!GraphOptimizationCache::Fingerprint(
+              item, devices, session_options_->config, &cache_key)) {
+        cache = nullptr;
+      }
+    }
+    if (cache != nullptr && cache->Lookup(cache_key, &new_graph)) {
+      VLOG(1) << "Using the cached optimized graph " << cache_key;
+    } else {
+      grappler::VirtualCluster cluster(device_set_);
+      TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+          item, session_options_->config, cpu_device, &cluster, &new_graph));
+      if (cache != nullptr) {
+        Status s = cache->Insert(cache_key, new_graph);
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to cache the optimized graph: " << s;
+        }
+      }
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
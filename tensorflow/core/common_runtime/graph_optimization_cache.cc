@@ -0,0 +1,167 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/graph_optimization_cache.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Appends the deterministic serialization of `msg` to `*out`, preceded by its
+// length so that adjacent fields cannot be confused. Returns false if `msg` is
+// too large to be serialized.
+bool AppendProto(const protobuf::MessageLite& msg, string* out) {
+  string serialized;
+  if (!SerializeToStringDeterministic(msg, &serialized)) return false;
+  absl::StrAppend(out, serialized.size(), ":", serialized);
+  return true;
+}
+
+void AppendString(const string& s, string* out) {
+  absl::StrAppend(out, s.size(), ":", s);
+}
+
+}  // namespace
+
+GraphOptimizationCache::GraphOptimizationCache(const string& directory,
+                                               Env* env)
+    : directory_(directory), env_(env) {}
+
+GraphOptimizationCache* GraphOptimizationCache::Global() {
+  static GraphOptimizationCache* cache = []() -> GraphOptimizationCache* {
+    string directory;
+    Status s = ReadStringFromEnvVar("TF_GRAPH_OPTIMIZATION_CACHE_DIR", "",
+                                    &directory);
+    if (!s.ok()) {
+      LOG(WARNING) << "Ignoring TF_GRAPH_OPTIMIZATION_CACHE_DIR: " << s;
+      return nullptr;
+    }
+    if (directory.empty()) return nullptr;
+    s = Env::Default()->RecursivelyCreateDir(directory);
+    if (!s.ok()) {
+      LOG(WARNING) << "Not caching optimized graphs in " << directory << ": "
+                   << s;
+      return nullptr;
+    }
+    VLOG(1) << "Caching optimized graphs in " << directory;
+    return new GraphOptimizationCache(directory);
+  }();
+  return cache;
+}
+
+bool GraphOptimizationCache::Fingerprint(
+    const grappler::GrapplerItem& item,
+    const std::vector<DeviceAttributes>& devices, const ConfigProto& config,
+    uint64* fingerprint) {
+  string key;
+  AppendString(TF_VERSION_STRING, &key);
+  AppendString(tf_git_version(), &key);
+  absl::StrAppend(&key, TF_GRAPH_DEF_VERSION, ";");
+  if (!AppendProto(item.graph, &key)) return false;
+  absl::StrAppend(&key, item.fetch.size(), ";");
+  for (const string& fetch : item.fetch) {
+    AppendString(fetch, &key);
+  }
+  // Grappler only uses the types and shapes of the feeds.
+  absl::StrAppend(&key, item.feed.size(), ";");
+  for (const auto& feed : item.feed) {
+    AppendString(feed.first, &key);
+    absl::StrAppend(&key, feed.second.dtype(), ";");
+    TensorShapeProto shape;
+    feed.second.shape().AsProto(&shape);
+    if (!AppendProto(shape, &key)) return false;
+  }
+  const grappler::GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  for (bool option : {options.allow_non_differentiable_rewrites,
+                      options.allow_pruning_stateful_and_dataset_ops,
+                      options.optimize_function_library,
+                      options.is_eager_mode}) {
+    absl::StrAppend(&key, option ? "1" : "0");
+  }
+  absl::StrAppend(&key, ";");
+  // `devices()` is ordered.
+  absl::StrAppend(&key, item.devices().size(), ";");
+  for (const string& device : item.devices()) {
+    AppendString(device, &key);
+  }
+  // The incarnation is chosen at random by every process, and does not affect
+  // the optimization.
+  std::vector<DeviceAttributes> sorted_devices(devices);
+  std::sort(sorted_devices.begin(), sorted_devices.end(),
+            [](const DeviceAttributes& a, const DeviceAttributes& b) {
+              return a.name() < b.name();
+            });
+  absl::StrAppend(&key, sorted_devices.size(), ";");
+  for (DeviceAttributes& device : sorted_devices) {
+    device.clear_incarnation();
+    if (!AppendProto(device, &key)) return false;
+  }
+  ConfigProto other_config = config;
+  other_config.mutable_graph_options()->clear_rewrite_options();
+  if (!AppendProto(config.graph_options().rewrite_options(), &key) ||
+      !AppendProto(other_config, &key)) {
+    return false;
+  }
+  *fingerprint = Fingerprint64(key);
+  return true;
+}
+
+string GraphOptimizationCache::FileName(uint64 key) const {
+  return io::JoinPath(directory_,
+                      absl::StrCat(absl::Hex(key, absl::kZeroPad16), ".pb"));
+}
+
+bool GraphOptimizationCache::Lookup(uint64 key,
+                                    GraphDef* optimized_graph) const {
+  const string file_name = FileName(key);
+  if (!env_->FileExists(file_name).ok()) return false;
+  Status s = ReadBinaryProto(env_, file_name, optimized_graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring unreadable optimized graph " << file_name << ": "
+                 << s;
+    optimized_graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+Status GraphOptimizationCache::Insert(uint64 key,
+                                      const GraphDef& optimized_graph) const {
+  const string file_name = FileName(key);
+  // Concurrent writers each write their own temporary file, and readers only
+  // see complete files.
+  const string tmp_file_name =
+      absl::StrCat(file_name, ".tmp.", absl::Hex(random::New64()));
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env_, tmp_file_name, optimized_graph));
+  Status s = env_->RenameFile(tmp_file_name, file_name);
+  if (!s.ok()) {
+    env_->DeleteFile(tmp_file_name).IgnoreError();
+  }
+  return s;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,85 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_OPTIMIZATION_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_OPTIMIZATION_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// An on-disk cache of the graphs produced by grappler's MetaOptimizer.
+//
+// GraphExecutionState optimizes the graph of a session again for each new
+// feed/fetch signature, which can take seconds for large graphs. The cache
+// stores each optimized GraphDef (with its function library) in a file named
+// after a fingerprint of everything the optimization depends on, so that
+// other processes running the same graph with the same configuration, such as
+// a restarted process or another replica, can skip the optimization.
+//
+// The directory may be shared by concurrent processes: entries are written to
+// a temporary file and renamed into place, and unreadable entries are treated
+// as misses.
+class GraphOptimizationCache {
+ public:
+  explicit GraphOptimizationCache(const string& directory,
+                                  Env* env = Env::Default());
+
+  // Returns the cache in the directory named by the
+  // TF_GRAPH_OPTIMIZATION_CACHE_DIR environment variable, or nullptr if it is
+  // not set.
+  static GraphOptimizationCache* Global();
+
+  // Computes the fingerprint of the optimization of `item` for `devices` under
+  // `config`: the graph and its library, the fetches, the names, types and
+  // shapes of the feeds, the grappler options of `item`, the attributes of the
+  // devices (type, memory limit, locality and description, but not their
+  // per-process incarnation), the RewriterConfig and the rest of the session
+  // configuration, and the version of TensorFlow. Returns false if the graph
+  // is too large to be serialized.
+  static bool Fingerprint(const grappler::GrapplerItem& item,
+                          const std::vector<DeviceAttributes>& devices,
+                          const ConfigProto& config, uint64* fingerprint);
+
+  // Looks up the optimized graph for `key`. Returns true and fills in
+  // `*optimized_graph` on a hit.
+  bool Lookup(uint64 key, GraphDef* optimized_graph) const;
+
+  // Stores `optimized_graph` as the optimized graph for `key`.
+  Status Insert(uint64 key, const GraphDef& optimized_graph) const;
+
+  const string& directory() const { return directory_; }
+
+ private:
+  string FileName(uint64 key) const;
+
+  const string directory_;
+  Env* const env_;  // Not owned.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GraphOptimizationCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_OPTIMIZATION_CACHE_H_
@@ -0,0 +1,189 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/graph_optimization_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace {
+
+grappler::GrapplerItem MakeItem() {
+  grappler::GrapplerItem item;
+  NodeDef* x = item.graph.add_node();
+  x->set_name("x");
+  x->set_op("Placeholder");
+  NodeDef* y = item.graph.add_node();
+  y->set_name("y");
+  y->set_op("Identity");
+  y->add_input("x");
+  item.fetch.push_back("y");
+  item.feed.emplace_back("x", Tensor(DT_FLOAT, TensorShape({2})));
+  TF_CHECK_OK(item.AddDevice("/job:localhost/replica:0/task:0/device:CPU:0"));
+  return item;
+}
+
+std::vector<DeviceAttributes> MakeDevices() {
+  DeviceAttributes cpu;
+  cpu.set_name("/job:localhost/replica:0/task:0/device:CPU:0");
+  cpu.set_device_type("CPU");
+  cpu.set_memory_limit(256 << 20);
+  cpu.set_incarnation(1);
+  return {cpu};
+}
+
+uint64 Fingerprint(const grappler::GrapplerItem& item,
+                   const std::vector<DeviceAttributes>& devices,
+                   const ConfigProto& config) {
+  uint64 fingerprint;
+  CHECK(GraphOptimizationCache::Fingerprint(item, devices, config,
+                                            &fingerprint));
+  return fingerprint;
+}
+
+uint64 Fingerprint(const grappler::GrapplerItem& item,
+                   const ConfigProto& config) {
+  return Fingerprint(item, MakeDevices(), config);
+}
+
+TEST(GraphOptimizationCacheTest, FingerprintCoversInputs) {
+  ConfigProto config;
+  const uint64 base = Fingerprint(MakeItem(), config);
+  EXPECT_EQ(base, Fingerprint(MakeItem(), config));
+
+  grappler::GrapplerItem item = MakeItem();
+  item.fetch.push_back("x");
+  EXPECT_NE(base, Fingerprint(item, config));
+
+  item = MakeItem();
+  item.feed[0].second = Tensor(DT_FLOAT, TensorShape({3}));
+  EXPECT_NE(base, Fingerprint(item, config));
+
+  item = MakeItem();
+  item.graph.mutable_node(1)->set_device("/device:CPU:0");
+  EXPECT_NE(base, Fingerprint(item, config));
+
+  item = MakeItem();
+  TF_ASSERT_OK(item.AddDevice("/job:localhost/replica:0/task:0/device:GPU:0"));
+  EXPECT_NE(base, Fingerprint(item, config));
+
+  item = MakeItem();
+  item.optimization_options().allow_pruning_stateful_and_dataset_ops = false;
+  EXPECT_NE(base, Fingerprint(item, config));
+
+  config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_disable_model_pruning(true);
+  EXPECT_NE(base, Fingerprint(MakeItem(), config));
+}
+
+TEST(GraphOptimizationCacheTest, FingerprintCoversDeviceAttributes) {
+  const ConfigProto config;
+  const uint64 base = Fingerprint(MakeItem(), MakeDevices(), config);
+
+  // Every process picks its own incarnations.
+  std::vector<DeviceAttributes> devices = MakeDevices();
+  devices[0].set_incarnation(2);
+  EXPECT_EQ(base, Fingerprint(MakeItem(), devices, config));
+
+  devices = MakeDevices();
+  devices[0].set_memory_limit(512 << 20);
+  EXPECT_NE(base, Fingerprint(MakeItem(), devices, config));
+
+  devices = MakeDevices();
+  devices[0].set_physical_device_desc("another model");
+  EXPECT_NE(base, Fingerprint(MakeItem(), devices, config));
+
+  devices = MakeDevices();
+  devices.push_back(devices[0]);
+  devices[1].set_name("/job:localhost/replica:0/task:0/device:GPU:0");
+  devices[1].set_device_type("GPU");
+  EXPECT_NE(base, Fingerprint(MakeItem(), devices, config));
+}
+
+TEST(GraphOptimizationCacheTest, ChangedConfigMissesCache) {
+  const string directory =
+      io::JoinPath(testing::TmpDir(), "graph_optimization_cache_config");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(directory));
+  GraphOptimizationCache cache(directory);
+  const grappler::GrapplerItem item = MakeItem();
+  ConfigProto config;
+  TF_ASSERT_OK(cache.Insert(Fingerprint(item, config), item.graph));
+  GraphDef graph;
+  EXPECT_TRUE(cache.Lookup(Fingerprint(item, config), &graph));
+
+  // A different optimizer configuration misses the cache.
+  ConfigProto rewriter_config = config;
+  rewriter_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_FALSE(cache.Lookup(Fingerprint(item, rewriter_config), &graph));
+
+  // So do devices with a different memory limit.
+  std::vector<DeviceAttributes> devices = MakeDevices();
+  devices[0].set_memory_limit(1 << 30);
+  EXPECT_FALSE(cache.Lookup(Fingerprint(item, devices, config), &graph));
+}
+
+TEST(GraphOptimizationCacheTest, InsertAndLookup) {
+  const string directory =
+      io::JoinPath(testing::TmpDir(), "graph_optimization_cache_insert");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(directory));
+  GraphOptimizationCache cache(directory);
+
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(1, &graph));
+
+  const grappler::GrapplerItem item = MakeItem();
+  TF_ASSERT_OK(cache.Insert(1, item.graph));
+  ASSERT_TRUE(cache.Lookup(1, &graph));
+  EXPECT_EQ(item.graph.DebugString(), graph.DebugString());
+  EXPECT_FALSE(cache.Lookup(2, &graph));
+
+  // Entries can be replaced, and no temporary files are left behind.
+  TF_ASSERT_OK(cache.Insert(1, GraphDef()));
+  ASSERT_TRUE(cache.Lookup(1, &graph));
+  EXPECT_EQ(0, graph.node_size());
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_EQ(1, children.size());
+}
+
+TEST(GraphOptimizationCacheTest, CorruptEntryIsAMiss) {
+  const string directory =
+      io::JoinPath(testing::TmpDir(), "graph_optimization_cache_corrupt");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(directory));
+  GraphOptimizationCache cache(directory);
+  TF_ASSERT_OK(cache.Insert(1, MakeItem().graph));
+
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  ASSERT_EQ(1, children.size());
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), io::JoinPath(directory, children[0]), "not a graph"));
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(1, &graph));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,328 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  const size_t alignment = Allocator::kAllocatorAlignment;
+  return std::max<size_t>(alignment,
+                          (num_bytes + alignment - 1) & ~(alignment - 1));
+}
+
+// Assigns offsets greedily, largest allocation first: each allocation gets
+// the lowest offset that does not overlap an already placed allocation with
+// an overlapping lifetime.
+std::shared_ptr<MemoryPlan> BuildPlan(const std::vector<size_t>& num_bytes,
+                                      const std::vector<int64>& alloc_times,
+                                      const std::vector<int64>& free_times) {
+  const int n = num_bytes.size();
+  auto plan = std::make_shared<MemoryPlan>();
+  plan->entries.resize(n);
+  for (int i = 0; i < n; ++i) {
+    plan->entries[i].num_bytes = num_bytes[i];
+    plan->entries[i].size = RoundUpToAlignment(num_bytes[i]);
+  }
+  auto lifetimes_overlap = [&alloc_times, &free_times](int i, int j) {
+    return alloc_times[i] < free_times[j] && alloc_times[j] < free_times[i];
+  };
+
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&plan](int a, int b) {
+    return plan->entries[a].size > plan->entries[b].size;
+  });
+  // The placed entries, sorted by offset.
+  std::vector<int> placed;
+  placed.reserve(n);
+  for (int i : order) {
+    MemoryPlan::Entry& entry = plan->entries[i];
+    size_t offset = 0;
+    for (int j : placed) {
+      if (!lifetimes_overlap(i, j)) continue;
+      const MemoryPlan::Entry& other = plan->entries[j];
+      if (offset + entry.size <= other.offset) break;
+      offset = std::max(offset, other.offset + other.size);
+    }
+    entry.offset = offset;
+    plan->slab_size = std::max(plan->slab_size, offset + entry.size);
+    auto pos = std::upper_bound(placed.begin(), placed.end(), offset,
+                                [&plan](size_t value, int j) {
+                                  return value < plan->entries[j].offset;
+                                });
+    placed.insert(pos, i);
+  }
+
+  for (int i = 0; i < n; ++i) {
+    MemoryPlan::Entry& a = plan->entries[i];
+    for (int j = i + 1; j < n; ++j) {
+      MemoryPlan::Entry& b = plan->entries[j];
+      if (a.offset < b.offset + b.size && b.offset < a.offset + a.size) {
+        a.conflicts.push_back(j);
+        b.conflicts.push_back(i);
+      }
+    }
+    plan->entries_by_num_bytes[a.num_bytes].push_back(i);
+  }
+  return plan;
+}
+
+}  // namespace
+
+MemoryPlanner::MemoryPlanner(Allocator* allocator) : allocator_(allocator) {}
+
+MemoryPlanner::~MemoryPlanner() {
+  mutex_lock l(mu_);
+  FreeSlabsLocked();
+}
+
+PlannedStepAllocator* MemoryPlanner::BeginStep() {
+  mutex_lock l(mu_);
+  if (plan_ != nullptr) {
+    char* slab = nullptr;
+    if (!free_slabs_.empty()) {
+      slab = free_slabs_.back();
+      free_slabs_.pop_back();
+    } else {
+      slab = static_cast<char*>(allocator_->AllocateRaw(
+          Allocator::kAllocatorAlignment, plan_->slab_size));
+    }
+    if (slab != nullptr) {
+      return new PlannedStepAllocator(shared_from_this(), allocator_, plan_,
+                                      slab, false /*record*/);
+    }
+  } else if (!recording_ && num_recordings_ < kMaxRecordings) {
+    recording_ = true;
+    ++num_recordings_;
+    return new PlannedStepAllocator(shared_from_this(), allocator_, nullptr,
+                                    nullptr, true /*record*/);
+  }
+  return new PlannedStepAllocator(shared_from_this(), allocator_, nullptr,
+                                  nullptr, false /*record*/);
+}
+
+std::shared_ptr<const MemoryPlan> MemoryPlanner::plan() {
+  mutex_lock l(mu_);
+  return plan_;
+}
+
+void MemoryPlanner::FinishRecording(const std::vector<size_t>& num_bytes,
+                                    const std::vector<int64>& alloc_times,
+                                    const std::vector<int64>& free_times) {
+  std::shared_ptr<MemoryPlan> plan;
+  if (!num_bytes.empty()) {
+    plan = BuildPlan(num_bytes, alloc_times, free_times);
+  }
+  mutex_lock l(mu_);
+  recording_ = false;
+  if (plan == nullptr) {
+    // Nothing to plan for.
+    num_recordings_ = kMaxRecordings;
+    return;
+  }
+  VLOG(1) << "Planned " << plan->entries.size() << " allocations in a slab of "
+          << plan->slab_size << " bytes";
+  FreeSlabsLocked();
+  plan_ = std::move(plan);
+}
+
+void MemoryPlanner::InvalidatePlan(const MemoryPlan* plan) {
+  mutex_lock l(mu_);
+  // Once out of recordings, keep the last plan: the requests that match it
+  // still avoid the underlying allocator.
+  if (plan_.get() == plan && num_recordings_ < kMaxRecordings) {
+    VLOG(1) << "Discarding a memory plan that does not match the step";
+    FreeSlabsLocked();
+    plan_.reset();
+  }
+}
+
+void MemoryPlanner::ReturnSlab(const MemoryPlan* plan, char* slab) {
+  mutex_lock l(mu_);
+  if (plan_.get() == plan) {
+    free_slabs_.push_back(slab);
+  } else {
+    allocator_->DeallocateRaw(slab);
+  }
+}
+
+void MemoryPlanner::FreeSlabsLocked() {
+  for (char* slab : free_slabs_) {
+    allocator_->DeallocateRaw(slab);
+  }
+  free_slabs_.clear();
+}
+
+PlannedStepAllocator::PlannedStepAllocator(
+    std::shared_ptr<MemoryPlanner> planner, Allocator* allocator,
+    std::shared_ptr<const MemoryPlan> plan, char* slab, bool record)
+    : planner_(std::move(planner)),
+      allocator_(allocator),
+      plan_(std::move(plan)),
+      slab_(slab),
+      record_(record) {
+  if (plan_ != nullptr) {
+    used_.resize(plan_->entries.size(), false);
+    live_.resize(plan_->entries.size(), false);
+  }
+}
+
+void* PlannedStepAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    ++num_outstanding_;
+    if (plan_ != nullptr && !released_ && alignment <= kAllocatorAlignment) {
+      void* ptr = AllocateFromPlan(num_bytes);
+      if (ptr != nullptr) {
+        return ptr;
+      }
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+  mutex_lock l(mu_);
+  if (ptr == nullptr) {
+    --num_outstanding_;
+    return nullptr;
+  }
+  if (record_ && !released_ && alignment <= kAllocatorAlignment &&
+      num_bytes_.size() < MemoryPlanner::kMaxPlannedAllocations) {
+    live_entries_[ptr] = num_bytes_.size();
+    num_bytes_.push_back(num_bytes);
+    alloc_times_.push_back(clock_++);
+    free_times_.push_back(kint64max);
+  }
+  return ptr;
+}
+
+void* PlannedStepAllocator::AllocateFromPlan(size_t num_bytes) {
+  auto it = plan_->entries_by_num_bytes.find(num_bytes);
+  if (it == plan_->entries_by_num_bytes.end()) {
+    mismatch_ = true;
+    return nullptr;
+  }
+  bool found_unused = false;
+  for (int k : it->second) {
+    if (used_[k]) continue;
+    found_unused = true;
+    const MemoryPlan::Entry& entry = plan_->entries[k];
+    bool in_use = false;
+    for (int c : entry.conflicts) {
+      if (live_[c]) {
+        in_use = true;
+        break;
+      }
+    }
+    // The kernels ran in a different order than in the recorded step; try
+    // the next entry of the same size.
+    if (in_use) continue;
+    used_[k] = true;
+    live_[k] = true;
+    ++num_live_in_slab_;
+    void* ptr = slab_ + entry.offset;
+    live_entries_[ptr] = k;
+    return ptr;
+  }
+  if (!found_unused) {
+    // More requests of this size than in the recorded step.
+    mismatch_ = true;
+  }
+  return nullptr;
+}
+
+void PlannedStepAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  bool in_slab = false;
+  char* slab_to_return = nullptr;
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    const char* p = static_cast<const char*>(ptr);
+    if (slab_ != nullptr && p >= slab_ && p < slab_ + plan_->slab_size) {
+      in_slab = true;
+      auto it = live_entries_.find(ptr);
+      DCHECK(it != live_entries_.end());
+      live_[it->second] = false;
+      live_entries_.erase(it);
+      if (--num_live_in_slab_ == 0 && released_) {
+        slab_to_return = slab_;
+        slab_ = nullptr;
+      }
+    } else if (record_ && !released_) {
+      auto it = live_entries_.find(ptr);
+      if (it != live_entries_.end()) {
+        free_times_[it->second] = clock_++;
+        live_entries_.erase(it);
+      }
+    }
+    --num_outstanding_;
+    should_delete = released_ && num_outstanding_ == 0;
+  }
+  if (!in_slab) {
+    allocator_->DeallocateRaw(ptr);
+  }
+  if (slab_to_return != nullptr) {
+    planner_->ReturnSlab(plan_.get(), slab_to_return);
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+void PlannedStepAllocator::Release() {
+  std::vector<size_t> num_bytes;
+  std::vector<int64> alloc_times;
+  std::vector<int64> free_times;
+  bool invalidate_plan;
+  char* slab_to_return = nullptr;
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    CHECK(!released_);
+    released_ = true;
+    if (record_) {
+      num_bytes.swap(num_bytes_);
+      alloc_times.swap(alloc_times_);
+      free_times.swap(free_times_);
+      live_entries_.clear();
+    }
+    invalidate_plan = plan_ != nullptr && mismatch_;
+    if (slab_ != nullptr && num_live_in_slab_ == 0) {
+      slab_to_return = slab_;
+      slab_ = nullptr;
+    }
+    should_delete = num_outstanding_ == 0;
+  }
+  if (record_) {
+    planner_->FinishRecording(num_bytes, alloc_times, free_times);
+  }
+  if (invalidate_plan) {
+    planner_->InvalidatePlan(plan_.get());
+  }
+  if (slab_to_return != nullptr) {
+    planner_->ReturnSlab(plan_.get(), slab_to_return);
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+}  // namespace tensorflow
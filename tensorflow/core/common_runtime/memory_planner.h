@@ -0,0 +1,177 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The offsets of the allocations of one step within a single slab of memory.
+struct MemoryPlan {
+  struct Entry {
+    // Size of the allocation request, and of its region in the slab.
+    size_t num_bytes;
+    size_t offset;
+    size_t size;
+    // The entries whose regions overlap this one. Two overlapping entries
+    // were never live at the same time during the recorded step, but may be
+    // in another step if the kernels run in a different order.
+    std::vector<int> conflicts;
+  };
+
+  std::vector<Entry> entries;
+  // Indices of the entries of each allocation size, in allocation order.
+  gtl::FlatMap<size_t, std::vector<int>> entries_by_num_bytes;
+  size_t slab_size = 0;
+};
+
+class PlannedStepAllocator;
+
+// Plans the memory of the steps of a graph whose allocations are the same
+// from step to step, e.g. a callable run with fixed input shapes.
+//
+// The first step records the size and lifetime of each allocation, and a
+// plan assigns every recorded allocation an offset in one slab: allocations
+// whose lifetimes do not overlap may share memory, as in XLA's HeapSimulator
+// and TFLite's ArenaPlanner. Later steps carve their allocations out of a
+// preallocated slab by matching each request against the plan by size. A
+// request that does not match the plan, or whose region is still in use, is
+// forwarded to the underlying allocator. If a step makes requests that the
+// plan did not expect, the plan is discarded and the next step records a new
+// one, up to a fixed number of times.
+class MemoryPlanner : public std::enable_shared_from_this<MemoryPlanner> {
+ public:
+  // `allocator` must outlive this object and every PlannedStepAllocator it
+  // returns.
+  explicit MemoryPlanner(Allocator* allocator);
+  ~MemoryPlanner();
+
+  // Returns the allocator for the intermediates of one step. The caller must
+  // call Release() on it once the step is done. Steps may run concurrently;
+  // each gets its own slab.
+  PlannedStepAllocator* BeginStep();
+
+  // Returns the current plan, or nullptr if there is none.
+  std::shared_ptr<const MemoryPlan> plan();
+
+  // Limits on the recordings made by a planner, and on the number of
+  // allocations per step that are planned.
+  static const int kMaxRecordings = 3;
+  static const int kMaxPlannedAllocations = 2048;
+
+ private:
+  friend class PlannedStepAllocator;
+
+  // Builds a plan from the allocations recorded during a step. `free_times`
+  // are kint64max for allocations that outlived the step.
+  void FinishRecording(const std::vector<size_t>& num_bytes,
+                       const std::vector<int64>& alloc_times,
+                       const std::vector<int64>& free_times);
+
+  // Discards `plan` because a step did not match it.
+  void InvalidatePlan(const MemoryPlan* plan);
+
+  // Returns a slab for `plan` that a step is done with.
+  void ReturnSlab(const MemoryPlan* plan, char* slab);
+
+  void FreeSlabsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const allocator_;
+
+  mutex mu_;
+  std::shared_ptr<const MemoryPlan> plan_ GUARDED_BY(mu_);
+  // Slabs of `plan_` that no step is using.
+  std::vector<char*> free_slabs_ GUARDED_BY(mu_);
+  // True while a step records its allocations.
+  bool recording_ GUARDED_BY(mu_) = false;
+  int num_recordings_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryPlanner);
+};
+
+// The allocator of a single step of a MemoryPlanner. Like
+// StepArenaAllocator, allocations may outlive the step: the allocator, and
+// its slab, stay alive until every allocation has been freed, after which the
+// allocator deletes itself and returns its slab to the planner.
+class PlannedStepAllocator : public Allocator {
+ public:
+  string Name() override { return "planned_step"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Called when the step is done. Later calls to AllocateRaw() are forwarded
+  // to the underlying allocator.
+  void Release();
+
+  // Returns true if this step allocates from a plan.
+  bool is_planned() const { return plan_ != nullptr; }
+
+ protected:
+  ~PlannedStepAllocator() override {}
+
+ private:
+  friend class MemoryPlanner;
+
+  // If `plan` is null and `record` is true, records the allocations of this
+  // step. If both are unset, forwards every request to `allocator`.
+  PlannedStepAllocator(std::shared_ptr<MemoryPlanner> planner,
+                       Allocator* allocator,
+                       std::shared_ptr<const MemoryPlan> plan, char* slab,
+                       bool record);
+
+  void* AllocateFromPlan(size_t num_bytes) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::shared_ptr<MemoryPlanner> planner_;
+  Allocator* const allocator_;
+  const std::shared_ptr<const MemoryPlan> plan_;
+  char* slab_;
+  const bool record_;
+
+  mutex mu_;
+  // Maps the pointers of the live recorded or planned allocations to their
+  // index.
+  gtl::FlatMap<const void*, int> live_entries_ GUARDED_BY(mu_);
+  int64 num_outstanding_ GUARDED_BY(mu_) = 0;
+  bool released_ GUARDED_BY(mu_) = false;
+
+  // Recording state.
+  int64 clock_ GUARDED_BY(mu_) = 0;
+  std::vector<size_t> num_bytes_ GUARDED_BY(mu_);
+  std::vector<int64> alloc_times_ GUARDED_BY(mu_);
+  std::vector<int64> free_times_ GUARDED_BY(mu_);
+
+  // Planning state, indexed by entry.
+  std::vector<bool> used_ GUARDED_BY(mu_);
+  std::vector<bool> live_ GUARDED_BY(mu_);
+  int64 num_live_in_slab_ GUARDED_BY(mu_) = 0;
+  // True if a request did not match the plan.
+  bool mismatch_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PlannedStepAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
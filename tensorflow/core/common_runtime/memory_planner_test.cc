@@ -0,0 +1,164 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the live allocations made through the CPU allocator.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs;
+    ++num_live;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocs = 0;
+  int num_live = 0;
+};
+
+// Runs a step of a chain a -> b -> c, where each buffer is freed as soon as
+// the next one has been allocated.
+void RunChainStep(MemoryPlanner* planner, std::vector<void*>* ptrs) {
+  PlannedStepAllocator* a = planner->BeginStep();
+  void* p0 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  void* p1 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a->DeallocateRaw(p0);
+  void* p2 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a->DeallocateRaw(p1);
+  a->DeallocateRaw(p2);
+  a->Release();
+  if (ptrs != nullptr) {
+    *ptrs = {p0, p1, p2};
+  }
+}
+
+TEST(MemoryPlannerTest, ReusesMemoryOfDeadAllocations) {
+  CountingAllocator base;
+  auto planner = std::make_shared<MemoryPlanner>(&base);
+  RunChainStep(planner.get(), nullptr);
+  EXPECT_EQ(3, base.num_allocs);
+
+  std::shared_ptr<const MemoryPlan> plan = planner->plan();
+  ASSERT_NE(nullptr, plan);
+  ASSERT_EQ(3, plan->entries.size());
+  // p0 and p2 are never live at the same time.
+  EXPECT_EQ(plan->entries[0].offset, plan->entries[2].offset);
+  EXPECT_NE(plan->entries[0].offset, plan->entries[1].offset);
+  EXPECT_EQ(2 * 1024, plan->slab_size);
+
+  // Planned steps only allocate their slab, which is reused.
+  std::vector<void*> ptrs;
+  RunChainStep(planner.get(), &ptrs);
+  RunChainStep(planner.get(), nullptr);
+  EXPECT_EQ(4, base.num_allocs);
+  EXPECT_EQ(ptrs[0], ptrs[2]);
+  EXPECT_EQ(1, base.num_live);
+  planner.reset();
+  EXPECT_EQ(0, base.num_live);
+}
+
+TEST(MemoryPlannerTest, ConflictingOrderFallsBack) {
+  CountingAllocator base;
+  auto planner = std::make_shared<MemoryPlanner>(&base);
+  RunChainStep(planner.get(), nullptr);
+
+  // p0 is still live when p2 is requested, so p2 cannot take its region.
+  PlannedStepAllocator* a = planner->BeginStep();
+  ASSERT_TRUE(a->is_planned());
+  void* p0 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  void* p1 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  void* p2 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_NE(p0, p2);
+  EXPECT_NE(p1, p2);
+  a->DeallocateRaw(p0);
+  a->DeallocateRaw(p1);
+  a->DeallocateRaw(p2);
+  a->Release();
+  // Reordering is not a mismatch: the plan is kept.
+  EXPECT_NE(nullptr, planner->plan());
+}
+
+TEST(MemoryPlannerTest, NewShapesReplan) {
+  CountingAllocator base;
+  auto planner = std::make_shared<MemoryPlanner>(&base);
+  RunChainStep(planner.get(), nullptr);
+
+  PlannedStepAllocator* a = planner->BeginStep();
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 5000);
+  EXPECT_NE(nullptr, p);
+  a->DeallocateRaw(p);
+  a->Release();
+  EXPECT_EQ(nullptr, planner->plan());
+
+  // The next step records a new plan.
+  a = planner->BeginStep();
+  EXPECT_FALSE(a->is_planned());
+  p = a->AllocateRaw(Allocator::kAllocatorAlignment, 5000);
+  a->DeallocateRaw(p);
+  a->Release();
+  ASSERT_NE(nullptr, planner->plan());
+  EXPECT_EQ(5000, planner->plan()->entries[0].num_bytes);
+}
+
+TEST(MemoryPlannerTest, AllocationsOutliveStep) {
+  CountingAllocator base;
+  auto planner = std::make_shared<MemoryPlanner>(&base);
+  RunChainStep(planner.get(), nullptr);
+
+  PlannedStepAllocator* a = planner->BeginStep();
+  void* p0 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a->Release();
+  // The slab of the first step is still in use, so the second step gets its
+  // own.
+  std::vector<void*> ptrs;
+  RunChainStep(planner.get(), &ptrs);
+  EXPECT_NE(p0, ptrs[0]);
+  EXPECT_EQ(2, base.num_live);
+  a->DeallocateRaw(p0);
+  planner.reset();
+  EXPECT_EQ(0, base.num_live);
+}
+
+static void BM_PlannedChain(int iters, int planned) {
+  CountingAllocator base;
+  auto planner = std::make_shared<MemoryPlanner>(&base);
+  if (!planned) {
+    // Use up the recordings so that every step allocates dynamically.
+    for (int i = 0; i < MemoryPlanner::kMaxRecordings; ++i) {
+      PlannedStepAllocator* a = planner->BeginStep();
+      a->Release();
+    }
+  }
+  while (iters-- > 0) {
+    RunChainStep(planner.get(), nullptr);
+  }
+}
+BENCHMARK(BM_PlannedChain)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace tensorflow
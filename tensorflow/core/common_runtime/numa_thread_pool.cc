@@ -0,0 +1,283 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/common_runtime/numa_thread_pool.h"
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/setround.h"
+#include "tensorflow/core/platform/tracing.h"
+
+namespace tensorflow {
+
+struct NumaThreadPool::Task {
+  struct TaskImpl {
+    std::function<void()> f;
+    Context context;
+    uint64 trace_id;
+  };
+  std::unique_ptr<TaskImpl> f;
+};
+
+struct NumaThreadPool::PerThread {
+  const NumaThreadPool* pool = nullptr;
+  int thread_id = -1;
+  uint64 rand = 0;
+};
+
+struct NumaThreadPool::ThreadData {
+  explicit ThreadData(int numa_node) : numa_node(numa_node) {}
+
+  const int numa_node;
+  Eigen::RunQueue<Task, 1024> queue;
+  std::unique_ptr<Thread> thread;
+};
+
+struct NumaThreadPool::NodeData {
+  NodeData(int begin, int end)
+      : begin(begin), end(end), waiters(end - begin), ec(waiters) {
+    waiters.resize(end - begin);
+  }
+
+  // The threads of this node are threads_[begin, end).
+  const int begin;
+  const int end;
+  // Used to spread closures scheduled from other threads over the queues.
+  std::atomic<uint32> next_queue{0};
+  // Number of threads of this node that are in WaitForWork().
+  std::atomic<int> num_waiters{0};
+  // Idle threads of this node block on `ec`, as in Eigen's thread pool.
+  Eigen::MaxSizeVector<Eigen::EventCount::Waiter> waiters;
+  Eigen::EventCount ec;
+};
+
+NumaThreadPool::NumaThreadPool(Env* env, const ThreadOptions& thread_options,
+                               const string& name, int num_threads,
+                               int num_numa_nodes)
+    : env_(env),
+      thread_options_(thread_options),
+      name_(name),
+      next_node_(0),
+      done_(false) {
+  CHECK_GE(num_threads, 1);
+  CHECK_GE(num_numa_nodes, 1);
+  num_numa_nodes = std::min(num_numa_nodes, num_threads);
+  for (int node = 0; node < num_numa_nodes; ++node) {
+    const int begin = threads_.size();
+    const int node_threads = num_threads / num_numa_nodes +
+                             (node < num_threads % num_numa_nodes ? 1 : 0);
+    for (int i = 0; i < node_threads; ++i) {
+      threads_.emplace_back(new ThreadData(node));
+    }
+    nodes_.emplace_back(new NodeData(begin, threads_.size()));
+  }
+  // All of the per-thread state must exist before the first worker starts,
+  // since workers steal from each other's queues.
+  const bool set_affinity = port::NUMAEnabled();
+  const int host_numa_nodes = port::NUMANumNodes();
+  for (int i = 0; i < threads_.size(); ++i) {
+    ThreadOptions options = thread_options_;
+    const int numa_node = threads_[i]->numa_node;
+    if (set_affinity && numa_node < host_numa_nodes) {
+      options.numa_node = numa_node;
+    }
+    threads_[i]->thread.reset(env_->StartThread(
+        options, strings::StrCat("tf_", name_, "_numa", numa_node),
+        [this, i, options]() {
+          // Set the processor flag to flush denormals to zero.
+          port::ScopedFlushDenormal flush;
+          // Set the processor rounding mode to ROUND TO NEAREST.
+          port::ScopedSetRound round(FE_TONEAREST);
+          if (options.numa_node != port::kNUMANoAffinity) {
+            port::NUMASetThreadNodeAffinity(options.numa_node);
+          }
+          WorkerLoop(i);
+        }));
+  }
+}
+
+NumaThreadPool::~NumaThreadPool() {
+  done_ = true;
+  for (auto& node : nodes_) {
+    node->ec.Notify(true);
+  }
+  // Joins the threads. Workers exit once every queue is empty.
+  for (auto& thread_data : threads_) {
+    thread_data->thread.reset();
+  }
+}
+
+void NumaThreadPool::Schedule(std::function<void()> fn) {
+  PerThread* pt = GetPerThread();
+  int numa_node;
+  if (pt->pool == this) {
+    numa_node = threads_[pt->thread_id]->numa_node;
+  } else {
+    numa_node =
+        next_node_.fetch_add(1, std::memory_order_relaxed) % nodes_.size();
+  }
+  Push(numa_node, CreateTask(std::move(fn)));
+}
+
+void NumaThreadPool::ScheduleOnNode(int numa_node, std::function<void()> fn) {
+  DCHECK_GE(numa_node, 0);
+  DCHECK_LT(numa_node, nodes_.size());
+  Push(numa_node, CreateTask(std::move(fn)));
+}
+
+int NumaThreadPool::NumThreads() const { return threads_.size(); }
+
+int NumaThreadPool::CurrentThreadId() const {
+  const PerThread* pt = GetPerThread();
+  return pt->pool == this ? pt->thread_id : -1;
+}
+
+int NumaThreadPool::CurrentNumaNode() const {
+  const PerThread* pt = GetPerThread();
+  return pt->pool == this ? threads_[pt->thread_id]->numa_node
+                          : port::kNUMANoAffinity;
+}
+
+NumaThreadPool::Task NumaThreadPool::CreateTask(std::function<void()> f) {
+  uint64 id = 0;
+  if (tracing::EventCollector::IsEnabled()) {
+    id = tracing::GetUniqueArg();
+    tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
+  }
+  return Task{
+      std::unique_ptr<Task::TaskImpl>(new Task::TaskImpl{
+          std::move(f),
+          Context(ContextKind::kThread),
+          id,
+      }),
+  };
+}
+
+void NumaThreadPool::RunTask(const Task& t) {
+  WithContext wc(t.f->context);
+  tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
+                               t.f->trace_id);
+  t.f->f();
+}
+
+NumaThreadPool::PerThread* NumaThreadPool::GetPerThread() {
+  static thread_local PerThread per_thread;
+  return &per_thread;
+}
+
+void NumaThreadPool::Push(int numa_node, Task t) {
+  PerThread* pt = GetPerThread();
+  if (pt->pool == this && threads_[pt->thread_id]->numa_node == numa_node) {
+    // Keep the closure on this thread's queue: it is the most likely to run it
+    // while its inputs are still in cache.
+    t = threads_[pt->thread_id]->queue.PushFront(std::move(t));
+  } else {
+    NodeData* node = nodes_[numa_node].get();
+    const int i = node->begin +
+                  node->next_queue.fetch_add(1, std::memory_order_relaxed) %
+                      (node->end - node->begin);
+    t = threads_[i]->queue.PushBack(std::move(t));
+  }
+  if (t.f) {
+    // The queue is full; run the closure inline, as Eigen's thread pool does.
+    RunTask(t);
+    return;
+  }
+  Notify(numa_node);
+}
+
+NumaThreadPool::Task NumaThreadPool::Steal(int thread_id) {
+  PerThread* pt = GetPerThread();
+  const int num_nodes = nodes_.size();
+  const int home = threads_[thread_id]->numa_node;
+  for (int n = 0; n < num_nodes; ++n) {
+    const NodeData* node = nodes_[(home + n) % num_nodes].get();
+    const int size = node->end - node->begin;
+    // Start at a random victim so that thieves do not contend on one queue.
+    pt->rand = pt->rand * 6364136223846793005ULL + 1442695040888963407ULL;
+    const int start = static_cast<int>((pt->rand >> 33) % size);
+    for (int j = 0; j < size; ++j) {
+      const int victim = node->begin + (start + j) % size;
+      if (victim == thread_id) continue;
+      Task t = threads_[victim]->queue.PopBack();
+      if (t.f) return t;
+    }
+  }
+  return Task();
+}
+
+bool NumaThreadPool::HasWork() const {
+  for (const auto& thread_data : threads_) {
+    if (!thread_data->queue.Empty()) return true;
+  }
+  return false;
+}
+
+void NumaThreadPool::WaitForWork(int thread_id) {
+  NodeData* node = nodes_[threads_[thread_id]->numa_node].get();
+  node->num_waiters.fetch_add(1, std::memory_order_relaxed);
+  // Prewait() is a sequentially consistent read-modify-write, which pairs with
+  // the fence in Notify(): either the pusher observes this waiter and notifies
+  // `ec`, or this thread observes the pushed closure below.
+  node->ec.Prewait();
+  if (done_ || HasWork()) {
+    node->ec.CancelWait();
+  } else {
+    node->ec.CommitWait(&node->waiters[thread_id - node->begin]);
+  }
+  node->num_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void NumaThreadPool::Notify(int numa_node) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int num_nodes = nodes_.size();
+  for (int n = 0; n < num_nodes; ++n) {
+    NodeData* node = nodes_[(numa_node + n) % num_nodes].get();
+    if (node->num_waiters.load(std::memory_order_relaxed) > 0) {
+      node->ec.Notify(false);
+      return;
+    }
+  }
+}
+
+void NumaThreadPool::WorkerLoop(int thread_id) {
+  PerThread* pt = GetPerThread();
+  pt->pool = this;
+  pt->thread_id = thread_id;
+  pt->rand = Hash64(reinterpret_cast<const char*>(&thread_id),
+                    sizeof(thread_id));
+  ThreadData* thread_data = threads_[thread_id].get();
+  while (true) {
+    Task t = thread_data->queue.PopFront();
+    if (!t.f) {
+      t = Steal(thread_id);
+    }
+    if (t.f) {
+      RunTask(t);
+      continue;
+    }
+    if (done_) break;
+    WaitForWork(thread_id);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,112 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_NUMA_THREAD_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_NUMA_THREAD_POOL_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A work-stealing thread pool whose threads are partitioned into one group per
+// NUMA node. Every thread is pinned to its node and owns a work-stealing
+// queue. An idle thread first steals from the other queues of its own node,
+// and only steals from the queues of other nodes when its node has no work.
+//
+// Closures scheduled from one of the pool's threads stay on the scheduling
+// thread's node, which keeps chains of dependent ops (and the tensors they
+// allocate) on one socket. Closures scheduled from other threads are spread
+// round-robin over the nodes, unless placed explicitly with ScheduleOnNode().
+class NumaThreadPool : public thread::ThreadPoolInterface {
+ public:
+  // Creates `num_threads` threads, divided as evenly as possible among
+  // `num_numa_nodes` groups. Thread affinity is only set for nodes that exist
+  // on the host, so the pool remains usable with a single NUMA node.
+  NumaThreadPool(Env* env, const ThreadOptions& thread_options,
+                 const string& name, int num_threads, int num_numa_nodes);
+  ~NumaThreadPool() override;
+
+  // Schedules `fn` on the caller's node if the caller is one of the pool's
+  // threads, or on the next node in round-robin order otherwise.
+  void Schedule(std::function<void()> fn) override;
+
+  // Schedules `fn` on a thread belonging to `numa_node`. `numa_node` must be
+  // in [0, NumNumaNodes()).
+  void ScheduleOnNode(int numa_node, std::function<void()> fn);
+
+  int NumThreads() const override;
+  int CurrentThreadId() const override;
+
+  int NumNumaNodes() const { return nodes_.size(); }
+
+  // Returns the NUMA node of the calling thread if it belongs to this pool,
+  // and port::kNUMANoAffinity otherwise.
+  int CurrentNumaNode() const;
+
+ private:
+  struct Task;
+  struct PerThread;
+  struct ThreadData;
+  struct NodeData;
+
+  static PerThread* GetPerThread();
+  static Task CreateTask(std::function<void()> f);
+  static void RunTask(const Task& t);
+
+  void WorkerLoop(int thread_id);
+
+  // Pushes `t` onto a queue of `numa_node`, and wakes up an idle thread.
+  void Push(int numa_node, Task t);
+
+  // Steals a task for thread `thread_id`, trying the queues of its own node
+  // before those of other nodes. Returns a task with a null closure if every
+  // queue was empty.
+  Task Steal(int thread_id);
+
+  // Returns true if any queue of the pool is non-empty.
+  bool HasWork() const;
+
+  // Blocks thread `thread_id` until a closure is pushed to any queue of the
+  // pool or the pool is destroyed. Returns immediately if a queue is
+  // non-empty, so that the thread can steal from it.
+  void WaitForWork(int thread_id);
+
+  // Wakes up an idle thread of `numa_node`, or of another node if all of the
+  // threads of `numa_node` are busy. A woken thread steals the closure from
+  // whichever node it was pushed to.
+  void Notify(int numa_node);
+
+  Env* const env_;
+  const ThreadOptions thread_options_;
+  const string name_;
+  std::vector<std::unique_ptr<ThreadData>> threads_;
+  std::vector<std::unique_ptr<NodeData>> nodes_;
+  std::atomic<uint32> next_node_;
+  std::atomic<bool> done_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(NumaThreadPool);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_NUMA_THREAD_POOL_H_
@@ -0,0 +1,114 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/numa_thread_pool.h"
+
+#include <atomic>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(NumaThreadPoolTest, SplitsThreadsAmongNodes) {
+  NumaThreadPool pool(Env::Default(), ThreadOptions(), "test", 5, 2);
+  EXPECT_EQ(5, pool.NumThreads());
+  EXPECT_EQ(2, pool.NumNumaNodes());
+  EXPECT_EQ(-1, pool.CurrentThreadId());
+  EXPECT_EQ(port::kNUMANoAffinity, pool.CurrentNumaNode());
+}
+
+TEST(NumaThreadPoolTest, MoreNodesThanThreads) {
+  NumaThreadPool pool(Env::Default(), ThreadOptions(), "test", 2, 4);
+  EXPECT_EQ(2, pool.NumThreads());
+  EXPECT_EQ(2, pool.NumNumaNodes());
+}
+
+TEST(NumaThreadPoolTest, RunsAllClosures) {
+  for (int num_threads : {1, 2, 4, 7}) {
+    NumaThreadPool pool(Env::Default(), ThreadOptions(), "test", num_threads,
+                        2);
+    const int kClosures = 10000;
+    std::atomic<int> count(0);
+    BlockingCounter done(kClosures);
+    for (int i = 0; i < kClosures; ++i) {
+      auto fn = [&pool, &count, &done, num_threads]() {
+        const int id = pool.CurrentThreadId();
+        EXPECT_GE(id, 0);
+        EXPECT_LT(id, num_threads);
+        const int node = pool.CurrentNumaNode();
+        EXPECT_GE(node, 0);
+        EXPECT_LT(node, pool.NumNumaNodes());
+        count.fetch_add(1);
+        done.DecrementCount();
+      };
+      if (i % 2 == 0) {
+        pool.Schedule(fn);
+      } else {
+        pool.ScheduleOnNode(i % pool.NumNumaNodes(), fn);
+      }
+    }
+    done.Wait();
+    EXPECT_EQ(kClosures, count.load());
+  }
+}
+
+TEST(NumaThreadPoolTest, ClosuresScheduleClosures) {
+  NumaThreadPool pool(Env::Default(), ThreadOptions(), "test", 4, 2);
+  const int kRoots = 100;
+  const int kChildren = 100;
+  BlockingCounter done(kRoots * kChildren);
+  for (int i = 0; i < kRoots; ++i) {
+    pool.Schedule([&pool, &done]() {
+      for (int j = 0; j < kChildren; ++j) {
+        pool.Schedule([&done]() { done.DecrementCount(); });
+      }
+    });
+  }
+  done.Wait();
+}
+
+TEST(NumaThreadPoolTest, DestructorRunsPendingClosures) {
+  std::atomic<int> count(0);
+  {
+    NumaThreadPool pool(Env::Default(), ThreadOptions(), "test", 2, 2);
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([&count]() { count.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(100, count.load());
+}
+
+static void BM_NumaThreadPoolFanOut(int iters, int num_nodes) {
+  NumaThreadPool pool(Env::Default(), ThreadOptions(), "bench", 8, num_nodes);
+  const int kFanOut = 64;
+  while (iters-- > 0) {
+    BlockingCounter done(kFanOut);
+    pool.Schedule([&pool, &done]() {
+      for (int i = 0; i < kFanOut; ++i) {
+        pool.Schedule([&done]() { done.DecrementCount(); });
+      }
+    });
+    done.Wait();
+  }
+}
+BENCHMARK(BM_NumaThreadPoolFanOut)->Arg(1)->Arg(2);
+
+}  // namespace
+}  // namespace tensorflow
@@ -91,9 +91,22 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
       }
       int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
       DCHECK(sub_allocator);
-      allocator =
+      BFCAllocator* bfc_allocator =
           new BFCAllocator(sub_allocator, cpu_mem_limit, true /*allow_growth*/,
                            "bfc_cpu_allocator_for_gpu" /*name*/);
+      // Many inter-op threads allocate and free small tensors concurrently;
+      // a thread-local cache keeps most of those off the allocator's lock.
+      int64 thread_cache_shards = 0;
+      status = ReadInt64FromEnvVar("TF_CPU_BFC_THREAD_CACHE_SHARDS", 0,
+                                   &thread_cache_shards);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
+      if (thread_cache_shards > 0) {
+        bfc_allocator->EnableThreadLocalCache(thread_cache_shards,
+                                              1 << 20 /*1MB per shard*/);
+      }
+      allocator = bfc_allocator;
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
     } else if (sub_allocator) {
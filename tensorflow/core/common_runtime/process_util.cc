@@ -22,10 +22,12 @@ limitations under the License.
 #endif  // INTEL_MKL
 #include <string.h>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
@@ -164,6 +166,25 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
       /*allocator=*/nullptr);
 }
 
+std::unique_ptr<NumaThreadPool> NewNumaThreadPoolFromSessionOptions(
+    const SessionOptions& options) {
+  if (!options.config.experimental().use_numa_inter_op_thread_pool()) {
+    return nullptr;
+  }
+  const int num_numa_nodes = port::NUMANumNodes();
+  if (!port::NUMAEnabled() || num_numa_nodes < 2) {
+    VLOG(1) << "Not using a NUMA-aware inter op thread pool since the host "
+               "has a single NUMA node.";
+    return nullptr;
+  }
+  const int32 num_threads = NumInterOpThreadsFromSessionOptions(options);
+  VLOG(1) << "Direct session inter op parallelism threads: " << num_threads
+          << " over " << num_numa_nodes << " NUMA nodes";
+  return absl::make_unique<NumaThreadPool>(options.env, ThreadOptions(),
+                                           "Compute", num_threads,
+                                           num_numa_nodes);
+}
+
 void SchedClosure(std::function<void()> closure) {
   if (!tracing::EventCollector::IsEnabled()) {
     return Env::Default()->SchedClosure(std::move(closure));
@@ -17,7 +17,9 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_UTIL_H_
 
 #include <functional>
+#include <memory>
 
+#include "tensorflow/core/common_runtime/numa_thread_pool.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -48,6 +50,12 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
     const SessionOptions& options);
 
+// Creates a NUMA-aware inter op thread pool, with one group of threads per
+// NUMA node, if `options.config.experimental().use_numa_inter_op_thread_pool()`
+// is set and the host has more than one NUMA node. Returns nullptr otherwise.
+std::unique_ptr<NumaThreadPool> NewNumaThreadPoolFromSessionOptions(
+    const SessionOptions& options);
+
 // Schedule "closure" in the default thread queue.
 void SchedClosure(std::function<void()> closure);
 
@@ -0,0 +1,161 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+StepArenaAllocator::StepArenaAllocator(Allocator* allocator, size_t block_size)
+    : allocator_(allocator),
+      block_size_(block_size),
+      max_arena_bytes_(block_size / 4) {
+  CHECK_GE(block_size, kAllocatorAlignment);
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  mutex_lock l(mu_);
+  DCHECK_EQ(num_outstanding_, 0);
+  while (!blocks_.empty()) {
+    DeleteBlock(blocks_.begin()->second);
+  }
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  bool use_arena = num_bytes <= max_arena_bytes_ &&
+                   alignment <= kAllocatorAlignment;
+  {
+    mutex_lock l(mu_);
+    ++num_outstanding_;
+    use_arena = use_arena && !released_;
+    if (use_arena) {
+      if (current_ != nullptr) {
+        const size_t offset =
+            (current_->offset + alignment - 1) & ~(alignment - 1);
+        if (offset + num_bytes <= block_size_) {
+          current_->offset = offset + num_bytes;
+          ++current_->num_live;
+          return current_->base + offset;
+        }
+        if (current_->num_live == 0) {
+          // Nothing lives in the current block any more: start over at its
+          // beginning.
+          current_->offset = 0;
+        } else {
+          current_ = nullptr;
+        }
+      }
+      if (current_ == nullptr) {
+        current_ = NewBlock();
+      }
+      if (current_ != nullptr) {
+        // The block is empty, and every block is aligned to
+        // kAllocatorAlignment, so the request fits at offset 0.
+        current_->offset = num_bytes;
+        ++current_->num_live;
+        return current_->base;
+      }
+      // Fall back to the underlying allocator, which will most likely fail as
+      // well.
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr == nullptr) {
+    mutex_lock l(mu_);
+    --num_outstanding_;
+  }
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  bool in_arena = false;
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    auto it = blocks_.upper_bound(static_cast<const char*>(ptr));
+    if (it != blocks_.begin()) {
+      --it;
+      Block* block = it->second;
+      if (static_cast<const char*>(ptr) < block->base + block_size_) {
+        in_arena = true;
+        if (--block->num_live == 0) {
+          if (block == current_) {
+            block->offset = 0;
+          } else if (released_) {
+            DeleteBlock(block);
+          } else {
+            block->offset = 0;
+            free_blocks_.push_back(block);
+          }
+        }
+      }
+    }
+    --num_outstanding_;
+    should_delete = released_ && num_outstanding_ == 0;
+  }
+  if (!in_arena) {
+    allocator_->DeallocateRaw(ptr);
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+void StepArenaAllocator::Release() {
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    CHECK(!released_);
+    released_ = true;
+    for (Block* block : free_blocks_) {
+      DeleteBlock(block);
+    }
+    free_blocks_.clear();
+    if (current_ != nullptr && current_->num_live == 0) {
+      DeleteBlock(current_);
+    }
+    current_ = nullptr;
+    should_delete = num_outstanding_ == 0;
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+StepArenaAllocator::Block* StepArenaAllocator::NewBlock() {
+  if (!free_blocks_.empty()) {
+    Block* block = free_blocks_.back();
+    free_blocks_.pop_back();
+    return block;
+  }
+  char* base = static_cast<char*>(
+      allocator_->AllocateRaw(kAllocatorAlignment, block_size_));
+  if (base == nullptr) {
+    return nullptr;
+  }
+  Block* block = new Block{base, 0, 0};
+  blocks_.emplace(base, block);
+  return block;
+}
+
+void StepArenaAllocator::DeleteBlock(Block* block) {
+  blocks_.erase(block->base);
+  allocator_->DeallocateRaw(block->base);
+  delete block;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator for the temporary tensors of a single step. Like core::Arena,
+// it carves small allocations out of large blocks by bumping a pointer, and
+// hands larger allocations to the underlying allocator directly. Unlike
+// core::Arena, individual allocations may be freed: each block counts its
+// live allocations and is reused as soon as that count drops to zero.
+//
+// An allocation may outlive the step, e.g. when a kernel forwards a temporary
+// to one of its outputs. Such an allocation keeps its block, and the
+// StepArenaAllocator itself, alive until it is freed. Like TrackingAllocator,
+// the allocator deletes itself once it has been released and every
+// outstanding allocation has been freed.
+class StepArenaAllocator : public Allocator {
+ public:
+  // Blocks of `block_size` bytes are obtained from `allocator`, which must
+  // outlive this object. Requests larger than a quarter of a block bypass the
+  // arena.
+  StepArenaAllocator(Allocator* allocator, size_t block_size);
+
+  string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Called when the step is done. Returns all unused blocks to the underlying
+  // allocator. Later calls to AllocateRaw() are forwarded to the underlying
+  // allocator.
+  void Release();
+
+ protected:
+  ~StepArenaAllocator() override;
+
+ private:
+  struct Block {
+    char* base;
+    size_t offset;
+    int64 num_live;
+  };
+
+  // Returns a block with no live allocations, or nullptr if the underlying
+  // allocator is out of memory.
+  Block* NewBlock() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns `block` to the underlying allocator.
+  void DeleteBlock(Block* block) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const allocator_;
+  const size_t block_size_;
+  const size_t max_arena_bytes_;
+
+  mutex mu_;
+  // All blocks, keyed by their base address.
+  std::map<const char*, Block*> blocks_ GUARDED_BY(mu_);
+  // The block that allocations are currently carved out of.
+  Block* current_ GUARDED_BY(mu_) = nullptr;
+  // Blocks with no live allocations, other than `current_`.
+  std::vector<Block*> free_blocks_ GUARDED_BY(mu_);
+  // Number of allocations, in blocks or not, that have not been freed yet.
+  int64 num_outstanding_ GUARDED_BY(mu_) = 0;
+  bool released_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
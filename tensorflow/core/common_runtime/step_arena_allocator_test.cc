@@ -0,0 +1,148 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the calls made to the CPU allocator.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs;
+    ++num_live;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocs = 0;
+  int num_live = 0;
+};
+
+const size_t kBlockSize = 4096;
+
+TEST(StepArenaAllocatorTest, SmallAllocationsShareBlocks) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kBlockSize);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) %
+                     Allocator::kAllocatorAlignment);
+    ptrs.push_back(p);
+  }
+  // 16 allocations of 128 aligned bytes fit in a 4KB block.
+  EXPECT_EQ(1, base.num_allocs);
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    EXPECT_GE(static_cast<char*>(ptrs[i]) - static_cast<char*>(ptrs[i - 1]),
+              100);
+  }
+  for (void* p : ptrs) {
+    arena->DeallocateRaw(p);
+  }
+  arena->Release();
+  EXPECT_EQ(0, base.num_live);
+}
+
+TEST(StepArenaAllocatorTest, ReusesFreedBlocks) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kBlockSize);
+  for (int i = 0; i < 100; ++i) {
+    void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+    void* q = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+    arena->DeallocateRaw(p);
+    arena->DeallocateRaw(q);
+  }
+  EXPECT_EQ(1, base.num_allocs);
+  arena->Release();
+  EXPECT_EQ(0, base.num_live);
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsBypassArena) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kBlockSize);
+  void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, kBlockSize);
+  EXPECT_EQ(1, base.num_allocs);
+  EXPECT_EQ(1, base.num_live);
+  arena->DeallocateRaw(p);
+  EXPECT_EQ(0, base.num_live);
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, AllocationsOutliveRelease) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kBlockSize);
+  void* small = arena->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  void* large = arena->AllocateRaw(Allocator::kAllocatorAlignment, kBlockSize);
+  arena->Release();
+  EXPECT_EQ(2, base.num_live);
+  // Allocations made after the step is done bypass the arena.
+  void* late = arena->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  EXPECT_EQ(3, base.num_live);
+  arena->DeallocateRaw(small);
+  arena->DeallocateRaw(late);
+  EXPECT_EQ(1, base.num_live);
+  // Deletes the arena.
+  arena->DeallocateRaw(large);
+  EXPECT_EQ(0, base.num_live);
+}
+
+TEST(StepArenaAllocatorTest, Tensors) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, kBlockSize);
+  Tensor escaped;
+  {
+    Tensor t1(arena, DT_FLOAT, TensorShape({16}));
+    Tensor t2(arena, DT_STRING, TensorShape({4}));
+    t1.flat<float>().setZero();
+    t2.flat<tstring>()(0) = "step";
+    escaped = t2;
+  }
+  arena->Release();
+  EXPECT_EQ("step", escaped.flat<tstring>()(0));
+  escaped = Tensor();
+  EXPECT_EQ(0, base.num_live);
+}
+
+static void BM_StepArenaAllocator(int iters, int num_allocs) {
+  CountingAllocator base;
+  std::vector<void*> ptrs(num_allocs);
+  while (iters-- > 0) {
+    StepArenaAllocator* arena = new StepArenaAllocator(&base, 256 << 10);
+    for (int i = 0; i < num_allocs; ++i) {
+      ptrs[i] = arena->AllocateRaw(Allocator::kAllocatorAlignment,
+                                   64 + (i % 16) * 64);
+    }
+    for (void* p : ptrs) {
+      arena->DeallocateRaw(p);
+    }
+    arena->Release();
+  }
+}
+BENCHMARK(BM_StepArenaAllocator)->Arg(16)->Arg(256);
+
+}  // namespace
+}  // namespace tensorflow
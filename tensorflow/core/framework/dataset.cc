@@ -398,6 +398,21 @@ Status DatasetBase::DatasetGraphDefBuilder::AddInputDataset(
   return status;
 }
 
+Status IteratorBase::Skip(IteratorContext* ctx, int64 num_to_skip,
+                          bool* end_of_sequence, int64* num_skipped) {
+  *end_of_sequence = false;
+  *num_skipped = 0;
+  while (*num_skipped < num_to_skip) {
+    std::vector<Tensor> unused_out_tensors;
+    TF_RETURN_IF_ERROR(GetNext(ctx, &unused_out_tensors, end_of_sequence));
+    if (*end_of_sequence) {
+      break;
+    }
+    ++*num_skipped;
+  }
+  return Status::OK();
+}
+
 Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
                                     std::vector<Tensor>* out_tensors,
                                     bool* end_of_sequence) {
@@ -420,6 +435,47 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
   return s;
 }
 
+Status DatasetBaseIterator::Skip(IteratorContext* ctx, int64 num_to_skip,
+                                 bool* end_of_sequence, int64* num_skipped) {
+  profiler::TraceMe activity([&] { return BuildTraceMeName(); },
+                             profiler::TraceMeLevel::kInfo);
+  DVLOG(3) << prefix() << " Skip enter";
+  RecordStart(ctx, /*stop_output=*/true);
+  Status s = SkipInternal(ctx, num_to_skip, end_of_sequence, num_skipped);
+  // Skipped elements count as produced, so that the model sees the same
+  // number of elements as if they had been taken with `GetNext()`.
+  if (s.ok()) RecordElements(ctx, *num_skipped);
+  RecordStop(ctx, /*start_output=*/true);
+  if (TF_PREDICT_FALSE(errors::IsOutOfRange(s))) {
+    s = errors::Internal("Iterator \"", params_.prefix,
+                         "\" returned `OutOfRange`. This indicates an "
+                         "implementation error as `OutOfRange` errors are not "
+                         "expected to be returned here. Original message: ",
+                         s.error_message());
+    LOG(ERROR) << s;
+  }
+  DVLOG(3) << prefix() << " Skip exit";
+  return s;
+}
+
+Status DatasetBaseIterator::SkipInternal(IteratorContext* ctx,
+                                         int64 num_to_skip,
+                                         bool* end_of_sequence,
+                                         int64* num_skipped) {
+  *end_of_sequence = false;
+  *num_skipped = 0;
+  while (*num_skipped < num_to_skip) {
+    std::vector<Tensor> unused_out_tensors;
+    TF_RETURN_IF_ERROR(
+        GetNextInternal(ctx, &unused_out_tensors, end_of_sequence));
+    if (*end_of_sequence) {
+      break;
+    }
+    ++*num_skipped;
+  }
+  return Status::OK();
+}
+
 void DatasetOpKernel::Compute(OpKernelContext* ctx) {
   DatasetBase* dataset = nullptr;
   MakeDataset(ctx, &dataset);
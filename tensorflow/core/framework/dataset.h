@@ -530,6 +530,18 @@ class IteratorBase {
     return GetNext(&ctx, out_tensors, end_of_sequence);
   }
 
+  // Skips the next `num_to_skip` elements of the sequence, and stores the
+  // number of elements that were skipped in `*num_skipped`. If the end of the
+  // sequence is reached first, `*end_of_sequence` is set to true.
+  //
+  // The default implementation calls `GetNext()` and discards the elements.
+  // Iterators that can move past elements without producing them, e.g. by
+  // seeking in a file, should override this method.
+  //
+  // This method is thread-safe.
+  virtual Status Skip(IteratorContext* ctx, int64 num_to_skip,
+                      bool* end_of_sequence, int64* num_skipped);
+
   // Returns a vector of DataType values, representing the respective
   // element types of each tuple component in the outputs of this
   // iterator.
@@ -734,6 +746,19 @@ class DatasetBase : public core::RefCounted {
   // Returns the cardinality of this dataset.
   virtual int64 Cardinality() const { return kUnknownCardinality; }
 
+  // Indicates whether the dataset supports random access through `Get()`. A
+  // dataset that does must have a finite, known `Cardinality()`.
+  virtual bool SupportsRandomAccess() const { return false; }
+
+  // Produces the element at position `index`, which must be in the range
+  // `[0, Cardinality())`, without iterating over the preceding elements. Must
+  // be thread-safe, as callers may fetch several elements concurrently.
+  virtual Status Get(IteratorContext* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const {
+    return errors::Unimplemented(DebugString(),
+                                 " does not support random access.");
+  }
+
   // A human-readable debug string for this dataset.
   virtual string DebugString() const = 0;
 
@@ -843,6 +868,9 @@ class DatasetBaseIterator : public IteratorBase {
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) final;
 
+  Status Skip(IteratorContext* ctx, int64 num_to_skip, bool* end_of_sequence,
+              int64* num_skipped) final;
+
   Status Save(SerializationContext* ctx, IteratorStateWriter* writer) final {
     TF_RETURN_IF_ERROR(params_.dataset->CheckExternalState());
     return IteratorBase::Save(ctx, writer);
@@ -854,6 +882,11 @@ class DatasetBaseIterator : public IteratorBase {
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) = 0;
 
+  // Internal implementation of Skip that is wrapped in tracing logic. By
+  // default, calls `GetNextInternal()` and discards the elements.
+  virtual Status SkipInternal(IteratorContext* ctx, int64 num_to_skip,
+                              bool* end_of_sequence, int64* num_skipped);
+
   string full_name(const string& name) const {
     return strings::StrCat(params_.prefix, ":", name);
   }
@@ -907,6 +940,14 @@ class DatasetBaseIterator : public IteratorBase {
     }
   }
 
+  // When modeling is enabled, this method records the fact that this iterator
+  // has produced `num_elements` elements, for example by skipping them.
+  void RecordElements(IteratorContext* ctx, int64 num_elements) {
+    if (node_ && num_elements > 0) {
+      node_->record_elements(num_elements);
+    }
+  }
+
   // When modeling is enabled, this method records the fact that a thread of
   // this iterator has started work.
   void RecordStart(IteratorContext* ctx, bool stop_output = false) {
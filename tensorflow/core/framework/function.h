@@ -274,7 +274,25 @@ class CallFrameInterface {
   virtual size_t num_retvals() const = 0;
 
   virtual Status GetArg(int index, Tensor* val) const = 0;
+
+  // Optimized implementation of `GetArg()` that allows the caller to take
+  // ownership of the tensor. This method may only be called once per
+  // value of `index` and `CallFrameInterface` instance.
+  //
+  // REQUIRES: `this->CanConsumeArg(index) == true`.
+  virtual void ConsumeArg(int index, Tensor* val) {
+    LOG(ERROR) << "This `CallFrameInterface` implementation does not support "
+                  "consuming arguments.";
+  }
+  virtual bool CanConsumeArg(int index) const { return false; }
+
   virtual Status SetRetval(int index, const Tensor& val) = 0;
+
+  // Returns the caller-owned tensor into which the return value `index`
+  // should be written, or nullptr if the callee allocates it. The producer of
+  // the return value may allocate its output in the buffer of this tensor if
+  // it has the same type and shape.
+  virtual const Tensor* GetRetvalBuffer(int index) const { return nullptr; }
 };
 
 // Represents a function call frame. I.e., the data structure used to
@@ -236,7 +236,8 @@ class AsyncInterleaveMany : public Node {
   // input_time, parallelism, ...)`, where `output_time` is the sum of the
   // self-processing time and the average output time of inputs comprising the
   // interleave "cycle", `input_time` is specified through `input_times` and
-  // `buffer_size` is derived from parallelism.
+  // `buffer_size` is derived from parallelism and, if the node has a buffer
+  // size parameter, the size of the per-input buffers.
   double OutputTimeLocked(std::vector<double>* input_times,
                           std::map<string, double>* gradient) const override
       SHARED_LOCKS_REQUIRED(mu_) {
@@ -254,6 +255,11 @@ class AsyncInterleaveMany : public Node {
     if (parameter) {
       parallelism = std::min(parallelism, (*parameter)->value);
     }
+    double buffer_size = parallelism;
+    auto* buffer_size_parameter = gtl::FindOrNull(parameters_, kBufferSize);
+    if (buffer_size_parameter) {
+      buffer_size = (*buffer_size_parameter)->value * parallelism;
+    }
     if (gradient) {
       std::map<string, double> inputs_gradient;
       double output_time_for_inputs =
@@ -265,7 +271,7 @@ class AsyncInterleaveMany : public Node {
       double input_time_der = 0.0L;
       double buffer_size_der = 0.0L;
       double result = ComputeWaitTime(
-          SelfProcessingTimeLocked() + output_time, old_input_time, parallelism,
+          SelfProcessingTimeLocked() + output_time, old_input_time, buffer_size,
           &output_time_der, &input_time_der, &buffer_size_der);
       auto last_input_time_der =
           gtl::FindWithDefault(*gradient, kInputTimeDerivativeKey, 0.0L);
@@ -289,10 +295,13 @@ class AsyncInterleaveMany : public Node {
       for (auto& pair : first_input_parameters) {
         (*gradient)[pair.first] = 0.0L;
       }
-      // Add derivative w.r.t. own parallelism parameter.
+      // Add derivative w.r.t. own parallelism or buffer size parameter.
       if (parameter && (*parameter)->state->tunable) {
         (*gradient)[long_name()] =
             output_time_der * parallelism_der + buffer_size_der;
+      } else if (buffer_size_parameter &&
+                 (*buffer_size_parameter)->state->tunable) {
+        (*gradient)[long_name()] = buffer_size_der * parallelism;
       }
       return result;
     }
@@ -301,7 +310,7 @@ class AsyncInterleaveMany : public Node {
          inputs_.front()->OutputTime(input_times, /*gradient=*/nullptr)) /
         static_cast<double>(num_inputs() - 1) / parallelism;
     return ComputeWaitTime(
-        SelfProcessingTimeLocked() + output_time, old_input_time, parallelism,
+        SelfProcessingTimeLocked() + output_time, old_input_time, buffer_size,
         /*output_time_derivative=*/nullptr,
         /*input_time_derivative=*/nullptr, /*buffer_size_derivative=*/nullptr);
   }
@@ -323,6 +332,21 @@ class AsyncInterleaveMany : public Node {
     return self_processing_time +
            processing_time / static_cast<double>(num_inputs() - 1);
   }
+
+  // A buffer size parameter limits the buffer of each interleaved input, so
+  // the maximum is scaled by the number of inputs comprising the "cycle".
+  double MaximumBufferedBytesLocked() const override
+      SHARED_LOCKS_REQUIRED(mu_) {
+    auto* buffer_size_parameter = gtl::FindOrNull(parameters_, kBufferSize);
+    if (!buffer_size_parameter) {
+      return Node::MaximumBufferedBytesLocked();
+    }
+    if (num_inputs() <= 1) {
+      return 0;
+    }
+    return (*buffer_size_parameter)->value *
+           static_cast<double>(num_inputs() - 1) * AverageBufferedElementSize();
+  }
 };
 
 class KnownRatio : public Node {
@@ -843,11 +867,9 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget) {
       model_parallelism += std::round(pair.second->value);
     }
     // We terminate once the improvement of the output latency is too small or
-    // the essential transformations' parallelism reaches the CPU budget or the
-    // worst-case total buffer size exceeds the memory budget.
+    // the essential transformations' parallelism reaches the CPU budget.
     if (std::abs(output_time - new_output_time) < kOptimizationPrecision ||
-        model_parallelism > cpu_budget ||
-        TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+        model_parallelism > cpu_budget) {
       break;
     }
     double max_abs_derivative = 1.0;
@@ -857,7 +879,9 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget) {
             std::max(max_abs_derivative, std::abs(gradient[pair.first]));
       }
     }
+    std::map<string, double> old_values;
     for (auto& pair : parameters) {
+      old_values[pair.first] = pair.second->value;
       new_value = pair.second->value -
                   kDescentStep * gradient[pair.first] / max_abs_derivative;
       // Projection on a feasible interval.
@@ -869,11 +893,33 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget) {
         pair.second->value = new_value;
       }
     }
+    // We also terminate once the step would make the worst-case total buffer
+    // size exceed the memory budget, in which case the step is reverted.
+    if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+      VLOG(2) << "Reached the memory budget of " << ram_budget << " bytes.";
+      for (auto& pair : parameters) {
+        pair.second->value = old_values[pair.first];
+      }
+      break;
+    }
     output_time = new_output_time;
   }
-  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+  // Round the parameter values to the nearest integer, or round all of them
+  // down if the rounded values would together exceed the memory budget.
+  // Rounding down cannot exceed the budget, since the unrounded values do not.
+  std::map<string, double> unrounded_values;
   for (auto& pair : parameters) {
+    unrounded_values[pair.first] = pair.second->value;
     pair.second->value = std::round(pair.second->value);
+  }
+  if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+    for (auto& pair : parameters) {
+      pair.second->value =
+          std::max(std::floor(unrounded_values[pair.first]), pair.second->min);
+    }
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+  for (auto& pair : parameters) {
     auto& parameter = pair.second;
     VLOG(2) << "Setting tunable parameter " << pair.first << " to "
             << parameter->value;
@@ -911,17 +957,24 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
         break;
       }
     }
-    if (output_time < processing_time / cpu_budget || all_max ||
-        TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+    if (output_time < processing_time / cpu_budget || all_max) {
       break;
     }
     double best_delta = -1.0L;
     Parameter* best_parameter = nullptr;
+    bool within_budget = false;
     for (auto& pair : parameters) {
       if (pair.second->value == pair.second->max) {
         continue;
       }
       pair.second->value++;
+      // Increments that would make the worst-case total buffer size exceed
+      // the memory budget are not considered.
+      if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+        pair.second->value--;
+        continue;
+      }
+      within_budget = true;
       double new_output_time = OutputTime(snapshot, /*gradient=*/nullptr);
       double delta = output_time - new_output_time;
       if (delta > best_delta &&
@@ -931,6 +984,10 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
       }
       pair.second->value--;
     }
+    if (!within_budget) {
+      VLOG(2) << "Reached the memory budget of " << ram_budget << " bytes.";
+      break;
+    }
     if (!best_parameter) {
       VLOG(2) << "Failed to find a tunable parameter that would decrease the "
                  "output time. This means that the autotuning optimization got "
@@ -951,6 +1008,32 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
   }
 }
 
+std::map<string, int64> Model::TunableParameterValues() {
+  std::map<string, std::shared_ptr<Parameter>> parameters;
+  {
+    tf_shared_lock l(mu_);
+    if (!output_) {
+      return {};
+    }
+    parameters = CollectTunableParameters(output_);
+  }
+  std::map<string, int64> values;
+  for (auto& pair : parameters) {
+    auto& state = pair.second->state;
+    mutex_lock l(*state->mu);
+    values[pair.first] = state->value;
+  }
+  return values;
+}
+
+double Model::MaximumBufferedBytes() {
+  tf_shared_lock l(mu_);
+  if (!output_) {
+    return 0;
+  }
+  return TotalMaximumBufferedBytes(output_);
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node,
                          std::map<string, double>* gradient) {
   std::vector<double> input_times(1, 0);
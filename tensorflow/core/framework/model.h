@@ -203,6 +203,12 @@ class Node {
     mutex_lock l(mu_);
     buffered_bytes_ += bytes_delta;
     buffered_elements_ += elements_delta;
+    if (bytes_delta > 0) {
+      enqueued_bytes_ += bytes_delta;
+    }
+    if (elements_delta > 0) {
+      enqueued_elements_ += elements_delta;
+    }
   }
 
   // Records that the node produced an element.
@@ -211,6 +217,13 @@ class Node {
     num_elements_++;
   }
 
+  // Records that the node produced `num_elements` elements at once, for
+  // example by skipping them.
+  void record_elements(int64 num_elements) LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    num_elements_ += num_elements;
+  }
+
   // Records that a node thread has started executing.
   void record_start(int64 time_nanos) LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
@@ -305,6 +318,8 @@ class Node {
       result->autotune_ = autotune_;
       result->buffered_bytes_ = buffered_bytes_;
       result->buffered_elements_ = buffered_elements_;
+      result->enqueued_bytes_ = enqueued_bytes_;
+      result->enqueued_elements_ = enqueued_elements_;
       result->processing_time_ = processing_time_;
       result->num_elements_ = num_elements_;
       result->parameters_ = parameters_;
@@ -350,14 +365,7 @@ class Node {
     if (!autotune_) {
       return 0;
     }
-    double result = 0;
-    auto* parameter = gtl::FindOrNull(parameters_, kBufferSize);
-    if (!parameter) {
-      parameter = gtl::FindOrNull(parameters_, kParallelism);
-    }
-    if (parameter) {
-      result = (*parameter)->value * AverageBufferedElementSize();
-    }
+    double result = MaximumBufferedBytesLocked();
     for (auto& input : inputs_) {
       result += input->TotalMaximumBufferedBytes();
     }
@@ -390,15 +398,34 @@ class Node {
   virtual std::shared_ptr<Node> Clone(std::shared_ptr<Node> output) const
       SHARED_LOCKS_REQUIRED(mu_) = 0;
 
-  // Returns the average size of an element buffered in this node.
+  // Returns the average size of an element buffered in this node. If the
+  // buffer is currently empty, the estimate is based on all elements that have
+  // been buffered so far.
   double AverageBufferedElementSize() const SHARED_LOCKS_REQUIRED(mu_) {
     if (buffered_elements_ == 0) {
-      return 0;
+      if (enqueued_elements_ == 0) {
+        return 0;
+      }
+      return static_cast<double>(enqueued_bytes_) /
+             static_cast<double>(enqueued_elements_);
     }
     return static_cast<double>(buffered_bytes_) /
            static_cast<double>(buffered_elements_);
   }
 
+  // Returns the number of bytes this node would buffer if its buffer was full,
+  // given the current value of its buffer size (or parallelism) parameter.
+  virtual double MaximumBufferedBytesLocked() const SHARED_LOCKS_REQUIRED(mu_) {
+    auto* parameter = gtl::FindOrNull(parameters_, kBufferSize);
+    if (!parameter) {
+      parameter = gtl::FindOrNull(parameters_, kParallelism);
+    }
+    if (!parameter) {
+      return 0;
+    }
+    return (*parameter)->value * AverageBufferedElementSize();
+  }
+
   // Returns the sum of per-element output time for the inputs of this node and
   // if `gradient` is not `nullptr`, collects gradients of output times w.r.t.
   // tunable parameters and the last input time.
@@ -497,6 +524,10 @@ class Node {
   bool autotune_ GUARDED_BY(mu_) = true;
   int64 buffered_bytes_ GUARDED_BY(mu_) = 0;
   int64 buffered_elements_ GUARDED_BY(mu_) = 0;
+  // The total number of bytes and elements that have ever been added to this
+  // node's buffer, used to estimate the per-element memory footprint.
+  int64 enqueued_bytes_ GUARDED_BY(mu_) = 0;
+  int64 enqueued_elements_ GUARDED_BY(mu_) = 0;
   int64 processing_time_ GUARDED_BY(mu_) = 0;
   int64 num_elements_ GUARDED_BY(mu_) = 0;
   std::map<std::thread::id, int64> work_start_ GUARDED_BY(mu_);
@@ -521,7 +552,8 @@ class Node {
 std::shared_ptr<Node> MakeInterleaveManyNode(Node::Args args);
 
 // AsyncInterleaveMany nodes are the asynchronous version of InterleaveMany
-// nodes.
+// nodes. If the node has a buffer size parameter, it identifies the size of
+// the buffer kept for each of the interleaved inputs.
 std::shared_ptr<Node> MakeAsyncInterleaveManyNode(
     Node::Args args, std::vector<std::shared_ptr<Parameter>> parameters);
 
@@ -584,10 +616,20 @@ class Model {
   // Increments the processing time for the given node..
   void AddProcessingTime(const string& name, int64 delta) LOCKS_EXCLUDED(mu_);
 
-  // Uses the given algorithm to perform the autotuning optimization.
+  // Uses the given algorithm to perform the autotuning optimization. The
+  // tunable parameters are chosen so that the number of bytes buffered by the
+  // input pipeline, were all of its buffers full, does not exceed `ram_budget`.
   void Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget)
       LOCKS_EXCLUDED(mu_);
 
+  // Returns the current values of tunable parameters, keyed by the (unique)
+  // name of the node the parameter belongs to.
+  std::map<string, int64> TunableParameterValues() LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of bytes that the tunable buffers of the input pipeline
+  // would hold if they were full, given the current parameter values.
+  double MaximumBufferedBytes() LOCKS_EXCLUDED(mu_);
+
   // Records that a node has produced an element.
   void RecordElement(const string& name) LOCKS_EXCLUDED(mu_);
 
@@ -624,7 +666,8 @@ class Model {
   // parameter whose increase in parallelism decreases the output time the most.
   // This process is repeated until all parameters reach their maximum values or
   // the projected output time is less than or equal to the processing time
-  // needed to produce an element divided by CPU budget.
+  // needed to produce an element divided by CPU budget. Increments that would
+  // make the worst-case memory usage exceed the RAM budget are not considered.
   void OptimizeHillClimb(int64 cpu_budget, int64 ram_budget);
 
   // This optimization algorithm starts by setting all tunable parallelism
@@ -633,7 +676,8 @@ class Model {
   // projecting resulting values on the feasible intervals. Improvement step is
   // repeated until either the output time improvement is smaller than threshold
   // value or the output time is less than the processing time needed to produce
-  // an element divided by CPU budget.
+  // an element divided by CPU budget. A step that would make the worst-case
+  // memory usage exceed the RAM budget is reverted and ends the optimization.
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget);
 
   // Collects the output time and if `gradient` is not `nullptr`, the output
@@ -187,6 +187,36 @@ INSTANTIATE_TEST_SUITE_P(Test, AsyncKnownRatioTest,
                                             ::testing::Values(0, 50, 100, 200),
                                             ::testing::Values(0, 1, 2, 4)));
 
+TEST(AsyncInterleaveManyBufferSizeTest, Model) {
+  const int64 buffer_size = 4;
+  std::shared_ptr<Node> async_interleave_many =
+      model::MakeAsyncInterleaveManyNode(
+          {0, "async_interleave_many", nullptr},
+          {model::MakeParameter(
+              "buffer_size",
+              std::make_shared<SharedState>(buffer_size, nullptr, nullptr), 1,
+              buffer_size)});
+  std::shared_ptr<Node> meta_source =
+      model::MakeSourceNode({1, "meta_source", async_interleave_many});
+  async_interleave_many->add_input(meta_source);
+  async_interleave_many->record_buffer_event(100, 1);
+  EXPECT_EQ(async_interleave_many->TotalMaximumBufferedBytes(), 0);
+  std::shared_ptr<Node> source1 =
+      model::MakeSourceNode({2, "source1", async_interleave_many});
+  async_interleave_many->add_input(source1);
+  std::shared_ptr<Node> source2 =
+      model::MakeSourceNode({3, "source2", async_interleave_many});
+  async_interleave_many->add_input(source2);
+  // Each of the interleaved inputs has its own buffer.
+  EXPECT_EQ(async_interleave_many->TotalMaximumBufferedBytes(),
+            100 * buffer_size * 2);
+  // The per-element size estimate outlives the buffered elements.
+  async_interleave_many->record_buffer_event(-100, -1);
+  EXPECT_EQ(async_interleave_many->TotalBufferedBytes(), 0);
+  EXPECT_EQ(async_interleave_many->TotalMaximumBufferedBytes(),
+            100 * buffer_size * 2);
+}
+
 TEST(InterleaveManyTest, Model) {
   std::shared_ptr<Node> interleave_many =
       model::MakeInterleaveManyNode({0, "interleave_many", nullptr});
@@ -727,6 +757,47 @@ TEST(UnknownGradientTest, Model) {
               (new_output_time - output_time) / kParameterStep,
               kComparisonPrecision);
 }
+
+class OptimizeTest : public ::testing::TestWithParam<AutotuneAlgorithm> {};
+
+TEST_P(OptimizeTest, RamBudget) {
+  const int64 kElementSize = 1000;
+  const int64 kRamBudget = 10 * kElementSize;
+  Model model([](std::shared_ptr<Node> node) {});
+  auto state = std::make_shared<SharedState>(
+      model::kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  std::shared_ptr<Node> async_known_ratio = model.AddNode(
+      [state](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter("parallelism", state, /*min=*/1,
+                                  /*max=*/64)});
+      },
+      "async_known_ratio", /*output_name=*/"");
+  model.AddNode(
+      [](Node::Args args) { return model::MakeSourceNode(std::move(args)); },
+      "async_known_ratio::source", "async_known_ratio");
+  for (int i = 0; i < 10; ++i) {
+    async_known_ratio->add_processing_time(1000000);
+    async_known_ratio->record_element();
+  }
+  async_known_ratio->record_buffer_event(kElementSize, 1);
+
+  model.Optimize(GetParam(), /*cpu_budget=*/64, kRamBudget);
+  // The bytes that are already buffered are not counted against the budget.
+  EXPECT_GT(state->value, 1);
+  EXPECT_LE(state->value * kElementSize, kRamBudget + kElementSize);
+  EXPECT_EQ(model.MaximumBufferedBytes(), state->value * kElementSize);
+  std::map<string, int64> values = model.TunableParameterValues();
+  EXPECT_EQ(values.size(), 1);
+  EXPECT_EQ(values[async_known_ratio->long_name()], state->value);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Test, OptimizeTest,
+    ::testing::Values(AutotuneAlgorithm::HILL_CLIMB,
+                      AutotuneAlgorithm::GRADIENT_DESCENT));
 }  // namespace
 }  // namespace model
 }  // namespace data
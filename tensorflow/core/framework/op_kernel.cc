@@ -709,7 +709,13 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+  return allocate_tensor(get_allocator(attr), type, shape, out_tensor,
+                         allocation_attr);
+}
+
+Status OpKernelContext::allocate_tensor(
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
   MEMDEBUG_CACHE_OP(op_kernel().name().c_str());
   MEMDEBUG_CACHE_STEPID(step_id());
   Tensor new_tensor(a, type, shape,
@@ -766,8 +772,26 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
           " more than once.  Try turning off the ScopedAllocator optimizer.");
     }
   }
+  if (params_->output_buffers != nullptr &&
+      params_->output_buffers[index] != nullptr && attr.value == 0 &&
+      attr.scope_id <= 0) {
+    const Tensor& buffer = *params_->output_buffers[index];
+    if (buffer.dtype() == type && buffer.shape() == shape) {
+      record_tensor_reference(buffer);
+      outputs_[index] = TensorValue(new Tensor(buffer));
+      *output = outputs_[index].tensor;
+      return Status::OK();
+    }
+  }
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Status s;
+  if (params_->step_allocator_for_outputs && attr.value == 0 &&
+      attr.scope_id <= 0 && !track_allocations()) {
+    s = allocate_tensor(params_->step_allocator, type, shape,
+                        output_tensor.get(), AllocationAttributes());
+  } else {
+    s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  }
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -795,8 +819,15 @@ Status OpKernelContext::allocate_temp(
             << ".  Switch to allocate_output to avoid performance penalty.";
     allocator_attr.scope_id = -1;
   }
-  Status s =
-      allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
+  Status s;
+  if (params_->step_allocator != nullptr && allocator_attr.value == 0 &&
+      !track_allocations()) {
+    s = allocate_tensor(params_->step_allocator, type, shape, out_temp,
+                        allocation_attr);
+  } else {
+    s = allocate_tensor(type, shape, out_temp, allocator_attr,
+                        allocation_attr);
+  }
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
     Allocator* a = get_allocator(allocator_attr);
     if (a->TracksAllocationSizes()) {
@@ -719,6 +719,20 @@ class OpKernelContext {
     // TensorSliceReaderCache support.
     checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache = nullptr;
 
+    // If not null, allocate_temp() uses this allocator for temporaries that
+    // request no special allocator attributes. It is owned by the step, and
+    // frees its memory in bulk when the step is done.
+    Allocator* step_allocator = nullptr;
+    // If true, allocate_output() also uses `step_allocator` for outputs that
+    // request no special allocator attributes.
+    bool step_allocator_for_outputs = false;
+
+    // If not null, the caller-owned tensor of each output, or nullptr.
+    // allocate_output() shares the buffer of that tensor instead of
+    // allocating one when the output requests no special allocator
+    // attributes and has the same type and shape.
+    const Tensor* const* output_buffers = nullptr;
+
     // Support for forwarding reservations (used by ScopedAllocator).
     static const int kNeverForward = -2;
     static const int kNoReservation = -1;
@@ -1297,6 +1311,10 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
+                         const AllocationAttributes& allocation_attr);
+
   // Initialize the allocated_scope_ids_ set the first time this method is
   // called.
   void maybe_initialize_scope_id_set();
@@ -156,7 +156,8 @@ class ThreadWorkSource {
         non_blocking_work_queues_(non_blocking_work_sharding_factor_),
         blocking_inflight_(0),
         non_blocking_inflight_(0),
-        traceme_id_(0) {
+        traceme_id_(0),
+        priority_(0) {
     queue_waiters_.next = &queue_waiters_;
     queue_waiters_.prev = &queue_waiters_;
     for (int i = 0; i < NonBlockingWorkShardingFactor(); ++i) {
@@ -295,6 +296,9 @@ class ThreadWorkSource {
   void SetTracemeId(int64 value) { traceme_id_ = value; }
   void SetRank(int64 value) { rank_ = value; }
 
+  int64 GetPriority() { return priority_.load(std::memory_order_relaxed); }
+  void SetPriority(int64 value) { priority_ = value; }
+
   void SetWaiter(Waiter* waiter, mutex* mutex) {
     mutex_lock l(run_handler_waiter_mu_);
     sub_thread_pool_waiter_ = waiter;
@@ -351,6 +355,7 @@ class ThreadWorkSource {
   Waiter queue_waiters_ GUARDED_BY(waiters_mu_);
   std::atomic<int64> traceme_id_;
   std::atomic<int64> rank_;
+  std::atomic<int64> priority_;
 
   mutex run_handler_waiter_mu_;
   mutex* sub_thread_pool_waiter_mu_ GUARDED_BY(run_handler_waiter_mu_);
@@ -441,8 +446,12 @@ class RunHandlerThreadPool {
   }
 
   // Set work queues from which the thread 'tid' can steal its work.
-  // The request with start_request_idx will be attempted first. Other requests
-  // will be attempted in FIFO order based on their arrival time.
+  // The requests of a higher priority class than the request with
+  // start_request_idx will be attempted first, then the request with
+  // start_request_idx. Other requests will be attempted in the order of
+  // `thread_work_sources`, i.e. by priority, deadline and arrival time. As
+  // threads look for work after each closure, a request is preempted at op
+  // boundaries by requests of a higher priority class.
 
   // TODO(donglin) Change the task steal order to be round-robin such that if
   // an attempt to steal task from request i failed, then attempt to steal task
@@ -467,6 +476,16 @@ class RunHandlerThreadPool {
             thread_work_sources[i]);
       }
     } else {
+      const int64 start_priority =
+          thread_work_sources[start_request_idx]->GetPriority();
+      int num_higher_priority = 0;
+      while (num_higher_priority < start_request_idx &&
+             thread_work_sources[num_higher_priority]->GetPriority() >
+                 start_priority) {
+        thread_data_[tid].thread_work_sources.emplace_back(
+            thread_work_sources[num_higher_priority]);
+        ++num_higher_priority;
+      }
       thread_data_[tid].thread_work_sources.emplace_back(
           thread_work_sources[start_request_idx]);
       // The number of shards for the queue. Threads in each shard will
@@ -482,7 +501,7 @@ class RunHandlerThreadPool {
       int token = tid % num_shards;
       for (int i = 0; i < num_shards; ++i) {
         for (int j = token; j < thread_work_sources.size(); j += num_shards) {
-          if (j != start_request_idx) {
+          if (j >= num_higher_priority && j != start_request_idx) {
             thread_data_[tid].thread_work_sources.emplace_back(
                 thread_work_sources[j]);
           }
@@ -799,7 +818,19 @@ class RunHandler::Impl {
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
-  void Reset(int64 step_id);
+  void Reset(int64 step_id,
+             const RunOptions::Experimental::RunHandlerPoolOptions& options);
+
+  // Returns true if the work of this handler goes before the work of `other`:
+  // handlers of a higher priority go first, then handlers with an earlier
+  // deadline, then handlers that were requested earlier.
+  bool RunsBefore(const Impl& other) const {
+    if (priority_ != other.priority_) return priority_ > other.priority_;
+    if (deadline_us_ != other.deadline_us_) {
+      return deadline_us_ < other.deadline_us_;
+    }
+    return start_time_us_ < other.start_time_us_;
+  }
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
@@ -822,6 +853,10 @@ class RunHandler::Impl {
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
   int64 step_id_;
+  int64 priority_;
+  // Time (in microseconds since unix epoch) by which the request should
+  // complete, or kuint64max if it has no deadline.
+  uint64 deadline_us_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   ThreadWorkSource tws_;
 };
@@ -879,7 +914,10 @@ class RunHandlerPool::Impl {
     return run_handler_thread_pool_.get();
   }
 
-  std::unique_ptr<RunHandler> Get(int64 step_id) LOCKS_EXCLUDED(mu_) {
+  std::unique_ptr<RunHandler> Get(
+      int64 step_id,
+      const RunOptions::Experimental::RunHandlerPoolOptions& options)
+      LOCKS_EXCLUDED(mu_) {
     std::unique_ptr<Eigen::MaxSizeVector<ThreadWorkSource*>>
         thread_work_sources;
     uint64 version;
@@ -890,13 +928,19 @@ class RunHandlerPool::Impl {
       while (free_handlers_.empty()) {
         one_handler_free_.wait(l);
       }
-      // Remove the last entry from free_handlers_ and add to the end of
-      // sorted_active_handlers_.
+      // Remove the last entry from free_handlers_ and add it to
+      // sorted_active_handlers_, after the handlers whose work goes first.
+      // Without priorities and deadlines this is the end of the list, since
+      // handlers are expected to be obtained in increasing order of time.
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id);
-      // Sortedness isn't violated if we simply add at the end of the list,
-      // since handlers are expected to be obtained in increasing order of time.
-      sorted_active_handlers_.push_back(handler_impl);
+      handler_impl->Reset(step_id, options);
+      auto pos = std::upper_bound(
+          sorted_active_handlers_.begin(), sorted_active_handlers_.end(),
+          handler_impl,
+          [](const RunHandler::Impl* a, const RunHandler::Impl* b) {
+            return a->RunsBefore(*b);
+          });
+      sorted_active_handlers_.insert(pos, handler_impl);
       DCHECK_LE(sorted_active_handlers_.size(), max_handlers_);
       free_handlers_.pop_back();
 
@@ -1005,8 +1049,8 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, deadline and start time. See
+  // RunHandler::Impl::RunsBefore().
   std::vector<RunHandler::Impl*> sorted_active_handlers_ GUARDED_BY(mu_);
   std::vector<RunHandler::Impl*> free_handlers_ GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ GUARDED_BY(mu_);
@@ -1092,7 +1136,7 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_.reset(new ThreadPoolInterfaceWrapper(this));
-  Reset(0);
+  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -1107,10 +1151,17 @@ void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
                                                         std::move(fn));
 }
 
-void RunHandler::Impl::Reset(int64 step_id) {
+void RunHandler::Impl::Reset(
+    int64 step_id,
+    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
+  priority_ = options.priority();
+  deadline_us_ = options.deadline_in_ms() > 0
+                     ? start_time_us_ + options.deadline_in_ms() * 1000
+                     : kuint64max;
   tws_.SetTracemeId(step_id);
+  tws_.SetPriority(priority_);
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
@@ -1122,8 +1173,10 @@ RunHandlerPool::RunHandlerPool(int num_inter_op_threads,
 
 RunHandlerPool::~RunHandlerPool() {}
 
-std::unique_ptr<RunHandler> RunHandlerPool::Get(int64 step_id) {
-  return impl_->Get(step_id);
+std::unique_ptr<RunHandler> RunHandlerPool::Get(
+    int64 step_id,
+    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
+  return impl_->Get(step_id, options);
 }
 
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
@@ -62,7 +62,15 @@ class RunHandlerPool {
   // unique_ptr is destroyed.
   //
   // Will block unless there is an inactive handler.
-  std::unique_ptr<RunHandler> Get(int64 step_id = 0);
+  //
+  // The work of the handlers of a higher `options.priority()` is scheduled
+  // first, and lower priority work is preempted at op boundaries. Within a
+  // priority class, handlers with an earlier deadline go first, then handlers
+  // obtained earlier.
+  std::unique_ptr<RunHandler> Get(
+      int64 step_id = 0,
+      const RunOptions::Experimental::RunHandlerPoolOptions& options =
+          RunOptions::Experimental::RunHandlerPoolOptions());
 
  private:
   class Impl;
@@ -74,7 +82,7 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority class and deadline of the request, then time of the Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -29,10 +29,14 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -78,6 +82,77 @@ TEST(RunHandlerUtilTest, TestBasicScheduling) {
   counter.Wait();
 }
 
+// Runs `kNumClosures` inter op closures of `first` and then of `second` on a
+// pool with a single thread, which is busy with another closure of `first`
+// while they are scheduled. Returns the order in which the closures ran, as
+// the indices of their handlers.
+std::vector<int> RunOrder(
+    const RunOptions::Experimental::RunHandlerPoolOptions& first,
+    const RunOptions::Experimental::RunHandlerPoolOptions& second) {
+  const int kNumClosures = 3;
+  RunHandlerPool pool(1);
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter counter(2 * kNumClosures + 1);
+  Notification started;
+  Notification unblock;
+
+  auto first_handler = pool.Get(1, first);
+  first_handler->ScheduleInterOpClosure([&]() {
+    started.Notify();
+    unblock.WaitForNotification();
+    counter.DecrementCount();
+  });
+  started.WaitForNotification();
+  for (int i = 0; i < kNumClosures; ++i) {
+    first_handler->ScheduleInterOpClosure([&]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(0);
+      }
+      counter.DecrementCount();
+    });
+  }
+  auto second_handler = pool.Get(2, second);
+  for (int i = 0; i < kNumClosures; ++i) {
+    second_handler->ScheduleInterOpClosure([&]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(1);
+      }
+      counter.DecrementCount();
+    });
+  }
+  unblock.Notify();
+  counter.Wait();
+  mutex_lock l(mu);
+  return order;
+}
+
+TEST(RunHandlerUtilTest, TestFifoOrder) {
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  EXPECT_EQ(std::vector<int>({0, 0, 0, 1, 1, 1}), RunOrder(options, options));
+}
+
+TEST(RunHandlerUtilTest, TestHigherPriorityRunsFirst) {
+  RunOptions::Experimental::RunHandlerPoolOptions low;
+  RunOptions::Experimental::RunHandlerPoolOptions high;
+  high.set_priority(1);
+  EXPECT_EQ(std::vector<int>({1, 1, 1, 0, 0, 0}), RunOrder(low, high));
+}
+
+TEST(RunHandlerUtilTest, TestEarlierDeadlineRunsFirst) {
+  RunOptions::Experimental::RunHandlerPoolOptions no_deadline;
+  RunOptions::Experimental::RunHandlerPoolOptions deadline;
+  deadline.set_deadline_in_ms(60000);
+  EXPECT_EQ(std::vector<int>({1, 1, 1, 0, 0, 0}),
+            RunOrder(no_deadline, deadline));
+  // The priority class goes before the deadline.
+  no_deadline.set_priority(1);
+  EXPECT_EQ(std::vector<int>({0, 0, 0, 1, 1, 1}),
+            RunOrder(no_deadline, deadline));
+}
+
 SessionOptions DefaultSessionOptions() {
   SessionOptions options;
   (*options.config.mutable_device_count())["CPU"] = 2;
@@ -205,5 +280,65 @@ TEST_F(RunHandlerTest, TestConcurrencyUseRunHandlerPool) {
   delete tp;
 }
 
+void SpinForMicros(int64 micros) {
+  const uint64 end = Env::Default()->NowMicros() + micros;
+  while (Env::Default()->NowMicros() < end) {
+  }
+}
+
+// Measures the latency of small requests while batch requests keep all the
+// threads busy. With `use_priority` the small requests are of a higher
+// priority class.
+static void BM_RunHandlerPoolMixedLoad(int iters, int use_priority) {
+  testing::StopTiming();
+  const int kNumThreads = 4;
+  const int kNumBatchClients = 4;
+  RunHandlerPool pool(kNumThreads, kNumThreads);
+  std::atomic<bool> stop(false);
+  {
+    thread::ThreadPool batch_clients(Env::Default(), "batch",
+                                     kNumBatchClients);
+    for (int i = 0; i < kNumBatchClients; ++i) {
+      batch_clients.Schedule([&pool, &stop]() {
+        while (!stop) {
+          auto handler = pool.Get();
+          BlockingCounter counter(64);
+          for (int j = 0; j < 64; ++j) {
+            handler->ScheduleInterOpClosure([&counter]() {
+              SpinForMicros(200);
+              counter.DecrementCount();
+            });
+          }
+          counter.Wait();
+        }
+      });
+    }
+
+    RunOptions::Experimental::RunHandlerPoolOptions options;
+    options.set_priority(use_priority ? 1 : 0);
+    histogram::Histogram latency;
+    testing::StartTiming();
+    for (int i = 0; i < iters; ++i) {
+      const uint64 start = Env::Default()->NowMicros();
+      auto handler = pool.Get(i, options);
+      BlockingCounter counter(kNumThreads);
+      for (int j = 0; j < kNumThreads; ++j) {
+        handler->ScheduleInterOpClosure([&counter]() {
+          SpinForMicros(20);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+      handler.reset();
+      latency.Add(Env::Default()->NowMicros() - start);
+    }
+    testing::StopTiming();
+    stop = true;
+    testing::SetLabel(strings::StrCat("p50=", latency.Percentile(50),
+                                      "us p99=", latency.Percentile(99), "us"));
+  }
+}
+BENCHMARK(BM_RunHandlerPoolMixedLoad)->Arg(0)->Arg(1);
+
 }  // namespace
 }  // namespace tensorflow
@@ -105,6 +105,26 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     return input_->CheckExternalState();
   }
 
+  bool SupportsRandomAccess() const override {
+    return input_->SupportsRandomAccess();
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index ", index, " is out of range for ",
+                                DebugString(), ".");
+    }
+    const int64 start = index * batch_size_;
+    const int64 end = std::min(start + batch_size_, input_->Cardinality());
+    std::vector<std::vector<Tensor>> batch_elements(end - start);
+    for (int64 i = start; i < end; ++i) {
+      TF_RETURN_IF_ERROR(input_->Get(ctx, i, &batch_elements[i - start]));
+    }
+    out_tensors->clear();
+    return CopyBatch(ctx, std::move(batch_elements), out_tensors);
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -177,74 +197,8 @@ class BatchDatasetOp::Dataset : public DatasetBase {
         return Status::OK();
       }
 
-      // Copy the retrieved batch elements into one output tensor per tuple
-      // component.
-      //
-      // NOTE(mrry): If the input or output sizes are statically known, we
-      // could potentially read the input values in-place into their
-      // respective slice locations. This would require a different GetNext()
-      // overload that supports zero-copy, and might make sense in an
-      // optimization pass.
-      const size_t num_tuple_components = batch_elements[0].size();
-      const int64 num_batch_elements = batch_elements.size();
-      for (size_t component_index = 0; component_index < num_tuple_components;
-           ++component_index) {
-        const Tensor& first_element = batch_elements[0][component_index];
-        TensorShape batch_component_shape({num_batch_elements});
-        // NOTE(mrry): Copy the shape of the first element here, because
-        // `first_element.shape()` will become undefined after the 0th batch
-        // element is moved into the output batch.
-        TensorShape first_element_shape(first_element.shape());
-        batch_component_shape.AppendShape(first_element_shape);
-        out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
-                                  batch_component_shape);
-        if (!out_tensors->back().IsInitialized()) {
-          return errors::ResourceExhausted(
-              "Failed to allocate memory for the batch of component ",
-              component_index);
-        }
-        Tensor& batch_component = out_tensors->back();
-        // Build the output tuple component by copying one slice
-        // from each input element in the batch.
-        auto copy_element_fn = [component_index, &batch_elements,
-                                &batch_component](int index) {
-          TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
-              std::move(batch_elements[index][component_index]),
-              &batch_component, index));
-          return Status::OK();
-        };
-        BlockingCounter counter(num_batch_elements);
-        Status status;
-        mutex status_mu;
-        for (size_t i = 0; i < num_batch_elements; ++i) {
-          if (batch_elements[i][component_index].shape() !=
-              first_element_shape) {
-            return errors::InvalidArgument(
-                "Cannot batch tensors with different shapes in "
-                "component ",
-                component_index, ". First element had shape ",
-                first_element_shape.DebugString(), " and element ", i,
-                " had shape ",
-                batch_elements[i][component_index].shape().DebugString(), ".");
-          }
-          if (TF_PREDICT_FALSE(dataset()->parallel_copy_)) {
-            (*ctx->runner())(
-                [i, &status, &status_mu, &counter, &copy_element_fn]() {
-                  Status s = copy_element_fn(i);
-                  {
-                    mutex_lock l(status_mu);
-                    status.Update(s);
-                  }
-                  counter.DecrementCount();
-                });
-          } else {
-            status.Update(copy_element_fn(i));
-            counter.DecrementCount();
-          }
-        }
-        counter.Wait();
-        TF_RETURN_IF_ERROR(status);
-      }
+      TF_RETURN_IF_ERROR(
+          dataset()->CopyBatch(ctx, std::move(batch_elements), out_tensors));
       *end_of_sequence = false;
       return Status::OK();
     }
@@ -281,6 +235,78 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
   };
 
+  // Copies the `batch_elements` into one output tensor per tuple component.
+  Status CopyBatch(IteratorContext* ctx,
+                   std::vector<std::vector<Tensor>>&& batch_elements,
+                   std::vector<Tensor>* out_tensors) const {
+    // NOTE(mrry): If the input or output sizes are statically known, we
+    // could potentially read the input values in-place into their
+    // respective slice locations. This would require a different GetNext()
+    // overload that supports zero-copy, and might make sense in an
+    // optimization pass.
+    const size_t num_tuple_components = batch_elements[0].size();
+    const int64 num_batch_elements = batch_elements.size();
+    for (size_t component_index = 0; component_index < num_tuple_components;
+         ++component_index) {
+      const Tensor& first_element = batch_elements[0][component_index];
+      TensorShape batch_component_shape({num_batch_elements});
+      // NOTE(mrry): Copy the shape of the first element here, because
+      // `first_element.shape()` will become undefined after the 0th batch
+      // element is moved into the output batch.
+      TensorShape first_element_shape(first_element.shape());
+      batch_component_shape.AppendShape(first_element_shape);
+      out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
+                                batch_component_shape);
+      if (!out_tensors->back().IsInitialized()) {
+        return errors::ResourceExhausted(
+            "Failed to allocate memory for the batch of component ",
+            component_index);
+      }
+      Tensor& batch_component = out_tensors->back();
+      // Build the output tuple component by copying one slice
+      // from each input element in the batch.
+      auto copy_element_fn = [component_index, &batch_elements,
+                              &batch_component](int index) {
+        TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+            std::move(batch_elements[index][component_index]),
+            &batch_component, index));
+        return Status::OK();
+      };
+      BlockingCounter counter(num_batch_elements);
+      Status status;
+      mutex status_mu;
+      for (size_t i = 0; i < num_batch_elements; ++i) {
+        if (batch_elements[i][component_index].shape() !=
+            first_element_shape) {
+          return errors::InvalidArgument(
+              "Cannot batch tensors with different shapes in "
+              "component ",
+              component_index, ". First element had shape ",
+              first_element_shape.DebugString(), " and element ", i,
+              " had shape ",
+              batch_elements[i][component_index].shape().DebugString(), ".");
+        }
+        if (TF_PREDICT_FALSE(parallel_copy_)) {
+          (*ctx->runner())(
+              [i, &status, &status_mu, &counter, &copy_element_fn]() {
+                Status s = copy_element_fn(i);
+                {
+                  mutex_lock l(status_mu);
+                  status.Update(s);
+                }
+                counter.DecrementCount();
+              });
+        } else {
+          status.Update(copy_element_fn(i));
+          counter.DecrementCount();
+        }
+      }
+      counter.Wait();
+      TF_RETURN_IF_ERROR(status);
+    }
+    return Status::OK();
+  }
+
   const int64 batch_size_;
   const bool drop_remainder_;
   const bool parallel_copy_;
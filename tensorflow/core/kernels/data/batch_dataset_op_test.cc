@@ -283,6 +283,28 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+TEST_F(BatchDatasetOpTest, RandomAccess) {
+  auto dataset_params = BatchDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  ASSERT_TRUE(dataset_->SupportsRandomAccess());
+  std::vector<Tensor> expected_outputs = {
+      CreateTensor<int64>(TensorShape({3}), {0, 1, 2}),
+      CreateTensor<int64>(TensorShape({3}), {3, 4, 5}),
+      CreateTensor<int64>(TensorShape({3}), {6, 7, 8}),
+      CreateTensor<int64>(TensorShape({1}), {9})};
+  for (int64 i = expected_outputs.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(iterator_ctx_.get(), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    TF_EXPECT_OK(ExpectEqual(out_tensors[0], expected_outputs[i]));
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(iterator_ctx_.get(), expected_outputs.size(),
+                          &out_tensors)
+                .code(),
+            error::OUT_OF_RANGE);
+}
+
 TEST_F(BatchDatasetOpTest, InvalidBatchSize) {
   auto batch_dataset_params = InvalidBatchSizeBatchDatasetParams();
   EXPECT_EQ(Initialize(batch_dataset_params).code(),
@@ -18,10 +18,12 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
+#include "tensorflow/core/kernels/data/columnar_cache.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -57,6 +59,18 @@ constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
 
+// Caches are written in the columnar format of `ColumnarCacheWriter` when this
+// environment variable is true, and as tensor bundles otherwise. Both formats
+// are read regardless of its value.
+bool UseColumnarCacheFormat() {
+  bool columnar = false;
+  Status s = ReadBoolFromEnvVar("TF_DATA_COLUMNAR_CACHE", false, &columnar);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_DATA_COLUMNAR_CACHE: " << s;
+  }
+  return columnar;
+}
+
 class CacheDatasetOp::FileDataset : public DatasetBase {
  public:
   explicit FileDataset(OpKernelContext* ctx, const DatasetBase* input,
@@ -65,6 +79,7 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         input_(input),
         filename_(std::move(filename)),
         env_(env),
+        columnar_(UseColumnarCacheFormat()),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
         item_index_padding_size_(StringPaddingSize(kMaxItems)),
@@ -130,13 +145,28 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
                            tensor_index);
   }
 
+  // Returns whether a complete cache, in either format, exists at `prefix`.
+  bool CacheExists(const string& prefix) const {
+    return env_->FileExists(MetaFilename(prefix)).ok() ||
+           env_->FileExists(ColumnarCache::IndexFilename(prefix)).ok();
+  }
+
+  // The names of the index and of the first data file of a cache written at
+  // `prefix` in the format of this dataset.
+  string CacheIndexFilename(const string& prefix) const {
+    return columnar_ ? ColumnarCache::IndexFilename(prefix)
+                     : MetaFilename(prefix);
+  }
+  string CacheDataFilename(const string& prefix) const {
+    return columnar_ ? ColumnarCache::DataFilename(prefix, 0, 1)
+                     : DataFilename(prefix, 0, 1);
+  }
+
   class FileIterator : public DatasetIterator<FileDataset> {
    public:
     explicit FileIterator(const Params& params)
         : DatasetIterator<FileDataset>(params) {
-      if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
-              .ok()) {
+      if (params.dataset->CacheExists(params.dataset->filename_)) {
         mode_ = Mode::read;
       } else {
         mode_ = Mode::write;
@@ -177,14 +207,12 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         mode_ = static_cast<Mode>(temp);
       }
       if (mode_ == Mode::write &&
-          dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
-              .ok()) {
+          dataset()->CacheExists(dataset()->filename_)) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
             << "It looks like the cache was already completely written("
-            << MetaFilename(dataset()->filename_)
+            << dataset()->filename_
             << ") after the last checkpoint was saved. Attempting to read "
             << "the cache instead of continuing to write. If this is a "
             << "mistake, please remove the above file and try running again.";
@@ -204,7 +232,8 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
     // elements.
     //
     // Caching is performed by writing the input tensors to disk using the
-    // `BundleWriter`. Note that the cache gets fully flushed to disk only
+    // `BundleWriter`, or the `ColumnarCacheWriter` if the dataset uses the
+    // columnar format. Note that the cache gets fully flushed to disk only
     // after the input iterator has been fully exhausted. If the program
     // exits, before completion of an epoch, the cached state would be lost.
     // To ensure that the partial cache persists across sessions, one should
@@ -225,7 +254,9 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
             iteration_completed_(false) {}
 
       ~FileWriterIterator() override {
-        if (!dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        if (!dataset()
+                 ->env_->FileExists(dataset()->CacheIndexFilename(filename_))
+                 .ok()) {
           std::vector<string> cache_files;
           Status s = dataset()->env_->GetMatchingPaths(
               strings::StrCat(filename_, "*"), &cache_files);
@@ -256,8 +287,10 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         if (*end_of_sequence) {
           return Status::OK();
         }
-        TF_RETURN_IF_ERROR(writer_->status());
-        if (cur_index_ >= kMaxItems) {
+        if (!dataset()->columnar_) {
+          TF_RETURN_IF_ERROR(writer_->status());
+        }
+        if (!dataset()->columnar_ && cur_index_ >= kMaxItems) {
           // As a courtesy, close the [truncated] cache file.
           Status s = Finish();
           if (!s.ok()) {
@@ -281,11 +314,15 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
               "Expected ",
               dataset()->num_tensors_, " got: ", out_tensors->size());
         }
-        size_t tensor_index = 0;
-        for (const Tensor& t : *out_tensors) {
-          DCHECK_LT(tensor_index, dataset()->num_tensors_);
-          string key = dataset()->FormatName(cur_index_, tensor_index++);
-          TF_RETURN_IF_ERROR(writer_->Add(key, t));
+        if (dataset()->columnar_) {
+          TF_RETURN_IF_ERROR(columnar_writer_->Add(*out_tensors));
+        } else {
+          size_t tensor_index = 0;
+          for (const Tensor& t : *out_tensors) {
+            DCHECK_LT(tensor_index, dataset()->num_tensors_);
+            string key = dataset()->FormatName(cur_index_, tensor_index++);
+            TF_RETURN_IF_ERROR(writer_->Add(key, t));
+          }
         }
         if (*end_of_sequence) {
           TF_RETURN_IF_ERROR(Finish());
@@ -319,7 +356,7 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         // empty shards.
         if (lockfile_created_) {
           // Flush the current bundle.
-          TF_RETURN_IF_ERROR(writer_->Finish());
+          TF_RETURN_IF_ERROR(FinishWriter());
 
           // Note: We do not delete the lockfile here. We keep lockfiles of
           // all shards around until the entire cache has been written to
@@ -368,11 +405,28 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        CreateWriter();
         return Status::OK();
       }
 
      private:
+      void CreateWriter() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (dataset()->columnar_) {
+          columnar_writer_ = absl::make_unique<ColumnarCacheWriter>(
+              dataset()->env_, filename_, dataset()->output_dtypes(),
+              dataset()->output_shapes());
+        } else {
+          writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        }
+      }
+
+      Status FinishWriter() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (dataset()->columnar_) {
+          return columnar_writer_->Finish();
+        }
+        return writer_->Finish();
+      }
+
       Status EnsureLockFileExists(bool* end_of_sequence)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (iteration_completed_) {
@@ -388,11 +442,12 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
 
         // 1. Check that a checkpoint for the shard has not already been
         // written.
-        if (dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
-          return errors::AlreadyExists("Existing cache files found: \n",
-                                       MetaFilename(filename_), "\n",
-                                       DataFilename(filename_, 0, 1), "\n",
-                                       "To continue delete the above files.");
+        const string index_filename = dataset()->CacheIndexFilename(filename_);
+        if (dataset()->env_->FileExists(index_filename).ok()) {
+          return errors::AlreadyExists(
+              "Existing cache files found: \n", index_filename, "\n",
+              dataset()->CacheDataFilename(filename_), "\n",
+              "To continue delete the above files.");
         }
 
         // 2. Check that there isn't a concurrent iterator that is writing
@@ -430,7 +485,7 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        CreateWriter();
         lockfile_created_ = true;
         return Status::OK();
       }
@@ -438,7 +493,7 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       Status Finish() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         iteration_completed_ = true;
         // Flush the current bundle.
-        TF_RETURN_IF_ERROR(writer_->Finish());
+        TF_RETURN_IF_ERROR(FinishWriter());
         // Merge all the bundles.
         // Currently there are `shard_id_ + 1` bundles, one for each
         // checkpoint. Each bundle has prefix <filename>_<id> where `id` is an
@@ -446,7 +501,16 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         // We merge all these bundles into a bundle with prefix <filename> so
         // that the next call to `MakeIterator` can build a
         // `FileReaderIterator`.
-        {
+        if (dataset()->columnar_) {
+          std::vector<string> prefixes;
+          prefixes.reserve(shard_id_ + 1);
+          for (size_t i = 0; i <= shard_id_; ++i) {
+            prefixes.emplace_back(
+                strings::StrCat(dataset()->filename_, "_", i));
+          }
+          TF_RETURN_IF_ERROR(ColumnarCache::Merge(dataset()->env_, prefixes,
+                                                  dataset()->filename_));
+        } else {
           std::vector<tstring> prefixes;
           prefixes.reserve(shard_id_ + 1);
           for (size_t i = 0; i <= shard_id_; ++i) {
@@ -473,7 +537,10 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       // The current prefix for the cache file. This is equal to
       // `StrCat(dataset()->filename_, "_", shard_id_)`.
       string filename_;
+      // Exactly one of `writer_` and `columnar_writer_` is used, depending on
+      // the format of the dataset.
       std::unique_ptr<BundleWriter> writer_ GUARDED_BY(mu_);
+      std::unique_ptr<ColumnarCacheWriter> columnar_writer_ GUARDED_BY(mu_);
       string lockfile_ GUARDED_BY(mu_);
       bool lockfile_created_ GUARDED_BY(mu_);
       bool iteration_completed_ GUARDED_BY(mu_);
@@ -567,6 +634,59 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       bool iterator_restored_ GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // FileColumnarReaderIterator reads a cache written in the columnar
+    // format. Elements are read from memory-mapped data files, and their
+    // larger components alias the mapped files instead of being copied.
+    class FileColumnarReaderIterator : public DatasetIterator<FileDataset> {
+     public:
+      explicit FileColumnarReaderIterator(const Params& params)
+          : DatasetIterator<FileDataset>(params), cur_index_(0) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        return ColumnarCacheReader::Open(dataset()->env_, dataset()->filename_,
+                                         dataset()->output_dtypes(), &reader_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(reader_->GetNext(out_tensors, end_of_sequence));
+        if (!*end_of_sequence) {
+          cur_index_++;
+        }
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kCurIndex), cur_index_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kCurIndex), &cur_index_));
+        return reader_->Seek(cur_index_);
+      }
+
+     private:
+      mutex mu_;
+      int64 cur_index_ GUARDED_BY(mu_);
+      std::unique_ptr<ColumnarCacheReader> reader_ GUARDED_BY(mu_);
+    };  // FileColumnarReaderIterator
+
     void InitializeIterator() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator`
       // and `FileWriterIterator`. Since at any time there will be at most
@@ -575,9 +695,19 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       // in the corner case when this iterator is restored from an old
       // checkpoint in `write` mode and the cache has been completely
       // flushed to disk since then. In that case we simply build a
-      // `FileReaderIterator` and seek to the `cur_index`.
+      // `FileReaderIterator` and seek to the `cur_index`. The same holds for
+      // `FileColumnarReaderIterator`, which reads caches in the columnar
+      // format.
+      const string columnar_index =
+          ColumnarCache::IndexFilename(dataset()->filename_);
       switch (mode_) {
         case Mode::read:
+          if (dataset()->env_->FileExists(columnar_index).ok()) {
+            iterator_ = absl::make_unique<FileColumnarReaderIterator>(
+                FileColumnarReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+            break;
+          }
           iterator_ =
               absl::make_unique<FileReaderIterator>(FileReaderIterator::Params{
                   dataset(), strings::StrCat(prefix(), kImpl)});
@@ -596,6 +726,8 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
   };  // FileIterator
 
   Env* const env_;
+  // Whether new caches are written in the columnar format.
+  const bool columnar_;
   const size_t num_tensors_;
   const size_t tensor_index_padding_size_;
   static const size_t kMaxItems = 10000000;  // 10 million
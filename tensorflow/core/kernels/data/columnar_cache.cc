@@ -0,0 +1,614 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_cache.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+constexpr uint64 ColumnarCache::kAlignment;
+
+namespace {
+
+constexpr char kIndexSuffix[] = ".cache-index";
+constexpr char kDataSuffix[] = ".cache-data";
+constexpr char kTempSuffix[] = ".tempstate";
+constexpr char kMagic[] = "TFCC";
+constexpr uint64 kVersion = 1;
+// Chunks are flushed once their values take this many bytes.
+constexpr uint64 kTargetChunkBytes = 4 << 20;
+
+uint64 RoundUp(uint64 offset) {
+  return (offset + ColumnarCache::kAlignment - 1) /
+         ColumnarCache::kAlignment * ColumnarCache::kAlignment;
+}
+
+bool IsSupported(DataType dtype) {
+  return dtype == DT_STRING || DataTypeCanUseMemcpy(dtype);
+}
+
+// The number of bytes of a numeric or boolean tensor of shape `shape`.
+uint64 NumBytes(DataType dtype, const TensorShape& shape) {
+  return shape.num_elements() * DataTypeSize(dtype);
+}
+
+// Partial shapes are encoded as their rank plus one (zero for an unknown
+// rank) followed by their dimensions plus one (zero for an unknown
+// dimension).
+void EncodeShape(const PartialTensorShape& shape, string* out) {
+  if (shape.unknown_rank()) {
+    core::PutVarint64(out, 0);
+    return;
+  }
+  core::PutVarint64(out, shape.dims() + 1);
+  for (int i = 0; i < shape.dims(); ++i) {
+    core::PutVarint64(out, shape.dim_size(i) + 1);
+  }
+}
+
+Status DecodeShape(StringPiece* in, PartialTensorShape* shape) {
+  uint64 rank;
+  if (!core::GetVarint64(in, &rank)) {
+    return errors::DataLoss("Truncated shape in columnar cache");
+  }
+  if (rank == 0) {
+    *shape = PartialTensorShape();
+    return Status::OK();
+  }
+  if (rank - 1 > static_cast<uint64>(TensorShape::MaxDimensions())) {
+    return errors::DataLoss("Invalid rank ", rank - 1, " in columnar cache");
+  }
+  std::vector<int64> dims(rank - 1);
+  for (int64& dim : dims) {
+    uint64 value;
+    if (!core::GetVarint64(in, &value)) {
+      return errors::DataLoss("Truncated shape in columnar cache");
+    }
+    dim = static_cast<int64>(value) - 1;
+  }
+  return PartialTensorShape::MakePartialShape(dims.data(), dims.size(), shape);
+}
+
+void PutString(string* out, StringPiece value) {
+  core::PutVarint64(out, value.size());
+  out->append(value.data(), value.size());
+}
+
+bool GetString(StringPiece* in, StringPiece* value) {
+  uint64 size;
+  if (!core::GetVarint64(in, &size) || in->size() < size) return false;
+  *value = StringPiece(in->data(), size);
+  in->remove_prefix(size);
+  return true;
+}
+
+// Aliases part of a memory-mapped data file, which it keeps alive.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(const char* data, size_t size, core::RefCounted* owner)
+      : TensorBuffer(const_cast<char*>(data)), size_(size), owner_(owner) {
+    owner_->Ref();
+  }
+
+  ~MappedTensorBuffer() override { owner_->Unref(); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("ColumnarCache");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  // The memory is read-only, so it must never be forwarded to an output.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  core::RefCounted* const owner_;
+};
+
+}  // namespace
+
+struct ColumnarCacheIndex {
+  struct Chunk {
+    uint64 file = 0;
+    uint64 offset = 0;
+    uint64 num_elements = 0;
+    // The size of each column, including the padding to `kAlignment`.
+    std::vector<uint64> column_sizes;
+    // The shapes of the components whose shape is not fully defined, for each
+    // element in turn.
+    string shapes;
+  };
+
+  DataTypeVector dtypes;
+  std::vector<PartialTensorShape> shapes;
+  // The names of the data files, relative to the directory of the index.
+  std::vector<string> files;
+  std::vector<Chunk> chunks;
+
+  string Encode() const;
+  Status Decode(StringPiece data);
+  Status Write(Env* env, const string& prefix) const;
+  Status Read(Env* env, const string& prefix);
+};
+
+string ColumnarCacheIndex::Encode() const {
+  string out = kMagic;
+  core::PutVarint64(&out, kVersion);
+  core::PutVarint64(&out, dtypes.size());
+  for (size_t i = 0; i < dtypes.size(); ++i) {
+    core::PutVarint64(&out, dtypes[i]);
+    EncodeShape(shapes[i], &out);
+  }
+  core::PutVarint64(&out, files.size());
+  for (const string& file : files) {
+    PutString(&out, file);
+  }
+  core::PutVarint64(&out, chunks.size());
+  for (const Chunk& chunk : chunks) {
+    core::PutVarint64(&out, chunk.file);
+    core::PutVarint64(&out, chunk.offset);
+    core::PutVarint64(&out, chunk.num_elements);
+    for (uint64 size : chunk.column_sizes) {
+      core::PutVarint64(&out, size);
+    }
+    PutString(&out, chunk.shapes);
+  }
+  core::PutFixed32(&out, crc32c::Mask(crc32c::Value(out.data(), out.size())));
+  return out;
+}
+
+Status ColumnarCacheIndex::Decode(StringPiece data) {
+  const size_t kMagicSize = sizeof(kMagic) - 1;
+  if (data.size() < kMagicSize + sizeof(uint32) ||
+      !str_util::StartsWith(data, kMagic)) {
+    return errors::DataLoss("Not a columnar cache index");
+  }
+  const size_t body_size = data.size() - sizeof(uint32);
+  if (crc32c::Unmask(core::DecodeFixed32(data.data() + body_size)) !=
+      crc32c::Value(data.data(), body_size)) {
+    return errors::DataLoss("Checksum mismatch in columnar cache index");
+  }
+  StringPiece in(data.data() + kMagicSize, body_size - kMagicSize);
+  const Status truncated =
+      errors::DataLoss("Truncated columnar cache index");
+  uint64 version;
+  if (!core::GetVarint64(&in, &version)) return truncated;
+  if (version != kVersion) {
+    return errors::Unimplemented("Unsupported columnar cache version ",
+                                 version);
+  }
+  uint64 num_components;
+  if (!core::GetVarint64(&in, &num_components)) return truncated;
+  dtypes.resize(num_components);
+  shapes.resize(num_components);
+  for (size_t i = 0; i < num_components; ++i) {
+    uint64 dtype;
+    if (!core::GetVarint64(&in, &dtype)) return truncated;
+    dtypes[i] = static_cast<DataType>(dtype);
+    TF_RETURN_IF_ERROR(DecodeShape(&in, &shapes[i]));
+  }
+  uint64 num_files;
+  if (!core::GetVarint64(&in, &num_files)) return truncated;
+  files.resize(num_files);
+  for (string& file : files) {
+    StringPiece name;
+    if (!GetString(&in, &name)) return truncated;
+    file = string(name);
+  }
+  uint64 num_chunks;
+  if (!core::GetVarint64(&in, &num_chunks)) return truncated;
+  chunks.resize(num_chunks);
+  for (Chunk& chunk : chunks) {
+    if (!core::GetVarint64(&in, &chunk.file) ||
+        !core::GetVarint64(&in, &chunk.offset) ||
+        !core::GetVarint64(&in, &chunk.num_elements)) {
+      return truncated;
+    }
+    if (chunk.file >= num_files) {
+      return errors::DataLoss("Invalid file in columnar cache index");
+    }
+    chunk.column_sizes.resize(num_components);
+    for (uint64& size : chunk.column_sizes) {
+      if (!core::GetVarint64(&in, &size)) return truncated;
+    }
+    StringPiece chunk_shapes;
+    if (!GetString(&in, &chunk_shapes)) return truncated;
+    chunk.shapes = string(chunk_shapes);
+  }
+  if (!in.empty()) {
+    return errors::DataLoss("Trailing data in columnar cache index");
+  }
+  return Status::OK();
+}
+
+Status ColumnarCacheIndex::Write(Env* env, const string& prefix) const {
+  // Write the index under a temporary name first, so that a partially written
+  // index is never mistaken for a complete cache.
+  const string filename = ColumnarCache::IndexFilename(prefix);
+  const string tmp_filename = strings::StrCat(filename, kTempSuffix);
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, Encode()));
+  return env->RenameFile(tmp_filename, filename);
+}
+
+Status ColumnarCacheIndex::Read(Env* env, const string& prefix) {
+  string data;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(env, ColumnarCache::IndexFilename(prefix), &data));
+  return Decode(data);
+}
+
+string ColumnarCache::IndexFilename(StringPiece prefix) {
+  return strings::StrCat(prefix, kIndexSuffix);
+}
+
+string ColumnarCache::DataFilename(StringPiece prefix, int64 shard_id,
+                                   int64 num_shards) {
+  return strings::Printf("%s%s-%05lld-of-%05lld",
+                         string(prefix).c_str(), kDataSuffix,
+                         static_cast<long long>(shard_id),
+                         static_cast<long long>(num_shards));
+}
+
+Status ColumnarCache::Merge(Env* env, const std::vector<string>& shard_prefixes,
+                            const string& prefix) {
+  const StringPiece directory = io::Dirname(prefix);
+  std::vector<ColumnarCacheIndex> shards(shard_prefixes.size());
+  size_t num_files = 0;
+  for (size_t i = 0; i < shards.size(); ++i) {
+    if (io::Dirname(shard_prefixes[i]) != directory) {
+      return errors::InvalidArgument("Cannot merge ", shard_prefixes[i],
+                                     " into a cache in another directory: ",
+                                     prefix);
+    }
+    TF_RETURN_IF_ERROR(shards[i].Read(env, shard_prefixes[i]));
+    if (shards[i].dtypes != shards[0].dtypes) {
+      return errors::InvalidArgument(
+          "Cannot merge columnar caches with different types: ",
+          DataTypeVectorString(shards[0].dtypes), " and ",
+          DataTypeVectorString(shards[i].dtypes));
+    }
+    num_files += shards[i].files.size();
+  }
+
+  ColumnarCacheIndex merged;
+  if (!shards.empty()) {
+    merged.dtypes = shards[0].dtypes;
+    merged.shapes = shards[0].shapes;
+  }
+  for (ColumnarCacheIndex& shard : shards) {
+    const uint64 first_file = merged.files.size();
+    for (const string& file : shard.files) {
+      const string name = io::Basename(ColumnarCache::DataFilename(
+          prefix, merged.files.size(), num_files));
+      TF_RETURN_IF_ERROR(env->RenameFile(io::JoinPath(directory, file),
+                                         io::JoinPath(directory, name)));
+      merged.files.push_back(name);
+    }
+    for (ColumnarCacheIndex::Chunk& chunk : shard.chunks) {
+      chunk.file += first_file;
+      merged.chunks.push_back(std::move(chunk));
+    }
+  }
+  TF_RETURN_IF_ERROR(merged.Write(env, prefix));
+  for (const string& shard_prefix : shard_prefixes) {
+    TF_RETURN_IF_ERROR(env->DeleteFile(IndexFilename(shard_prefix)));
+  }
+  return Status::OK();
+}
+
+ColumnarCacheWriter::ColumnarCacheWriter(
+    Env* env, const string& prefix, const DataTypeVector& dtypes,
+    const std::vector<PartialTensorShape>& shapes)
+    : env_(env),
+      prefix_(prefix),
+      index_(new ColumnarCacheIndex),
+      columns_(dtypes.size()) {
+  index_->dtypes = dtypes;
+  index_->shapes = shapes;
+}
+
+ColumnarCacheWriter::~ColumnarCacheWriter() {}
+
+Status ColumnarCacheWriter::Add(const std::vector<Tensor>& element) {
+  if (finished_) {
+    return errors::FailedPrecondition("Columnar cache ", prefix_,
+                                      " is already finished");
+  }
+  if (element.size() != index_->dtypes.size()) {
+    return errors::InvalidArgument("Expected an element with ",
+                                   index_->dtypes.size(),
+                                   " components, got ", element.size());
+  }
+  for (size_t i = 0; i < element.size(); ++i) {
+    const Tensor& t = element[i];
+    if (t.dtype() != index_->dtypes[i]) {
+      return errors::InvalidArgument(
+          "Component ", i, " has type ", DataTypeString(t.dtype()),
+          ", expected ", DataTypeString(index_->dtypes[i]));
+    }
+    if (!IsSupported(t.dtype())) {
+      return errors::Unimplemented("Columnar caches do not support type ",
+                                   DataTypeString(t.dtype()));
+    }
+    const PartialTensorShape& expected = index_->shapes[i];
+    if (!expected.IsCompatibleWith(t.shape())) {
+      return errors::InvalidArgument(
+          "Component ", i, " has shape ", t.shape().DebugString(),
+          ", expected ", expected.DebugString());
+    }
+  }
+  for (size_t i = 0; i < element.size(); ++i) {
+    const Tensor& t = element[i];
+    if (!index_->shapes[i].IsFullyDefined()) {
+      EncodeShape(t.shape(), &chunk_shapes_);
+    }
+    string* column = &columns_[i];
+    const uint64 column_size = column->size();
+    if (t.dtype() == DT_STRING) {
+      for (const tstring& value : t.flat<tstring>()) {
+        PutString(column, StringPiece(value.data(), value.size()));
+      }
+    } else {
+      const StringPiece data = t.tensor_data();
+      if (data.size() >= ColumnarCache::kAlignment) {
+        column->resize(RoundUp(column->size()), '\0');
+      }
+      column->append(data.data(), data.size());
+    }
+    chunk_bytes_ += column->size() - column_size;
+  }
+  ++chunk_elements_;
+  if (chunk_bytes_ >= kTargetChunkBytes) {
+    TF_RETURN_IF_ERROR(FlushChunk());
+  }
+  return Status::OK();
+}
+
+Status ColumnarCacheWriter::FlushChunk() {
+  if (chunk_elements_ == 0) return Status::OK();
+  if (!data_file_) {
+    const string filename = ColumnarCache::DataFilename(prefix_, 0, 1);
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(filename, &data_file_));
+    index_->files.push_back(string(io::Basename(filename)));
+  }
+  ColumnarCacheIndex::Chunk chunk;
+  chunk.file = 0;
+  chunk.offset = data_file_size_;
+  chunk.num_elements = chunk_elements_;
+  chunk.column_sizes.reserve(columns_.size());
+  for (string& column : columns_) {
+    // Pad each column so that the next one starts at an aligned offset.
+    column.resize(RoundUp(column.size()), '\0');
+    TF_RETURN_IF_ERROR(data_file_->Append(column));
+    data_file_size_ += column.size();
+    chunk.column_sizes.push_back(column.size());
+    column.clear();
+  }
+  chunk.shapes.swap(chunk_shapes_);
+  chunk_shapes_.clear();
+  index_->chunks.push_back(std::move(chunk));
+  chunk_elements_ = 0;
+  chunk_bytes_ = 0;
+  return Status::OK();
+}
+
+Status ColumnarCacheWriter::Finish() {
+  if (finished_) return Status::OK();
+  finished_ = true;
+  TF_RETURN_IF_ERROR(FlushChunk());
+  if (data_file_) {
+    TF_RETURN_IF_ERROR(data_file_->Close());
+    data_file_.reset();
+  }
+  return index_->Write(env_, prefix_);
+}
+
+class ColumnarCacheReader::MappedFile : public core::RefCounted {
+ public:
+  explicit MappedFile(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  const char* data() const {
+    return static_cast<const char*>(region_->data());
+  }
+  uint64 length() const { return region_->length(); }
+
+ private:
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+ColumnarCacheReader::ColumnarCacheReader(
+    Env* env, string directory, std::unique_ptr<ColumnarCacheIndex> index)
+    : env_(env),
+      directory_(std::move(directory)),
+      index_(std::move(index)),
+      mapped_files_(index_->files.size(), nullptr),
+      column_positions_(index_->dtypes.size()),
+      column_limits_(index_->dtypes.size()) {
+  chunk_starts_.reserve(index_->chunks.size());
+  for (const ColumnarCacheIndex::Chunk& chunk : index_->chunks) {
+    chunk_starts_.push_back(num_elements_);
+    num_elements_ += chunk.num_elements;
+  }
+  chunk_ = index_->chunks.size();
+}
+
+ColumnarCacheReader::~ColumnarCacheReader() {
+  for (MappedFile* file : mapped_files_) {
+    if (file != nullptr) file->Unref();
+  }
+}
+
+Status ColumnarCacheReader::Open(Env* env, const string& prefix,
+                                 const DataTypeVector& dtypes,
+                                 std::unique_ptr<ColumnarCacheReader>* reader) {
+  std::unique_ptr<ColumnarCacheIndex> index(new ColumnarCacheIndex);
+  TF_RETURN_IF_ERROR(index->Read(env, prefix));
+  if (index->dtypes != dtypes) {
+    return errors::InvalidArgument(
+        "Columnar cache ", prefix, " has types ",
+        DataTypeVectorString(index->dtypes), ", expected ",
+        DataTypeVectorString(dtypes));
+  }
+  reader->reset(new ColumnarCacheReader(env, string(io::Dirname(prefix)),
+                                        std::move(index)));
+  return (*reader)->Seek(0);
+}
+
+Status ColumnarCacheReader::Seek(int64 index) {
+  if (index < 0 || index > num_elements_) {
+    return errors::OutOfRange("Cannot seek to element ", index,
+                              " of a columnar cache with ", num_elements_,
+                              " elements");
+  }
+  if (index == num_elements_) {
+    chunk_ = index_->chunks.size();
+    return Status::OK();
+  }
+  const size_t chunk =
+      std::upper_bound(chunk_starts_.begin(), chunk_starts_.end(), index) -
+      chunk_starts_.begin() - 1;
+  TF_RETURN_IF_ERROR(LoadChunk(chunk));
+  for (int64 i = chunk_starts_[chunk]; i < index; ++i) {
+    TF_RETURN_IF_ERROR(ReadElement(nullptr));
+  }
+  return Status::OK();
+}
+
+Status ColumnarCacheReader::GetNext(std::vector<Tensor>* element,
+                                    bool* end_of_sequence) {
+  while (chunk_ < index_->chunks.size() &&
+         element_in_chunk_ == index_->chunks[chunk_].num_elements) {
+    if (chunk_ + 1 == index_->chunks.size()) {
+      chunk_ = index_->chunks.size();
+    } else {
+      TF_RETURN_IF_ERROR(LoadChunk(chunk_ + 1));
+    }
+  }
+  if (chunk_ == index_->chunks.size()) {
+    *end_of_sequence = true;
+    return Status::OK();
+  }
+  *end_of_sequence = false;
+  element->clear();
+  element->reserve(index_->dtypes.size());
+  return ReadElement(element);
+}
+
+Status ColumnarCacheReader::LoadChunk(size_t chunk) {
+  const ColumnarCacheIndex::Chunk& c = index_->chunks[chunk];
+  if (mapped_files_[c.file] == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    TF_RETURN_IF_ERROR(env_->NewReadOnlyMemoryRegionFromFile(
+        io::JoinPath(directory_, index_->files[c.file]), &region));
+    mapped_files_[c.file] = new MappedFile(std::move(region));
+  }
+  uint64 offset = c.offset;
+  for (size_t i = 0; i < c.column_sizes.size(); ++i) {
+    column_positions_[i] = offset;
+    offset += c.column_sizes[i];
+    column_limits_[i] = offset;
+  }
+  if (offset > mapped_files_[c.file]->length()) {
+    return errors::DataLoss("Chunk ", chunk, " of columnar cache ends at ",
+                            offset, " past the end of ",
+                            index_->files[c.file]);
+  }
+  chunk_ = chunk;
+  element_in_chunk_ = 0;
+  chunk_shapes_ = c.shapes;
+  return Status::OK();
+}
+
+Status ColumnarCacheReader::ReadShape(size_t component, TensorShape* shape) {
+  const PartialTensorShape& static_shape = index_->shapes[component];
+  if (static_shape.AsTensorShape(shape)) return Status::OK();
+  PartialTensorShape partial_shape;
+  TF_RETURN_IF_ERROR(DecodeShape(&chunk_shapes_, &partial_shape));
+  if (!partial_shape.AsTensorShape(shape)) {
+    return errors::DataLoss("Invalid shape ", partial_shape.DebugString(),
+                            " in columnar cache");
+  }
+  return Status::OK();
+}
+
+Status ColumnarCacheReader::ReadElement(std::vector<Tensor>* element) {
+  MappedFile* file = mapped_files_[index_->chunks[chunk_].file];
+  for (size_t i = 0; i < index_->dtypes.size(); ++i) {
+    const DataType dtype = index_->dtypes[i];
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(ReadShape(i, &shape));
+    uint64& position = column_positions_[i];
+    const uint64 limit = column_limits_[i];
+    if (dtype == DT_STRING) {
+      StringPiece in(file->data() + position, limit - position);
+      const size_t size = in.size();
+      Tensor t;
+      if (element != nullptr) t = Tensor(DT_STRING, shape);
+      for (int64 j = 0; j < shape.num_elements(); ++j) {
+        StringPiece value;
+        if (!GetString(&in, &value)) {
+          return errors::DataLoss("Truncated string in columnar cache");
+        }
+        if (element != nullptr) {
+          t.flat<tstring>()(j).assign(value.data(), value.size());
+        }
+      }
+      position += size - in.size();
+      if (element != nullptr) element->push_back(std::move(t));
+      continue;
+    }
+    const uint64 num_bytes = NumBytes(dtype, shape);
+    if (num_bytes >= ColumnarCache::kAlignment) {
+      position = RoundUp(position);
+    }
+    if (position + num_bytes > limit) {
+      return errors::DataLoss("Truncated value in columnar cache");
+    }
+    if (element != nullptr) {
+      const char* data = file->data() + position;
+      if (num_bytes >= ColumnarCache::kAlignment) {
+        MappedTensorBuffer* buffer =
+            new MappedTensorBuffer(data, num_bytes, file);
+        element->emplace_back(dtype, shape, buffer);
+        buffer->Unref();
+      } else {
+        Tensor t(dtype, shape);
+        std::copy_n(data, num_bytes, const_cast<char*>(t.tensor_data().data()));
+        element->push_back(std::move(t));
+      }
+    }
+    position += num_bytes;
+  }
+  ++element_in_chunk_;
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,162 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+struct ColumnarCacheIndex;
+
+// A file format for the elements cached by `CacheDataset`, as an alternative
+// to a tensor bundle with one key per component of each element.
+//
+// Elements are grouped into chunks of a few megabytes. Within a chunk, the
+// values of each component are stored contiguously (one column per
+// component), and values of at least `kAlignment` bytes start at aligned
+// offsets so that they can be read in place from a memory-mapped file. The
+// index records, for each chunk, its location and the shapes of the
+// components whose shape is not fully defined; the offsets of the values are
+// implied by their shapes, so the index is a few bytes per chunk for
+// elements of static shape.
+//
+// A cache with prefix `P` consists of the index `P.cache-index` and the data
+// files named in the index, `P.cache-data-?????-of-?????`. Caches written in
+// several shards, for example across checkpoints, are combined with `Merge()`
+// without copying their data.
+struct ColumnarCache {
+  static constexpr uint64 kAlignment = 64;
+
+  static string IndexFilename(StringPiece prefix);
+  static string DataFilename(StringPiece prefix, int64 shard_id,
+                             int64 num_shards);
+
+  // Writes an index with prefix `prefix` that refers to the data of all the
+  // caches in `shard_prefixes`, in order. Their data files are renamed to data
+  // files of `prefix` and their indices are deleted. All the caches must be in
+  // the directory of `prefix`.
+  static Status Merge(Env* env, const std::vector<string>& shard_prefixes,
+                      const string& prefix);
+};
+
+// Writes a columnar cache. Not thread-safe.
+class ColumnarCacheWriter {
+ public:
+  ColumnarCacheWriter(Env* env, const string& prefix,
+                      const DataTypeVector& dtypes,
+                      const std::vector<PartialTensorShape>& shapes);
+  ~ColumnarCacheWriter();
+
+  // Appends an element to the cache. Numeric, boolean and string components
+  // are supported. The components must match the types and shapes given to
+  // the constructor.
+  Status Add(const std::vector<Tensor>& element);
+
+  // Writes the remaining elements and the index. No elements can be added
+  // afterwards.
+  Status Finish();
+
+ private:
+  Status FlushChunk();
+
+  Env* const env_;
+  const string prefix_;
+  std::unique_ptr<ColumnarCacheIndex> index_;
+  std::unique_ptr<WritableFile> data_file_;
+  uint64 data_file_size_ = 0;
+  // The chunk being filled: its values, one string per component, and the
+  // shapes of its components whose shape is not fully defined.
+  std::vector<string> columns_;
+  string chunk_shapes_;
+  uint64 chunk_elements_ = 0;
+  uint64 chunk_bytes_ = 0;
+  bool finished_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnarCacheWriter);
+};
+
+// Reads a columnar cache. Tensors of at least `ColumnarCache::kAlignment`
+// bytes alias the memory-mapped data files instead of being copied. Not
+// thread-safe.
+class ColumnarCacheReader {
+ public:
+  ~ColumnarCacheReader();
+
+  // Opens the cache with prefix `prefix`, whose components must have the
+  // given types.
+  static Status Open(Env* env, const string& prefix,
+                     const DataTypeVector& dtypes,
+                     std::unique_ptr<ColumnarCacheReader>* reader);
+
+  int64 num_elements() const { return num_elements_; }
+
+  // Positions the reader before the element at `index`.
+  Status Seek(int64 index);
+
+  // Reads the next element, or sets `*end_of_sequence` after the last one.
+  Status GetNext(std::vector<Tensor>* element, bool* end_of_sequence);
+
+ private:
+  class MappedFile;
+
+  ColumnarCacheReader(Env* env, string directory,
+                      std::unique_ptr<ColumnarCacheIndex> index);
+
+  // Positions the reader at the start of chunk `chunk`.
+  Status LoadChunk(size_t chunk);
+  // Reads the element at the current position, or skips it if `element` is
+  // null.
+  Status ReadElement(std::vector<Tensor>* element);
+  // Reads the shape of component `component` of the current element.
+  Status ReadShape(size_t component, TensorShape* shape);
+
+  Env* const env_;
+  const string directory_;
+  const std::unique_ptr<ColumnarCacheIndex> index_;
+  // `chunk_starts_[i]` is the index of the first element of chunk `i`.
+  std::vector<int64> chunk_starts_;
+  int64 num_elements_ = 0;
+  // The mapped data files, indexed like the files of the index, or null for
+  // files that have not been mapped yet.
+  std::vector<MappedFile*> mapped_files_;
+
+  // The position of the reader: the current chunk, the number of its elements
+  // read so far, the shapes of its remaining elements, and for each component
+  // the file offset of its next value and the end of its column.
+  size_t chunk_ = 0;
+  uint64 element_in_chunk_ = 0;
+  StringPiece chunk_shapes_;
+  std::vector<uint64> column_positions_;
+  std::vector<uint64> column_limits_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnarCacheReader);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_CACHE_H_
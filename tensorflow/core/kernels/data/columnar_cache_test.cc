@@ -0,0 +1,197 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Elements with a large float vector of static shape, a small int64 vector of
+// dynamic shape and a string scalar.
+const DataTypeVector& Dtypes() {
+  static const DataTypeVector* dtypes =
+      new DataTypeVector({DT_FLOAT, DT_INT64, DT_STRING});
+  return *dtypes;
+}
+
+std::vector<PartialTensorShape> Shapes(int64 num_floats) {
+  return {PartialTensorShape({num_floats}), PartialTensorShape({-1}),
+          PartialTensorShape({})};
+}
+
+std::vector<Tensor> MakeElement(int64 i, int64 num_floats) {
+  Tensor floats(DT_FLOAT, TensorShape({num_floats}));
+  floats.flat<float>().setConstant(i);
+  Tensor ints(DT_INT64, TensorShape({i % 4}));
+  ints.flat<int64>().setConstant(i);
+  Tensor str(DT_STRING, TensorShape({}));
+  str.scalar<tstring>()() = strings::StrCat("element ", i);
+  return {floats, ints, str};
+}
+
+Status WriteCache(const string& prefix, int64 begin, int64 end,
+                  int64 num_floats) {
+  ColumnarCacheWriter writer(Env::Default(), prefix, Dtypes(),
+                             Shapes(num_floats));
+  for (int64 i = begin; i < end; ++i) {
+    TF_RETURN_IF_ERROR(writer.Add(MakeElement(i, num_floats)));
+  }
+  return writer.Finish();
+}
+
+void ExpectElements(ColumnarCacheReader* reader, int64 begin, int64 end,
+                    int64 num_floats) {
+  for (int64 i = begin; i < end; ++i) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = true;
+    TF_ASSERT_OK(reader->GetNext(&element, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    std::vector<Tensor> expected = MakeElement(i, num_floats);
+    ASSERT_EQ(element.size(), expected.size());
+    test::ExpectTensorEqual<float>(element[0], expected[0]);
+    test::ExpectTensorEqual<int64>(element[1], expected[1]);
+    test::ExpectTensorEqual<tstring>(element[2], expected[2]);
+  }
+}
+
+TEST(ColumnarCacheTest, RoundTrip) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "round_trip");
+  // 256KiB per element, so that the elements span several chunks.
+  const int64 kNumFloats = 64 << 10;
+  TF_ASSERT_OK(WriteCache(prefix, 0, 40, kNumFloats));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  TF_ASSERT_OK(
+      ColumnarCacheReader::Open(Env::Default(), prefix, Dtypes(), &reader));
+  EXPECT_EQ(reader->num_elements(), 40);
+  ExpectElements(reader.get(), 0, 40, kNumFloats);
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(reader->GetNext(&element, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+TEST(ColumnarCacheTest, LargeValuesAliasAlignedMemory) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "aligned");
+  TF_ASSERT_OK(WriteCache(prefix, 0, 10, 100));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  TF_ASSERT_OK(
+      ColumnarCacheReader::Open(Env::Default(), prefix, Dtypes(), &reader));
+  std::vector<std::vector<Tensor>> elements(10);
+  for (auto& element : elements) {
+    bool end_of_sequence;
+    TF_ASSERT_OK(reader->GetNext(&element, &end_of_sequence));
+  }
+  // The tensors remain valid after the reader is destroyed.
+  reader.reset();
+  for (size_t i = 0; i < elements.size(); ++i) {
+    const Tensor& floats = elements[i][0];
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(floats.tensor_data().data()) %
+                  ColumnarCache::kAlignment,
+              0);
+    EXPECT_TRUE(floats.IsAligned());
+    EXPECT_EQ(floats.flat<float>()(99), i);
+  }
+}
+
+TEST(ColumnarCacheTest, Seek) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "seek");
+  const int64 kNumFloats = 64 << 10;
+  TF_ASSERT_OK(WriteCache(prefix, 0, 40, kNumFloats));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  TF_ASSERT_OK(
+      ColumnarCacheReader::Open(Env::Default(), prefix, Dtypes(), &reader));
+  for (int64 index : {37, 3, 16, 0}) {
+    TF_ASSERT_OK(reader->Seek(index));
+    ExpectElements(reader.get(), index, std::min<int64>(index + 3, 40),
+                   kNumFloats);
+  }
+  TF_ASSERT_OK(reader->Seek(40));
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(reader->GetNext(&element, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Seek(41)));
+}
+
+TEST(ColumnarCacheTest, Merge) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "merged");
+  std::vector<string> shard_prefixes;
+  for (int i = 0; i < 3; ++i) {
+    shard_prefixes.push_back(strings::StrCat(prefix, "_", i));
+    TF_ASSERT_OK(WriteCache(shard_prefixes.back(), 10 * i, 10 * (i + 1), 100));
+  }
+  TF_ASSERT_OK(ColumnarCache::Merge(Env::Default(), shard_prefixes, prefix));
+  for (const string& shard_prefix : shard_prefixes) {
+    EXPECT_FALSE(Env::Default()
+                     ->FileExists(ColumnarCache::IndexFilename(shard_prefix))
+                     .ok());
+  }
+  TF_EXPECT_OK(
+      Env::Default()->FileExists(ColumnarCache::DataFilename(prefix, 2, 3)));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  TF_ASSERT_OK(
+      ColumnarCacheReader::Open(Env::Default(), prefix, Dtypes(), &reader));
+  EXPECT_EQ(reader->num_elements(), 30);
+  ExpectElements(reader.get(), 0, 30, 100);
+}
+
+TEST(ColumnarCacheTest, EmptyCache) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "empty");
+  TF_ASSERT_OK(WriteCache(prefix, 0, 0, 100));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  TF_ASSERT_OK(
+      ColumnarCacheReader::Open(Env::Default(), prefix, Dtypes(), &reader));
+  EXPECT_EQ(reader->num_elements(), 0);
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(reader->GetNext(&element, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+TEST(ColumnarCacheTest, InvalidElements) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "invalid");
+  ColumnarCacheWriter writer(Env::Default(), prefix, Dtypes(), Shapes(100));
+  std::vector<Tensor> element = MakeElement(0, 99);
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.Add(element)));
+  element = MakeElement(0, 100);
+  element.pop_back();
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.Add(element)));
+  element.push_back(Tensor(DT_INT32, TensorShape({})));
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.Add(element)));
+}
+
+TEST(ColumnarCacheTest, WrongTypes) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "wrong_types");
+  TF_ASSERT_OK(WriteCache(prefix, 0, 1, 100));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  EXPECT_TRUE(errors::IsInvalidArgument(ColumnarCacheReader::Open(
+      Env::Default(), prefix, {DT_FLOAT, DT_INT32, DT_STRING}, &reader)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,433 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in global_shuffle_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kNumParallelCalls;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kReshuffleEachIteration;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputShapes;
+
+constexpr int IndexPermutation::kNumRounds;
+
+namespace {
+
+constexpr char kTFData[] = "tf_data";
+constexpr char kTFDataGlobalShuffleWorkerPool[] =
+    "tf_data_global_shuffle_worker_pool";
+constexpr char kRandomSeedGenerator[] = "RandomSeedGenerator";
+constexpr char kNextIndex[] = "next_index";
+constexpr char kDSNumRandomSamples[] = "ds_num_random_samples";
+
+// The finalizer of MurmurHash3, used as the Feistel round function.
+uint64 Mix(uint64 x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+}  // namespace
+
+IndexPermutation::IndexPermutation(int64 n, int64 seed, int64 seed2)
+    : n_(n) {
+  while (half_bits_ < 32 && (uint64{1} << (2 * half_bits_)) < n_) {
+    ++half_bits_;
+  }
+  half_mask_ = (uint64{1} << half_bits_) - 1;
+  random::PhiloxRandom generator(seed, seed2);
+  random::SingleSampleAdapter<random::PhiloxRandom> sampler(&generator);
+  for (uint64& key : keys_) {
+    const uint64 high = sampler();
+    const uint64 low = sampler();
+    key = (high << 32) | low;
+  }
+}
+
+uint64 IndexPermutation::Encrypt(uint64 value) const {
+  uint64 left = value >> half_bits_;
+  uint64 right = value & half_mask_;
+  for (uint64 key : keys_) {
+    const uint64 next_right = left ^ (Mix(right ^ key) & half_mask_);
+    left = right;
+    right = next_right;
+  }
+  return (left << half_bits_) | right;
+}
+
+int64 IndexPermutation::operator()(int64 index) const {
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, n_);
+  uint64 value = Encrypt(index);
+  while (value >= n_) {
+    value = Encrypt(value);
+  }
+  return value;
+}
+
+class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 seed,
+          int64 seed2, int64 num_parallel_calls, bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        seed_(seed),
+        seed2_(seed2),
+        num_parallel_calls_(num_parallel_calls),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(seed_, seed2_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* seed = nullptr;
+    Node* seed2 = nullptr;
+    Node* num_parallel_calls = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+    TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+    TF_RETURN_IF_ERROR(b->AddScalar(num_parallel_calls_, &num_parallel_calls));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, seed, seed2, num_parallel_calls},
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  // Produces the input elements in the order of an `IndexPermutation` of their
+  // positions. The only state is the position in the permutation, so the
+  // memory used does not depend on the size of the input. Elements are
+  // fetched from the input `num_parallel_calls` at a time.
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~Iterator() override {
+      if (seed_generator_) {
+        seed_generator_->Unref();
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      num_parallel_calls_ = dataset()->num_parallel_calls_;
+      if (num_parallel_calls_ == model::kAutotune) {
+        num_parallel_calls_ = ctx->runner_threadpool_size();
+      }
+      // The elements are fetched on a dedicated thread pool rather than with
+      // `ctx->runner()`, whose threads may be the ones waiting for them.
+      thread_pool_ = ctx->CreateThreadPool(kTFDataGlobalShuffleWorkerPool,
+                                           num_parallel_calls_);
+      int64 seed = dataset()->seed_;
+      int64 seed2 = dataset()->seed2_;
+      if (dataset()->reshuffle_each_iteration_) {
+        // As in `ShuffleDataset`, successive iterators draw their seeds from a
+        // `RandomSeedGenerator` seeded with the dataset's seeds.
+        const string name = strings::StrCat(
+            prefix(), name_utils::kDelimiter, dataset()->type_string(),
+            name_utils::kDelimiter, kRandomSeedGenerator);
+        const int64 dataset_seed = seed;
+        const int64 dataset_seed2 = seed2;
+        TF_RETURN_IF_ERROR(
+            ctx->resource_mgr()->LookupOrCreate<RandomSeedGenerator>(
+                kTFData, name, &seed_generator_,
+                [dataset_seed,
+                 dataset_seed2](RandomSeedGenerator** seed_generator) {
+                  *seed_generator =
+                      new RandomSeedGenerator(dataset_seed, dataset_seed2);
+                  return Status::OK();
+                }));
+        seed_generator_->GenerateRandomSeeds(&seed, &seed2);
+      }
+      mutex_lock l(mu_);
+      seed_ = seed;
+      seed2_ = seed2;
+      ResetPermutation();
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<int64> indices;
+      {
+        mutex_lock l(mu_);
+        // Only one caller fetches at a time, and the others wait for the
+        // elements it fetches.
+        while (buffer_.empty() && fetching_) {
+          cond_var_.wait(l);
+        }
+        if (!buffer_.empty()) {
+          *out_tensors = std::move(buffer_.front());
+          buffer_.pop_front();
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        if (!pending_status_.ok()) {
+          Status s = pending_status_;
+          pending_status_ = Status::OK();
+          return s;
+        }
+        if (next_index_ >= dataset()->Cardinality()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        const int64 num_elements = std::min<int64>(
+            num_parallel_calls_, dataset()->Cardinality() - next_index_);
+        indices.reserve(num_elements);
+        for (int64 i = 0; i < num_elements; ++i) {
+          indices.push_back((*permutation_)(next_index_ + i));
+        }
+        fetching_ = true;
+      }
+
+      // `mu_` is not held while fetching, so that saving the iterator or
+      // other callers do not wait for the input.
+      std::vector<std::vector<Tensor>> elements;
+      std::vector<Status> statuses;
+      FetchElements(ctx, indices, &elements, &statuses);
+
+      mutex_lock l(mu_);
+      fetching_ = false;
+      cond_var_.notify_all();
+      BufferElements(&elements, statuses);
+      if (buffer_.empty()) {
+        Status s = pending_status_;
+        pending_status_ = Status::OK();
+        return s;
+      }
+      *out_tensors = std::move(buffer_.front());
+      buffer_.pop_front();
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (seed_generator_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kDSNumRandomSamples),
+                                seed_generator_->num_random_samples()));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed2), seed2_));
+      // Elements that were fetched but not yet produced (including one that
+      // failed to be fetched) are fetched again after restoring.
+      const int64 next_index = next_index_ - buffer_.size() -
+                               (pending_status_.ok() ? 0 : 1);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNextIndex), next_index));
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (seed_generator_) {
+        int64 num_random_samples;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kDSNumRandomSamples),
+                                              &num_random_samples));
+        seed_generator_->set_num_random_samples(num_random_samples);
+        seed_generator_->Reset();
+      }
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed2), &seed2_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextIndex), &next_index_));
+      ResetPermutation();
+      buffer_.clear();
+      pending_status_ = Status::OK();
+      return Status::OK();
+    }
+
+   private:
+    void ResetPermutation() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      permutation_ = absl::make_unique<IndexPermutation>(
+          dataset()->Cardinality(), seed_, seed2_);
+    }
+
+    // Fetches the input elements at `indices` in parallel on `thread_pool_`.
+    void FetchElements(IteratorContext* ctx, const std::vector<int64>& indices,
+                       std::vector<std::vector<Tensor>>* elements,
+                       std::vector<Status>* statuses) LOCKS_EXCLUDED(mu_) {
+      const int64 num_elements = indices.size();
+      elements->resize(num_elements);
+      statuses->resize(num_elements);
+      BlockingCounter counter(num_elements);
+      for (int64 i = 0; i < num_elements; ++i) {
+        const int64 index = indices[i];
+        thread_pool_->Schedule(
+            [this, ctx, index, i, elements, statuses, &counter]() {
+              (*statuses)[i] =
+                  dataset()->input_->Get(ctx, index, &(*elements)[i]);
+              counter.DecrementCount();
+            });
+      }
+      counter.Wait();
+    }
+
+    // Appends the fetched `elements` to `buffer_`. If fetching an element
+    // failed, only the preceding elements are buffered, and the error is
+    // recorded in `pending_status_` to be returned once they have been
+    // produced.
+    void BufferElements(std::vector<std::vector<Tensor>>* elements,
+                        const std::vector<Status>& statuses)
+        EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int64 i = 0; i < statuses.size(); ++i) {
+        ++next_index_;
+        if (!statuses[i].ok()) {
+          pending_status_ = statuses[i];
+          return;
+        }
+        buffer_.push_back(std::move((*elements)[i]));
+      }
+    }
+
+    mutex mu_;
+    condition_variable cond_var_;
+    std::unique_ptr<thread::ThreadPool> thread_pool_;
+    int64 num_parallel_calls_ = 1;
+    RandomSeedGenerator* seed_generator_ = nullptr;
+    int64 seed_ GUARDED_BY(mu_) = 0;
+    int64 seed2_ GUARDED_BY(mu_) = 0;
+    std::unique_ptr<IndexPermutation> permutation_ GUARDED_BY(mu_);
+    // The position in the permutation of the next element to fetch.
+    int64 next_index_ GUARDED_BY(mu_) = 0;
+    std::deque<std::vector<Tensor>> buffer_ GUARDED_BY(mu_);
+    Status pending_status_ GUARDED_BY(mu_);
+    // Whether a caller of `GetNextInternal` is fetching elements.
+    bool fetching_ GUARDED_BY(mu_) = false;
+  };
+
+  const DatasetBase* const input_;
+  const int64 seed_;
+  const int64 seed2_;
+  const int64 num_parallel_calls_;
+  const bool reshuffle_each_iteration_;
+};
+
+GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                         DatasetBase* input,
+                                         DatasetBase** output) {
+  int64 seed;
+  int64 seed2;
+  int64 num_parallel_calls;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed, &seed));
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed2, &seed2));
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kNumParallelCalls,
+                                                 &num_parallel_calls));
+  OP_REQUIRES(
+      ctx, num_parallel_calls > 0 || num_parallel_calls == model::kAutotune,
+      errors::InvalidArgument("num_parallel_calls must be greater than zero."));
+  OP_REQUIRES(ctx, input->SupportsRandomAccess(),
+              errors::InvalidArgument(
+                  "Global shuffling requires an input dataset that supports "
+                  "random access, but got ",
+                  input->DebugString(), "."));
+  OP_REQUIRES(ctx, input->Cardinality() >= 0,
+              errors::InvalidArgument(
+                  "Global shuffling requires an input dataset with a known, "
+                  "finite cardinality, but got ",
+                  input->DebugString(), " with cardinality ",
+                  input->Cardinality(), "."));
+
+  if (seed == 0 && seed2 == 0) {
+    seed = random::New64();
+    seed2 = random::New64();
+  }
+  *output = new Dataset(ctx, input, seed, seed2, num_parallel_calls,
+                        reshuffle_each_iteration_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_GLOBAL_SHUFFLE_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_GLOBAL_SHUFFLE_DATASET_OP_H_
+
+#include <array>
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A pseudorandom permutation of `[0, n)` that maps an index to its position
+// in O(1) time and memory, so that a dataset can be shuffled without
+// materializing the permutation.
+//
+// The permutation is a balanced Feistel network over the smallest domain of
+// `4^k` elements that covers `[0, n)`. Outputs that fall outside of `[0, n)`
+// are fed back into the network ("cycle walking"), which terminates because
+// the network is a bijection on its domain, and takes fewer than four rounds
+// on average because the domain has fewer than `4 * n` elements.
+class IndexPermutation {
+ public:
+  IndexPermutation(int64 n, int64 seed, int64 seed2);
+
+  // Returns the position of `index`, which must be in `[0, n)`.
+  int64 operator()(int64 index) const;
+
+ private:
+  static constexpr int kNumRounds = 6;
+
+  uint64 Encrypt(uint64 value) const;
+
+  const uint64 n_;
+  int half_bits_ = 1;
+  uint64 half_mask_ = 1;
+  std::array<uint64, kNumRounds> keys_;
+};
+
+// See tensorflow/core/api_def/base_api/api_def_GlobalShuffleDataset.pbtxt for
+// the API definition that corresponds to this kernel.
+class GlobalShuffleDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  // Names of op parameters, public so that they can be accessed by test cases.
+  // Make sure that these are kept in sync with the REGISTER_OP call in
+  // tensorflow/core/ops/experimental_dataset_ops.cc
+  static constexpr const char* const kDatasetType = "GlobalShuffle";
+  static constexpr const char* const kInputDataset = "input_dataset";
+  static constexpr const char* const kSeed = "seed";
+  static constexpr const char* const kSeed2 = "seed2";
+  static constexpr const char* const kNumParallelCalls = "num_parallel_calls";
+  static constexpr const char* const kReshuffleEachIteration =
+      "reshuffle_each_iteration";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  explicit GlobalShuffleDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  bool reshuffle_each_iteration_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_GLOBAL_SHUFFLE_DATASET_OP_H_
@@ -0,0 +1,275 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "global_shuffle_dataset";
+constexpr int64 kRandomSeed = 42;
+constexpr int64 kRandomSeed2 = 7;
+
+class GlobalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  GlobalShuffleDatasetParams(T input_dataset_params, int64 num_parallel_calls,
+                             bool reshuffle_each_iteration,
+                             DataTypeVector output_dtypes,
+                             std::vector<PartialTensorShape> output_shapes,
+                             string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        num_parallel_calls_(num_parallel_calls),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64>(TensorShape({}), {kRandomSeed}),
+            CreateTensor<int64>(TensorShape({}), {kRandomSeed2}),
+            CreateTensor<int64>(TensorShape({}), {num_parallel_calls_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleDatasetOp::kInputDataset,
+                    GlobalShuffleDatasetOp::kSeed,
+                    GlobalShuffleDatasetOp::kSeed2,
+                    GlobalShuffleDatasetOp::kNumParallelCalls};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {GlobalShuffleDatasetOp::kReshuffleEachIteration,
+         reshuffle_each_iteration_},
+        {GlobalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+        {GlobalShuffleDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64 num_parallel_calls_;
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleDatasetOpTest : public DatasetOpsTestBaseV2 {};
+
+GlobalShuffleDatasetParams RangeParams(int64 num_parallel_calls,
+                                       bool reshuffle_each_iteration) {
+  return GlobalShuffleDatasetParams(
+      RangeDatasetParams(0, 100, 1), num_parallel_calls,
+      reshuffle_each_iteration,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+GlobalShuffleDatasetParams TensorSliceParams() {
+  return GlobalShuffleDatasetParams(
+      TensorSliceDatasetParams(
+          {CreateTensor<int64>(TensorShape({5, 2}),
+                               {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+          "tensor_slice"),
+      /*num_parallel_calls=*/2, /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({2})},
+      /*node_name=*/kNodeName);
+}
+
+GlobalShuffleDatasetParams EmptyParams() {
+  return GlobalShuffleDatasetParams(
+      RangeDatasetParams(0, 0, 1), /*num_parallel_calls=*/4,
+      /*reshuffle_each_iteration=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> RangeOutputs(int64 n) {
+  std::vector<Tensor> outputs;
+  for (int64 i = 0; i < n; ++i) {
+    outputs.push_back(CreateTensor<int64>(TensorShape({}), {i}));
+  }
+  return outputs;
+}
+
+std::vector<GetNextTestCase<GlobalShuffleDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/RangeParams(/*num_parallel_calls=*/1,
+                                          /*reshuffle_each_iteration=*/false),
+           /*expected_outputs=*/RangeOutputs(100),
+           /*compare_order=*/false},
+          {/*dataset_params=*/RangeParams(/*num_parallel_calls=*/7,
+                                          /*reshuffle_each_iteration=*/true),
+           /*expected_outputs=*/RangeOutputs(100),
+           /*compare_order=*/false},
+          {/*dataset_params=*/RangeParams(model::kAutotune,
+                                          /*reshuffle_each_iteration=*/true),
+           /*expected_outputs=*/RangeOutputs(100),
+           /*compare_order=*/false},
+          {/*dataset_params=*/TensorSliceParams(),
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape({2}),
+                                {{0, 1}, {2, 3}, {4, 5}, {6, 7}, {8, 9}}),
+           /*compare_order=*/false},
+          {/*dataset_params=*/EmptyParams(), /*expected_outputs=*/{}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(GlobalShuffleDatasetOpTest, GlobalShuffleDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(GlobalShuffleDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = RangeParams(1, false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(GlobalShuffleDatasetOp::kDatasetType)));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, Cardinality) {
+  auto dataset_params = RangeParams(1, false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(100));
+}
+
+std::vector<int64> ReadAll(TestIterator* iterator) {
+  std::vector<int64> values;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> out_tensors;
+    TF_EXPECT_OK(iterator->GetNext(&out_tensors, &end_of_sequence));
+    if (!end_of_sequence) {
+      values.push_back(out_tensors[0].scalar<int64>()());
+    }
+  }
+  return values;
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, FixedSeedOrderIsShuffledAndRepeatable) {
+  auto dataset_params = RangeParams(3, /*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<int64> first = ReadAll(iterator.get());
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<int64> second = ReadAll(iterator.get());
+  EXPECT_EQ(first, second);
+
+  std::vector<int64> identity(100);
+  std::iota(identity.begin(), identity.end(), 0);
+  EXPECT_NE(first, identity);
+  std::sort(first.begin(), first.end());
+  EXPECT_EQ(first, identity);
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ConcurrentGetNext) {
+  auto dataset_params = RangeParams(5, /*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+
+  // Callers that find the buffer empty while another one fetches wait for its
+  // elements instead of fetching the same positions again.
+  mutex mu;
+  std::vector<int64> values;
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back(Env::Default()->StartThread(
+          {}, "consumer", [&iterator, &mu, &values]() {
+            bool end_of_sequence = false;
+            while (!end_of_sequence) {
+              std::vector<Tensor> out_tensors;
+              TF_EXPECT_OK(iterator->GetNext(&out_tensors, &end_of_sequence));
+              if (!end_of_sequence) {
+                mutex_lock l(mu);
+                values.push_back(out_tensors[0].scalar<int64>()());
+              }
+            }
+          }));
+    }
+  }
+
+  std::vector<int64> identity(100);
+  std::iota(identity.begin(), identity.end(), 0);
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(values, identity);
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<GlobalShuffleDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/RangeParams(/*num_parallel_calls=*/4,
+                                          /*reshuffle_each_iteration=*/false),
+           /*breakpoints=*/{0, 5, 37, 100},
+           /*expected_outputs=*/RangeOutputs(100),
+           /*compare_order=*/false},
+          {/*dataset_params=*/RangeParams(/*num_parallel_calls=*/4,
+                                          /*reshuffle_each_iteration=*/true),
+           /*breakpoints=*/{0, 5, 37, 100},
+           /*expected_outputs=*/RangeOutputs(100),
+           /*compare_order=*/false}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(GlobalShuffleDatasetOpTest,
+                                 GlobalShuffleDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST(IndexPermutationTest, IsPermutation) {
+  for (int64 n : {1, 2, 3, 4, 5, 17, 64, 100, 1000, 4097}) {
+    IndexPermutation permutation(n, kRandomSeed, kRandomSeed2);
+    std::vector<bool> seen(n, false);
+    for (int64 i = 0; i < n; ++i) {
+      const int64 position = permutation(i);
+      ASSERT_GE(position, 0);
+      ASSERT_LT(position, n);
+      EXPECT_FALSE(seen[position]) << "n = " << n << ", i = " << i;
+      seen[position] = true;
+    }
+  }
+}
+
+TEST(IndexPermutationTest, DependsOnSeed) {
+  const int64 n = 1000;
+  IndexPermutation permutation(n, kRandomSeed, kRandomSeed2);
+  IndexPermutation same_seed(n, kRandomSeed, kRandomSeed2);
+  IndexPermutation other_seed(n, kRandomSeed + 1, kRandomSeed2);
+  int64 num_different = 0;
+  for (int64 i = 0; i < n; ++i) {
+    EXPECT_EQ(permutation(i), same_seed(i));
+    num_different += permutation(i) != other_seed(i);
+  }
+  EXPECT_GT(num_different, n / 2);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
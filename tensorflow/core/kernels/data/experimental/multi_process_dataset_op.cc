@@ -0,0 +1,579 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/multi_process_dataset_op.h"
+
+#include <atomic>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/serialization_utils.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/platform.h"
+#include "tensorflow/core/platform/subprocess.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if defined(PLATFORM_POSIX)
+#include <dlfcn.h>
+#endif  // PLATFORM_POSIX
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const MultiProcessDatasetOp::kDatasetType;
+/* static */ constexpr const char* const MultiProcessDatasetOp::kInputDataset;
+/* static */ constexpr const char* const MultiProcessDatasetOp::kNumWorkers;
+/* static */ constexpr const char* const
+    MultiProcessDatasetOp::kBufferSizeBytes;
+/* static */ constexpr const char* const MultiProcessDatasetOp::kDeterministic;
+/* static */ constexpr const char* const
+    MultiProcessDatasetOp::kAutoShardPolicy;
+/* static */ constexpr const char* const MultiProcessDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const MultiProcessDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    MultiProcessDatasetOp::kWorkerIndexNode;
+/* static */ constexpr const char* const
+    MultiProcessDatasetOp::kMakeIteratorNode;
+/* static */ constexpr const char* const MultiProcessDatasetOp::kGetNextNode;
+/* static */ constexpr const char* const
+    MultiProcessDatasetOp::kWorkerBinaryEnvVar;
+
+namespace {
+
+constexpr char kNumWorkersNode[] = "multi_process/num_workers";
+constexpr char kShardNode[] = "multi_process/shard";
+constexpr char kIteratorNode[] = "multi_process/iterator";
+constexpr char kNextWorker[] = "next_worker";
+constexpr char kConsumed[] = "consumed";
+// Bounds a wait for the workers, in case a wakeup is lost.
+constexpr int64 kMaxWaitMicros = 1000 * 1000;
+constexpr int kKillSignal = 9;  // SIGKILL
+constexpr char kWorkerBinaryName[] = "multi_process_dataset_worker";
+
+// Returns the directory of the binary or shared library that contains this
+// kernel, or an empty string if it cannot be determined.
+string RuntimeDirectory() {
+#if defined(PLATFORM_POSIX)
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(&RuntimeDirectory), &info) != 0 &&
+      info.dli_fname != nullptr) {
+    return string(io::Dirname(info.dli_fname));
+  }
+#endif  // PLATFORM_POSIX
+  return "";
+}
+
+// Resolves the path of the worker binary. The path is a property of the
+// installation rather than of the graph, so that a graph cannot choose the
+// program that its workers run.
+//
+// The pip package installs the binary next to the library that contains this
+// kernel. Other installations must set `kWorkerBinaryEnvVar`.
+Status GetWorkerBinary(Env* env, string* worker_binary) {
+#if !defined(PLATFORM_POSIX)
+  return errors::Unimplemented(
+      "MultiProcessDataset is only supported on POSIX platforms.");
+#else
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar(
+      MultiProcessDatasetOp::kWorkerBinaryEnvVar, "", worker_binary));
+  if (!worker_binary->empty()) {
+    if (!env->FileExists(*worker_binary).ok()) {
+      return errors::NotFound("The ", kWorkerBinaryName,
+                              " binary was not found at ", *worker_binary,
+                              ", the path set in ",
+                              MultiProcessDatasetOp::kWorkerBinaryEnvVar, ".");
+    }
+    return Status::OK();
+  }
+  const string runtime_directory = RuntimeDirectory();
+  if (!runtime_directory.empty()) {
+    *worker_binary = io::JoinPath(runtime_directory, kWorkerBinaryName);
+    if (env->FileExists(*worker_binary).ok()) return Status::OK();
+  }
+  return errors::Unimplemented(
+      "MultiProcessDataset is not supported by this TensorFlow installation, "
+      "which does not include the ",
+      kWorkerBinaryName, " binary next to its runtime library. Set ",
+      MultiProcessDatasetOp::kWorkerBinaryEnvVar,
+      " to the path of a binary built from "
+      "//tensorflow/core/kernels/data/experimental:",
+      kWorkerBinaryName, " to use it.");
+#endif  // PLATFORM_POSIX
+}
+
+}  // namespace
+
+class MultiProcessDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 num_workers,
+          GraphDef worker_graph, const string& worker_binary,
+          int64 buffer_size_bytes, bool deterministic, int64 auto_shard_policy)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        num_workers_(num_workers),
+        worker_graph_(std::move(worker_graph)),
+        worker_binary_(worker_binary),
+        buffer_size_bytes_(buffer_size_bytes),
+        deterministic_(deterministic),
+        auto_shard_policy_(auto_shard_policy) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* num_workers = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(num_workers_, &num_workers));
+    AttrValue buffer_size_bytes;
+    b->BuildAttrValue(buffer_size_bytes_, &buffer_size_bytes);
+    AttrValue deterministic;
+    b->BuildAttrValue(deterministic_, &deterministic);
+    AttrValue auto_shard_policy;
+    b->BuildAttrValue(auto_shard_policy_, &auto_shard_policy);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_graph_node, num_workers},
+                      {{kBufferSizeBytes, buffer_size_bytes},
+                       {kDeterministic, deterministic},
+                       {kAutoShardPolicy, auto_shard_policy}},
+                      output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          consumed_(params.dataset->num_workers_, 0),
+          exhausted_(params.dataset->num_workers_, false) {}
+
+    ~Iterator() override {
+      if (deregister_fn_) deregister_fn_();
+      mutex_lock l(mu_);
+      StopWorkers();
+      if (!graph_file_.empty()) {
+        Env::Default()->DeleteFile(graph_file_).IgnoreError();
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(),
+          [this]() {
+            mutex_lock l(mu_);
+            cancelled_ = true;
+            cond_var_.notify_all();
+            if (consumer_pipe_) consumer_pipe_->Wake();
+          },
+          &deregister_fn_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      while (true) {
+        WakeupPipe* pipe;
+        {
+          mutex_lock l(mu_);
+          // The workers are started lazily so that restoring an iterator does
+          // not start them twice.
+          if (workers_.empty()) {
+            TF_RETURN_IF_ERROR(StartWorkers(ctx->env()));
+          }
+          bool found;
+          TF_RETURN_IF_ERROR(TryGetNext(ctx, /*request_wakeup=*/false,
+                                        out_tensors, end_of_sequence, &found));
+          if (found) return Status::OK();
+          // Asks the workers to wake `consumer_pipe_`, then checks again for an
+          // element that arrived in between.
+          TF_RETURN_IF_ERROR(TryGetNext(ctx, /*request_wakeup=*/true,
+                                        out_tensors, end_of_sequence, &found));
+          if (found) return Status::OK();
+          if (cancelled_) {
+            return errors::Cancelled("Operation was cancelled");
+          }
+          // One thread waits on the pipe, without holding `mu_` so that the
+          // iterator can be saved or cancelled meanwhile. Others wait for it.
+          if (waiting_on_pipe_) {
+            RecordStop(ctx);
+            cond_var_.wait(l);
+            RecordStart(ctx);
+            continue;
+          }
+          waiting_on_pipe_ = true;
+          pipe = consumer_pipe_.get();
+        }
+        RecordStop(ctx);
+        pipe->Wait(kMaxWaitMicros);
+        RecordStart(ctx);
+        mutex_lock l(mu_);
+        waiting_on_pipe_ = false;
+        cond_var_.notify_all();
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    // The workers are restarted from the checkpoint by skipping the elements
+    // that each of them had produced, so the elements that were still in the
+    // buffers are produced again. Only the element counts are saved, so the
+    // checkpoint does not depend on the state of the worker processes, but
+    // the workers produce and discard the skipped elements, so a restore takes
+    // time proportional to the sum of `consumed_`.
+    Status SaveInternal(IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNextWorker), next_worker_));
+      for (int64 i = 0; i < dataset()->num_workers_; ++i) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(strings::StrCat(kConsumed, "[", i, "]")),
+            consumed_[i]));
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      StopWorkers();
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextWorker), &next_worker_));
+      for (int64 i = 0; i < dataset()->num_workers_; ++i) {
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(strings::StrCat(kConsumed, "[", i, "]")),
+            &consumed_[i]));
+        exhausted_[i] = false;
+      }
+      return Status::OK();
+    }
+
+   private:
+    struct Worker {
+      // Wakes the worker when it waits for space in `buffer`. Declared first
+      // so that it is closed last.
+      std::unique_ptr<WakeupPipe> pipe;
+      std::unique_ptr<SharedMemoryRingBuffer> buffer;
+      std::unique_ptr<SubProcess> process;
+      // Waits for `process` to exit.
+      std::unique_ptr<Thread> waiter;
+      std::atomic<bool> exited{false};
+    };
+
+    // Takes an element from a worker that has one, from the workers in turn if
+    // the dataset is deterministic. Sets `*found` to false if there is none
+    // yet. If `request_wakeup` is true, asks each worker that has none to wake
+    // `consumer_pipe_` once it produces one.
+    Status TryGetNext(IteratorContext* ctx, bool request_wakeup,
+                      std::vector<Tensor>* out_tensors, bool* end_of_sequence,
+                      bool* found) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64 num_workers = dataset()->num_workers_;
+      bool all_exhausted = true;
+      for (int64 i = 0; i < num_workers; ++i) {
+        const int64 index = (next_worker_ + i) % num_workers;
+        if (exhausted_[index]) continue;
+        all_exhausted = false;
+        Worker* worker = workers_[index].get();
+        if (request_wakeup) worker->buffer->RequestWakeup();
+        // Reads the state of the worker before its buffer, so that no record
+        // committed before the worker finished is missed.
+        const bool exited = worker->exited;
+        const SharedMemoryRingBuffer::ProducerState state =
+            worker->buffer->producer_state();
+        StringPiece record;
+        if (worker->buffer->Peek(&record)) {
+          Status s = DecodeTensors(ctx->allocator({}), record, out_tensors);
+          worker->buffer->Release();
+          TF_RETURN_IF_ERROR(s);
+          ++consumed_[index];
+          next_worker_ = (index + 1) % num_workers;
+          *end_of_sequence = false;
+          *found = true;
+          return Status::OK();
+        }
+        if (state == SharedMemoryRingBuffer::ProducerState::kError) {
+          return worker->buffer->producer_status();
+        }
+        if (state == SharedMemoryRingBuffer::ProducerState::kEndOfSequence) {
+          exhausted_[index] = true;
+          continue;
+        }
+        if (exited) {
+          return errors::Unavailable("Worker ", index, " of ",
+                                     dataset()->DebugString(),
+                                     " exited unexpectedly.");
+        }
+        // In deterministic mode, the elements are taken from the workers in
+        // turn.
+        if (dataset()->deterministic_) break;
+      }
+      *end_of_sequence = all_exhausted;
+      *found = all_exhausted;
+      return Status::OK();
+    }
+
+    Status StartWorkers(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (consumer_pipe_ == nullptr) {
+        TF_RETURN_IF_ERROR(WakeupPipe::Create(&consumer_pipe_));
+      }
+      if (graph_file_.empty()) {
+        string graph_file;
+        if (!env->LocalTempFilename(&graph_file)) {
+          return errors::Unavailable(
+              "Failed to create a temporary file for the graph of ",
+              dataset()->DebugString());
+        }
+        TF_RETURN_IF_ERROR(
+            WriteBinaryProto(env, graph_file, dataset()->worker_graph_));
+        graph_file_ = graph_file;
+      }
+      const string name_prefix =
+          strings::StrCat("/tf_data_", strings::Hex(random::New64()));
+      for (int64 i = 0; i < dataset()->num_workers_; ++i) {
+        auto worker = absl::make_unique<Worker>();
+        TF_RETURN_IF_ERROR(WakeupPipe::Create(&worker->pipe));
+        TF_RETURN_IF_ERROR(SharedMemoryRingBuffer::Create(
+            strings::StrCat(name_prefix, "_", i), dataset()->buffer_size_bytes_,
+            &worker->buffer));
+        worker->buffer->SetWakeupFds(consumer_pipe_->read_fd(),
+                                     worker->pipe->write_fd());
+        worker->process = absl::make_unique<SubProcess>();
+        const string& binary = dataset()->worker_binary_;
+        worker->process->SetProgram(
+            binary,
+            {binary, strings::StrCat("--graph=", graph_file_),
+             strings::StrCat("--shared_memory=", worker->buffer->name()),
+             strings::StrCat("--worker_index=", i),
+             strings::StrCat("--skip=", consumed_[i]),
+             strings::StrCat("--wait_fd=", worker->pipe->read_fd()),
+             strings::StrCat("--wake_fd=", consumer_pipe_->write_fd())});
+        worker->process->SetChannelAction(CHAN_STDIN, ACTION_CLOSE);
+        worker->process->SetChannelAction(CHAN_STDOUT, ACTION_DUPPARENT);
+        worker->process->SetChannelAction(CHAN_STDERR, ACTION_DUPPARENT);
+        // The worker inherits only its ends of the two pipes.
+        worker->pipe->SetInheritable(/*read_end=*/true, /*write_end=*/false);
+        consumer_pipe_->SetInheritable(/*read_end=*/false, /*write_end=*/true);
+        const bool started = worker->process->Start();
+        worker->pipe->SetInheritable(false, false);
+        consumer_pipe_->SetInheritable(false, false);
+        if (!started) {
+          StopWorkers();
+          return errors::Unavailable("Failed to start worker ", i, " of ",
+                                     dataset()->DebugString(), ": ", binary);
+        }
+        Worker* w = worker.get();
+        WakeupPipe* consumer_pipe = consumer_pipe_.get();
+        worker->waiter.reset(env->StartThread(
+            {}, "tf_data_multi_process_waiter", [w, consumer_pipe]() {
+              w->process->Wait();
+              w->exited = true;
+              consumer_pipe->Wake();
+            }));
+        workers_.push_back(std::move(worker));
+      }
+      return Status::OK();
+    }
+
+    void StopWorkers() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (auto& worker : workers_) {
+        worker->process->Kill(kKillSignal);
+      }
+      // Joins the waiter threads and removes the buffers.
+      workers_.clear();
+    }
+
+    mutex mu_;
+    condition_variable cond_var_;
+    // Woken by the workers when they produce an element, finish or exit, and
+    // on cancellation. Created with the first workers and never replaced, so
+    // it may be waited on without holding `mu_`.
+    std::unique_ptr<WakeupPipe> consumer_pipe_;
+    // Whether a thread waits on `consumer_pipe_`.
+    bool waiting_on_pipe_ GUARDED_BY(mu_) = false;
+    bool cancelled_ GUARDED_BY(mu_) = false;
+    std::function<void()> deregister_fn_;
+    std::vector<std::unique_ptr<Worker>> workers_ GUARDED_BY(mu_);
+    string graph_file_ GUARDED_BY(mu_);
+    // The worker to take the next element from.
+    int64 next_worker_ GUARDED_BY(mu_) = 0;
+    // The number of elements taken from each worker.
+    std::vector<int64> consumed_ GUARDED_BY(mu_);
+    std::vector<bool> exhausted_ GUARDED_BY(mu_);
+  };
+
+  const DatasetBase* const input_;
+  const int64 num_workers_;
+  const GraphDef worker_graph_;
+  const string worker_binary_;
+  const int64 buffer_size_bytes_;
+  const bool deterministic_;
+  const int64 auto_shard_policy_;
+};
+
+MultiProcessDatasetOp::MultiProcessDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kBufferSizeBytes, &buffer_size_bytes_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kDeterministic, &deterministic_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kAutoShardPolicy, &auto_shard_policy_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES(ctx, buffer_size_bytes_ > 0,
+              errors::InvalidArgument("`buffer_size_bytes` must be > 0."));
+  OP_REQUIRES_OK(ctx, GetWorkerBinary(ctx->env(), &worker_binary_));
+}
+
+/* static */ Status MultiProcessDatasetOp::MakeWorkerGraph(
+    const GraphDef& input_graph, int64 num_workers, int64 auto_shard_policy,
+    const DataTypeVector& output_types,
+    const std::vector<PartialTensorShape>& output_shapes,
+    GraphDef* worker_graph) {
+  *worker_graph = input_graph;
+  // Replaces the `_Retval` node that marks the output of the input dataset.
+  string dataset_node;
+  auto* nodes = worker_graph->mutable_node();
+  for (auto it = nodes->begin(); it != nodes->end(); ++it) {
+    if (it->op() == "_Retval") {
+      dataset_node = it->input(0);
+      nodes->erase(it);
+      break;
+    }
+  }
+  if (dataset_node.empty()) {
+    return errors::InvalidArgument(
+        "The graph of the input dataset has no output node.");
+  }
+  const TensorId dataset_output = ParseTensorName(dataset_node);
+
+  Tensor num_workers_tensor(DT_INT64, TensorShape({}));
+  num_workers_tensor.scalar<int64>()() = num_workers;
+  TF_RETURN_IF_ERROR(NodeDefBuilder(kNumWorkersNode, "Const")
+                         .Attr("dtype", DT_INT64)
+                         .Attr("value", num_workers_tensor)
+                         .Finalize(worker_graph->add_node()));
+  TF_RETURN_IF_ERROR(NodeDefBuilder(kWorkerIndexNode, "Placeholder")
+                         .Attr("dtype", DT_INT64)
+                         .Attr("shape", TensorShape({}))
+                         .Finalize(worker_graph->add_node()));
+  TF_RETURN_IF_ERROR(
+      NodeDefBuilder(kShardNode, "AutoShardDataset")
+          .Input(string(dataset_output.node()), dataset_output.index(),
+                 DT_VARIANT)
+          .Input(kNumWorkersNode, 0, DT_INT64)
+          .Input(kWorkerIndexNode, 0, DT_INT64)
+          .Attr(kAutoShardPolicy, auto_shard_policy)
+          .Attr(kOutputTypes, output_types)
+          .Attr(kOutputShapes, output_shapes)
+          .Finalize(worker_graph->add_node()));
+  TF_RETURN_IF_ERROR(NodeDefBuilder(kIteratorNode, "IteratorV2")
+                         .Attr("shared_name", "")
+                         .Attr("container", "")
+                         .Attr(kOutputTypes, output_types)
+                         .Attr(kOutputShapes, output_shapes)
+                         .Finalize(worker_graph->add_node()));
+  TF_RETURN_IF_ERROR(NodeDefBuilder(kMakeIteratorNode, "MakeIterator")
+                         .Input(kShardNode, 0, DT_VARIANT)
+                         .Input(kIteratorNode, 0, DT_RESOURCE)
+                         .Finalize(worker_graph->add_node()));
+  TF_RETURN_IF_ERROR(NodeDefBuilder(kGetNextNode, "IteratorGetNext")
+                         .Input(kIteratorNode, 0, DT_RESOURCE)
+                         .Attr(kOutputTypes, output_types)
+                         .Attr(kOutputShapes, output_shapes)
+                         .Finalize(worker_graph->add_node()));
+  return Status::OK();
+}
+
+void MultiProcessDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                        DatasetBase* input,
+                                        DatasetBase** output) {
+  int64 num_workers;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64>(ctx, kNumWorkers, &num_workers));
+  OP_REQUIRES(ctx, num_workers > 0,
+              errors::InvalidArgument("`num_workers` must be > 0."));
+
+  // The workers rebuild the input from its graph, so functions with state
+  // such as random number generators start over in each worker.
+  SerializationContext::Params params;
+  std::vector<std::pair<string, Tensor>> input_list;
+  params.input_list = &input_list;
+  params.external_state_policy =
+      SerializationContext::ExternalStatePolicy::kWarn;
+  GraphDef input_graph;
+  OP_REQUIRES_OK(
+      ctx, AsGraphDef(ctx, input, SerializationContext(params), &input_graph));
+  OP_REQUIRES(ctx, input_list.empty(),
+              errors::InvalidArgument(
+                  "The input of MultiProcessDataset must not depend on "
+                  "tensors that cannot be serialized into its graph."));
+  GraphDef worker_graph;
+  OP_REQUIRES_OK(ctx, MakeWorkerGraph(input_graph, num_workers,
+                                      auto_shard_policy_, output_types_,
+                                      output_shapes_, &worker_graph));
+  *output = new Dataset(ctx, input, num_workers, std::move(worker_graph),
+                        worker_binary_, buffer_size_bytes_, deterministic_,
+                        auto_shard_policy_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("MultiProcessDataset").Device(DEVICE_CPU),
+                        MultiProcessDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
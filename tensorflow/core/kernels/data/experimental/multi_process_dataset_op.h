@@ -0,0 +1,91 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_MULTI_PROCESS_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_MULTI_PROCESS_DATASET_OP_H_
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/graph.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See tensorflow/core/api_def/base_api/api_def_MultiProcessDataset.pbtxt for
+// the API definition that corresponds to this kernel.
+//
+// The input dataset is produced by `num_workers` worker processes, each
+// running the `multi_process_dataset_worker` binary on an auto-sharded copy of
+// the input. Each worker passes its elements back through its own shared
+// memory ring buffer.
+//
+// The worker binary is the one named by the `TF_DATA_MULTI_PROCESS_WORKER`
+// environment variable if it is set, and otherwise the one installed next to
+// the binary or shared library that contains this kernel.
+class MultiProcessDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  // Names of op parameters, public so that they can be accessed by test cases.
+  // Make sure that these are kept in sync with the REGISTER_OP call in
+  // tensorflow/core/ops/experimental_dataset_ops.cc
+  static constexpr const char* const kDatasetType = "MultiProcess";
+  static constexpr const char* const kInputDataset = "input_dataset";
+  static constexpr const char* const kNumWorkers = "num_workers";
+  static constexpr const char* const kBufferSizeBytes = "buffer_size_bytes";
+  static constexpr const char* const kDeterministic = "deterministic";
+  static constexpr const char* const kAutoShardPolicy = "auto_shard_policy";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  // Names of the nodes of the graph run by the workers. The worker index is
+  // fed to `kWorkerIndexNode` when running `kMakeIteratorNode`.
+  static constexpr const char* const kWorkerIndexNode =
+      "multi_process/worker_index";
+  static constexpr const char* const kMakeIteratorNode =
+      "multi_process/make_iterator";
+  static constexpr const char* const kGetNextNode = "multi_process/get_next";
+
+  // The environment variable that overrides the path of the worker binary.
+  static constexpr const char* const kWorkerBinaryEnvVar =
+      "TF_DATA_MULTI_PROCESS_WORKER";
+
+  explicit MultiProcessDatasetOp(OpKernelConstruction* ctx);
+
+  // Builds the graph run by the workers from `input_graph`, the serialized
+  // input dataset as returned by `AsGraphDef()`.
+  static Status MakeWorkerGraph(
+      const GraphDef& input_graph, int64 num_workers, int64 auto_shard_policy,
+      const DataTypeVector& output_types,
+      const std::vector<PartialTensorShape>& output_shapes,
+      GraphDef* worker_graph);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  string worker_binary_;
+  int64 buffer_size_bytes_;
+  bool deterministic_;
+  int64 auto_shard_policy_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_MULTI_PROCESS_DATASET_OP_H_
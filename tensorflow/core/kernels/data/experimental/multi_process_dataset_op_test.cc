@@ -0,0 +1,282 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/multi_process_dataset_op.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "multi_process_dataset";
+
+// Points the kernel at the worker binary built for this test.
+void SetWorkerBinary() {
+  const string worker_binary = io::JoinPath(
+      testing::TensorFlowSrcRoot(),
+      "core/kernels/data/experimental/multi_process_dataset_worker");
+  setenv(MultiProcessDatasetOp::kWorkerBinaryEnvVar, worker_binary.c_str(),
+         /*overwrite=*/1);
+}
+
+class MultiProcessDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  MultiProcessDatasetParams(T input_dataset_params, int64 num_workers,
+                            bool deterministic, DataTypeVector output_dtypes,
+                            std::vector<PartialTensorShape> output_shapes,
+                            string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        num_workers_(num_workers),
+        deterministic_(deterministic) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64>(TensorShape({}), {num_workers_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {MultiProcessDatasetOp::kInputDataset,
+                    MultiProcessDatasetOp::kNumWorkers};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{MultiProcessDatasetOp::kBufferSizeBytes, 4096},
+                    {MultiProcessDatasetOp::kDeterministic, deterministic_},
+                    {MultiProcessDatasetOp::kAutoShardPolicy, 0},
+                    {MultiProcessDatasetOp::kOutputTypes, output_dtypes_},
+                    {MultiProcessDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return MultiProcessDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64 num_workers_;
+  bool deterministic_;
+};
+
+class MultiProcessDatasetOpTest : public DatasetOpsTestBaseV2 {
+ protected:
+  MultiProcessDatasetOpTest() { SetWorkerBinary(); }
+};
+
+MultiProcessDatasetParams DeterministicParams() {
+  return MultiProcessDatasetParams(RangeDatasetParams(0, 10, 1),
+                                   /*num_workers=*/2,
+                                   /*deterministic=*/true,
+                                   /*output_dtypes=*/{DT_INT64},
+                                   /*output_shapes=*/{PartialTensorShape({})},
+                                   /*node_name=*/kNodeName);
+}
+
+MultiProcessDatasetParams NondeterministicParams() {
+  return MultiProcessDatasetParams(RangeDatasetParams(0, 10, 1),
+                                   /*num_workers=*/3,
+                                   /*deterministic=*/false,
+                                   /*output_dtypes=*/{DT_INT64},
+                                   /*output_shapes=*/{PartialTensorShape({})},
+                                   /*node_name=*/kNodeName);
+}
+
+MultiProcessDatasetParams MoreWorkersThanElementsParams() {
+  return MultiProcessDatasetParams(RangeDatasetParams(0, 2, 1),
+                                   /*num_workers=*/4,
+                                   /*deterministic=*/true,
+                                   /*output_dtypes=*/{DT_INT64},
+                                   /*output_shapes=*/{PartialTensorShape({})},
+                                   /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<MultiProcessDatasetParams>> GetNextTestCases() {
+  return {
+      // The range is sharded element by element, so taking the elements from
+      // the workers in turn restores the order of the input.
+      {/*dataset_params=*/DeterministicParams(),
+       /*expected_outputs=*/
+       CreateTensors<int64>(
+           TensorShape({}),
+           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/NondeterministicParams(),
+       /*expected_outputs=*/
+       CreateTensors<int64>(TensorShape({}),
+                            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}}),
+       /*compare_order=*/false},
+      {/*dataset_params=*/MoreWorkersThanElementsParams(),
+       /*expected_outputs=*/CreateTensors<int64>(TensorShape({}), {{0}, {1}})}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(MultiProcessDatasetOpTest, MultiProcessDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(MultiProcessDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = DeterministicParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(MultiProcessDatasetOp::kDatasetType)));
+}
+
+TEST_F(MultiProcessDatasetOpTest, Cardinality) {
+  auto dataset_params = DeterministicParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(10));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<MultiProcessDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/DeterministicParams(),
+           /*breakpoints=*/{0, 3, 10},
+           /*expected_outputs=*/
+           CreateTensors<int64>(
+               TensorShape({}),
+               {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(MultiProcessDatasetOpTest,
+                                 MultiProcessDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(MultiProcessDatasetOpTest, MissingWorkerBinary) {
+  setenv(MultiProcessDatasetOp::kWorkerBinaryEnvVar,
+         io::JoinPath(testing::TmpDir(), "no_such_worker").c_str(),
+         /*overwrite=*/1);
+  auto dataset_params = DeterministicParams();
+  EXPECT_TRUE(errors::IsNotFound(Initialize(dataset_params)));
+  SetWorkerBinary();
+}
+
+// Builds a graph that repeats a tensor of `num_floats` floats forever, in
+// `num_workers` worker processes, or in this process if `num_workers` is 0.
+GraphDef MakeBenchmarkGraph(int num_floats, int num_workers) {
+  const DataTypeVector output_types = {DT_FLOAT};
+  const std::vector<PartialTensorShape> output_shapes = {
+      PartialTensorShape({num_floats})};
+  Tensor value(DT_FLOAT, TensorShape({num_floats}));
+  value.flat<float>().setConstant(1.0f);
+  Tensor count(DT_INT64, TensorShape({}));
+  count.scalar<int64>()() = -1;
+  Tensor num_workers_tensor(DT_INT64, TensorShape({}));
+  num_workers_tensor.scalar<int64>()() = num_workers;
+
+  GraphDef graph;
+  TF_CHECK_OK(NodeDefBuilder("value", "Const")
+                  .Attr("dtype", DT_FLOAT)
+                  .Attr("value", value)
+                  .Finalize(graph.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("count", "Const")
+                  .Attr("dtype", DT_INT64)
+                  .Attr("value", count)
+                  .Finalize(graph.add_node()));
+  const std::vector<NodeDefBuilder::NodeOut> components = {
+      NodeDefBuilder::NodeOut("value", 0, DT_FLOAT)};
+  TF_CHECK_OK(NodeDefBuilder("tensor", "TensorDataset")
+                  .Input(components)
+                  .Attr("Toutput_types", output_types)
+                  .Attr("output_shapes", output_shapes)
+                  .Finalize(graph.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("repeat", "RepeatDataset")
+                  .Input("tensor", 0, DT_VARIANT)
+                  .Input("count", 0, DT_INT64)
+                  .Attr("output_types", output_types)
+                  .Attr("output_shapes", output_shapes)
+                  .Finalize(graph.add_node()));
+  string dataset = "repeat";
+  if (num_workers > 0) {
+    TF_CHECK_OK(NodeDefBuilder("num_workers", "Const")
+                    .Attr("dtype", DT_INT64)
+                    .Attr("value", num_workers_tensor)
+                    .Finalize(graph.add_node()));
+    // Every worker repeats the whole input, so that the benchmark measures
+    // the transfer of the elements rather than the sharding.
+    TF_CHECK_OK(NodeDefBuilder("multi_process", "MultiProcessDataset")
+                    .Input("repeat", 0, DT_VARIANT)
+                    .Input("num_workers", 0, DT_INT64)
+                    .Attr(MultiProcessDatasetOp::kDeterministic, false)
+                    .Attr(MultiProcessDatasetOp::kAutoShardPolicy, -1)
+                    .Attr("output_types", output_types)
+                    .Attr("output_shapes", output_shapes)
+                    .Finalize(graph.add_node()));
+    dataset = "multi_process";
+  }
+  TF_CHECK_OK(NodeDefBuilder("iterator", "IteratorV2")
+                  .Attr("shared_name", "")
+                  .Attr("container", "")
+                  .Attr("output_types", output_types)
+                  .Attr("output_shapes", output_shapes)
+                  .Finalize(graph.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("make_iterator", "MakeIterator")
+                  .Input(dataset, 0, DT_VARIANT)
+                  .Input("iterator", 0, DT_RESOURCE)
+                  .Finalize(graph.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("get_next", "IteratorGetNext")
+                  .Input("iterator", 0, DT_RESOURCE)
+                  .Attr("output_types", output_types)
+                  .Attr("output_shapes", output_shapes)
+                  .Finalize(graph.add_node()));
+  return graph;
+}
+
+// Measures the end-to-end throughput of a session that fetches elements of
+// one float tensor of `num_floats` floats, produced by `num_workers` worker
+// processes, or by the same pipeline in this process if `num_workers` is 0.
+static void BM_MultiProcessDatasetThroughput(int iters, int num_floats,
+                                             int num_workers) {
+  testing::StopTiming();
+  SetWorkerBinary();
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(MakeBenchmarkGraph(num_floats, num_workers)));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<Tensor> outputs;
+  // Starts the workers before timing.
+  TF_CHECK_OK(session->Run({}, {"get_next"}, {}, &outputs));
+
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(session->Run({}, {"get_next"}, {}, &outputs));
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters));
+  testing::BytesProcessed(static_cast<int64>(iters) * num_floats *
+                          sizeof(float));
+}
+
+BENCHMARK(BM_MultiProcessDatasetThroughput)
+    ->ArgPair(1 << 10, 0)
+    ->ArgPair(1 << 10, 1)
+    ->ArgPair(1 << 10, 4)
+    ->ArgPair(1 << 20, 0)
+    ->ArgPair(1 << 20, 1)
+    ->ArgPair(1 << 20, 4);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
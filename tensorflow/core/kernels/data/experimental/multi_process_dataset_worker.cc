@@ -0,0 +1,162 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// The worker process of MultiProcessDataset. Runs the graph written by
+// `MultiProcessDatasetOp` for one shard of the input dataset, and writes the
+// elements to the shared memory ring buffer created by the consumer.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/experimental/multi_process_dataset_op.h"
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+#if defined(__linux__)
+#include <signal.h>
+#include <sys/prctl.h>
+#endif  // __linux__
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+Status RunWorker(const string& graph_file, int64 worker_index, int64 skip,
+                 SharedMemoryRingBuffer* buffer) {
+  GraphDef graph;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), graph_file, &graph));
+  int num_components = -1;
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == MultiProcessDatasetOp::kGetNextNode) {
+      const AttrValue& output_types =
+          node.attr().at(MultiProcessDatasetOp::kOutputTypes);
+      num_components = output_types.list().type_size();
+    }
+  }
+  if (num_components < 0) {
+    return errors::InvalidArgument("No ", MultiProcessDatasetOp::kGetNextNode,
+                                   " node in ", graph_file);
+  }
+
+  // The workers only run the input pipeline, which belongs on the CPU.
+  SessionOptions options;
+  (*options.config.mutable_device_count())["GPU"] = 0;
+  Session* session_ptr;
+  TF_RETURN_IF_ERROR(NewSession(options, &session_ptr));
+  std::unique_ptr<Session> session(session_ptr);
+  TF_RETURN_IF_ERROR(session->Create(graph));
+
+  Tensor index(DT_INT64, TensorShape({}));
+  index.scalar<int64>()() = worker_index;
+  TF_RETURN_IF_ERROR(
+      session->Run({{MultiProcessDatasetOp::kWorkerIndexNode, index}}, {},
+                   {MultiProcessDatasetOp::kMakeIteratorNode}, nullptr));
+
+  CallableOptions callable_options;
+  for (int i = 0; i < num_components; ++i) {
+    callable_options.add_fetch(
+        strings::StrCat(MultiProcessDatasetOp::kGetNextNode, ":", i));
+  }
+  Session::CallableHandle get_next;
+  TF_RETURN_IF_ERROR(session->MakeCallable(callable_options, &get_next));
+
+  std::vector<Tensor> element;
+  for (int64 num_elements = 0;; ++num_elements) {
+    Status s = session->RunCallable(get_next, {}, &element, nullptr);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    // Elements consumed before the iterator was checkpointed are dropped.
+    if (num_elements < skip) continue;
+    uint64 size;
+    TF_RETURN_IF_ERROR(EncodedTensorsSize(element, &size));
+    char* data;
+    TF_RETURN_IF_ERROR(buffer->Reserve(size, &data));
+    EncodeTensors(element, data);
+    buffer->Commit(size);
+  }
+  buffer->SetEndOfSequence();
+  return session->ReleaseCallable(get_next);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  tensorflow::string graph_file;
+  tensorflow::string shared_memory;
+  tensorflow::int64 worker_index = 0;
+  tensorflow::int64 skip = 0;
+  tensorflow::int32 wait_fd = -1;
+  tensorflow::int32 wake_fd = -1;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("graph", &graph_file, "The graph to run."),
+      tensorflow::Flag("shared_memory", &shared_memory,
+                       "The name of the shared memory ring buffer."),
+      tensorflow::Flag("worker_index", &worker_index,
+                       "The index of the shard to produce."),
+      tensorflow::Flag("skip", &skip,
+                       "The number of elements to skip before writing."),
+      tensorflow::Flag("wait_fd", &wait_fd,
+                       "The inherited read end of the pipe that the consumer "
+                       "writes to when it has released space."),
+      tensorflow::Flag("wake_fd", &wake_fd,
+                       "The inherited write end of the pipe that wakes the "
+                       "consumer."),
+  };
+  const tensorflow::string usage =
+      tensorflow::Flags::Usage(argv[0], flag_list);
+  if (!tensorflow::Flags::Parse(&argc, argv, flag_list) ||
+      graph_file.empty() || shared_memory.empty()) {
+    LOG(ERROR) << usage;
+    return 2;
+  }
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+#if defined(__linux__)
+  // Exits with the consumer, which may otherwise leave the worker waiting for
+  // space in the buffer forever.
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif  // __linux__
+
+  std::unique_ptr<tensorflow::data::experimental::SharedMemoryRingBuffer>
+      buffer;
+  tensorflow::Status s =
+      tensorflow::data::experimental::SharedMemoryRingBuffer::Open(
+          shared_memory, &buffer);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return 1;
+  }
+  buffer->SetWakeupFds(wait_fd, wake_fd);
+  s = tensorflow::data::experimental::RunWorker(graph_file, worker_index, skip,
+                                                buffer.get());
+  if (!s.ok()) {
+    buffer->SetError(s);
+    return 1;
+  }
+  return 0;
+}
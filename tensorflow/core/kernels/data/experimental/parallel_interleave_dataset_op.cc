@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <atomic>
 #include <deque>
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/function.h"
@@ -221,6 +222,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
    public:
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params),
+          buffer_output_elements_(std::make_shared<model::SharedState>(
+              dataset()->buffer_output_elements_,
+              std::make_shared<mutex>(),
+              std::make_shared<condition_variable>())),
           workers_(dataset()->num_threads()),
           worker_thread_states_(dataset()->num_threads()) {}
 
@@ -241,6 +246,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     }
 
     Status Initialize(IteratorContext* ctx) override {
+      {
+        mutex_lock l(*buffer_output_elements_->mu);
+        if (buffer_output_elements_->value == model::kAutotune) {
+          buffer_output_elements_->value = 2 * dataset()->block_length_;
+        }
+      }
       TF_RETURN_IF_ERROR(
           dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
       return dataset()->captured_func_->Instantiate(
@@ -289,6 +300,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             Status s = current_worker->outputs.front().status;
             current_worker->outputs.front().output.swap(*out_tensors);
             current_worker->outputs.pop_front();
+            RecordBufferDequeue(ctx, *out_tensors);
             current_worker->cond_var.notify_one();
             return s;
           } else if (current_worker->is_producing && !dataset()->sloppy_) {
@@ -312,6 +324,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                 input_impl_.reset();
               } else {
                 current_worker->SetInputs(s, std::move(args));
+                if (!s.ok()) {
+                  // The error is buffered and dequeued like an element.
+                  RecordBufferEnqueue(ctx,
+                                      current_worker->outputs.back().output);
+                }
                 staging_indices_.emplace_back(current_worker_index);
               }
             }
@@ -356,8 +373,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
-      return model::MakeAsyncInterleaveManyNode(std::move(args),
-                                                /*parameters=*/{});
+      return model::MakeAsyncInterleaveManyNode(
+          std::move(args),
+          {model::MakeParameter(model::kBufferSize, buffer_output_elements_,
+                                /*min=*/1,
+                                /*max=*/std::numeric_limits<int64>::max())});
     }
 
     Status SaveInternal(IteratorStateWriter* writer) override {
@@ -578,6 +598,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             return Status::OK();
           }
           workers_[i].SetInputs(s, std::move(args));
+          if (!s.ok()) {
+            RecordBufferEnqueue(ctx, workers_[i].outputs.back().output);
+          }
           std::shared_ptr<IteratorContext> new_ctx(new IteratorContext(*ctx));
           worker_threads_.push_back(ctx->StartThread(
               strings::StrCat(kTFDataParallelInterleaveWorker, "_", i),
@@ -594,6 +617,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    // Returns the current number of elements each worker buffers.
+    int64 BufferOutputElements() {
+      mutex_lock l(*buffer_output_elements_->mu);
+      return buffer_output_elements_->value;
+    }
+
     // Produces elements into the worker's output buffers.
     void WorkerThread(const std::shared_ptr<IteratorContext>& ctx,
                       const int64 thread_index) {
@@ -708,8 +737,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         if (!iterator_creation_status.ok()) {
           mutex_lock l(mu_);
           // Wait for space in the prefetch queue.
-          while (!cancelled_ && workers_[thread_index].outputs.size() ==
-                                    dataset()->buffer_output_elements_) {
+          while (!cancelled_ && workers_[thread_index].outputs.size() >=
+                                    BufferOutputElements()) {
             RecordStop(ctx.get());
             workers_[thread_index].cond_var.wait(l);
             RecordStart(ctx.get());
@@ -717,6 +746,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           if (cancelled_) return;
           tf_shared_lock ckpt_l(ckpt_mu_);
           workers_[thread_index].outputs.emplace_back(iterator_creation_status);
+          RecordBufferEnqueue(ctx.get(),
+                              workers_[thread_index].outputs.back().output);
           workers_[thread_index].is_producing = false;
           worker_thread_states_[thread_index].iterator_creation_status =
               Status::OK();
@@ -760,8 +791,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               mutex_lock l(mu_);
 
               // Wait for space in the prefetch queue.
-              while (!cancelled_ && workers_[thread_index].outputs.size() ==
-                                        dataset()->buffer_output_elements_) {
+              while (!cancelled_ && workers_[thread_index].outputs.size() >=
+                                        BufferOutputElements()) {
                 RecordStop(ctx.get());
                 workers_[thread_index].cond_var.wait(l);
                 RecordStart(ctx.get());
@@ -784,6 +815,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                     worker_thread_states_[thread_index].output_elem.status);
                 workers_[thread_index].outputs.back().output.swap(
                     worker_thread_states_[thread_index].output_elem.output);
+                RecordBufferEnqueue(
+                    ctx.get(), workers_[thread_index].outputs.back().output);
               }
               worker_thread_states_[thread_index].output_elem.status =
                   Status::OK();
@@ -852,6 +885,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(ReadOutputElemLocked(
             reader, &workers_[index].outputs.back(),
             full_name(strings::StrCat(worker_prefix, "_", kOutputs, "_", i))));
+        // Restored elements are dequeued like the ones the workers produce.
+        RecordBufferEnqueue(ctx, workers_[index].outputs.back().output);
       }
       if (reader->Contains(
               full_name(strings::StrCat(worker_prefix, "_", kIsProducing)))) {
@@ -1025,6 +1060,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
 
+    // The number of elements each worker buffers. Can be autotuned, in which
+    // case the model updates the value and a worker blocked on a full buffer
+    // observes it the next time the client consumes one of its elements.
+    const std::shared_ptr<model::SharedState> buffer_output_elements_;
+
     // The WorkerState structs the worker threads operate on.
     // workers_ elements are in at most one of interleave_ and staging_.
     std::vector<WorkerState> workers_ GUARDED_BY(mu_);
@@ -1091,8 +1131,11 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
   int64 buffer_output_elements = 0;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kBufferOutputElements,
                                           &buffer_output_elements));
-  OP_REQUIRES(ctx, buffer_output_elements > 0,
-              errors::InvalidArgument("`buffer_output_elements` must be > 0"));
+  OP_REQUIRES(
+      ctx,
+      buffer_output_elements > 0 || buffer_output_elements == model::kAutotune,
+      errors::InvalidArgument(
+          "`buffer_output_elements` must be > 0 or AUTOTUNE"));
 
   int64 prefetch_input_elements = 0;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kPrefetchInputElements,
@@ -251,6 +251,31 @@ TestCase TestCase5() {
           /*breakpoints*/ {0, 4, 11}};
 }
 
+// Test case 6: cycle_length = 2, block_length = 2, sloppy = false
+// buffer_output_elements = AUTOTUNE, prefetch_input_elements = 2
+TestCase TestCase6() {
+  return {/*input_tensors=*/
+          {CreateTensor<tstring>(TensorShape{3, 3, 1}, {"a", "b", "c", "d", "e",
+                                                        "f", "g", "h", "i"})},
+          /*cycle_length=*/2,
+          /*block_length=*/2,
+          /*sloppy=*/false,
+          /*buffer_output_elements=*/model::kAutotune,
+          /*prefetch_input_elements=*/2,
+          /*func=*/
+          MakeTensorSliceDatasetFunc(
+              DataTypeVector({DT_STRING}),
+              std::vector<PartialTensorShape>({PartialTensorShape({1})})),
+          /*func_lib=*/{test::function::MakeTensorSliceDataset()},
+          /*expected_outputs*/
+          ConvertToTensorVec<tstring>(
+              {"a", "b", "d", "e", "c", "f", "g", "h", "i"}),
+          /*expected_output_dtypes*/ {DT_INT64},
+          /*expected_output_shapes*/ {PartialTensorShape({1})},
+          /*expected_cardinality*/ tensorflow::data::kUnknownCardinality,
+          /*breakpoints*/ {0, 4, 11}};
+}
+
 TestCase InvalidCycleLengthTestCase() {
   return {
       /*input_tensors=*/
@@ -766,7 +791,89 @@ INSTANTIATE_TEST_SUITE_P(ParallelInterleaveDatasetOpTest,
                          ParameterizedParallelInterleaveDatasetOpTest,
                          ::testing::ValuesIn(std::vector<TestCase>(
                              {TestCase1(), TestCase2(), TestCase3(),
-                              TestCase4(), TestCase5()})));
+                              TestCase4(), TestCase5(), TestCase6()})));
+
+TEST_F(ParallelInterleaveDatasetOpTest, RoundtripBufferAccounting) {
+  int thread_num = 2, cpu_num = 2;
+  TestCase test_case = TestCase6();
+  TF_ASSERT_OK(InitThreadPool(thread_num));
+  TF_ASSERT_OK(InitFunctionLibraryRuntime(test_case.func_lib, cpu_num));
+
+  std::unique_ptr<OpKernel> parallel_interleave_dataset_kernel;
+  TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
+      test_case.func, test_case.expected_output_dtypes,
+      test_case.expected_output_shapes, &parallel_interleave_dataset_kernel));
+
+  Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
+  std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
+  TF_ASSERT_OK(CreateTensorSliceDatasetTensor(&inputs_for_tensor_slice_dataset,
+                                              &tensor_slice_dataset_tensor));
+  gtl::InlinedVector<TensorValue, 4> inputs(
+      {TensorValue(&tensor_slice_dataset_tensor),
+       TensorValue(&test_case.cycle_length),
+       TensorValue(&test_case.block_length), TensorValue(&test_case.sloppy),
+       TensorValue(&test_case.buffer_output_elements),
+       TensorValue(&test_case.prefetch_input_elements)});
+  std::unique_ptr<OpKernelContext> parallel_interleave_dataset_context;
+  TF_ASSERT_OK(CreateParallelInterleaveDatasetContext(
+      parallel_interleave_dataset_kernel.get(), &inputs,
+      &parallel_interleave_dataset_context));
+  DatasetBase* parallel_interleave_dataset;
+  TF_ASSERT_OK(CreateDataset(parallel_interleave_dataset_kernel.get(),
+                             parallel_interleave_dataset_context.get(),
+                             &parallel_interleave_dataset));
+  core::ScopedUnref scoped_unref_dataset(parallel_interleave_dataset);
+
+  // Records the buffer counters of the interleave node when its iterator is
+  // destroyed.
+  int64 buffered_bytes = -1;
+  int64 buffered_elements = -1;
+  std::unique_ptr<IteratorContext> base_iterator_ctx;
+  TF_ASSERT_OK(CreateIteratorContext(parallel_interleave_dataset_context.get(),
+                                     &base_iterator_ctx));
+  IteratorContext::Params params(base_iterator_ctx.get());
+  params.model = std::make_shared<model::Model>(
+      [&buffered_bytes,
+       &buffered_elements](std::shared_ptr<model::Node> node) {
+        if (node->name() == ParallelInterleaveDatasetOp::kDatasetType) {
+          buffered_bytes = node->buffered_bytes();
+          buffered_elements = node->buffered_elements();
+        }
+      });
+  IteratorContext iterator_ctx(std::move(params));
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(parallel_interleave_dataset->MakeIterator(
+      &iterator_ctx, kIteratorPrefix, &iterator));
+
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  bool end_of_sequence = false;
+  std::vector<Tensor> next;
+  for (int i = 0; i < 4; ++i) {
+    TF_EXPECT_OK(iterator->GetNext(&iterator_ctx, &next, &end_of_sequence));
+  }
+  VariantTensorData data;
+  VariantTensorDataWriter writer(&data);
+  TF_EXPECT_OK(iterator->Save(serialization_ctx.get(), &writer));
+  TF_EXPECT_OK(writer.Flush());
+  // Destroys the iterator before restoring it, so that the restored iterator
+  // owns the interleave node of the model.
+  iterator.reset();
+  EXPECT_GE(buffered_bytes, 0);
+  EXPECT_GE(buffered_elements, 0);
+
+  VariantTensorDataReader reader(&data);
+  TF_EXPECT_OK(RestoreIterator(&iterator_ctx, &reader, kIteratorPrefix,
+                               *parallel_interleave_dataset, &iterator));
+  while (!end_of_sequence) {
+    TF_EXPECT_OK(iterator->GetNext(&iterator_ctx, &next, &end_of_sequence));
+  }
+  // Every element buffered by the restored iterator, including the ones it
+  // restored, has been dequeued.
+  iterator.reset();
+  EXPECT_EQ(buffered_bytes, 0);
+  EXPECT_EQ(buffered_elements, 0);
+}
 
 TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
   int thread_num = 2, cpu_num = 2;
@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/stats_aggregator.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/data/parallel_map_dataset_op.h"
 #include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
@@ -26,11 +27,22 @@ namespace data {
 namespace experimental {
 namespace {
 
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+
 class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit ParseExampleDatasetOp(OpKernelConstruction* ctx)
+      : ParseExampleDatasetOp(ctx, /*fuse_batch=*/false) {}
+
+ protected:
+  // If `fuse_batch` is true, the kernel implements `ParseExampleBatchDataset`,
+  // which batches scalar serialized examples and parses each batch in a
+  // single call, instead of `ParseExampleDataset`, which parses batches that
+  // were already formed by an upstream `BatchDataset`.
+  ParseExampleDatasetOp(OpKernelConstruction* ctx, bool fuse_batch)
       : UnaryDatasetOpKernel(ctx),
-        graph_def_version_(ctx->graph_def_version()) {
+        graph_def_version_(ctx->graph_def_version()),
+        fuse_batch_(fuse_batch) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("sparse_keys", &sparse_keys_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_keys", &dense_keys_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("sparse_types", &sparse_types_));
@@ -38,7 +50,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_shapes", &dense_shapes_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
-    OP_REQUIRES_OK(ctx, ctx->GetAttr("sloppy", &sloppy_));
+    if (!fuse_batch_) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("sloppy", &sloppy_));
+    }
     has_ragged_keys_ = ctx->HasAttr("ragged_keys");
     if (has_ragged_keys_) {
       OP_REQUIRES_OK(ctx, ctx->GetAttr("ragged_keys", &ragged_keys_));
@@ -79,16 +93,27 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     metrics::RecordParseSparseFeature(sparse_keys_.size());
   }
 
- protected:
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                    DatasetBase** output) override {
     int64 num_parallel_calls = 0;
-    OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
-                                            &num_parallel_calls));
-    OP_REQUIRES(
-        ctx, num_parallel_calls > 0 || num_parallel_calls == model::kAutotune,
-        errors::InvalidArgument(
-            "num_parallel_calls must be greater than zero."));
+    int64 batch_size = 0;
+    bool drop_remainder = false;
+    if (fuse_batch_) {
+      OP_REQUIRES_OK(ctx,
+                     ParseScalarArgument(ctx, "batch_size", &batch_size));
+      OP_REQUIRES(
+          ctx, batch_size > 0,
+          errors::InvalidArgument("batch_size must be greater than zero."));
+      OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "drop_remainder",
+                                              &drop_remainder));
+    } else {
+      OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
+                                              &num_parallel_calls));
+      OP_REQUIRES(
+          ctx, num_parallel_calls > 0 || num_parallel_calls == model::kAutotune,
+          errors::InvalidArgument(
+              "num_parallel_calls must be greater than zero."));
+    }
 
     OpInputList dense_default_tensors;
     OP_REQUIRES_OK(ctx,
@@ -164,8 +189,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
 
     *output = new Dataset(ctx, input, dense_defaults, sparse_keys_, dense_keys_,
                           std::move(key_to_output_index), std::move(config),
-                          num_parallel_calls, sparse_types_, dense_types_,
-                          dense_shapes_, output_types_, output_shapes_, sloppy_,
+                          num_parallel_calls, batch_size, drop_remainder,
+                          sparse_types_, dense_types_, dense_shapes_,
+                          output_types_, output_shapes_, sloppy_,
                           has_ragged_keys_, ragged_keys_, ragged_value_types_,
                           ragged_split_types_);
   }
@@ -178,6 +204,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
             std::vector<string> dense_keys,
             std::map<string, int> key_to_output_index,
             example::FastParseExampleConfig config, int32 num_parallel_calls,
+            int64 batch_size, bool drop_remainder,
             const DataTypeVector& sparse_types,
             const DataTypeVector& dense_types,
             const std::vector<PartialTensorShape>& dense_shapes,
@@ -195,6 +222,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           key_to_output_index_(std::move(key_to_output_index)),
           config_(std::move(config)),
           num_parallel_calls_(num_parallel_calls),
+          batch_size_(batch_size),
+          drop_remainder_(drop_remainder),
           sparse_types_(sparse_types),
           dense_types_(dense_types),
           ragged_value_types_(ragged_value_types),
@@ -211,6 +240,10 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
 
     std::unique_ptr<IteratorBase> MakeIteratorInternal(
         const string& prefix) const override {
+      if (batch_size_ > 0) {
+        return absl::make_unique<BatchIterator>(BatchIterator::Params{
+            this, strings::StrCat(prefix, "::ParseExampleBatch")});
+      }
       std::unique_ptr<ParallelMapFunctor> parse_example_functor =
           absl::make_unique<ParseExampleFunctor>(this);
       return NewParallelMapIterator(
@@ -231,7 +264,15 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       return "ParseExampleDatasetOp::Dataset";
     }
 
-    int64 Cardinality() const override { return input_->Cardinality(); }
+    int64 Cardinality() const override {
+      int64 n = input_->Cardinality();
+      if (batch_size_ == 0 || n == kInfiniteCardinality ||
+          n == kUnknownCardinality) {
+        return n;
+      }
+      return n / batch_size_ +
+             (n % batch_size_ == 0 || drop_remainder_ ? 0 : 1);
+    }
 
     Status CheckExternalState() const override {
       return input_->CheckExternalState();
@@ -244,13 +285,26 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       Node* input_graph_node = nullptr;
       TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
 
-      Node* num_parallle_calls_node;
+      std::vector<std::pair<size_t, Node*>> scalar_inputs = {
+          {0, input_graph_node}};
+      if (batch_size_ > 0) {
+        Node* batch_size_node;
+        TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size_node));
+        Node* drop_remainder_node;
+        TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder_node));
+        scalar_inputs.emplace_back(1, batch_size_node);
+        scalar_inputs.emplace_back(2, drop_remainder_node);
+      } else {
+        Node* num_parallle_calls_node;
+        TF_RETURN_IF_ERROR(
+            b->AddScalar(num_parallel_calls_, &num_parallle_calls_node));
+        scalar_inputs.emplace_back(1, num_parallle_calls_node);
+      }
+      const size_t dense_defaults_index = scalar_inputs.size();
+
       std::vector<Node*> dense_defaults_nodes;
       dense_defaults_nodes.reserve(dense_defaults_.size());
 
-      TF_RETURN_IF_ERROR(
-          b->AddScalar(num_parallel_calls_, &num_parallle_calls_node));
-
       for (const Tensor& dense_default : dense_defaults_) {
         Node* node;
         TF_RETURN_IF_ERROR(b->AddTensor(dense_default, &node));
@@ -262,15 +316,24 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       AttrValue sparse_types_attr;
       AttrValue dense_attr;
       AttrValue dense_shapes_attr;
-      AttrValue sloppy_attr;
 
       b->BuildAttrValue(sparse_keys_, &sparse_keys_attr);
       b->BuildAttrValue(dense_keys_, &dense_keys_attr);
       b->BuildAttrValue(sparse_types_, &sparse_types_attr);
       b->BuildAttrValue(dense_types_, &dense_attr);
       b->BuildAttrValue(dense_shapes_, &dense_shapes_attr);
-      b->BuildAttrValue(sloppy_, &sloppy_attr);
 
+      std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+          {"sparse_keys", sparse_keys_attr},
+          {"dense_keys", dense_keys_attr},
+          {"sparse_types", sparse_types_attr},
+          {"Tdense", dense_attr},
+          {"dense_shapes", dense_shapes_attr}};
+      if (batch_size_ == 0) {
+        AttrValue sloppy_attr;
+        b->BuildAttrValue(sloppy_, &sloppy_attr);
+        attrs.emplace_back("sloppy", sloppy_attr);
+      }
       if (has_ragged_keys_) {
         AttrValue ragged_keys_attr;
         AttrValue ragged_value_types_attr;
@@ -278,39 +341,14 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         b->BuildAttrValue(ragged_keys_, &ragged_keys_attr);
         b->BuildAttrValue(ragged_value_types_, &ragged_value_types_attr);
         b->BuildAttrValue(ragged_split_types_, &ragged_split_types_attr);
-
-        TF_RETURN_IF_ERROR(
-            b->AddDataset(this,
-                          {
-                              {0, input_graph_node},
-                              {1, num_parallle_calls_node},
-                          },
-                          {{2, dense_defaults_nodes}},
-                          {{"sparse_keys", sparse_keys_attr},
-                           {"dense_keys", dense_keys_attr},
-                           {"sparse_types", sparse_types_attr},
-                           {"Tdense", dense_attr},
-                           {"dense_shapes", dense_shapes_attr},
-                           {"sloppy", sloppy_attr},
-                           {"ragged_keys", ragged_keys_attr},
-                           {"ragged_value_types", ragged_value_types_attr},
-                           {"ragged_split_types", ragged_split_types_attr}},
-                          output));
-      } else {
-        TF_RETURN_IF_ERROR(b->AddDataset(this,
-                                         {
-                                             {0, input_graph_node},
-                                             {1, num_parallle_calls_node},
-                                         },
-                                         {{2, dense_defaults_nodes}},
-                                         {{"sparse_keys", sparse_keys_attr},
-                                          {"dense_keys", dense_keys_attr},
-                                          {"sparse_types", sparse_types_attr},
-                                          {"Tdense", dense_attr},
-                                          {"dense_shapes", dense_shapes_attr},
-                                          {"sloppy", sloppy_attr}},
-                                         output));
+        attrs.emplace_back("ragged_keys", ragged_keys_attr);
+        attrs.emplace_back("ragged_value_types", ragged_value_types_attr);
+        attrs.emplace_back("ragged_split_types", ragged_split_types_attr);
       }
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, scalar_inputs, {{dense_defaults_index, dense_defaults_nodes}},
+          attrs, output));
       return Status::OK();
     }
 
@@ -326,108 +364,239 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         (*ctx->runner())([this, ctx, prefix, input, output, callback]() {
           thread::ThreadPool* device_threadpool =
               ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
-          std::vector<tstring> slice_vec;
+          // Parse views of the input strings rather than copies of them.
+          std::vector<absl::string_view> serialized;
           for (const Tensor& t : input) {
             auto serialized_t = t.flat<tstring>();
-            gtl::ArraySlice<tstring> slice(serialized_t.data(),
-                                           serialized_t.size());
-            for (auto it = slice.begin(); it != slice.end(); it++)
-              slice_vec.push_back(*it);
-          }
-          example::FastParseExampleConfig config = dataset_->config_;
-          // local copy of config_ for modification.
-          auto stats_aggregator = ctx->stats_aggregator();
-          if (stats_aggregator) {
-            config.collect_feature_stats = true;
+            serialized.insert(serialized.end(), serialized_t.data(),
+                              serialized_t.data() + serialized_t.size());
           }
           example::Result example_result;
-          Status s = FastParseExample(config, slice_vec, {}, device_threadpool,
-                                      &example_result);
+          Status s = dataset_->Parse(ctx, serialized, device_threadpool,
+                                     &example_result);
           if (s.ok()) {
-            (*output).resize(dataset_->key_to_output_index_.size());
-            for (int d = 0; d < dataset_->dense_keys_.size(); ++d) {
-              int output_index =
-                  dataset_->key_to_output_index_.at(dataset_->dense_keys_[d]);
-              CheckOutputTensor(example_result.dense_values[d], d,
-                                output_index);
-              (*output)[output_index] = example_result.dense_values[d];
-            }
-            for (int d = 0; d < dataset_->sparse_keys_.size(); ++d) {
-              int output_index =
-                  dataset_->key_to_output_index_.at(dataset_->sparse_keys_[d]);
-              (*output)[output_index] =
-                  Tensor(ctx->allocator({}), DT_VARIANT, {3});
-              Tensor& serialized_sparse = (*output)[output_index];
-              auto serialized_sparse_t = serialized_sparse.vec<Variant>();
-              serialized_sparse_t(0) = example_result.sparse_indices[d];
-              serialized_sparse_t(1) = example_result.sparse_values[d];
-              serialized_sparse_t(2) = example_result.sparse_shapes[d];
-              CheckOutputTensor(serialized_sparse, d, output_index);
-            }
-            for (int d = 0; d < dataset_->ragged_keys_.size(); ++d) {
-              int output_index =
-                  dataset_->key_to_output_index_.at(dataset_->ragged_keys_[d]);
-              (*output)[output_index] =
-                  Tensor(ctx->allocator({}), DT_VARIANT, {});
-              Tensor serialized_ragged =
-                  Tensor(ctx->allocator({}), DT_VARIANT, {2});
-              auto serialized_ragged_t = serialized_ragged.vec<Variant>();
-              serialized_ragged_t(0) = example_result.ragged_splits[d];
-              serialized_ragged_t(1) = example_result.ragged_values[d];
-              (*output)[output_index] =
-                  Tensor(ctx->allocator({}), DT_VARIANT, {});
-              Tensor& ragged_wrapper = (*output)[output_index];
-              ragged_wrapper.scalar<Variant>()() = serialized_ragged;
-              CheckOutputTensor(ragged_wrapper, d, output_index);
-            }
-            if (stats_aggregator) {
-              stats_aggregator->IncrementCounter(
-                  stats_utils::kExamplesCount, "trainer",
-                  example_result.feature_stats.size());
-              for (example::PerExampleFeatureStats feature_stats :
-                   example_result.feature_stats) {
-                stats_aggregator->IncrementCounter(
-                    stats_utils::kFeaturesCount, "trainer",
-                    feature_stats.features_count);
-                stats_aggregator->IncrementCounter(
-                    stats_utils::kFeatureValuesCount, "trainer",
-                    feature_stats.feature_values_count);
-                int64 steps = ctx->model()->NumElements(prefix);
-                stats_aggregator->AddToHistogram(
-                    stats_utils::FeatureHistogramName(dataset_->node_name()),
-                    {static_cast<double>(feature_stats.features_count)}, steps);
-
-                stats_aggregator->AddToHistogram(
-                    stats_utils::FeatureValueHistogramName(
-                        dataset_->node_name()),
-                    {static_cast<double>(feature_stats.feature_values_count)},
-                    steps);
-              }
-            }
+            dataset_->ResultToElement(ctx, &example_result, output);
+            dataset_->RecordStats(ctx, prefix, example_result);
           }
           callback(s);
         });
       }
 
      private:
-      inline void CheckOutputTensor(const Tensor& tensor, size_t value_index,
-                                    size_t output_index) const {
-        DCHECK(tensor.dtype() == dataset_->output_dtypes()[output_index])
-            << "Got wrong type for FastParseExample return value "
-            << value_index << " (expected "
-            << DataTypeString(dataset_->output_dtypes()[output_index])
-            << ", got " << DataTypeString(tensor.dtype()) << ").";
-        DCHECK(dataset_->output_shapes()[output_index].IsCompatibleWith(
-            tensor.shape()))
-            << "Got wrong shape for FastParseExample return value "
-            << value_index << " (expected "
-            << dataset_->output_shapes()[output_index].DebugString() << ", got "
-            << tensor.shape().DebugString() << ").";
+      const Dataset* dataset_;
+    };
+
+    // Batches `batch_size` scalar serialized examples from the input and
+    // parses the whole batch with a single `FastParseExample` call, which
+    // writes fixed-length dense features directly into the output tensors.
+    class BatchIterator : public DatasetIterator<Dataset> {
+     public:
+      explicit BatchIterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        if (ctx->thread_pool()) {
+          owned_thread_pool_ = ctx->CreateThreadPool(
+              "data_parse_example_batch", ctx->runner_threadpool_size());
+          thread_pool_ = owned_thread_pool_.get();
+        } else {
+          thread_pool_ =
+              ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
+        }
+        return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
       }
 
-      const Dataset* dataset_;
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        std::vector<std::vector<Tensor>> batch_elements;
+        {
+          mutex_lock l(mu_);
+          if (!input_impl_) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          batch_elements.reserve(dataset()->batch_size_);
+          *end_of_sequence = false;
+          for (int64 i = 0; i < dataset()->batch_size_ && !*end_of_sequence;
+               ++i) {
+            std::vector<Tensor> batch_element_tuple;
+            TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &batch_element_tuple,
+                                                    end_of_sequence));
+            if (!*end_of_sequence) {
+              batch_elements.emplace_back(std::move(batch_element_tuple));
+            } else {
+              input_impl_.reset();
+            }
+          }
+        }
+
+        if (batch_elements.empty()) {
+          DCHECK(*end_of_sequence);
+          return Status::OK();
+        }
+
+        if (dataset()->drop_remainder_ &&
+            batch_elements.size() < dataset()->batch_size_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+        // The views remain valid for as long as `batch_elements` holds a
+        // reference to the input tensors.
+        std::vector<absl::string_view> serialized;
+        serialized.reserve(batch_elements.size());
+        for (const std::vector<Tensor>& element : batch_elements) {
+          if (element.size() != 1 || element[0].dtype() != DT_STRING ||
+              !TensorShapeUtils::IsScalar(element[0].shape())) {
+            return errors::InvalidArgument(
+                "ParseExampleBatchDataset expects each input element to be a "
+                "scalar string, but got an element with ",
+                element.size(), " component(s), the first of which has type ",
+                element.empty() ? "<none>" : DataTypeString(element[0].dtype()),
+                " and shape ",
+                element.empty() ? "<none>" : element[0].shape().DebugString(),
+                ".");
+          }
+          serialized.emplace_back(element[0].scalar<tstring>()());
+        }
+
+        example::Result example_result;
+        TF_RETURN_IF_ERROR(
+            dataset()->Parse(ctx, serialized, thread_pool_, &example_result));
+        dataset()->ResultToElement(ctx, &example_result, out_tensors);
+        dataset()->RecordStats(ctx, prefix(), example_result);
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         dataset()->batch_size_);
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        if (!input_impl_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kInputImplEmpty), ""));
+        } else {
+          TF_RETURN_IF_ERROR(SaveInput(writer, input_impl_));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        if (!reader->Contains(full_name(kInputImplEmpty))) {
+          TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+        } else {
+          input_impl_.reset();
+        }
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      // Not owned unless it was created by `Initialize()`, in which case it is
+      // also held by `owned_thread_pool_`.
+      thread::ThreadPool* thread_pool_ = nullptr;
+      std::unique_ptr<thread::ThreadPool> owned_thread_pool_;
     };
 
+    Status Parse(IteratorContext* ctx,
+                 gtl::ArraySlice<absl::string_view> serialized,
+                 thread::ThreadPool* thread_pool,
+                 example::Result* example_result) const {
+      if (ctx->stats_aggregator()) {
+        // Local copy of `config_` for modification.
+        example::FastParseExampleConfig config = config_;
+        config.collect_feature_stats = true;
+        return FastParseExample(config, serialized, {}, thread_pool,
+                                example_result);
+      }
+      return FastParseExample(config_, serialized, {}, thread_pool,
+                              example_result);
+    }
+
+    // Converts the parsed features in `example_result` into the components of
+    // an output element, ordered by feature key.
+    void ResultToElement(IteratorContext* ctx, example::Result* example_result,
+                         std::vector<Tensor>* output) const {
+      output->resize(key_to_output_index_.size());
+      for (int d = 0; d < dense_keys_.size(); ++d) {
+        int output_index = key_to_output_index_.at(dense_keys_[d]);
+        CheckOutputTensor(example_result->dense_values[d], d, output_index);
+        (*output)[output_index] = std::move(example_result->dense_values[d]);
+      }
+      for (int d = 0; d < sparse_keys_.size(); ++d) {
+        int output_index = key_to_output_index_.at(sparse_keys_[d]);
+        (*output)[output_index] = Tensor(ctx->allocator({}), DT_VARIANT, {3});
+        Tensor& serialized_sparse = (*output)[output_index];
+        auto serialized_sparse_t = serialized_sparse.vec<Variant>();
+        serialized_sparse_t(0) = example_result->sparse_indices[d];
+        serialized_sparse_t(1) = example_result->sparse_values[d];
+        serialized_sparse_t(2) = example_result->sparse_shapes[d];
+        CheckOutputTensor(serialized_sparse, d, output_index);
+      }
+      for (int d = 0; d < ragged_keys_.size(); ++d) {
+        int output_index = key_to_output_index_.at(ragged_keys_[d]);
+        Tensor serialized_ragged = Tensor(ctx->allocator({}), DT_VARIANT, {2});
+        auto serialized_ragged_t = serialized_ragged.vec<Variant>();
+        serialized_ragged_t(0) = example_result->ragged_splits[d];
+        serialized_ragged_t(1) = example_result->ragged_values[d];
+        (*output)[output_index] = Tensor(ctx->allocator({}), DT_VARIANT, {});
+        Tensor& ragged_wrapper = (*output)[output_index];
+        ragged_wrapper.scalar<Variant>()() = serialized_ragged;
+        CheckOutputTensor(ragged_wrapper, d, output_index);
+      }
+    }
+
+    void RecordStats(IteratorContext* ctx, const string& prefix,
+                     const example::Result& example_result) const {
+      auto stats_aggregator = ctx->stats_aggregator();
+      if (!stats_aggregator) {
+        return;
+      }
+      stats_aggregator->IncrementCounter(stats_utils::kExamplesCount,
+                                         "trainer",
+                                         example_result.feature_stats.size());
+      for (example::PerExampleFeatureStats feature_stats :
+           example_result.feature_stats) {
+        stats_aggregator->IncrementCounter(stats_utils::kFeaturesCount,
+                                           "trainer",
+                                           feature_stats.features_count);
+        stats_aggregator->IncrementCounter(stats_utils::kFeatureValuesCount,
+                                           "trainer",
+                                           feature_stats.feature_values_count);
+        int64 steps = ctx->model()->NumElements(prefix);
+        stats_aggregator->AddToHistogram(
+            stats_utils::FeatureHistogramName(node_name()),
+            {static_cast<double>(feature_stats.features_count)}, steps);
+
+        stats_aggregator->AddToHistogram(
+            stats_utils::FeatureValueHistogramName(node_name()),
+            {static_cast<double>(feature_stats.feature_values_count)}, steps);
+      }
+    }
+
+    inline void CheckOutputTensor(const Tensor& tensor, size_t value_index,
+                                  size_t output_index) const {
+      DCHECK(tensor.dtype() == output_dtypes()[output_index])
+          << "Got wrong type for FastParseExample return value " << value_index
+          << " (expected " << DataTypeString(output_dtypes()[output_index])
+          << ", got " << DataTypeString(tensor.dtype()) << ").";
+      DCHECK(output_shapes()[output_index].IsCompatibleWith(tensor.shape()))
+          << "Got wrong shape for FastParseExample return value "
+          << value_index << " (expected "
+          << output_shapes()[output_index].DebugString() << ", got "
+          << tensor.shape().DebugString() << ").";
+    }
+
     const DatasetBase* const input_;
     const std::vector<Tensor> dense_defaults_;
     const std::vector<string> sparse_keys_;
@@ -436,6 +605,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     const std::map<string, int> key_to_output_index_;
     const example::FastParseExampleConfig config_;
     const int64 num_parallel_calls_;
+    // Zero unless the dataset implements `ParseExampleBatchDataset`.
+    const int64 batch_size_;
+    const bool drop_remainder_;
     const DataTypeVector sparse_types_;
     const DataTypeVector dense_types_;
     const DataTypeVector ragged_value_types_;
@@ -448,9 +620,10 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
   };
 
   const int graph_def_version_;
+  const bool fuse_batch_;
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
-  bool sloppy_;
+  bool sloppy_ = false;
   std::vector<string> sparse_keys_;
   std::vector<string> dense_keys_;
   std::vector<string> ragged_keys_;
@@ -464,11 +637,19 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
   bool has_ragged_keys_;
 };
 
+class ParseExampleBatchDatasetOp : public ParseExampleDatasetOp {
+ public:
+  explicit ParseExampleBatchDatasetOp(OpKernelConstruction* ctx)
+      : ParseExampleDatasetOp(ctx, /*fuse_batch=*/true) {}
+};
+
 REGISTER_KERNEL_BUILDER(Name("ParseExampleDataset").Device(DEVICE_CPU),
                         ParseExampleDatasetOp);
 REGISTER_KERNEL_BUILDER(
     Name("ExperimentalParseExampleDataset").Device(DEVICE_CPU),
     ParseExampleDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("ParseExampleBatchDataset").Device(DEVICE_CPU),
+                        ParseExampleBatchDatasetOp);
 
 }  // namespace
 }  // namespace experimental
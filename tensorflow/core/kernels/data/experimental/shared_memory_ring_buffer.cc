@@ -0,0 +1,526 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !PLATFORM_WINDOWS
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr uint64 kMagic = 0x74667368726e6732ULL;  // "tfshrng2"
+constexpr uint64 kAlignment = 8;
+// Each record is preceded by its length.
+constexpr uint64 kLengthSize = sizeof(uint64);
+// Written in place of a length when the next record starts at offset 0.
+constexpr uint64 kWrapMarker = ~0ULL;
+constexpr uint64 kMinCapacity = 64;
+constexpr size_t kMaxErrorMessageSize = 1024;
+constexpr int64 kMinBackoffMicros = 10;
+constexpr int64 kMaxBackoffMicros = 1000;
+// Bounds a wait on a `WakeupPipe`, in case the other side exits without
+// writing to it.
+constexpr int64 kMaxWaitMicros = 1000 * 1000;
+
+// The positions are shared between processes, so they must not be
+// implemented with a lock.
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "uint64 atomics must be lock-free");
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "int32 atomics must be lock-free");
+
+uint64 RoundUp(uint64 size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint64 LoadLength(const char* data) {
+  uint64 length;
+  memcpy(&length, data, sizeof(length));
+  return length;
+}
+
+void StoreLength(uint64 length, char* data) {
+  memcpy(data, &length, sizeof(length));
+}
+
+}  // namespace
+
+// The header at the start of the segment. `write_pos` and `read_pos` count the
+// bytes ever written and released; each is written by one side only and is
+// kept on its own cache line. A side sets its `*_waiting` flag before it
+// blocks on its pipe, and the other side clears it when it writes to the pipe.
+struct SharedMemoryRingBuffer::Header {
+  uint64 magic;
+  uint64 capacity;
+  alignas(64) std::atomic<uint64> write_pos;
+  alignas(64) std::atomic<uint64> read_pos;
+  alignas(64) std::atomic<int32> producer_state;
+  std::atomic<int32> consumer_waiting;
+  std::atomic<int32> producer_waiting;
+  int32 error_code;
+  char error_message[kMaxErrorMessageSize];
+};
+
+SharedMemoryRingBuffer::SharedMemoryRingBuffer(const string& name, bool owner,
+                                               int fd, char* base,
+                                               uint64 mapped_size)
+    : name_(name),
+      owner_(owner),
+      fd_(fd),
+      base_(base),
+      mapped_size_(mapped_size),
+      header_(reinterpret_cast<Header*>(base)),
+      data_(base + sizeof(Header)) {}
+
+SharedMemoryRingBuffer::~SharedMemoryRingBuffer() {
+#if !defined(PLATFORM_WINDOWS)
+  munmap(base_, mapped_size_);
+  close(fd_);
+  if (owner_) shm_unlink(name_.c_str());
+#endif  // !PLATFORM_WINDOWS
+}
+
+Status SharedMemoryRingBuffer::Create(
+    const string& name, uint64 capacity,
+    std::unique_ptr<SharedMemoryRingBuffer>* buffer) {
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented(
+      "Shared memory ring buffers are not supported on Windows.");
+#else
+  capacity = std::max(RoundUp(capacity), kMinCapacity);
+  const uint64 mapped_size = sizeof(Header) + capacity;
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::Unavailable("Failed to create shared memory segment ",
+                               name, ": ", strerror(errno));
+  }
+  if (ftruncate(fd, mapped_size) != 0) {
+    const int error = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    return errors::ResourceExhausted("Failed to allocate ", mapped_size,
+                                     " bytes of shared memory for ", name,
+                                     ": ", strerror(error));
+  }
+  void* base =
+      mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    const int error = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    return errors::ResourceExhausted("Failed to map shared memory segment ",
+                                     name, ": ", strerror(error));
+  }
+  Header* header = new (base) Header;
+  header->capacity = capacity;
+  header->write_pos.store(0, std::memory_order_relaxed);
+  header->read_pos.store(0, std::memory_order_relaxed);
+  header->producer_state.store(static_cast<int32>(ProducerState::kRunning),
+                               std::memory_order_relaxed);
+  header->consumer_waiting.store(0, std::memory_order_relaxed);
+  header->producer_waiting.store(0, std::memory_order_relaxed);
+  header->error_code = 0;
+  header->error_message[0] = '\0';
+  // The magic number marks the segment as initialized for `Open()`.
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+  buffer->reset(new SharedMemoryRingBuffer(
+      name, /*owner=*/true, fd, static_cast<char*>(base), mapped_size));
+  return Status::OK();
+#endif  // PLATFORM_WINDOWS
+}
+
+Status SharedMemoryRingBuffer::Open(
+    const string& name, std::unique_ptr<SharedMemoryRingBuffer>* buffer) {
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented(
+      "Shared memory ring buffers are not supported on Windows.");
+#else
+  const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::NotFound("Failed to open shared memory segment ", name,
+                            ": ", strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<uint64>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    return errors::DataLoss("Shared memory segment ", name,
+                            " is not a ring buffer.");
+  }
+  const uint64 mapped_size = st.st_size;
+  void* base =
+      mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    const int error = errno;
+    close(fd);
+    return errors::ResourceExhausted("Failed to map shared memory segment ",
+                                     name, ": ", strerror(error));
+  }
+  const Header* header = static_cast<const Header*>(base);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->magic != kMagic ||
+      header->capacity + sizeof(Header) != mapped_size) {
+    munmap(base, mapped_size);
+    close(fd);
+    return errors::DataLoss("Shared memory segment ", name,
+                            " is not a ring buffer.");
+  }
+  buffer->reset(new SharedMemoryRingBuffer(
+      name, /*owner=*/false, fd, static_cast<char*>(base), mapped_size));
+  return Status::OK();
+#endif  // PLATFORM_WINDOWS
+}
+
+/* static */ uint64 SharedMemoryRingBuffer::MaxRecordSize(uint64 capacity) {
+  return std::max(RoundUp(capacity), kMinCapacity) - kLengthSize;
+}
+
+uint64 SharedMemoryRingBuffer::capacity() const { return header_->capacity; }
+
+void SharedMemoryRingBuffer::SetWakeupFds(int wait_fd, int wake_fd) {
+  wait_fd_ = wait_fd;
+  wake_fd_ = wake_fd;
+}
+
+void SharedMemoryRingBuffer::WakeIfWaiting(std::atomic<int32>* waiting) {
+  if (wake_fd_ < 0) return;
+  // Pairs with the fence of the waiting side: either it sees the change that
+  // this side made before the call, or this side sees its flag.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting->load(std::memory_order_relaxed) != 0 &&
+      waiting->exchange(0, std::memory_order_relaxed) != 0) {
+    WakeupPipe::Wake(wake_fd_);
+  }
+}
+
+Status SharedMemoryRingBuffer::Reserve(uint64 size, char** data) {
+  const uint64 capacity = header_->capacity;
+  const uint64 record_size = kLengthSize + RoundUp(size);
+  if (record_size > capacity) {
+    return errors::InvalidArgument("A record of ", size,
+                                   " bytes does not fit in a ring buffer of ",
+                                   capacity, " bytes.");
+  }
+  int64 backoff_micros = kMinBackoffMicros;
+  // Waits until the consumer has released all but `capacity` bytes before
+  // `end_pos`.
+  auto wait_for_space = [this, capacity, &backoff_micros](uint64 end_pos) {
+    auto has_space = [this, capacity, end_pos]() {
+      return end_pos - header_->read_pos.load(std::memory_order_acquire) <=
+             capacity;
+    };
+    while (!has_space()) {
+      if (wait_fd_ < 0) {
+        Env::Default()->SleepForMicroseconds(backoff_micros);
+        backoff_micros = std::min(2 * backoff_micros, kMaxBackoffMicros);
+        continue;
+      }
+      // Announces the wait before checking again, so that a release in
+      // between is either seen here or wakes the pipe.
+      header_->producer_waiting.store(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (has_space()) break;
+      WakeupPipe::Wait(wait_fd_, kMaxWaitMicros);
+    }
+  };
+
+  uint64 pos = header_->write_pos.load(std::memory_order_relaxed);
+  uint64 offset = pos % capacity;
+  if (offset + record_size > capacity) {
+    // Records are contiguous, so skip the rest of the buffer.
+    const uint64 tail_size = capacity - offset;
+    wait_for_space(pos + tail_size);
+    StoreLength(kWrapMarker, data_ + offset);
+    pos += tail_size;
+    offset = 0;
+    header_->write_pos.store(pos, std::memory_order_release);
+  }
+  wait_for_space(pos + record_size);
+  reserved_pos_ = pos;
+  *data = data_ + offset + kLengthSize;
+  return Status::OK();
+}
+
+void SharedMemoryRingBuffer::Commit(uint64 size) {
+  const uint64 offset = reserved_pos_ % header_->capacity;
+  StoreLength(size, data_ + offset);
+  header_->write_pos.store(reserved_pos_ + kLengthSize + RoundUp(size),
+                           std::memory_order_release);
+  WakeIfWaiting(&header_->consumer_waiting);
+}
+
+void SharedMemoryRingBuffer::SetEndOfSequence() {
+  header_->producer_state.store(
+      static_cast<int32>(ProducerState::kEndOfSequence),
+      std::memory_order_release);
+  WakeIfWaiting(&header_->consumer_waiting);
+}
+
+void SharedMemoryRingBuffer::SetError(const Status& status) {
+  DCHECK(!status.ok());
+  header_->error_code = status.code();
+  const size_t length =
+      std::min(status.error_message().size(), kMaxErrorMessageSize - 1);
+  memcpy(header_->error_message, status.error_message().data(), length);
+  header_->error_message[length] = '\0';
+  header_->producer_state.store(static_cast<int32>(ProducerState::kError),
+                                std::memory_order_release);
+  WakeIfWaiting(&header_->consumer_waiting);
+}
+
+SharedMemoryRingBuffer::ProducerState SharedMemoryRingBuffer::producer_state()
+    const {
+  return static_cast<ProducerState>(
+      header_->producer_state.load(std::memory_order_acquire));
+}
+
+Status SharedMemoryRingBuffer::producer_status() const {
+  if (producer_state() != ProducerState::kError) return Status::OK();
+  return Status(static_cast<error::Code>(header_->error_code),
+                header_->error_message);
+}
+
+bool SharedMemoryRingBuffer::Peek(StringPiece* record) {
+  const uint64 capacity = header_->capacity;
+  uint64 pos = header_->read_pos.load(std::memory_order_relaxed);
+  while (pos != header_->write_pos.load(std::memory_order_acquire)) {
+    const uint64 offset = pos % capacity;
+    const uint64 length = LoadLength(data_ + offset);
+    if (length == kWrapMarker) {
+      pos += capacity - offset;
+      header_->read_pos.store(pos, std::memory_order_release);
+      WakeIfWaiting(&header_->producer_waiting);
+      continue;
+    }
+    *record = StringPiece(data_ + offset + kLengthSize, length);
+    peeked_end_pos_ = pos + kLengthSize + RoundUp(length);
+    return true;
+  }
+  return false;
+}
+
+void SharedMemoryRingBuffer::Release() {
+  header_->read_pos.store(peeked_end_pos_, std::memory_order_release);
+  WakeIfWaiting(&header_->producer_waiting);
+}
+
+void SharedMemoryRingBuffer::RequestWakeup() {
+  header_->consumer_waiting.store(1, std::memory_order_relaxed);
+  // Pairs with the fence in `WakeIfWaiting()`.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+WakeupPipe::~WakeupPipe() {
+#if !defined(PLATFORM_WINDOWS)
+  close(read_fd_);
+  close(write_fd_);
+#endif  // !PLATFORM_WINDOWS
+}
+
+Status WakeupPipe::Create(std::unique_ptr<WakeupPipe>* pipe) {
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented("Wakeup pipes are not supported on Windows.");
+#else
+  int fds[2];
+  if (::pipe(fds) != 0) {
+    return errors::Unavailable("Failed to create a pipe: ", strerror(errno));
+  }
+  for (int fd : fds) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+  pipe->reset(new WakeupPipe(fds[0], fds[1]));
+  return Status::OK();
+#endif  // PLATFORM_WINDOWS
+}
+
+/* static */ void WakeupPipe::Wake(int write_fd) {
+#if !defined(PLATFORM_WINDOWS)
+  // A full pipe already holds a wakeup.
+  const char byte = 0;
+  while (write(write_fd, &byte, 1) < 0 && errno == EINTR) {
+  }
+#endif  // !PLATFORM_WINDOWS
+}
+
+/* static */ void WakeupPipe::Wait(int read_fd, int64 timeout_micros) {
+#if !defined(PLATFORM_WINDOWS)
+  struct pollfd poll_fd;
+  poll_fd.fd = read_fd;
+  poll_fd.events = POLLIN;
+  poll_fd.revents = 0;
+  poll(&poll_fd, 1, (timeout_micros + 999) / 1000);
+  char bytes[64];
+  while (read(read_fd, bytes, sizeof(bytes)) > 0) {
+  }
+#endif  // !PLATFORM_WINDOWS
+}
+
+void WakeupPipe::SetInheritable(bool read_end, bool write_end) {
+#if !defined(PLATFORM_WINDOWS)
+  fcntl(read_fd_, F_SETFD, read_end ? 0 : FD_CLOEXEC);
+  fcntl(write_fd_, F_SETFD, write_end ? 0 : FD_CLOEXEC);
+#endif  // !PLATFORM_WINDOWS
+}
+
+// The encoding of a list of tensors is the number of tensors, followed by the
+// dtype, rank, dimensions and contents of each tensor. Memcpy-able tensors are
+// stored as their buffer, and string tensors as the length and bytes of each
+// element.
+namespace {
+
+template <typename T>
+void Put(const T& value, char** data) {
+  memcpy(*data, &value, sizeof(T));
+  *data += sizeof(T);
+}
+
+class Decoder {
+ public:
+  explicit Decoder(StringPiece data) : data_(data) {}
+
+  template <typename T>
+  bool Get(T* value) {
+    return GetBytes(reinterpret_cast<char*>(value), sizeof(T));
+  }
+
+  bool GetBytes(char* dst, uint64 size) {
+    if (data_.size() < size) return false;
+    memcpy(dst, data_.data(), size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+  bool done() const { return data_.empty(); }
+
+ private:
+  StringPiece data_;
+};
+
+}  // namespace
+
+Status EncodedTensorsSize(const std::vector<Tensor>& tensors, uint64* size) {
+  uint64 total = sizeof(uint64);
+  for (const Tensor& t : tensors) {
+    total += 2 * sizeof(int32) + t.dims() * sizeof(int64);
+    if (DataTypeCanUseMemcpy(t.dtype())) {
+      total += t.TotalBytes();
+    } else if (t.dtype() == DT_STRING) {
+      const auto flat = t.flat<tstring>();
+      total += flat.size() * sizeof(uint64);
+      for (int64 i = 0; i < flat.size(); ++i) {
+        total += flat(i).size();
+      }
+    } else {
+      return errors::Unimplemented("Cannot encode tensors of type ",
+                                   DataTypeString(t.dtype()),
+                                   " in shared memory.");
+    }
+  }
+  *size = total;
+  return Status::OK();
+}
+
+void EncodeTensors(const std::vector<Tensor>& tensors, char* data) {
+  Put<uint64>(tensors.size(), &data);
+  for (const Tensor& t : tensors) {
+    Put<int32>(t.dtype(), &data);
+    Put<int32>(t.dims(), &data);
+    for (int i = 0; i < t.dims(); ++i) {
+      Put<int64>(t.dim_size(i), &data);
+    }
+    if (t.dtype() == DT_STRING) {
+      const auto flat = t.flat<tstring>();
+      for (int64 i = 0; i < flat.size(); ++i) {
+        Put<uint64>(flat(i).size(), &data);
+        memcpy(data, flat(i).data(), flat(i).size());
+        data += flat(i).size();
+      }
+    } else {
+      const StringPiece bytes = t.tensor_data();
+      memcpy(data, bytes.data(), bytes.size());
+      data += bytes.size();
+    }
+  }
+}
+
+Status DecodeTensors(Allocator* allocator, StringPiece data,
+                     std::vector<Tensor>* tensors) {
+  const auto corrupt = [] {
+    return errors::DataLoss("Corrupt tensors in shared memory.");
+  };
+  Decoder decoder(data);
+  uint64 num_tensors;
+  if (!decoder.Get(&num_tensors) || num_tensors > data.size()) {
+    return corrupt();
+  }
+  tensors->clear();
+  tensors->reserve(num_tensors);
+  for (uint64 i = 0; i < num_tensors; ++i) {
+    int32 dtype;
+    int32 rank;
+    if (!decoder.Get(&dtype) || !decoder.Get(&rank) || rank < 0 ||
+        rank > TensorShape::MaxDimensions()) {
+      return corrupt();
+    }
+    gtl::InlinedVector<int64, 4> dims(rank);
+    for (int32 d = 0; d < rank; ++d) {
+      if (!decoder.Get(&dims[d])) return corrupt();
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShapeUtils::MakeShape(dims, &shape));
+    const DataType type = static_cast<DataType>(dtype);
+    if (!DataTypeCanUseMemcpy(type) && type != DT_STRING) return corrupt();
+    tensors->emplace_back(allocator, type, shape);
+    Tensor& t = tensors->back();
+    if (type == DT_STRING) {
+      auto flat = t.flat<tstring>();
+      for (int64 j = 0; j < flat.size(); ++j) {
+        uint64 length;
+        if (!decoder.Get(&length) || length > data.size()) return corrupt();
+        flat(j).resize(length);
+        if (!decoder.GetBytes(&flat(j)[0], length)) return corrupt();
+      }
+    } else {
+      const StringPiece bytes = t.tensor_data();
+      if (!decoder.GetBytes(const_cast<char*>(bytes.data()), bytes.size())) {
+        return corrupt();
+      }
+    }
+  }
+  if (!decoder.done()) return corrupt();
+  return Status::OK();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
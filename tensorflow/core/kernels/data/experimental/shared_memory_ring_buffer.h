@@ -0,0 +1,190 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A single-producer, single-consumer queue of variable-sized records in a
+// named POSIX shared memory segment, used to pass dataset elements from a
+// worker process to the process that consumes them.
+//
+// The consumer creates the segment and the producer attaches to it by name.
+// Records are written in place: the producer reserves space for a record,
+// fills it and commits it, and the consumer reads a record in place and
+// then releases it. Neither side blocks the other on a lock. A side that has
+// to wait for the other blocks on a `WakeupPipe`, which the other side writes
+// to once it has made progress; without one, a full producer polls.
+class SharedMemoryRingBuffer {
+ public:
+  enum class ProducerState { kRunning, kEndOfSequence, kError };
+
+  ~SharedMemoryRingBuffer();
+
+  // Creates a segment named `name` with room for `capacity` bytes of records.
+  // The segment is removed when the returned buffer is destroyed.
+  static Status Create(const string& name, uint64 capacity,
+                       std::unique_ptr<SharedMemoryRingBuffer>* buffer);
+
+  // Attaches to the segment named `name`, created by `Create()`.
+  static Status Open(const string& name,
+                     std::unique_ptr<SharedMemoryRingBuffer>* buffer);
+
+  // The largest record that fits in a buffer of `capacity` bytes.
+  static uint64 MaxRecordSize(uint64 capacity);
+
+  // Lets this side block instead of polling while it waits for the other.
+  // `wait_fd` is the read end of this side's `WakeupPipe`, and `wake_fd` the
+  // write end of the other side's, which the buffer writes to when the other
+  // side waits. Both must stay open while the buffer is in use.
+  void SetWakeupFds(int wait_fd, int wake_fd);
+
+  // Producer methods.
+
+  // Waits until `size` contiguous bytes are free and sets `*data` to point at
+  // them. Returns an error if the record can never fit. Wakes the consumer, if
+  // it waits, after `Commit()`, `SetEndOfSequence()` and `SetError()`.
+  Status Reserve(uint64 size, char** data);
+  // Publishes the record written to the space returned by the last call to
+  // `Reserve()`. `size` must not exceed the reserved size.
+  void Commit(uint64 size);
+  // Marks the end of the records. Must be called at most once, and not
+  // together with `SetError()`.
+  void SetEndOfSequence();
+  // Reports an error to the consumer in place of further records.
+  void SetError(const Status& status);
+
+  // Consumer methods.
+
+  // Returns the state of the producer. Records committed before the producer
+  // changed its state are visible to `Peek()` once this returns.
+  ProducerState producer_state() const;
+  // The error reported by the producer, if `producer_state()` is kError.
+  Status producer_status() const;
+  // Returns false if no record is available. Otherwise sets `*record` to the
+  // oldest record, which stays valid until the next call to `Release()`.
+  bool Peek(StringPiece* record);
+  // Releases the record returned by the last call to `Peek()`.
+  void Release();
+  // Asks the producer to wake the consumer's pipe after its next commit or
+  // change of state. The consumer must check `Peek()` and `producer_state()`
+  // again after this call and before it waits, or it may miss a record.
+  void RequestWakeup();
+
+  const string& name() const { return name_; }
+  uint64 capacity() const;
+
+ private:
+  struct Header;
+
+  SharedMemoryRingBuffer(const string& name, bool owner, int fd, char* base,
+                         uint64 mapped_size);
+
+  // Writes to `wake_fd_` if `*waiting` shows that the other side waits for
+  // the change just made by this side.
+  void WakeIfWaiting(std::atomic<int32>* waiting);
+
+  const string name_;
+  const bool owner_;
+  const int fd_;
+  char* const base_;
+  const uint64 mapped_size_;
+  Header* const header_;
+  char* const data_;
+
+  // The position of the record reserved by the producer.
+  uint64 reserved_pos_ = 0;
+  // The position after the record peeked by the consumer.
+  uint64 peeked_end_pos_ = 0;
+
+  int wait_fd_ = -1;
+  int wake_fd_ = -1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryRingBuffer);
+};
+
+// A non-blocking pipe that a process blocks on until another process, or
+// another thread, writes to it. One pipe can wake a consumer that waits for
+// any of several ring buffers.
+class WakeupPipe {
+ public:
+  ~WakeupPipe();
+
+  // Creates a pipe whose ends are closed when this process executes another
+  // program.
+  static Status Create(std::unique_ptr<WakeupPipe>* pipe);
+
+  // Writes to the pipe whose write end is `write_fd`. Never blocks.
+  static void Wake(int write_fd);
+  // Waits until the pipe whose read end is `read_fd` has been written to
+  // since it was last drained, or for at most `timeout_micros`, and drains
+  // it. May return early.
+  static void Wait(int read_fd, int64 timeout_micros);
+
+  void Wake() { Wake(write_fd_); }
+  void Wait(int64 timeout_micros) { Wait(read_fd_, timeout_micros); }
+
+  // Sets whether each end is inherited by the programs that this process
+  // executes.
+  void SetInheritable(bool read_end, bool write_end);
+
+  int read_fd() const { return read_fd_; }
+  int write_fd() const { return write_fd_; }
+
+ private:
+  WakeupPipe(int read_fd, int write_fd)
+      : read_fd_(read_fd), write_fd_(write_fd) {}
+
+  const int read_fd_;
+  const int write_fd_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WakeupPipe);
+};
+
+// Returns the number of bytes that `EncodeTensors()` writes for `tensors`, or
+// an error if they contain a type that cannot be encoded. Numeric, boolean
+// and string tensors are supported.
+Status EncodedTensorsSize(const std::vector<Tensor>& tensors, uint64* size);
+
+// Writes the dtypes, shapes and contents of `tensors` to `data`, which must
+// hold `EncodedTensorsSize()` bytes. Unlike `TensorProto`, the encoding is a
+// flat copy of the tensor buffers.
+void EncodeTensors(const std::vector<Tensor>& tensors, char* data);
+
+// Decodes tensors written by `EncodeTensors()`, allocating them with
+// `allocator`.
+Status DecodeTensors(Allocator* allocator, StringPiece data,
+                     std::vector<Tensor>* tensors);
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
@@ -0,0 +1,270 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+
+#include <memory>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+string UniqueName() {
+  return strings::StrCat("/tf_ring_buffer_test_",
+                         strings::Hex(random::New64()));
+}
+
+// Opens a second mapping of `consumer`'s segment, as a worker process would.
+std::unique_ptr<SharedMemoryRingBuffer> OpenProducer(
+    const SharedMemoryRingBuffer& consumer) {
+  std::unique_ptr<SharedMemoryRingBuffer> producer;
+  TF_CHECK_OK(SharedMemoryRingBuffer::Open(consumer.name(), &producer));
+  return producer;
+}
+
+void Write(StringPiece record, SharedMemoryRingBuffer* producer) {
+  char* data;
+  TF_ASSERT_OK(producer->Reserve(record.size(), &data));
+  memcpy(data, record.data(), record.size());
+  producer->Commit(record.size());
+}
+
+TEST(SharedMemoryRingBufferTest, WriteAndRead) {
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(UniqueName(), 1024, &consumer));
+  auto producer = OpenProducer(*consumer);
+
+  StringPiece record;
+  EXPECT_FALSE(consumer->Peek(&record));
+  Write("hello", producer.get());
+  Write("", producer.get());
+  Write("world", producer.get());
+  producer->SetEndOfSequence();
+
+  EXPECT_EQ(SharedMemoryRingBuffer::ProducerState::kEndOfSequence,
+            consumer->producer_state());
+  ASSERT_TRUE(consumer->Peek(&record));
+  EXPECT_EQ("hello", record);
+  consumer->Release();
+  ASSERT_TRUE(consumer->Peek(&record));
+  EXPECT_EQ("", record);
+  consumer->Release();
+  ASSERT_TRUE(consumer->Peek(&record));
+  EXPECT_EQ("world", record);
+  consumer->Release();
+  EXPECT_FALSE(consumer->Peek(&record));
+}
+
+TEST(SharedMemoryRingBufferTest, WrapsAround) {
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(UniqueName(), 256, &consumer));
+  auto producer = OpenProducer(*consumer);
+  const uint64 max_size = SharedMemoryRingBuffer::MaxRecordSize(256);
+
+  // Records of varying sizes, including the largest one, must wrap around the
+  // end of the buffer without tearing.
+  for (int i = 0; i < 1000; ++i) {
+    const string expected(i % max_size + 1, 'a' + i % 26);
+    Write(expected, producer.get());
+    StringPiece record;
+    ASSERT_TRUE(consumer->Peek(&record));
+    EXPECT_EQ(expected, record);
+    consumer->Release();
+  }
+}
+
+TEST(SharedMemoryRingBufferTest, ConcurrentProducer) {
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(UniqueName(), 512, &consumer));
+  auto producer = OpenProducer(*consumer);
+  const int kNumRecords = 10000;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      {}, "producer", [&producer, kNumRecords]() {
+        for (int i = 0; i < kNumRecords; ++i) {
+          Write(strings::StrCat(i, string(i % 100, 'x')), producer.get());
+        }
+        producer->SetEndOfSequence();
+      }));
+
+  int i = 0;
+  while (true) {
+    const SharedMemoryRingBuffer::ProducerState state =
+        consumer->producer_state();
+    StringPiece record;
+    if (consumer->Peek(&record)) {
+      ASSERT_EQ(strings::StrCat(i, string(i % 100, 'x')), record);
+      consumer->Release();
+      ++i;
+    } else if (state == SharedMemoryRingBuffer::ProducerState::kEndOfSequence) {
+      break;
+    }
+  }
+  EXPECT_EQ(kNumRecords, i);
+}
+
+TEST(SharedMemoryRingBufferTest, ConcurrentProducerWithWakeupPipes) {
+  std::unique_ptr<WakeupPipe> consumer_pipe;
+  TF_ASSERT_OK(WakeupPipe::Create(&consumer_pipe));
+  std::unique_ptr<WakeupPipe> producer_pipe;
+  TF_ASSERT_OK(WakeupPipe::Create(&producer_pipe));
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(UniqueName(), 512, &consumer));
+  consumer->SetWakeupFds(consumer_pipe->read_fd(), producer_pipe->write_fd());
+  auto producer = OpenProducer(*consumer);
+  producer->SetWakeupFds(producer_pipe->read_fd(), consumer_pipe->write_fd());
+  const int kNumRecords = 10000;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      {}, "producer", [&producer, kNumRecords]() {
+        for (int i = 0; i < kNumRecords; ++i) {
+          Write(strings::StrCat(i, string(i % 100, 'x')), producer.get());
+        }
+        producer->SetEndOfSequence();
+      }));
+
+  // A lost wakeup would stall the consumer for the whole timeout.
+  const int64 kTimeoutMicros = 60 * 1000 * 1000;
+  int i = 0;
+  while (true) {
+    consumer->RequestWakeup();
+    const SharedMemoryRingBuffer::ProducerState state =
+        consumer->producer_state();
+    StringPiece record;
+    if (consumer->Peek(&record)) {
+      ASSERT_EQ(strings::StrCat(i, string(i % 100, 'x')), record);
+      consumer->Release();
+      ++i;
+    } else if (state == SharedMemoryRingBuffer::ProducerState::kEndOfSequence) {
+      break;
+    } else {
+      const uint64 start_micros = Env::Default()->NowMicros();
+      consumer_pipe->Wait(kTimeoutMicros);
+      ASSERT_LT(Env::Default()->NowMicros() - start_micros, kTimeoutMicros);
+    }
+  }
+  EXPECT_EQ(kNumRecords, i);
+}
+
+TEST(SharedMemoryRingBufferTest, RecordTooLarge) {
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(UniqueName(), 256, &consumer));
+  auto producer = OpenProducer(*consumer);
+  char* data;
+  EXPECT_TRUE(errors::IsInvalidArgument(producer->Reserve(257, &data)));
+}
+
+TEST(SharedMemoryRingBufferTest, ProducerError) {
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(UniqueName(), 256, &consumer));
+  auto producer = OpenProducer(*consumer);
+  producer->SetError(errors::NotFound("no such file"));
+  EXPECT_EQ(SharedMemoryRingBuffer::ProducerState::kError,
+            consumer->producer_state());
+  Status s = consumer->producer_status();
+  EXPECT_TRUE(errors::IsNotFound(s));
+  EXPECT_EQ("no such file", s.error_message());
+}
+
+TEST(SharedMemoryRingBufferTest, OpenMissingSegment) {
+  std::unique_ptr<SharedMemoryRingBuffer> buffer;
+  EXPECT_TRUE(
+      errors::IsNotFound(SharedMemoryRingBuffer::Open(UniqueName(), &buffer)));
+}
+
+TEST(SharedMemoryRingBufferTest, EncodeAndDecodeTensors) {
+  std::vector<Tensor> tensors = {
+      test::AsTensor<float>({1.0, 2.0, 3.0, 4.0}, TensorShape({2, 2})),
+      test::AsScalar<int64>(42),
+      test::AsTensor<tstring>({"a", "", "bcd"}, TensorShape({3})),
+      test::AsTensor<bool>({}, TensorShape({0, 5}))};
+  uint64 size;
+  TF_ASSERT_OK(EncodedTensorsSize(tensors, &size));
+  string encoded(size, '\0');
+  EncodeTensors(tensors, &encoded[0]);
+
+  std::vector<Tensor> decoded;
+  TF_ASSERT_OK(DecodeTensors(cpu_allocator(), encoded, &decoded));
+  ASSERT_EQ(tensors.size(), decoded.size());
+  test::ExpectTensorEqual<float>(tensors[0], decoded[0]);
+  test::ExpectTensorEqual<int64>(tensors[1], decoded[1]);
+  test::ExpectTensorEqual<tstring>(tensors[2], decoded[2]);
+  test::ExpectTensorEqual<bool>(tensors[3], decoded[3]);
+
+  EXPECT_TRUE(errors::IsDataLoss(DecodeTensors(
+      cpu_allocator(), StringPiece(encoded).substr(0, size - 1), &decoded)));
+}
+
+TEST(SharedMemoryRingBufferTest, EncodeUnsupportedType) {
+  Tensor variant(DT_VARIANT, TensorShape({}));
+  uint64 size;
+  EXPECT_TRUE(errors::IsUnimplemented(EncodedTensorsSize({variant}, &size)));
+}
+
+// Measures the throughput of elements of one float tensor of `num_floats`
+// floats, written by one thread and read by another through a 64 MiB buffer.
+static void BM_SharedMemoryRingBufferThroughput(int iters, int num_floats) {
+  testing::StopTiming();
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_CHECK_OK(
+      SharedMemoryRingBuffer::Create(UniqueName(), 64 << 20, &consumer));
+  auto producer = OpenProducer(*consumer);
+  const std::vector<Tensor> element = {
+      Tensor(DT_FLOAT, TensorShape({num_floats}))};
+  uint64 size;
+  TF_CHECK_OK(EncodedTensorsSize(element, &size));
+
+  testing::StartTiming();
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread({}, "producer", [&]() {
+        for (int i = 0; i < iters; ++i) {
+          char* data;
+          TF_CHECK_OK(producer->Reserve(size, &data));
+          EncodeTensors(element, data);
+          producer->Commit(size);
+        }
+      }));
+  std::vector<Tensor> decoded;
+  for (int i = 0; i < iters;) {
+    StringPiece record;
+    if (consumer->Peek(&record)) {
+      TF_CHECK_OK(DecodeTensors(cpu_allocator(), record, &decoded));
+      consumer->Release();
+      ++i;
+    }
+  }
+  thread.reset();
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters));
+  testing::BytesProcessed(static_cast<int64>(iters) * size);
+}
+
+BENCHMARK(BM_SharedMemoryRingBufferThroughput)
+    ->Arg(1)
+    ->Arg(1 << 10)
+    ->Arg(64 << 10)
+    ->Arg(1 << 20);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -30,7 +30,15 @@ limitations under the License.
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/platform.h"
 #if !defined(IS_SLIM_BUILD)
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/lib/io/lz4/lz4_inputstream.h"
+#include "tensorflow/core/lib/io/lz4/lz4_outputbuffer.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+#endif  // IS_MOBILE_PLATFORM
+#include "tensorflow/core/lib/io/parallel_zlib_outputbuffer.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputbuffer.h"
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -43,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/data/experimental/snapshot.pb.h"
@@ -74,8 +83,12 @@ class SnapshotWriter {
   static constexpr const char* const kWriteStringPiece = "WriteStringPiece";
   static constexpr const char* const kWriteCord = "WriteCord";
 
-  explicit SnapshotWriter(WritableFile* dest, const string& compression_type =
-                                                  io::compression::kNone)
+  // With GZIP compression, `compression_threads` > 1 compresses blocks of
+  // the output in parallel with `io::ParallelZlibOutputBuffer`.
+  explicit SnapshotWriter(
+      WritableFile* dest,
+      const string& compression_type = io::compression::kNone,
+      int compression_threads = 1)
       : dest_(dest), compression_type_(compression_type) {
 #if defined(IS_SLIM_BUILD)
     if (compression_type != io::compression::kNone) {
@@ -86,12 +99,21 @@ class SnapshotWriter {
     if (compression_type == io::compression::kGzip) {
       io::ZlibCompressionOptions zlib_options;
       zlib_options = io::ZlibCompressionOptions::GZIP();
-
-      io::ZlibOutputBuffer* zlib_output_buffer = new io::ZlibOutputBuffer(
-          dest, zlib_options.input_buffer_size, zlib_options.output_buffer_size,
-          zlib_options);
-      TF_CHECK_OK(zlib_output_buffer->Init());
-      dest_ = zlib_output_buffer;
+      zlib_options.num_threads = compression_threads;
+
+      if (compression_threads > 1) {
+        io::ParallelZlibOutputBuffer* zlib_output_buffer =
+            new io::ParallelZlibOutputBuffer(
+                dest, zlib_options.input_buffer_size, zlib_options);
+        TF_CHECK_OK(zlib_output_buffer->Init());
+        dest_ = zlib_output_buffer;
+      } else {
+        io::ZlibOutputBuffer* zlib_output_buffer = new io::ZlibOutputBuffer(
+            dest, zlib_options.input_buffer_size,
+            zlib_options.output_buffer_size, zlib_options);
+        TF_CHECK_OK(zlib_output_buffer->Init());
+        dest_ = zlib_output_buffer;
+      }
       dest_is_owned_ = true;
     } else if (compression_type == io::compression::kSnappy) {
       io::SnappyOutputBuffer* snappy_output_buffer = new io::SnappyOutputBuffer(
@@ -99,6 +121,24 @@ class SnapshotWriter {
           /*output_buffer_bytes=*/kSnappyBufferSizeBytes);
       dest_ = snappy_output_buffer;
       dest_is_owned_ = true;
+#if !defined(IS_MOBILE_PLATFORM)
+    } else if (compression_type == io::compression::kZstd) {
+      io::ZstdCompressionOptions zstd_options;
+      io::ZstdOutputBuffer* zstd_output_buffer = new io::ZstdOutputBuffer(
+          dest, zstd_options.input_buffer_size,
+          zstd_options.output_buffer_size, zstd_options);
+      TF_CHECK_OK(zstd_output_buffer->Init());
+      dest_ = zstd_output_buffer;
+      dest_is_owned_ = true;
+    } else if (compression_type == io::compression::kLz4) {
+      io::Lz4CompressionOptions lz4_options;
+      io::Lz4OutputBuffer* lz4_output_buffer = new io::Lz4OutputBuffer(
+          dest, lz4_options.input_buffer_size, lz4_options.output_buffer_size,
+          lz4_options);
+      TF_CHECK_OK(lz4_output_buffer->Init());
+      dest_ = lz4_output_buffer;
+      dest_is_owned_ = true;
+#endif  // IS_MOBILE_PLATFORM
     }
 #endif  // IS_SLIM_BUILD
   }
@@ -180,6 +220,18 @@ class SnapshotReader {
       input_stream_ = absl::make_unique<io::SnappyInputBuffer>(
           file_, /*input_buffer_bytes=*/kSnappyBufferSizeBytes,
           /*output_buffer_bytes=*/kSnappyBufferSizeBytes);
+#if !defined(IS_MOBILE_PLATFORM)
+    } else if (compression_type_ == io::compression::kZstd) {
+      io::ZstdCompressionOptions zstd_options;
+      input_stream_.reset(new io::ZstdInputStream(
+          input_stream_.release(), zstd_options.input_buffer_size,
+          zstd_options.output_buffer_size, zstd_options, true));
+    } else if (compression_type_ == io::compression::kLz4) {
+      io::Lz4CompressionOptions lz4_options;
+      input_stream_.reset(new io::Lz4InputStream(
+          input_stream_.release(), lz4_options.input_buffer_size,
+          lz4_options.output_buffer_size, lz4_options, true));
+#endif  // IS_MOBILE_PLATFORM
     }
 #endif  // IS_SLIM_BUILD
   }
@@ -319,6 +371,11 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("shuffle_on_read", &shuffle_on_read_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("seed", &seed_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("seed2", &seed2_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("reader_reorder_window",
+                                     &reader_reorder_window_));
+    bool autotune_num_reader_threads;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("autotune_num_reader_threads",
+                                     &autotune_num_reader_threads));
 
     if (shard_size_bytes_ == -1) shard_size_bytes_ = kDefaultShardSizeBytes;
 
@@ -336,14 +393,28 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         ctx,
         compression_ == io::compression::kNone ||
             compression_ == io::compression::kGzip ||
-            compression_ == io::compression::kSnappy,
-        errors::InvalidArgument("compression must be either '', 'GZIP' or "
-                                "'SNAPPY'."));
+            compression_ == io::compression::kSnappy ||
+            compression_ == io::compression::kZstd ||
+            compression_ == io::compression::kLz4,
+        errors::InvalidArgument("compression must be either '', 'GZIP', "
+                                "'SNAPPY', 'ZSTD' or 'LZ4'."));
 
     OP_REQUIRES(
         ctx, pending_snapshot_expiry_seconds_ >= 1,
         errors::InvalidArgument(
             "pending_snapshot_expiry_seconds must be at least 1 second."));
+
+    OP_REQUIRES(
+        ctx, num_reader_threads_ > 0,
+        errors::InvalidArgument("num_reader_threads must be greater than zero "
+                                "or -1."));
+    // -1 keeps its old meaning of one reader thread, so autotuning is only
+    // requested through its own attr.
+    if (autotune_num_reader_threads) num_reader_threads_ = model::kAutotune;
+
+    OP_REQUIRES(ctx, reader_reorder_window_ >= -1,
+                errors::InvalidArgument(
+                    "reader_reorder_window must be at least -1."));
   }
 
  protected:
@@ -372,7 +443,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         reader_path_prefix_, writer_path_prefix_, compression_,
         shard_size_bytes_, pending_snapshot_expiry_seconds_,
         num_reader_threads_, reader_buffer_size_, num_writer_threads_,
-        writer_buffer_size_, shuffle_on_read_, seed_, seed2_);
+        writer_buffer_size_, shuffle_on_read_, seed_, seed2_,
+        reader_reorder_window_);
   }
 
  private:
@@ -383,9 +455,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
             const string& writer_path_prefix, const string& compression,
             const uint64 shard_size_bytes,
             const uint64 pending_snapshot_expiry_seconds,
-            const uint64 num_reader_threads, const uint64 reader_buffer_size,
+            const int64 num_reader_threads, const uint64 reader_buffer_size,
             const uint64 num_writer_threads, const uint64 writer_buffer_size,
-            const bool shuffle_on_read, const uint64 seed, const uint64 seed2)
+            const bool shuffle_on_read, const uint64 seed, const uint64 seed2,
+            const int64 reader_reorder_window)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           dir_(path),
@@ -401,7 +474,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           writer_buffer_size_(writer_buffer_size),
           shuffle_on_read_(shuffle_on_read),
           seed_(seed),
-          seed2_(seed2) {
+          seed2_(seed2),
+          reader_reorder_window_(reader_reorder_window) {
       input_->Ref();
     }
 
@@ -455,8 +529,16 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
       b->BuildAttrValue<int64>(pending_snapshot_expiry_seconds_,
                                &pending_snapshot_expiry_seconds_attr);
 
+      const bool autotune_num_reader_threads =
+          num_reader_threads_ == model::kAutotune;
       AttrValue num_reader_threads_attr;
-      b->BuildAttrValue<int64>(num_reader_threads_, &num_reader_threads_attr);
+      b->BuildAttrValue<int64>(
+          autotune_num_reader_threads ? 1 : num_reader_threads_,
+          &num_reader_threads_attr);
+
+      AttrValue autotune_num_reader_threads_attr;
+      b->BuildAttrValue<bool>(autotune_num_reader_threads,
+                              &autotune_num_reader_threads_attr);
 
       AttrValue reader_buffer_size_attr;
       b->BuildAttrValue<int64>(reader_buffer_size_, &reader_buffer_size_attr);
@@ -476,6 +558,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
       AttrValue seed2_attr;
       b->BuildAttrValue<int64>(seed2_, &seed2_attr);
 
+      AttrValue reader_reorder_window_attr;
+      b->BuildAttrValue<int64>(reader_reorder_window_,
+                               &reader_reorder_window_attr);
+
       TF_RETURN_IF_ERROR(b->AddDataset(
           this,
           /*inputs=*/
@@ -495,7 +581,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
            {"writer_buffer_size", writer_buffer_size_attr},
            {"shuffle_on_read", shuffle_on_read_attr},
            {"seed", seed_attr},
-           {"seed2", seed2_attr}},
+           {"seed2", seed2_attr},
+           {"reader_reorder_window", reader_reorder_window_attr},
+           {"autotune_num_reader_threads", autotune_num_reader_threads_attr}},
           output));
       return Status::OK();
     }
@@ -563,6 +651,19 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
       }
 
      private:
+      // Reads the files of a snapshot in a pipeline of two stages:
+      //
+      // 1. Up to `num_reader_threads` threads each read one file at a time,
+      //    and read and decompress its records in order.
+      // 2. Each record is parsed into tensors by a function scheduled on the
+      //    runner of the iterator context, so that parsing does not hold up
+      //    the reading and decompression of the next records.
+      //
+      // Records are added to `buffer_` in the order in which they are read,
+      // and elements are produced from it in that order, except that an
+      // element that is parsed early can be produced ahead of at most
+      // `reader_reorder_window` elements. If the number of reader threads is
+      // autotuned, it is the `parallelism` parameter of the model.
       class SnapshotReaderIterator : public DatasetIterator<Dataset> {
        public:
         static constexpr const char* const kParse = "Parse";
@@ -572,21 +673,31 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
             const experimental::SnapshotMetadataRecord& metadata)
             : DatasetIterator<Dataset>(params),
               hash_dir_(hash_dir),
-              metadata_(metadata) {}
+              metadata_(metadata),
+              mu_(std::make_shared<mutex>()),
+              cond_var_(std::make_shared<condition_variable>()),
+              num_reader_threads_(std::make_shared<model::SharedState>(
+                  params.dataset->num_reader_threads_, mu_, cond_var_)) {}
 
         ~SnapshotReaderIterator() override {
-          mutex_lock l(mu_);
+          mutex_lock l(*mu_);
           cancelled_ = true;
-          cond_var_.notify_all();
-          while (num_active_threads_ > 0) {
-            cond_var_.wait(l);
+          cond_var_->notify_all();
+          while (num_active_threads_ > 0 || num_parse_calls_ > 0) {
+            cond_var_->wait(l);
           }
         }
 
         Status Initialize(IteratorContext* ctx) override {
-          mutex_lock l(mu_);
+          mutex_lock l(*mu_);
+          if (num_reader_threads_->value == model::kAutotune) {
+            num_reader_threads_->value = ctx->runner_threadpool_size();
+          }
+          max_reader_threads_ = num_reader_threads_->tunable
+                                    ? ctx->runner_threadpool_size()
+                                    : num_reader_threads_->value;
           thread_pool_ = ctx->CreateThreadPool(kSnapshotReaderWorkerPool,
-                                               dataset()->num_reader_threads_);
+                                               max_reader_threads_);
           run_id_ = metadata_.run_id();
           run_dir_ = absl::StrCat(hash_dir_, "/", run_id_);
           // Get all the files in the run_dir.
@@ -615,19 +726,16 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
                                std::vector<Tensor>* out_tensors,
                                bool* end_of_sequence) override {
           absl::Time start = absl::Now();
-          mutex_lock l(mu_);
-          if (!background_threads_started_) {
-            for (int i = 0; i < dataset()->num_reader_threads_; ++i) {
-              ++num_active_threads_;
-              thread_pool_->Schedule([this]() { ReadingFilesLoop(); });
-            }
-            background_threads_started_ = true;
-          }
-
-          // Wait till the buffer has something in it.
-          while (!cancelled_ && buffer_.empty() &&
-                 !background_threads_finished_) {
-            cond_var_.wait(l);
+          mutex_lock l(*mu_);
+          EnsureReaderThreadsStarted(ctx);
+
+          // Wait till the buffer has an element that can be produced.
+          std::shared_ptr<BufferElement> elem;
+          while (!cancelled_ && !TakeElement(&elem) &&
+                 !(buffer_.empty() && background_threads_finished_)) {
+            RecordStop(ctx);
+            cond_var_->wait(l);
+            RecordStart(ctx);
           }
 
           if (cancelled_) {
@@ -635,122 +743,247 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
                 "SnapshotDatasetOp::Dataset::SnapshotReaderIterator::GetNext");
           }
 
-          if (!buffer_.empty()) {
-            Status s = buffer_.front().status;
-            if (s.ok()) {
-              *end_of_sequence = false;
-              *out_tensors = std::move(buffer_.front().value);
-
-              {
-                profiler::TraceMe activity(
-                    absl::StrCat(prefix(), kSeparator, kBookkeeping),
-                    profiler::TraceMeLevel::kInfo);
-                // Printing some statistics along the way.
-                int64 num_bytes = 0;
-                for (int i = 0; i < out_tensors->size(); ++i) {
-                  num_bytes += (*out_tensors)[i].TotalBytes();
-                }
-                absl::Time end = absl::Now();
-                absl::Duration d = end - start;
-                time_spent_micros_ += absl::ToInt64Microseconds(d);
-                kbytes_read_ += static_cast<double>(num_bytes) / 1024.0;
-                elements_produced_++;
-                if (elements_produced_ % 10000 == 0) {
-                  LOG(INFO) << "Current read throughput (MBPS): "
-                            << ((kbytes_read_ / 1024.0) /
-                                (time_spent_micros_ / 1000000.0));
-                }
+          if (elem == nullptr) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          if (elem->status.ok()) {
+            *end_of_sequence = false;
+            *out_tensors = std::move(elem->value);
+
+            {
+              profiler::TraceMe activity(
+                  absl::StrCat(prefix(), kSeparator, kBookkeeping),
+                  profiler::TraceMeLevel::kInfo);
+              // Printing some statistics along the way.
+              int64 num_bytes = 0;
+              for (int i = 0; i < out_tensors->size(); ++i) {
+                num_bytes += (*out_tensors)[i].TotalBytes();
+              }
+              absl::Time end = absl::Now();
+              absl::Duration d = end - start;
+              time_spent_micros_ += absl::ToInt64Microseconds(d);
+              kbytes_read_ += static_cast<double>(num_bytes) / 1024.0;
+              elements_produced_++;
+              if (elements_produced_ % 10000 == 0) {
+                LOG(INFO) << "Current read throughput (MBPS): "
+                          << ((kbytes_read_ / 1024.0) /
+                              (time_spent_micros_ / 1000000.0));
               }
             }
-            buffer_.pop_front();
-            cond_var_.notify_all();
-            return s;
           }
+          return elem->status;
+        }
 
-          if (background_threads_finished_) {
-            *end_of_sequence = true;
-            return Status::OK();
+       protected:
+        std::shared_ptr<model::Node> CreateNode(
+            IteratorContext* ctx, model::Node::Args args) const override {
+          return model::MakeAsyncKnownRatioNode(
+              std::move(args),
+              /*ratio=*/1,
+              {model::MakeParameter(model::kParallelism, num_reader_threads_,
+                                    /*min=*/1,
+                                    /*max=*/ctx->runner_threadpool_size())});
+        }
+
+       private:
+        // A buffered element. It is `ready` once its record has been parsed
+        // into `value`, or reading or parsing failed with `status`.
+        struct BufferElement {
+          bool ready = false;
+          Status status;
+          std::vector<Tensor> value;
+        };
+
+        void EnsureReaderThreadsStarted(IteratorContext* ctx)
+            EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+          if (background_threads_started_) return;
+          // The reader threads and the parse functions outlive this call, so
+          // they use a copy of the iterator context.
+          std::shared_ptr<IteratorContext> ctx_copy =
+              std::make_shared<IteratorContext>(*ctx);
+          for (int64 i = 0; i < max_reader_threads_; ++i) {
+            ++num_active_threads_;
+            thread_pool_->Schedule(
+                [this, ctx_copy]() { ReadingFilesLoop(ctx_copy); });
           }
+          background_threads_started_ = true;
+        }
 
-          return errors::Internal("Unreachable point in SnapshotReader");
+        // Takes the first element of `buffer_` that is ready and within the
+        // reorder window, if any.
+        bool TakeElement(std::shared_ptr<BufferElement>* elem)
+            EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+          size_t window = buffer_.size();
+          if (dataset()->reader_reorder_window_ >= 0) {
+            window = std::min<size_t>(window,
+                                      dataset()->reader_reorder_window_ + 1);
+          }
+          for (size_t i = 0; i < window; ++i) {
+            if (buffer_[i]->ready) {
+              *elem = std::move(buffer_[i]);
+              buffer_.erase(buffer_.begin() + i);
+              cond_var_->notify_all();
+              return true;
+            }
+          }
+          return false;
         }
 
-       private:
-        // Reads one file end to end.
-        Status ReadFile(const string& filename) {
+        // The buffer holds at least one element per reader thread, so that
+        // every reader can overlap its reads with the parsing of its last
+        // record.
+        size_t BufferCapacity() EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+          return std::max<size_t>(
+              dataset()->reader_buffer_size_,
+              static_cast<size_t>(num_reader_threads_->value));
+        }
+
+        // Waits until the calling reader thread may read, i.e. until fewer
+        // than `num_reader_threads_` threads are reading. Returns false if the
+        // iterator is cancelled.
+        bool WaitForReaderSlot(const std::shared_ptr<IteratorContext>& ctx,
+                               mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+          while (!cancelled_ &&
+                 num_reading_threads_ >= num_reader_threads_->value) {
+            RecordStop(ctx.get());
+            cond_var_->wait(*l);
+            RecordStart(ctx.get());
+          }
+          if (cancelled_) return false;
+          ++num_reading_threads_;
+          return true;
+        }
+
+        void ReleaseReaderSlot() EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+          --num_reading_threads_;
+          cond_var_->notify_all();
+        }
+
+        // Reads one file end to end, scheduling the parsing of each record.
+        // The calling thread holds a reader slot.
+        Status ReadFile(const std::shared_ptr<IteratorContext>& ctx,
+                        const string& filename) {
           std::unique_ptr<RandomAccessFile> file;
-          TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+          TF_RETURN_IF_ERROR(
+              Env::Default()->NewRandomAccessFile(filename, &file));
           std::unique_ptr<SnapshotReader> reader(
               new SnapshotReader(file.get(), dataset()->compression_));
 
           while (true) {
-            // Wait for a slot in the buffer.
+            // Read the next record before waiting for a slot in the buffer,
+            // so that reading overlaps with the parsing of earlier records.
+#if !defined(PLATFORM_GOOGLE)
+            auto record_bytes = std::make_shared<tstring>();
+            Status s = reader->ReadRecord(record_bytes.get());
+#else
+            auto record_cord = std::make_shared<absl::Cord>();
+            Status s = reader->ReadRecord(record_cord.get());
+#endif
+            if (errors::IsOutOfRange(s)) {
+              return Status::OK();
+            }
+            TF_RETURN_IF_ERROR(s);
+
+            auto elem = std::make_shared<BufferElement>();
             {
-              mutex_lock l(mu_);
-              while (!cancelled_ &&
-                     buffer_.size() >= dataset()->reader_buffer_size_) {
-                cond_var_.wait(l);
+              mutex_lock l(*mu_);
+              // Give up the reader slot if the autotuner lowered the number
+              // of reader threads.
+              if (num_reading_threads_ > num_reader_threads_->value) {
+                ReleaseReaderSlot();
+                if (!WaitForReaderSlot(ctx, &l)) {
+                  // Cancelled. Keep holding the slot, which the caller
+                  // releases.
+                  ++num_reading_threads_;
+                }
+              }
+              while (!cancelled_ && buffer_.size() >= BufferCapacity()) {
+                RecordStop(ctx.get());
+                cond_var_->wait(l);
+                RecordStart(ctx.get());
               }
-
               if (cancelled_) {
                 return errors::Cancelled(
                     "SnapshotDatasetOp::Dataset::SnapshotReaderIterator::"
                     "ReadFile");
               }
+              buffer_.push_back(elem);
+              ++num_parse_calls_;
             }
 #if !defined(PLATFORM_GOOGLE)
-            string record_bytes;
-            Status s = reader->ReadRecord(&record_bytes);
+            (*ctx->runner())([this, ctx, record_bytes, elem]() {
+              ParseRecord(ctx, *record_bytes, elem.get());
+            });
 #else
-            absl::Cord record_cord;
-            Status s = reader->ReadRecord(&record_cord);
+            (*ctx->runner())([this, ctx, record_cord, elem]() {
+              ParseRecord(ctx, *record_cord, elem.get());
+            });
 #endif
-            if (s.ok()) {
-              profiler::TraceMe activity(
-                  absl::StrCat(prefix(), kSeparator, kParse),
-                  profiler::TraceMeLevel::kInfo);
-              experimental::SnapshotRecord record;
+          }
+          return Status::OK();
+        }
+
+        // Parses a serialized `SnapshotRecord` into `elem`.
+        template <typename T>
+        void ParseRecord(const std::shared_ptr<IteratorContext>& ctx,
+                         const T& serialized, BufferElement* elem) {
+          RecordStart(ctx.get());
+          Status s;
+          std::vector<Tensor> out_tensors;
+          {
+            profiler::TraceMe activity(
+                absl::StrCat(prefix(), kSeparator, kParse),
+                profiler::TraceMeLevel::kInfo);
+            experimental::SnapshotRecord record;
 #if !defined(PLATFORM_GOOGLE)
-              record.ParseFromString(record_bytes);
+            bool parsed = record.ParseFromString(serialized);
 #else
-              record.ParseFromCord(record_cord);
+            bool parsed = record.ParseFromCord(serialized);
 #endif
-              std::vector<Tensor> out_tensors;
-              for (int i = 0; i < record.tensor_size(); ++i) {
-                Tensor t;
-                if (!t.FromProto(record.tensor(i))) {
-                  return errors::DataLoss("Unable to parse tensor from proto.");
-                }
-                out_tensors.push_back(t);
+            if (!parsed) {
+              s = errors::DataLoss("Unable to parse snapshot record.");
+            }
+            out_tensors.reserve(record.tensor_size());
+            for (int i = 0; s.ok() && i < record.tensor_size(); ++i) {
+              Tensor t;
+              if (!t.FromProto(record.tensor(i))) {
+                s = errors::DataLoss("Unable to parse tensor from proto.");
               }
-              BufferElement elem;
-              std::swap(elem.value, out_tensors);
-              elem.status = Status::OK();
-              mutex_lock l(mu_);
-              buffer_.push_back(std::move(elem));
-              cond_var_.notify_all();
-            } else if (errors::IsOutOfRange(s)) {
-              return Status::OK();
-            } else {
-              return s;
+              out_tensors.push_back(std::move(t));
             }
           }
-          return Status::OK();
+          RecordStop(ctx.get());
+          mutex_lock l(*mu_);
+          elem->status = s;
+          elem->value = std::move(out_tensors);
+          elem->ready = true;
+          --num_parse_calls_;
+          cond_var_->notify_all();
         }
 
         // Pulls one file off the filenames_ list and reads it through. When
-        // all files are read, terminates.
-        void ReadingFilesLoop() {
-          auto cleanup = gtl::MakeCleanup([this]() {
-            mutex_lock l(mu_);
+        // all files are read, terminates. A file that cannot be read produces
+        // an error element, and the thread moves on to the next file.
+        void ReadingFilesLoop(const std::shared_ptr<IteratorContext>& ctx) {
+          RecordStart(ctx.get());
+          auto cleanup = gtl::MakeCleanup([this, ctx]() {
+            RecordStop(ctx.get());
+            mutex_lock l(*mu_);
             --num_active_threads_;
-            cond_var_.notify_all();
+            cond_var_->notify_all();
           });
           while (true) {
             string filename = "";
             {
-              mutex_lock l(mu_);
+              mutex_lock l(*mu_);
+              if (next_file_index_ >= filenames_.size() ||
+                  !WaitForReaderSlot(ctx, &l)) {
+                return;
+              }
               if (next_file_index_ >= filenames_.size()) {
+                ReleaseReaderSlot();
                 return;
               }
               filename = absl::StrCat(dataset()->reader_path_prefix_,
@@ -758,58 +991,62 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
               VLOG(2) << "Starting to read: " << filename;
               next_file_index_++;
             }
-            Status s = ReadFile(filename);
+            Status s = ReadFile(ctx, filename);
             // If we get to the end of the file, it's a clean termination and
             // we are at the end of the file. If all files have been processed,
-            // then we insert an end_of_sequence marker in the buffer and
-            // terminate the loop.
+            // then the background threads are finished and the iterator
+            // produces end_of_sequence once the buffer has been drained.
+            mutex_lock l(*mu_);
+            ReleaseReaderSlot();
+            num_files_done_++;
             if (s.ok()) {
               VLOG(2) << "Finished reading: " << filename;
-              mutex_lock l(mu_);
-              num_files_done_++;
-              if (num_files_done_ >= filenames_.size()) {
-                background_threads_finished_ = true;
-                cond_var_.notify_all();
-                return;
-              }
             } else {
               LOG(ERROR) << "Encountered an error: " << s.ToString();
-              BufferElement elem;
-              elem.status = s;
-              mutex_lock l(mu_);
+              auto elem = std::make_shared<BufferElement>();
+              elem->ready = true;
+              elem->status = s;
               buffer_.push_back(std::move(elem));
-              cond_var_.notify_all();
+            }
+            if (num_files_done_ >= filenames_.size()) {
+              background_threads_finished_ = true;
+              cond_var_->notify_all();
               return;
             }
+            cond_var_->notify_all();
           }
         }
 
-        struct BufferElement {
-          Status status;
-          std::vector<Tensor> value;
-        };
-
-        mutex mu_;
-        condition_variable cond_var_;
-
         const string hash_dir_;
         const experimental::SnapshotMetadataRecord metadata_;
-        string run_id_ GUARDED_BY(mu_);
-        string run_dir_ GUARDED_BY(mu_);
+
+        // Used for coordination between the consumer, the reader threads and
+        // the parse functions.
+        const std::shared_ptr<mutex> mu_;
+        const std::shared_ptr<condition_variable> cond_var_;
+        // The number of threads that read files at a time.
+        const std::shared_ptr<model::SharedState> num_reader_threads_;
+        int64 max_reader_threads_ = 0;
+
+        string run_id_ GUARDED_BY(*mu_);
+        string run_dir_ GUARDED_BY(*mu_);
         std::vector<string> filenames_;
 
-        uint64 elements_produced_ GUARDED_BY(mu_) = 0;
-        int64 time_spent_micros_ GUARDED_BY(mu_) = 0;
-        double kbytes_read_ GUARDED_BY(mu_) = 0;
-        size_t next_file_index_ GUARDED_BY(mu_) = 0;
-        int64 num_files_done_ GUARDED_BY(mu_) = 0;
+        uint64 elements_produced_ GUARDED_BY(*mu_) = 0;
+        int64 time_spent_micros_ GUARDED_BY(*mu_) = 0;
+        double kbytes_read_ GUARDED_BY(*mu_) = 0;
+        size_t next_file_index_ GUARDED_BY(*mu_) = 0;
+        int64 num_files_done_ GUARDED_BY(*mu_) = 0;
 
         std::unique_ptr<thread::ThreadPool> thread_pool_;
-        int64 num_active_threads_ GUARDED_BY(mu_) = 0;
-        std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
-        bool cancelled_ GUARDED_BY(mu_) = false;
-        bool background_threads_started_ GUARDED_BY(mu_) = false;
-        bool background_threads_finished_ GUARDED_BY(mu_) = false;
+        int64 num_active_threads_ GUARDED_BY(*mu_) = 0;
+        // The number of threads that hold a reader slot.
+        int64 num_reading_threads_ GUARDED_BY(*mu_) = 0;
+        int64 num_parse_calls_ GUARDED_BY(*mu_) = 0;
+        std::deque<std::shared_ptr<BufferElement>> buffer_ GUARDED_BY(*mu_);
+        bool cancelled_ GUARDED_BY(*mu_) = false;
+        bool background_threads_started_ GUARDED_BY(*mu_) = false;
+        bool background_threads_finished_ GUARDED_BY(*mu_) = false;
       };
 
       class SnapshotWriterIterator : public DatasetIterator<Dataset> {
@@ -972,6 +1209,12 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           return Status::OK();
         }
 
+        // Splits the cores between the writer threads for compression.
+        int CompressionThreads() const {
+          return std::max<int64>(
+              1, port::MaxParallelism() / dataset()->num_writer_threads_);
+        }
+
         Status ProcessOneElement(int64* bytes_written,
                                  string* snapshot_data_filename,
                                  std::unique_ptr<WritableFile>* file,
@@ -1033,7 +1276,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
               TF_RETURN_IF_ERROR(Env::Default()->NewAppendableFile(
                   *snapshot_data_filename, file));
               *writer = absl::make_unique<SnapshotWriter>(
-                  file->get(), dataset()->compression_);
+                  file->get(), dataset()->compression_, CompressionThreads());
               *bytes_written = 0;
             }
 #if defined(PLATFORM_GOOGLE)
@@ -1089,8 +1332,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
             cond_var_.notify_all();
             return;
           }
-          std::unique_ptr<SnapshotWriter> writer(
-              new SnapshotWriter(file.get(), dataset()->compression_));
+          std::unique_ptr<SnapshotWriter> writer(new SnapshotWriter(
+              file.get(), dataset()->compression_, CompressionThreads()));
 
           bool end_of_processing = false;
           while (!end_of_processing) {
@@ -1177,7 +1420,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
     const uint64 shard_size_bytes_;
     const uint64 pending_snapshot_expiry_seconds_;
-    const uint64 num_reader_threads_;
+    // The number of threads reading files, or `model::kAutotune`.
+    const int64 num_reader_threads_;
     const uint64 reader_buffer_size_;
     const uint64 num_writer_threads_;
     const uint64 writer_buffer_size_;
@@ -1185,6 +1429,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
     const uint64 seed_;
     const uint64 seed2_;
+    // How many elements read before an element may be produced after it, or
+    // -1 if elements are produced in the order in which they are parsed.
+    const int64 reader_reorder_window_;
   };
 
   const int graph_def_version_;
@@ -1205,6 +1452,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
   int64 seed_;
   int64 seed2_;
+  int64 reader_reorder_window_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("SnapshotDataset").Device(DEVICE_CPU),
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
@@ -62,9 +63,14 @@ class ToTFRecordOp : public AsyncOpKernel {
           std::unique_ptr<WritableFile> file;
           OP_REQUIRES_OK_ASYNC(
               ctx, ctx->env()->NewWritableFile(filename, &file), done);
-          auto writer = absl::make_unique<io::RecordWriter>(
-              file.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
-                              compression_type));
+          io::RecordWriterOptions options =
+              io::RecordWriterOptions::CreateRecordWriterOptions(
+                  compression_type);
+          // Records are written from a single thread, so compress on all
+          // cores to keep compression from capping the write throughput.
+          options.zlib_options.num_threads = port::MaxParallelism();
+          auto writer =
+              absl::make_unique<io::RecordWriter>(file.get(), options);
 
           DatasetBase* dataset;
           OP_REQUIRES_OK_ASYNC(
@@ -183,8 +183,11 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         }
         TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
             dataset()->filenames_[current_file_index_], &file_));
+        // Records are read sequentially, so read the next buffer while the
+        // current one is consumed. This is a no-op unless the file supports
+        // asynchronous reads (e.g. POSIX with `TF_POSIX_ASYNC_IO` set).
         input_buffer_ = absl::make_unique<io::InputBuffer>(
-            file_.get(), dataset()->buffer_size_);
+            file_.get(), dataset()->buffer_size_, /*read_ahead=*/true);
         TF_RETURN_IF_ERROR(input_buffer_->SkipNBytes(dataset()->header_bytes_));
       } while (true);
     }
@@ -226,7 +229,7 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
             dataset()->filenames_[current_file_index_], &file_));
         input_buffer_ = absl::make_unique<io::InputBuffer>(
-            file_.get(), dataset()->buffer_size_);
+            file_.get(), dataset()->buffer_size_, /*read_ahead=*/true);
         TF_RETURN_IF_ERROR(input_buffer_->Seek(current_pos));
       }
 
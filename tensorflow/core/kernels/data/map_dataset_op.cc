@@ -50,7 +50,13 @@ class MapDatasetOp::Dataset : public DatasetBase {
         preserve_cardinality_(preserve_cardinality),
         captured_func_(std::move(captured_func)),
         output_types_(output_types),
-        output_shapes_(output_shapes) {
+        output_shapes_(output_shapes),
+        // A stateless function that preserves the cardinality maps each input
+        // element independently, so the input can be randomly accessed
+        // through this dataset.
+        supports_random_access_(input->SupportsRandomAccess() &&
+                                preserve_cardinality &&
+                                captured_func_->CheckExternalState().ok()) {
     input_->Ref();
   }
 
@@ -79,6 +85,30 @@ class MapDatasetOp::Dataset : public DatasetBase {
     return input_->CheckExternalState();
   }
 
+  bool SupportsRandomAccess() const override { return supports_random_access_; }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (!supports_random_access_) {
+      return DatasetBase::Get(ctx, index, out_tensors);
+    }
+    std::vector<Tensor> args;
+    TF_RETURN_IF_ERROR(input_->Get(ctx, index, &args));
+    // The instantiation is cached by the function handle cache of `ctx`.
+    std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func;
+    TF_RETURN_IF_ERROR(
+        captured_func_->Instantiate(ctx, &instantiated_captured_func));
+    out_tensors->clear();
+    Status s =
+        instantiated_captured_func->Run(ctx, std::move(args), out_tensors);
+    if (errors::IsOutOfRange(s)) {
+      // As in `GetNextInternal()`, since the cardinality is preserved.
+      return errors::InvalidArgument(
+          "Function invocation produced OutOfRangeError: ", s.error_message());
+    }
+    return s;
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -195,6 +225,7 @@ class MapDatasetOp::Dataset : public DatasetBase {
   const std::unique_ptr<CapturedFunction> captured_func_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
+  const bool supports_random_access_;
 };
 
 MapDatasetOp::MapDatasetOp(OpKernelConstruction* ctx)
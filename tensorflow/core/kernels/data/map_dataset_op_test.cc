@@ -105,6 +105,28 @@ std::vector<GetNextTestCase<MapDatasetParams>> GetNextTestCases() {
 
 ITERATOR_GET_NEXT_TEST_P(MapDatasetOpTest, MapDatasetParams, GetNextTestCases())
 
+TEST_F(MapDatasetOpTest, RandomAccess) {
+  auto dataset_params = MapDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  ASSERT_TRUE(dataset_->SupportsRandomAccess());
+  std::vector<Tensor> expected_outputs =
+      CreateTensors<int64>(TensorShape({}), {{0}, {12}, {24}, {36}});
+  for (int64 i = expected_outputs.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(iterator_ctx_.get(), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    TF_EXPECT_OK(ExpectEqual(out_tensors[0], expected_outputs[i]));
+  }
+}
+
+// `MapDatasetParams2()` does not preserve the cardinality, so the function may
+// end the sequence early.
+TEST_F(MapDatasetOpTest, NoRandomAccessWithoutPreservedCardinality) {
+  auto dataset_params = MapDatasetParams2();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_FALSE(dataset_->SupportsRandomAccess());
+}
+
 TEST_F(MapDatasetOpTest, DatasetNodeName) {
   auto dataset_params = MapDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -18,7 +18,9 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/util/ptr_util.h"
@@ -50,7 +52,17 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES(ctx, cpu_budget_ > 0,
                 errors::InvalidArgument("CPU budget must be positive but is ",
                                         cpu_budget_, "."));
-    ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    if (ctx->HasAttr("ram_budget")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("ram_budget", &ram_budget_));
+    } else {
+      ram_budget_ = 0;
+    }
+    if (ram_budget_ == 0) {
+      ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    }
+    OP_REQUIRES(ctx, ram_budget_ > 0,
+                errors::InvalidArgument("RAM budget must be positive but is ",
+                                        ram_budget_, "."));
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -179,6 +191,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       void OptimizeThread(const std::shared_ptr<IteratorContext>& ctx) {
         int64 last_optimization_ms = 0;
         int64 optimization_period_ms = 10;
+        int64 num_optimizations = 0;
         int64 current_time_ms =
             ctx->env()->NowMicros() / EnvTime::kMillisToMicros;
         while (true) {
@@ -198,6 +211,8 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
           }
           model_->Optimize(dataset()->algorithm_, dataset()->cpu_budget_,
                            dataset()->ram_budget_);
+          num_optimizations++;
+          RecordOptimization(ctx.get(), num_optimizations);
           // Exponentially increase the period of running the optimization
           // until a threshold is reached.
           if (optimization_period_ms != kOptimizationPeriodThresholdMs) {
@@ -209,6 +224,28 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
         }
       }
 
+      // Exports the values of tunable parameters chosen by the optimization
+      // and the resulting worst-case memory usage through the stats
+      // aggregator, if any.
+      void RecordOptimization(IteratorContext* ctx, int64 num_optimizations) {
+        const auto& stats_aggregator = ctx->stats_aggregator();
+        if (!stats_aggregator) {
+          return;
+        }
+        for (const auto& pair : model_->TunableParameterValues()) {
+          stats_aggregator->AddScalar(
+              stats_utils::TunableParameterScalarName(pair.first),
+              static_cast<float>(pair.second), num_optimizations);
+        }
+        stats_aggregator->AddScalar(
+            stats_utils::MaximumBufferedBytesScalarName(prefix()),
+            static_cast<float>(model_->MaximumBufferedBytes()),
+            num_optimizations);
+        stats_aggregator->AddScalar(
+            stats_utils::RamBudgetScalarName(prefix()),
+            static_cast<float>(dataset()->ram_budget_), num_optimizations);
+      }
+
       mutex mu_;
       condition_variable cond_var_;
       std::shared_ptr<model::Model> model_;
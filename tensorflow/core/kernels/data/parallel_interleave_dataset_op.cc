@@ -97,6 +97,11 @@ constexpr double kCyclePrefetchFactor = 2.0L;
 // behavior of the original autotune implementation.
 constexpr double kPerIteratorPrefetchFactor = 2.0L;
 
+// Current workers which have no element to process read ahead up to
+// `kPerIteratorStealFactor * block_length` results beyond the per-iterator
+// prefetch limit of some other element (see `FindElementToSteal()`).
+constexpr int kPerIteratorStealFactor = 1;
+
 // The motivation for creating an alternative implementation of parallel
 // interleave is to decouple the degree of parallelism from the cycle length.
 // This makes it possible to change the degree of parallelism (e.g. through
@@ -205,6 +210,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               1),
           future_elements_prefetch_(static_cast<int>(
               params.dataset->cycle_length_ * kCyclePrefetchFactor)),
+          per_iterator_steal_prefetch_(
+              per_iterator_prefetch_ +
+              params.dataset->block_length_ * kPerIteratorStealFactor),
           mu_(std::make_shared<mutex>()),
           num_parallel_calls_cond_var_(std::make_shared<condition_variable>()),
           num_parallel_calls_(std::make_shared<model::SharedState>(
@@ -487,6 +495,29 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         AdvanceToNextInCycle();
       }
+      // No element in the cycle has a result, e.g. because the cycle is
+      // stalled on slow inputs. Take a result from an element which has not
+      // joined the cycle yet instead of waiting.
+      return ConsumeFutureResult(result);
+    }
+
+    // Consumes a result from `future_elements_` (if available), returning an
+    // indication of whether a result is available. Only used when `sloppy_` is
+    // true.
+    bool ConsumeFutureResult(std::shared_ptr<Result>* result)
+        EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (auto& element : future_elements_) {
+        if (!element->results.empty()) {
+          std::swap(*result, element->results.front());
+          element->results.pop_front();
+          if (!element->active) {
+            // Future workers do not revisit their elements, so wake up a
+            // current worker to refill the element's buffer.
+            current_workers_cond_var_.notify_one();
+          }
+          return true;
+        }
+      }
       return false;
     }
 
@@ -642,6 +673,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // claim the element by setting `element->active`, then continue to produce
     // results for the element until enough results have been computed for the
     // current cycle and the results buffer is full.
+    //
+    // A worker which finds no element that needs processing steals work
+    // instead: it reads up to `per_iterator_steal_prefetch_` results ahead for
+    // any idle current or future element. This keeps otherwise idle workers
+    // busy while the cycle waits on a slow input, so that the cycle can catch
+    // up from memory once the slow input produces its block. Each element is
+    // still read by one worker at a time, which preserves per-input order.
     void CurrentWorkerThread() LOCKS_EXCLUDED(mu_) {
       RecordStart(ctx_.get());
       auto done = [this]() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -653,6 +691,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       while (true) {
         int element_index;
         std::shared_ptr<Element> element;
+        bool stolen = false;
         // Find an element to process.
         {
           mutex_lock l(*mu_);
@@ -674,6 +713,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                 break;
               }
             }
+            if (!element && !wait_for_checkpoint_) {
+              element = FindElementToSteal();
+              stolen = element != nullptr;
+            }
             if (element) {
               break;
             }
@@ -685,13 +728,19 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             done();
             return;
           }
-          VLOG(3) << "Current worker woke up to process " << element->id;
+          VLOG(3) << "Current worker woke up to "
+                  << (stolen ? "steal " : "process ") << element->id;
           element->active = true;
+          if (stolen) {
+            ++num_stolen_elements_;
+            UpdateStealStats();
+          }
         }
         // Loop on the element until we fill its results buffer or reach end of
         // input for the element.
         while (true) {
-          ProcessElement(element);
+          ProcessElement(element, stolen ? per_iterator_steal_prefetch_
+                                         : per_iterator_prefetch_);
           {
             mutex_lock l(*mu_);
             // Check whether we have produced enough results for the current
@@ -747,13 +796,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           element->active = true;
           future_elements_.push_back(element);
         }
-        ProcessElement(element);
+        ProcessElement(element, per_iterator_prefetch_);
       }
     }
 
     // Generates results for the given element until the element's results
-    // buffer is full or the element is done producing results.
-    void ProcessElement(std::shared_ptr<Element> element) LOCKS_EXCLUDED(mu_) {
+    // buffer holds `max_results` results or the element is done producing
+    // results.
+    void ProcessElement(std::shared_ptr<Element> element, int max_results)
+        LOCKS_EXCLUDED(mu_) {
       DCHECK(element != nullptr);
       IteratorBase* iterator;
       // Initialize the inputs and iterator if necessary.
@@ -789,7 +840,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == per_iterator_prefetch_) {
+        if (element->results.size() >= max_results) {
           break;
         }
       }
@@ -882,6 +933,34 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Returns an idle element whose results buffer has room for reading ahead
+    // beyond `per_iterator_prefetch_`, or nullptr if there is none. Current
+    // elements are preferred in the order in which they will be consumed.
+    std::shared_ptr<Element> FindElementToSteal()
+        EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64 num_current_elements = last_valid_current_element_ + 1;
+      for (int64 i = 0; i < num_current_elements; ++i) {
+        const std::shared_ptr<Element>& element =
+            current_elements_[(cycle_index_ + i) % num_current_elements];
+        if (CanSteal(element)) {
+          return element;
+        }
+      }
+      for (const std::shared_ptr<Element>& element : future_elements_) {
+        if (CanSteal(element)) {
+          return element;
+        }
+      }
+      return nullptr;
+    }
+
+    bool CanSteal(const std::shared_ptr<Element>& element)
+        EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return element && !element->active && element->initialized &&
+             element->iterator &&
+             element->results.size() < per_iterator_steal_prefetch_;
+    }
+
     bool NeedsProcessing(const std::shared_ptr<Element>& element)
         EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!element) {
@@ -945,6 +1024,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    inline void UpdateStealStats() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const auto& stats_aggregator = ctx_->stats_aggregator();
+      if (stats_aggregator) {
+        stats_aggregator->AddScalar(
+            stats_utils::StolenElementsScalarName(dataset()->node_name()),
+            static_cast<float>(num_stolen_elements_), num_elements());
+      }
+    }
+
     Status WriteStatusLocked(IteratorStateWriter* writer,
                              const string& key_prefix, size_t idx,
                              const Status& status)
@@ -1166,6 +1254,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     const int per_iterator_prefetch_;
     const int future_elements_prefetch_;
+    // The number of per-iterator results that current workers read ahead when
+    // they steal work (see `CurrentWorkerThread()`).
+    const int per_iterator_steal_prefetch_;
 
     // Identifies whether the current_elements_ vector has been initialized.
     bool initial_elements_created_ GUARDED_BY(mu_) = false;
@@ -1191,6 +1282,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Number of active current worker threads.
     int num_current_active_workers_ GUARDED_BY(mu_) = 0;
 
+    // Number of times a current worker stole work, i.e. read ahead for an
+    // element that did not need processing.
+    int64 num_stolen_elements_ GUARDED_BY(mu_) = 0;
+
     // Condition variable notified whenever the total number of active workers
     // drops to zero. Used for checkpointing.
     condition_variable zero_active_workers_cond_var_;
@@ -11,7 +11,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_interleave_dataset_op.h"
 
+#include <algorithm>
+#include <numeric>
+
+#include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/data/stats_utils.h"
 
 namespace tensorflow {
 namespace data {
@@ -113,6 +118,63 @@ FunctionDefHelper::AttrValueWrapper MakeTensorSliceDatasetFunc(
                  {"output_shapes", output_shapes}});
 }
 
+// Makes a dataset of the slices of `x` that sleeps for `sleep_microseconds`
+// before producing each slice.
+FunctionDef MakeSleepTensorSliceDataset() {
+  return FunctionDefHelper::Define(
+      // Name
+      "MakeSleepTensorSliceDataset",
+      // Args
+      {"x: int64", "sleep_microseconds: int64"},
+      // Return values
+      {"y: variant"},
+      // Attr def
+      {},
+      // Nodes
+      {{{"slices"},
+        "TensorSliceDataset",
+        {"x"},
+        {{"Toutput_types", DataTypeVector({DT_INT64})},
+         {"output_shapes",
+          std::vector<PartialTensorShape>({PartialTensorShape({})})}}},
+       {{"y"},
+        "SleepDataset",
+        {"slices", "sleep_microseconds"},
+        {{"output_types", DataTypeVector({DT_INT64})},
+         {"output_shapes",
+          std::vector<PartialTensorShape>({PartialTensorShape({})})}}}});
+}
+
+// Records the last value of each scalar.
+class TestStatsAggregator : public StatsAggregator {
+ public:
+  void AddToHistogram(const string& name, gtl::ArraySlice<double> values,
+                      int64 global_step) override {}
+
+  void AddScalar(const string& name, float value, int64 global_step) override {
+    mutex_lock l(mu_);
+    scalars_[name] = value;
+  }
+
+  void EncodeToProto(Summary* out_summary) override {}
+
+  Status SetSummaryWriter(SummaryWriterInterface* summary_writer) override {
+    return errors::Unimplemented("TestStatsAggregator has no summary writer.");
+  }
+
+  void IncrementCounter(const string& name, const string& label,
+                        int64 val) override {}
+
+  float GetScalar(const string& name) {
+    mutex_lock l(mu_);
+    return scalars_[name];
+  }
+
+ private:
+  mutex mu_;
+  std::map<string, float> scalars_ GUARDED_BY(mu_);
+};
+
 // test case 1: cycle_length = 1, block_length = 1, num_parallel_calls = 1,
 // sloppy = false
 ParallelInterleaveDatasetParams ParallelInterleaveDatasetParams1() {
@@ -696,6 +758,70 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(ParallelInterleaveDatasetOpTest,
                                  ParallelInterleaveDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// The first input sleeps before each of its elements, so the cycle waits on it
+// while the other current worker runs out of elements to process.
+TEST_F(ParallelInterleaveDatasetOpTest, IdleWorkersStealWork) {
+  constexpr int64 kNumInputs = 4;
+  constexpr int64 kNumElementsPerInput = 8;
+  std::vector<int64> values(kNumInputs * kNumElementsPerInput);
+  std::iota(values.begin(), values.end(), 0);
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(
+                          TensorShape{kNumInputs, kNumElementsPerInput},
+                          values),
+                      CreateTensor<int64>(TensorShape{kNumInputs},
+                                          {20 * 1000, 0, 0, 0})},
+      /*node_name=*/"tensor_slice");
+  auto dataset_params = ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/2,
+      /*block_length=*/1,
+      /*num_parallel_calls=*/2,
+      /*func=*/FunctionDefHelper::FunctionRef("MakeSleepTensorSliceDataset"),
+      /*func_lib=*/{MakeSleepTensorSliceDataset()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*sloppy=*/true,
+      /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  auto stats_aggregator = std::make_shared<TestStatsAggregator>();
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.stats_aggregator = stats_aggregator;
+  IteratorContext iterator_ctx(std::move(params));
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(
+      &iterator_ctx, dataset_params.iterator_prefix(), &iterator));
+
+  // The first call starts the workers. While nothing is consumed, the worker
+  // that is not stuck on the first input fills its element's buffer and then
+  // reads ahead for idle elements.
+  bool end_of_sequence = false;
+  std::vector<Tensor> next;
+  std::vector<int64> outputs;
+  TF_ASSERT_OK(iterator->GetNext(&iterator_ctx, &next, &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  outputs.push_back(next[0].scalar<int64>()());
+  const string stolen_elements_name =
+      stats_utils::StolenElementsScalarName(kNodeName);
+  for (int i = 0; i < 1000; ++i) {
+    if (stats_aggregator->GetScalar(stolen_elements_name) > 0) break;
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+  }
+  EXPECT_GT(stats_aggregator->GetScalar(stolen_elements_name), 0);
+
+  while (true) {
+    next.clear();
+    TF_ASSERT_OK(iterator->GetNext(&iterator_ctx, &next, &end_of_sequence));
+    if (end_of_sequence) break;
+    outputs.push_back(next[0].scalar<int64>()());
+  }
+  // Sloppy output is still a permutation of the input elements.
+  std::sort(outputs.begin(), outputs.end());
+  EXPECT_EQ(outputs, values);
+}
+
 TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
   std::vector<ParallelInterleaveDatasetParams> invalid_params = {
       ParallelInterleaveDatasetParamsWithInvalidCycleLength(),
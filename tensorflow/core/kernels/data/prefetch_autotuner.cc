@@ -15,13 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/model.h"
 
 namespace tensorflow {
 namespace data {
 
-PrefetchAutotuner::PrefetchAutotuner(int64 initial_buffer_size)
-    : buffer_limit_(initial_buffer_size) {
+PrefetchAutotuner::PrefetchAutotuner(int64 initial_buffer_size,
+                                     int64 max_buffer_bytes)
+    : buffer_limit_(initial_buffer_size), max_buffer_bytes_(max_buffer_bytes) {
   if (initial_buffer_size == model::kAutotune) {
     mode_ = Mode::kUpswing;
     buffer_limit_ = 1;
@@ -33,19 +36,52 @@ namespace {
 // limits less than the threshold, an exponential increase is used, while for
 // limits greater than or equal to the threshold, a linear increase is used.
 size_t kBufferLimitThreshold = 2048;
+
+// The weight of the most recent element in the moving average of element
+// sizes.
+constexpr double kElementBytesDecay = 0.1;
 }  // namespace
 
+int64 PrefetchAutotuner::buffer_limit() const {
+  if (mode_ == Mode::kDisabled) {
+    return buffer_limit_;
+  }
+  return std::min(buffer_limit_, byte_limit());
+}
+
+int64 PrefetchAutotuner::byte_limit() const {
+  if (max_buffer_bytes_ <= 0 || average_element_bytes_ <= 0) {
+    return kint64max;
+  }
+  return std::max<int64>(
+      1, static_cast<int64>(max_buffer_bytes_ / average_element_bytes_));
+}
+
+void PrefetchAutotuner::RecordElementBytes(int64 bytes) {
+  if (max_buffer_bytes_ <= 0) {
+    return;
+  }
+  if (average_element_bytes_ == 0) {
+    average_element_bytes_ = bytes;
+  } else {
+    average_element_bytes_ = (1 - kElementBytesDecay) * average_element_bytes_ +
+                             kElementBytesDecay * bytes;
+  }
+}
+
 void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
   switch (mode_) {
     case Mode::kDisabled:
       return;
     case Mode::kUpswing:
-      if (current_buffer_size == buffer_limit_) {
+      if (current_buffer_size >= buffer_limit()) {
         mode_ = Mode::kDownswing;
       }
       return;
     case Mode::kDownswing:
-      if (current_buffer_size == 0) {
+      // Once the byte budget caps the buffer, growing the limit further would
+      // not let the buffer hold more elements.
+      if (current_buffer_size == 0 && buffer_limit_ < byte_limit()) {
         if (buffer_limit_ >= kBufferLimitThreshold) {
           buffer_limit_ += kBufferLimitThreshold;
         } else {
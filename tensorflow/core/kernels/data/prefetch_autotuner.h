@@ -33,19 +33,28 @@ namespace data {
 // if the prefetching thread is able to successfully fill the buffer at its
 // current size.
 //
-// Note: in the current implementation, we never decrease the buffer_limit().
-// This should change in the future!
+// If `max_buffer_bytes` is positive, the buffer_limit() is additionally capped
+// at the number of elements that fit in `max_buffer_bytes` bytes, based on a
+// moving average of the element sizes passed to RecordElementBytes(). The cap
+// shrinks the buffer when elements get larger and lets it grow back when they
+// get smaller, and PrefetchAutotuner stops increasing the buffer_limit() once
+// it reaches the cap. Without a byte budget, we never decrease the
+// buffer_limit().
 //
 // PrefetchAutotuner is NOT thread safe.
 class PrefetchAutotuner {
  public:
-  explicit PrefetchAutotuner(int64 initial_buffer_size);
+  explicit PrefetchAutotuner(int64 initial_buffer_size,
+                             int64 max_buffer_bytes = 0);
 
-  int64 buffer_limit() const { return buffer_limit_; }
+  int64 buffer_limit() const;
 
   void RecordConsumption(size_t current_buffer_size);
   void RecordEmpty() { RecordConsumption(0); }
 
+  // Records the size of an element that was added to the buffer.
+  void RecordElementBytes(int64 bytes);
+
  private:
   // PrefetchAutotuner operates as a state machine.
   enum class Mode {
@@ -61,8 +70,14 @@ class PrefetchAutotuner {
     kDownswing,
   };
 
+  // Returns the number of elements of average size that fit in the byte
+  // budget, or `kint64max` if there is no budget.
+  int64 byte_limit() const;
+
   int64 buffer_limit_;
   Mode mode_ = Mode::kDisabled;
+  const int64 max_buffer_bytes_;
+  double average_element_bytes_ = 0;
 };
 
 }  // namespace data
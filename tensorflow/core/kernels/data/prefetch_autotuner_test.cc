@@ -80,6 +80,46 @@ TEST(PrefetchAutotuner, EnabledSteady) {
   }
 }
 
+TEST(PrefetchAutotuner, ByteBudget) {
+  PrefetchAutotuner t(model::kAutotune, /*max_buffer_bytes=*/1050);
+  EXPECT_EQ(1, t.buffer_limit());
+  t.RecordElementBytes(100);
+  t.RecordConsumption(1);
+  t.RecordConsumption(0);  // Expect buffer limit to increase.
+  EXPECT_EQ(2, t.buffer_limit());
+  t.RecordConsumption(2);
+  t.RecordConsumption(0);  // Expect buffer limit to increase.
+  EXPECT_EQ(4, t.buffer_limit());
+  t.RecordConsumption(4);
+  t.RecordConsumption(0);  // Expect buffer limit to increase up to the budget.
+  EXPECT_EQ(8, t.buffer_limit());
+  t.RecordConsumption(8);
+  t.RecordConsumption(0);  // Expect buffer limit to be capped by the budget.
+  EXPECT_EQ(10, t.buffer_limit());
+  t.RecordConsumption(10);
+  t.RecordConsumption(0);  // Expect buffer limit to stay at the budget.
+  EXPECT_EQ(10, t.buffer_limit());
+
+  // Larger elements shrink the buffer limit.
+  for (int i = 0; i < 100; ++i) {
+    t.RecordElementBytes(500);
+  }
+  EXPECT_EQ(2, t.buffer_limit());
+
+  // Smaller elements let it grow back.
+  for (int i = 0; i < 100; ++i) {
+    t.RecordElementBytes(100);
+  }
+  EXPECT_EQ(10, t.buffer_limit());
+}
+
+TEST(PrefetchAutotuner, ByteBudgetDisabled) {
+  // A fixed buffer size is not changed by the byte budget.
+  PrefetchAutotuner t(4, /*max_buffer_bytes=*/100);
+  t.RecordElementBytes(1000);
+  EXPECT_EQ(4, t.buffer_limit());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -41,6 +41,7 @@ namespace data {
 /* static */ constexpr const char* const PrefetchDatasetOp::kOutputShapes;
 /* static */ constexpr const char* const PrefetchDatasetOp::kSlackPeriod;
 /* static */ constexpr const char* const PrefetchDatasetOp::kLegacyAutotune;
+/* static */ constexpr const char* const PrefetchDatasetOp::kMaxBufferBytes;
 
 // Determines the fraction of slack time by which to delay prefetching of data.
 constexpr double kSleepFactor = 0.2;
@@ -53,12 +54,13 @@ constexpr char kErrorMessageSuffix[] = ".error_message";
 class PrefetchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
-          int64 slack_period, bool legacy_autotune)
+          int64 slack_period, bool legacy_autotune, int64 max_buffer_bytes)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
-        legacy_autotune_(legacy_autotune) {
+        legacy_autotune_(legacy_autotune),
+        max_buffer_bytes_(max_buffer_bytes) {
     input_->Ref();
   }
 
@@ -98,9 +100,13 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
     AttrValue slack_period_attr;
     b->BuildAttrValue(slack_period_, &slack_period_attr);
+    AttrValue max_buffer_bytes_attr;
+    b->BuildAttrValue(max_buffer_bytes_, &max_buffer_bytes_attr);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this, {input_graph_node, buffer_size},
-        {std::make_pair(kSlackPeriod, slack_period_attr)}, output));
+        {std::make_pair(kSlackPeriod, slack_period_attr),
+         std::make_pair(kMaxBufferBytes, max_buffer_bytes_attr)},
+        output));
     return Status::OK();
   }
 
@@ -112,7 +118,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           mu_(std::make_shared<mutex>()),
           parent_mu_(std::make_shared<mutex>()),
           cond_var_(std::make_shared<condition_variable>()),
-          auto_tuner_(params.dataset->buffer_size_),
+          auto_tuner_(params.dataset->buffer_size_,
+                      params.dataset->max_buffer_bytes_),
           legacy_autotune_(params.dataset->legacy_autotune_),
           buffer_size_(std::make_shared<model::SharedState>(
               legacy_autotune_ ? 0 : params.dataset->buffer_size_, mu_,
@@ -263,6 +270,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       mutex_lock parent_l(*parent_mu_);
       mutex_lock l(*mu_);
       buffer_.clear();
+      buffered_bytes_ = 0;
       TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
       size_t buffer_size;
       {
@@ -291,6 +299,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
                 &buffer_element.value.back()));
           }
         }
+        if (dataset()->max_buffer_bytes_ > 0) {
+          buffer_element.bytes = GetAllocatedBytes(buffer_element.value);
+          buffered_bytes_ += buffer_element.bytes;
+        }
       }
       return Status::OK();
     }
@@ -304,6 +316,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       // The buffered data element.
       std::vector<Tensor> value;
       int64 created_us;
+      // The number of bytes allocated for `value`.
+      int64 bytes = 0;
     };
 
     inline int64 buffer_limit() EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
@@ -313,6 +327,14 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       return buffer_size_->value;
     }
 
+    // Returns true if the buffered elements use up the byte budget. The
+    // buffer always admits one element, so the budget may be exceeded by the
+    // size of the most recently buffered element.
+    inline bool ByteBudgetExhausted() EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      return dataset()->max_buffer_bytes_ > 0 && !buffer_.empty() &&
+             buffered_bytes_ >= dataset()->max_buffer_bytes_;
+    }
+
     Status Consume(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                    bool* end_of_sequence) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       const auto& stats_aggregator = ctx->stats_aggregator();
@@ -355,6 +377,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         auto_tuner_.RecordConsumption(buffer_.size());
         buffer_size_->value = auto_tuner_.buffer_limit();
       }
+      buffered_bytes_ -= buffer_.front().bytes;
       buffer_.pop_front();
       *end_of_sequence = false;
 
@@ -390,7 +413,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         // 1. Wait for a slot in the buffer.
         {
           mutex_lock l(*mu_);
-          while (!cancelled_ && buffer_.size() >= buffer_limit()) {
+          while (!cancelled_ &&
+                 (buffer_.size() >= buffer_limit() || ByteBudgetExhausted())) {
             RecordStop(ctx.get());
             cond_var_->wait(l);
             RecordStart(ctx.get());
@@ -434,6 +458,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           mutex_lock l(*mu_);
           RecordBufferEnqueue(ctx.get(), buffer_element.value);
           buffer_element.created_us = ctx->env()->NowMicros();
+          if (dataset()->max_buffer_bytes_ > 0) {
+            buffer_element.bytes = GetAllocatedBytes(buffer_element.value);
+            buffered_bytes_ += buffer_element.bytes;
+            auto_tuner_.RecordElementBytes(buffer_element.bytes);
+          }
           buffer_.push_back(std::move(buffer_element));
           cond_var_->notify_all();
         }
@@ -490,6 +519,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     const std::shared_ptr<condition_variable> cond_var_;
     PrefetchAutotuner auto_tuner_ GUARDED_BY(*mu_);
     std::deque<BufferElement> buffer_ GUARDED_BY(*mu_);
+    // The total bytes of the elements in `buffer_`, if there is a byte budget.
+    int64 buffered_bytes_ GUARDED_BY(*mu_) = 0;
     std::unique_ptr<Thread> prefetch_thread_ GUARDED_BY(*mu_);
     bool cancelled_ GUARDED_BY(*mu_) = false;
     bool prefetch_thread_finished_ GUARDED_BY(*mu_) = false;
@@ -510,6 +541,9 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
 
   // Determines whether legacy autotuning should be used.
   const bool legacy_autotune_ = true;
+
+  // If positive, the maximum number of bytes of buffered elements.
+  const int64 max_buffer_bytes_;
 };
 
 PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
@@ -520,6 +554,11 @@ PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
   if (ctx->HasAttr(kLegacyAutotune)) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kLegacyAutotune, &legacy_autotune_));
   }
+  if (ctx->HasAttr(kMaxBufferBytes)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMaxBufferBytes, &max_buffer_bytes_));
+    OP_REQUIRES(ctx, max_buffer_bytes_ >= 0,
+                errors::InvalidArgument("max_buffer_bytes must be >= 0"));
+  }
 }
 
 void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -536,8 +575,8 @@ void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     metrics::RecordTFDataAutotune(kDatasetType);
   }
 
-  *output =
-      new Dataset(ctx, input, buffer_size, slack_period_, legacy_autotune_);
+  *output = new Dataset(ctx, input, buffer_size, slack_period_,
+                        legacy_autotune_, max_buffer_bytes_);
 }
 
 namespace {
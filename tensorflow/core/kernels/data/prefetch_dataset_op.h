@@ -31,6 +31,7 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kSlackPeriod = "slack_period";
   static constexpr const char* const kLegacyAutotune = "legacy_autotune";
+  static constexpr const char* const kMaxBufferBytes = "max_buffer_bytes";
 
   explicit PrefetchDatasetOp(OpKernelConstruction* ctx);
 
@@ -42,6 +43,7 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
   class Dataset;
   int64 slack_period_ = 0;
   bool legacy_autotune_ = true;
+  int64 max_buffer_bytes_ = 0;
 };
 
 }  // namespace data
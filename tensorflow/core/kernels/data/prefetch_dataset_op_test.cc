@@ -29,12 +29,13 @@ class PrefetchDatasetParams : public DatasetParams {
                         DataTypeVector output_dtypes,
                         std::vector<PartialTensorShape> output_shapes,
                         int slack_period, bool legacy_autotune,
-                        string node_name)
+                        int64 max_buffer_bytes, string node_name)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
-        legacy_autotune_(legacy_autotune) {
+        legacy_autotune_(legacy_autotune),
+        max_buffer_bytes_(max_buffer_bytes) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -59,6 +60,8 @@ class PrefetchDatasetParams : public DatasetParams {
     attr_vector->emplace_back(PrefetchDatasetOp::kSlackPeriod, slack_period_);
     attr_vector->emplace_back(PrefetchDatasetOp::kLegacyAutotune,
                               legacy_autotune_);
+    attr_vector->emplace_back(PrefetchDatasetOp::kMaxBufferBytes,
+                              max_buffer_bytes_);
     return Status::OK();
   }
 
@@ -70,6 +73,7 @@ class PrefetchDatasetParams : public DatasetParams {
   int64 buffer_size_;
   int slack_period_;
   bool legacy_autotune_;
+  int64 max_buffer_bytes_;
 };
 
 // Test case 1: positive buffer size.
@@ -85,6 +89,7 @@ PrefetchDatasetParams PrefetchDatasetParams1() {
       /*output_shapes=*/{PartialTensorShape({1})},
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/0,
       /*node_name=*/kNodeName);
 }
 
@@ -101,6 +106,7 @@ PrefetchDatasetParams PrefetchDatasetParams2() {
       /*output_shapes=*/{PartialTensorShape({1})},
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/0,
       /*node_name=*/kNodeName);
 }
 
@@ -117,6 +123,7 @@ PrefetchDatasetParams PrefetchDatasetParams3() {
       /*output_shapes=*/{PartialTensorShape({1})},
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/0,
       /*node_name=*/kNodeName);
 }
 
@@ -133,6 +140,7 @@ PrefetchDatasetParams PrefetchDatasetParams4() {
       /*output_shapes=*/{PartialTensorShape({1})},
       /*slack_period=*/5,
       /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/0,
       /*node_name=*/kNodeName);
 }
 
@@ -149,6 +157,42 @@ PrefetchDatasetParams PrefetchDatasetParams5() {
       /*output_shapes=*/{PartialTensorShape({1})},
       /*slack_period=*/5,
       /*legacy_autotune=*/false,
+      /*max_buffer_bytes=*/0,
+      /*node_name=*/kNodeName);
+}
+
+// Test case 6: autotune buffer size with a byte budget of two elements.
+PrefetchDatasetParams PrefetchDatasetParams6() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{10, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      /*node_name=*/"tensor_slice");
+  return PrefetchDatasetParams(
+      /*input_dataset_params=*/tensor_slice_dataset_params,
+      /*buffer_size=*/-1,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*slack_period=*/0,
+      /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/2 * sizeof(int64),
+      /*node_name=*/kNodeName);
+}
+
+// Test case 7: positive buffer size with a byte budget smaller than one
+// element.
+PrefetchDatasetParams PrefetchDatasetParams7() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{10, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      /*node_name=*/"tensor_slice");
+  return PrefetchDatasetParams(
+      /*input_dataset_params=*/tensor_slice_dataset_params,
+      /*buffer_size=*/5,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*slack_period=*/0,
+      /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/1,
       /*node_name=*/kNodeName);
 }
 
@@ -164,6 +208,23 @@ PrefetchDatasetParams InvalidBufferSizePrefetchDatasetParams() {
       /*output_shapes=*/{PartialTensorShape({1})},
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/0,
+      /*node_name=*/kNodeName);
+}
+
+PrefetchDatasetParams InvalidMaxBufferBytesPrefetchDatasetParams() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{10, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      /*node_name=*/"tensor_slice");
+  return PrefetchDatasetParams(
+      /*input_dataset_params=*/tensor_slice_dataset_params,
+      /*buffer_size=*/5,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*slack_period=*/0,
+      /*legacy_autotune=*/true,
+      /*max_buffer_bytes=*/-1,
       /*node_name=*/kNodeName);
 }
 
@@ -190,6 +251,18 @@ std::vector<GetNextTestCase<PrefetchDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/
        PrefetchDatasetParams5(),
        /*expected_outputs=*/
+       CreateTensors<int64>(
+           TensorShape{1},
+           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams6(),
+       /*expected_outputs=*/
+       CreateTensors<int64>(
+           TensorShape{1},
+           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams7(),
+       /*expected_outputs=*/
        CreateTensors<int64>(
            TensorShape{1},
            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})}};
@@ -287,6 +360,20 @@ IteratorSaveAndRestoreTestCases() {
        PrefetchDatasetParams5(),
        /*breakpoints=*/{0, 4, 11},
        /*expected_outputs=*/
+       CreateTensors<int64>(
+           TensorShape{1},
+           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams6(),
+       /*breakpoints=*/{0, 4, 11},
+       /*expected_outputs=*/
+       CreateTensors<int64>(
+           TensorShape{1},
+           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams7(),
+       /*breakpoints=*/{0, 4, 11},
+       /*expected_outputs=*/
        CreateTensors<int64>(
            TensorShape{1},
            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})}};
@@ -300,6 +387,11 @@ TEST_F(PrefetchDatasetOpTest, InvalidBufferSize) {
   EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
 }
 
+TEST_F(PrefetchDatasetOpTest, InvalidMaxBufferBytes) {
+  auto dataset_params = InvalidMaxBufferBytesPrefetchDatasetParams();
+  EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -75,6 +75,19 @@ class RangeDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return Status::OK(); }
 
+  bool SupportsRandomAccess() const override { return true; }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index ", index, " is out of range for ",
+                                DebugString(), ".");
+    }
+    out_tensors->clear();
+    out_tensors->emplace_back(start_ + index * step_);
+    return Status::OK();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
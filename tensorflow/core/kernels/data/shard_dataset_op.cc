@@ -128,15 +128,31 @@ class ShardDatasetOp::Dataset : public DatasetBase {
         return Status::OK();
       }
 
-      std::vector<Tensor> result;
-      do {
-        result.clear();
-        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &result, end_of_sequence));
+      // Skip the elements of the other shards that precede the next element
+      // of this shard.
+      const int64 num_to_skip =
+          (dataset()->index_ - next_index_ % dataset()->num_shards_ +
+           dataset()->num_shards_) %
+          dataset()->num_shards_;
+      if (num_to_skip > 0) {
+        int64 num_skipped;
+        Status s = input_impl_->Skip(ctx, num_to_skip, end_of_sequence,
+                                     &num_skipped);
+        next_index_ += num_skipped;
+        TF_RETURN_IF_ERROR(s);
         if (*end_of_sequence) {
           input_impl_.reset();
           return Status::OK();
         }
-      } while ((next_index_++ % dataset()->num_shards_) != dataset()->index_);
+      }
+
+      std::vector<Tensor> result;
+      TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &result, end_of_sequence));
+      if (*end_of_sequence) {
+        input_impl_.reset();
+        return Status::OK();
+      }
+      ++next_index_;
 
       while (dataset()->require_non_empty_ &&
              next_index_ < dataset()->num_shards_) {
@@ -12,6 +12,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/shard_dataset_op.h"
 
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/data/range_dataset_op.h"
 
 namespace tensorflow {
 namespace data {
@@ -316,6 +317,38 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(ShardDatasetOpTest, ShardDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// The elements of the other shards are skipped, but still count as produced by
+// the input in the model.
+TEST_F(ShardDatasetOpTest, ModelCountsSkippedElements) {
+  auto dataset_params = ShardDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.model = std::make_shared<model::Model>(
+      [](std::shared_ptr<model::Node> node) {});
+  IteratorContext iterator_ctx(std::move(params));
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(
+      &iterator_ctx, dataset_params.iterator_prefix(), &iterator));
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  int64 num_outputs = 0;
+  while (true) {
+    TF_ASSERT_OK(
+        iterator->GetNext(&iterator_ctx, &out_tensors, &end_of_sequence));
+    if (end_of_sequence) break;
+    ++num_outputs;
+  }
+  EXPECT_EQ(num_outputs, 2);
+
+  const string shard_prefix = name_utils::IteratorPrefix(
+      ShardDatasetOp::kDatasetType, dataset_params.iterator_prefix());
+  const string range_prefix =
+      name_utils::IteratorPrefix(RangeDatasetOp::kDatasetType, shard_prefix);
+  EXPECT_EQ(iterator_ctx.model()->NumElements(shard_prefix), 2);
+  EXPECT_EQ(iterator_ctx.model()->NumElements(range_prefix), 10);
+}
+
 TEST_F(ShardDatasetOpTest, NoElemForEachShard) {
   auto dataset_params = InvalidShardDatasetParamsWithNoElemForEachShard();
   TF_ASSERT_OK(Initialize(dataset_params));
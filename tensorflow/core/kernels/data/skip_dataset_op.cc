@@ -139,21 +139,17 @@ class SkipDatasetOp::Dataset : public DatasetBase {
         return Status::OK();
       }
 
-      // Keep calling GetNext().  TODO(vrv): Figure out a way to
-      // skip records without reading, perhaps by adding an
-      // interface to iterator.
-      while (i_ < dataset()->count_) {
-        // Fetch and throw away Tensors.
-        std::vector<Tensor> dummy_out_tensors;
-        TF_RETURN_IF_ERROR(
-            input_impl_->GetNext(ctx, &dummy_out_tensors, end_of_sequence));
+      if (i_ < dataset()->count_) {
+        int64 num_skipped;
+        Status s = input_impl_->Skip(ctx, dataset()->count_ - i_,
+                                     end_of_sequence, &num_skipped);
+        i_ += num_skipped;
+        TF_RETURN_IF_ERROR(s);
         if (*end_of_sequence) {
           // We reached the end before the count was reached.
           input_impl_.reset();
           return Status::OK();
         }
-
-        ++i_;
       }
 
       // Return GetNext() on the underlying iterator.
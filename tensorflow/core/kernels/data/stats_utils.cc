@@ -32,6 +32,10 @@ ABSL_CONST_INIT const char kDroppedElements[] = "dropped_elements";
 ABSL_CONST_INIT const char kFeaturesCount[] = "features_count";
 ABSL_CONST_INIT const char kFeatureValuesCount[] = "feature_values_count";
 ABSL_CONST_INIT const char kExamplesCount[] = "examples_count";
+ABSL_CONST_INIT const char kTunableParameter[] = "tunable_parameter";
+ABSL_CONST_INIT const char kMaximumBufferedBytes[] = "maximum_buffered_bytes";
+ABSL_CONST_INIT const char kRamBudget[] = "ram_budget";
+ABSL_CONST_INIT const char kStolenElements[] = "stolen_elements";
 
 string ExecutionTimeHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kExecutionTime);
@@ -69,6 +73,22 @@ string FeatureValueHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kFeatureValuesCount);
 }
 
+string TunableParameterScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kTunableParameter);
+}
+
+string MaximumBufferedBytesScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kMaximumBufferedBytes);
+}
+
+string RamBudgetScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kRamBudget);
+}
+
+string StolenElementsScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kStolenElements);
+}
+
 }  // namespace stats_utils
 }  // namespace data
 }  // namespace tensorflow
@@ -31,6 +31,9 @@ extern const char kDroppedElements[];
 extern const char kFeaturesCount[];
 extern const char kFeatureValuesCount[];
 extern const char kExamplesCount[];
+extern const char kTunableParameter[];
+extern const char kMaximumBufferedBytes[];
+extern const char kRamBudget[];
 
 // Name for tf.data function execution time (in ns) histogram metrics.
 string ExecutionTimeHistogramName(const string& prefix);
@@ -61,6 +64,20 @@ string FeatureHistogramName(const string& prefix);
 // Name for feature-values count histogram metrics.
 string FeatureValueHistogramName(const string& prefix);
 
+// Name for autotuned parameter value scalar metrics.
+string TunableParameterScalarName(const string& prefix);
+
+// Name for worst-case buffered bytes (the memory used by tunable buffers if
+// they were full) scalar metrics.
+string MaximumBufferedBytesScalarName(const string& prefix);
+
+// Name for autotuning RAM budget scalar metrics.
+string RamBudgetScalarName(const string& prefix);
+
+// Name for the scalar metrics counting the elements that idle workers read
+// ahead for, i.e. stole work from.
+string StolenElementsScalarName(const string& prefix);
+
 }  // namespace stats_utils
 }  // namespace data
 }  // namespace tensorflow
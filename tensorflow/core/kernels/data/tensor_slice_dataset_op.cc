@@ -70,6 +70,26 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return Status::OK(); }
 
+  bool SupportsRandomAccess() const override { return true; }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index ", index, " is out of range for ",
+                                DebugString(), ".");
+    }
+    out_tensors->clear();
+    out_tensors->reserve(tensors_.size());
+    for (int i = 0; i < tensors_.size(); ++i) {
+      const Tensor& t = tensors_[i];
+      out_tensors->emplace_back(ctx->allocator({}), t.dtype(),
+                                TensorShape(shapes_[i].dim_sizes()));
+      TF_RETURN_IF_ERROR(
+          batch_util::CopySliceToElement(t, &out_tensors->back(), index));
+    }
+    return Status::OK();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -116,16 +136,7 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
       }
-      out_tensors->clear();
-      out_tensors->reserve(dataset()->tensors_.size());
-      for (int i = 0; i < dataset()->tensors_.size(); ++i) {
-        const Tensor& t = dataset()->tensors_[i];
-        out_tensors->emplace_back(
-            ctx->allocator({}), t.dtype(),
-            TensorShape(dataset()->shapes_[i].dim_sizes()));
-        TF_RETURN_IF_ERROR(
-            batch_util::CopySliceToElement(t, &out_tensors->back(), index));
-      }
+      TF_RETURN_IF_ERROR(dataset()->Get(ctx, index, out_tensors));
       *end_of_sequence = false;
       return Status::OK();
     }
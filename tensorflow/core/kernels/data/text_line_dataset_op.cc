@@ -186,8 +186,10 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       // Actually move on to next file.
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
           dataset()->filenames_[current_file_index_], &file_));
-      input_stream_ =
-          absl::make_unique<io::RandomAccessInputStream>(file_.get(), false);
+      // Lines are read sequentially, so read the next buffer while the
+      // current one is consumed, if the file supports asynchronous reads.
+      input_stream_ = absl::make_unique<io::RandomAccessInputStream>(
+          file_.get(), /*owns_file=*/false, /*read_ahead=*/true);
 
       if (dataset()->use_compression_) {
         zlib_input_stream_ = absl::make_unique<io::ZlibInputStream>(
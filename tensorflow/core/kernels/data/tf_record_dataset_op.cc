@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -22,8 +25,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
 namespace data {
@@ -35,22 +40,43 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseIndex;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseMmap;
+/* static */ constexpr const char* const TFRecordDatasetOp::kVerifyChecksums;
+/* static */ constexpr const char* const TFRecordDatasetOp::kIndexFileSuffix;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
 
+// The number of records of a mapped file that are checksummed together.
+constexpr size_t kMappedRecordBatchSize = 64;
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
+  // If `use_index` is true, `num_records[i]` is the number of records in
+  // `filenames[i]`, as given by its index.
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   bool use_index, std::vector<int64> num_records,
+                   bool use_mmap, bool verify_checksums)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        use_index_(use_index),
+        use_mmap_(use_mmap),
+        verify_checksums_(verify_checksums),
+        record_limits_(num_records.size()),
+        indexed_files_(use_index ? filenames_.size() : 0) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    int64 limit = 0;
+    for (size_t i = 0; i < num_records.size(); ++i) {
+      limit += num_records[i];
+      record_limits_[i] = limit;
+    }
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -74,6 +100,58 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType);
   }
 
+  int64 Cardinality() const override {
+    if (!use_index_) {
+      return kUnknownCardinality;
+    }
+    return record_limits_.empty() ? 0 : record_limits_.back();
+  }
+
+  bool SupportsRandomAccess() const override { return use_index_; }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (!use_index_) {
+      return DatasetBase::Get(ctx, index, out_tensors);
+    }
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index ", index, " is out of range for ",
+                                DebugString(), ".");
+    }
+    // Find the file that contains the record, and its position in that file.
+    const size_t file_index =
+        std::upper_bound(record_limits_.begin(), record_limits_.end(), index) -
+        record_limits_.begin();
+    const int64 record_index =
+        file_index == 0 ? index : index - record_limits_[file_index - 1];
+    IndexedFile* indexed_file;
+    TF_RETURN_IF_ERROR(GetIndexedFile(ctx->env(), file_index, &indexed_file));
+    uint64 offset;
+    TF_RETURN_IF_ERROR(indexed_file->index->GetOffset(record_index, &offset));
+
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx->allocator({}), DT_STRING, TensorShape({}));
+    tstring& record = out_tensors->back().scalar<tstring>()();
+    Status s;
+    if (indexed_file->mapped_reader) {
+      StringPiece record_view;
+      s = indexed_file->mapped_reader->ReadRecord(&offset, &record_view);
+      if (s.ok()) {
+        record = record_view;
+      }
+    } else {
+      io::RecordReader reader(indexed_file->file.get());
+      s = reader.ReadRecord(&offset, &record);
+    }
+    if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("The index of ", filenames_[file_index],
+                           " refers to a record past the end of the file.");
+    }
+    TF_RETURN_IF_ERROR(s);
+    metrics::RecordTFDataBytesRead(kDatasetType, record.size());
+    return Status::OK();
+  }
+
   Status CheckExternalState() const override { return Status::OK(); }
 
  protected:
@@ -86,12 +164,87 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    AttrValue use_index;
+    b->BuildAttrValue(use_index_, &use_index);
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
+    AttrValue verify_checksums;
+    b->BuildAttrValue(verify_checksums_, &verify_checksums);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {std::make_pair(kUseIndex, use_index),
+         std::make_pair(kUseMmap, use_mmap),
+         std::make_pair(kVerifyChecksums, verify_checksums)},
+        output));
     return Status::OK();
   }
 
  private:
+  // A TFRecord file and its index, opened for random access.
+  struct IndexedFile {
+    // If the file is mapped into memory, `mapped_reader` borrows the object
+    // that `region` points to, and `file` is null.
+    std::unique_ptr<RandomAccessFile> file;
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    std::unique_ptr<io::MappedRecordReader> mapped_reader;
+    // `index` borrows the object that `index_file` points to.
+    std::unique_ptr<RandomAccessFile> index_file;
+    std::unique_ptr<io::RecordIndexReader> index;
+  };
+
+  // If `use_mmap_` is set, maps `filename` into memory and stores the mapping
+  // in `*region`. Leaves `*region` null if the file is empty, or if its file
+  // system does not support mapping, in which case the file should be read
+  // through a `RandomAccessFile` instead.
+  Status MaybeMapFile(Env* env, const string& filename,
+                      std::unique_ptr<ReadOnlyMemoryRegion>* region) const {
+    region->reset();
+    if (!use_mmap_) {
+      return Status::OK();
+    }
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+    if (file_size == 0) {
+      // Empty files cannot be mapped, and have no records to read anyway.
+      return Status::OK();
+    }
+    Status s = env->NewReadOnlyMemoryRegionFromFile(filename, region);
+    if (errors::IsUnimplemented(s)) {
+      VLOG(1) << "Not mapping " << filename << " into memory: " << s;
+      region->reset();
+      return Status::OK();
+    }
+    return s;
+  }
+
+  // Opens `filenames_[file_index]` and its index on first use, and stores
+  // them in `*indexed_file`, which remains valid for the lifetime of the
+  // dataset.
+  Status GetIndexedFile(Env* env, size_t file_index,
+                        IndexedFile** indexed_file) const {
+    mutex_lock l(mu_);
+    IndexedFile& result = indexed_files_[file_index];
+    if (!result.index) {
+      const string& filename = filenames_[file_index];
+      const string index_filename = strings::StrCat(filename, kIndexFileSuffix);
+      uint64 index_file_size;
+      TF_RETURN_IF_ERROR(env->GetFileSize(index_filename, &index_file_size));
+      TF_RETURN_IF_ERROR(MaybeMapFile(env, filename, &result.region));
+      if (result.region) {
+        result.mapped_reader = absl::make_unique<io::MappedRecordReader>(
+            result.region.get(), verify_checksums_);
+      } else {
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &result.file));
+      }
+      TF_RETURN_IF_ERROR(
+          env->NewRandomAccessFile(index_filename, &result.index_file));
+      result.index = absl::make_unique<io::RecordIndexReader>(
+          result.index_file.get(), index_file_size);
+    }
+    *indexed_file = &result;
+    return Status::OK();
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
@@ -103,11 +256,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
+        if (StreamsOpenLocked()) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
                                     TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+          Status s = ReadRecordLocked(&out_tensors->back().scalar<tstring>()());
           if (s.ok()) {
             metrics::RecordTFDataBytesRead(
                 kDatasetType, out_tensors->back().scalar<tstring>()().size());
@@ -146,14 +298,57 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       return model::MakeSourceNode(std::move(args));
     }
 
+    // With an index, records are skipped by seeking past them, so skipping
+    // costs one index lookup per file instead of reading every record.
+    Status SkipInternal(IteratorContext* ctx, int64 num_to_skip,
+                        bool* end_of_sequence, int64* num_skipped) override {
+      if (!dataset()->use_index_) {
+        return DatasetIterator<Dataset>::SkipInternal(
+            ctx, num_to_skip, end_of_sequence, num_skipped);
+      }
+      mutex_lock l(mu_);
+      *end_of_sequence = false;
+      *num_skipped = 0;
+      while (*num_skipped < num_to_skip) {
+        if (!StreamsOpenLocked()) {
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        }
+        IndexedFile* indexed_file;
+        TF_RETURN_IF_ERROR(dataset()->GetIndexedFile(
+            ctx->env(), current_file_index_, &indexed_file));
+        int64 record_index;
+        TF_RETURN_IF_ERROR(
+            indexed_file->index->FindRecord(TellOffsetLocked(), &record_index));
+        const int64 num_remaining =
+            indexed_file->index->num_records() - record_index;
+        if (num_to_skip - *num_skipped < num_remaining) {
+          uint64 offset;
+          TF_RETURN_IF_ERROR(indexed_file->index->GetOffset(
+              record_index + num_to_skip - *num_skipped, &offset));
+          TF_RETURN_IF_ERROR(SeekOffsetLocked(offset));
+          *num_skipped = num_to_skip;
+        } else {
+          // Skip the rest of the current file.
+          *num_skipped += num_remaining;
+          ResetStreamsLocked();
+          ++current_file_index_;
+        }
+      }
+      return Status::OK();
+    }
+
     Status SaveInternal(IteratorStateWriter* writer) override {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
-      if (reader_) {
+      if (StreamsOpenLocked()) {
         TF_RETURN_IF_ERROR(
-            writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
+            writer->WriteScalar(full_name(kOffset), TellOffsetLocked()));
       }
       return Status::OK();
     }
@@ -170,7 +365,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64 offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(SeekOffsetLocked(offset));
       }
       return Status::OK();
     }
@@ -186,6 +381,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
+      TF_RETURN_IF_ERROR(dataset()->MaybeMapFile(env, next_filename, &region_));
+      if (region_) {
+        mapped_reader_ = absl::make_unique<io::MappedRecordReader>(
+            region_.get(), dataset()->verify_checksums_);
+        mapped_offset_ = 0;
+        mapped_records_.clear();
+        next_mapped_record_ = 0;
+        return Status::OK();
+      }
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
       reader_ = absl::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
@@ -196,6 +400,55 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mapped_records_.clear();
+      next_mapped_record_ = 0;
+      mapped_reader_.reset();
+      region_.reset();
+    }
+
+    bool StreamsOpenLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return reader_ || mapped_reader_;
+    }
+
+    // Reads the next record of the current file into `*record`. A mapped file
+    // is copied straight from the mapping into `*record`, without going
+    // through a read buffer; its records are located and checksummed in
+    // batches of `kMappedRecordBatchSize`.
+    Status ReadRecordLocked(tstring* record) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!mapped_reader_) {
+        return reader_->ReadRecord(record);
+      }
+      if (next_mapped_record_ == mapped_records_.size()) {
+        mapped_records_.clear();
+        next_mapped_record_ = 0;
+        TF_RETURN_IF_ERROR(mapped_reader_->ReadRecords(
+            &mapped_offset_, kMappedRecordBatchSize, &mapped_records_));
+      }
+      *record = mapped_records_[next_mapped_record_++];
+      return Status::OK();
+    }
+
+    uint64 TellOffsetLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!mapped_reader_) {
+        return reader_->TellOffset();
+      }
+      if (next_mapped_record_ == mapped_records_.size()) {
+        return mapped_offset_;
+      }
+      // The offset of the first record that was read but not yet returned.
+      return mapped_records_[next_mapped_record_].data() -
+             static_cast<const char*>(region_->data()) -
+             io::RecordReader::kHeaderSize;
+    }
+
+    Status SeekOffsetLocked(uint64 offset) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!mapped_reader_) {
+        return reader_->SeekOffset(offset);
+      }
+      mapped_offset_ = offset;
+      mapped_records_.clear();
+      next_mapped_record_ = 0;
+      return Status::OK();
     }
 
     mutex mu_;
@@ -205,15 +458,41 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ GUARDED_BY(mu_);
+
+    // If `use_mmap_` is set, the current file is mapped into memory instead.
+    // `mapped_reader_` borrows the object that `region_` points to.
+    std::unique_ptr<ReadOnlyMemoryRegion> region_ GUARDED_BY(mu_);
+    std::unique_ptr<io::MappedRecordReader> mapped_reader_ GUARDED_BY(mu_);
+    uint64 mapped_offset_ GUARDED_BY(mu_) = 0;
+    // Records of the mapped file that were read ahead of `mapped_offset_`,
+    // of which those from `next_mapped_record_` on have not been returned.
+    std::vector<StringPiece> mapped_records_ GUARDED_BY(mu_);
+    size_t next_mapped_record_ GUARDED_BY(mu_) = 0;
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  const bool use_index_;
+  // Whether uncompressed files are mapped into memory instead of being read.
+  const bool use_mmap_;
+  // Whether the payload checksums of mapped records are verified. The length
+  // checksums are always verified, and records that are read rather than
+  // mapped are always fully verified.
+  const bool verify_checksums_;
+  // If `use_index_` is true, `record_limits_[i]` is the total number of
+  // records in the files up to and including `filenames_[i]`.
+  std::vector<int64> record_limits_;
+  mutable mutex mu_;
+  mutable std::vector<IndexedFile> indexed_files_ GUARDED_BY(mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseIndex, &use_index_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseMmap, &use_mmap_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kVerifyChecksums, &verify_checksums_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -241,8 +520,31 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
               errors::InvalidArgument(
                   "`buffer_size` must be >= 0 (0 == no buffering)"));
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  OP_REQUIRES(ctx, !use_mmap_ || compression_type.empty(),
+              errors::InvalidArgument(
+                  "`use_mmap` is only supported for uncompressed files, "
+                  "but `compression_type` is \"", compression_type, "\"."));
+
+  std::vector<int64> num_records;
+  if (use_index_) {
+    OP_REQUIRES(ctx, compression_type.empty(),
+                errors::InvalidArgument(
+                    "`use_index` is only supported for uncompressed files, "
+                    "but `compression_type` is \"", compression_type, "\"."));
+    num_records.reserve(filenames.size());
+    for (const string& filename : filenames) {
+      uint64 index_file_size;
+      OP_REQUIRES_OK(ctx, ctx->env()->GetFileSize(
+                              strings::StrCat(filename, kIndexFileSuffix),
+                              &index_file_size));
+      num_records.push_back(index_file_size /
+                            io::RecordWriter::kIndexEntrySize);
+    }
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, use_index_, std::move(num_records),
+                        use_mmap_, verify_checksums_);
 }
 
 namespace {
@@ -26,6 +26,12 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kFileNames = "filenames";
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kUseIndex = "use_index";
+  static constexpr const char* const kUseMmap = "use_mmap";
+  static constexpr const char* const kVerifyChecksums = "verify_checksums";
+  // The suffix that is appended to the name of a TFRecord file to form the
+  // name of its index file, which is read when `use_index` is set.
+  static constexpr const char* const kIndexFileSuffix = ".index";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -34,6 +40,10 @@ class TFRecordDatasetOp : public DatasetOpKernel {
 
  private:
   class Dataset;
+
+  bool use_index_;
+  bool use_mmap_;
+  bool verify_checksums_;
 };
 
 }  // namespace data
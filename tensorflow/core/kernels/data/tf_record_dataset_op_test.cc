@@ -12,6 +12,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 
 namespace tensorflow {
 namespace data {
@@ -23,12 +24,14 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64 buffer_size,
-                        string node_name)
+                        bool use_index, bool use_mmap, string node_name)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        buffer_size_(buffer_size) {}
+        buffer_size_(buffer_size),
+        use_index_(use_index),
+        use_mmap_(use_mmap) {}
 
   std::vector<Tensor> GetInputTensors() const override {
     int num_files = filenames_.size();
@@ -49,7 +52,8 @@ class TFRecordDatasetParams : public DatasetParams {
   }
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
-    *attr_vector = {};
+    *attr_vector = {{TFRecordDatasetOp::kUseIndex, use_index_},
+                    {TFRecordDatasetOp::kUseMmap, use_mmap_}};
     return Status::OK();
   }
 
@@ -61,6 +65,8 @@ class TFRecordDatasetParams : public DatasetParams {
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
   int64 buffer_size_;
+  bool use_index_;
+  bool use_mmap_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBaseV2 {};
@@ -98,6 +104,8 @@ TFRecordDatasetParams TFRecordDatasetParams1() {
   return TFRecordDatasetParams(filenames,
                                /*compression_type=*/compression_type,
                                /*buffer_size=*/10,
+                               /*use_index=*/false,
+                               /*use_mmap=*/false,
                                /*node_name=*/kNodeName);
 }
 
@@ -116,6 +124,8 @@ TFRecordDatasetParams TFRecordDatasetParams2() {
   return TFRecordDatasetParams(filenames,
                                /*compression_type=*/compression_type,
                                /*buffer_size=*/10,
+                               /*use_index=*/false,
+                               /*use_mmap=*/false,
                                /*node_name=*/kNodeName);
 }
 
@@ -134,6 +144,117 @@ TFRecordDatasetParams TFRecordDatasetParams3() {
   return TFRecordDatasetParams(filenames,
                                /*compression_type=*/compression_type,
                                /*buffer_size=*/10,
+                               /*use_index=*/false,
+                               /*use_mmap=*/false,
+                               /*node_name=*/kNodeName);
+}
+
+// Writes uncompressed TFRecord files along with their indices.
+Status CreateIndexedTestFiles(
+    const std::vector<tstring>& filenames,
+    const std::vector<std::vector<string>>& contents) {
+  if (filenames.size() != contents.size()) {
+    return tensorflow::errors::InvalidArgument(
+        "The number of files does not match with the contents");
+  }
+  Env* env = Env::Default();
+  for (int i = 0; i < filenames.size(); ++i) {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(filenames[i], &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(
+        absl::StrCat(filenames[i], TFRecordDatasetOp::kIndexFileSuffix),
+        &index_file));
+    io::RecordWriter writer(file.get(), index_file.get());
+    for (const string& record : contents[i]) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+    TF_RETURN_IF_ERROR(index_file->Close());
+  }
+  return Status::OK();
+}
+
+// Test case 4: multiple text files without compression, read with their
+// indices.
+TFRecordDatasetParams TFRecordDatasetParams4() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_2"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_3")};
+  std::vector<std::vector<string>> contents = {
+      {"1", "22", "333"}, {}, {"a", "bb", "ccc"}};
+  if (!CreateIndexedTestFiles(filenames, contents).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(
+      filenames,
+      /*compression_type=*/CompressionType::UNCOMPRESSED,
+      /*buffer_size=*/10,
+      /*use_index=*/true,
+      /*use_mmap=*/false,
+      /*node_name=*/kNodeName);
+}
+
+// Test case 5: multiple text files without compression, mapped into memory
+// and read with their indices.
+TFRecordDatasetParams TFRecordDatasetParams5() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_INDEXED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_INDEXED_2"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_INDEXED_3")};
+  std::vector<std::vector<string>> contents = {
+      {"1", "22", "333"}, {}, {"a", "bb", "ccc"}};
+  if (!CreateIndexedTestFiles(filenames, contents).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(
+      filenames,
+      /*compression_type=*/CompressionType::UNCOMPRESSED,
+      /*buffer_size=*/10,
+      /*use_index=*/true,
+      /*use_mmap=*/true,
+      /*node_name=*/kNodeName);
+}
+
+// Test case 6: multiple text files without compression, mapped into memory.
+TFRecordDatasetParams TFRecordDatasetParams6() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*use_index=*/false,
+                               /*use_mmap=*/true,
+                               /*node_name=*/kNodeName);
+}
+
+// Mapping compressed files into memory is not supported.
+TFRecordDatasetParams InvalidMmapTFRecordDatasetParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_ZLIB")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"}};
+  CompressionType compression_type = CompressionType::ZLIB;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*use_index=*/false,
+                               /*use_mmap=*/true,
                                /*node_name=*/kNodeName);
 }
 
@@ -147,6 +268,15 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams5(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
 }
@@ -185,6 +315,82 @@ TEST_F(TFRecordDatasetOpTest, Cardinality) {
   TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
 }
 
+TEST_F(TFRecordDatasetOpTest, CardinalityWithIndex) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(6));
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithIndex) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  ASSERT_TRUE(dataset_->SupportsRandomAccess());
+  std::vector<Tensor> expected_outputs = CreateTensors<tstring>(
+      TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}});
+  for (int64 i = expected_outputs.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(iterator_ctx_.get(), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    TF_EXPECT_OK(ExpectEqual(out_tensors[0], expected_outputs[i]));
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(iterator_ctx_.get(), expected_outputs.size(),
+                          &out_tensors)
+                .code(),
+            error::OUT_OF_RANGE);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithMappedIndex) {
+  auto dataset_params = TFRecordDatasetParams5();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  ASSERT_TRUE(dataset_->SupportsRandomAccess());
+  std::vector<Tensor> expected_outputs = CreateTensors<tstring>(
+      TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}});
+  for (int64 i = expected_outputs.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(iterator_ctx_.get(), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    TF_EXPECT_OK(ExpectEqual(out_tensors[0], expected_outputs[i]));
+  }
+}
+
+TEST_F(TFRecordDatasetOpTest, InvalidMmapWithCompression) {
+  auto dataset_params = InvalidMmapTFRecordDatasetParams();
+  EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
+}
+
+TEST_F(TFRecordDatasetOpTest, SkipWithIndex) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  int64 num_skipped = 0;
+  std::vector<Tensor> out_tensors;
+  // Skip within the first file.
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), /*num_to_skip=*/1,
+                               &end_of_sequence, &num_skipped));
+  EXPECT_FALSE(end_of_sequence);
+  EXPECT_EQ(num_skipped, 1);
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  TF_EXPECT_OK(ExpectEqual(
+      out_tensors[0], CreateTensor<tstring>(TensorShape({}), {"22"})));
+  // Skip across the empty second file into the third file.
+  out_tensors.clear();
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), /*num_to_skip=*/2,
+                               &end_of_sequence, &num_skipped));
+  EXPECT_FALSE(end_of_sequence);
+  EXPECT_EQ(num_skipped, 2);
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  TF_EXPECT_OK(ExpectEqual(
+      out_tensors[0], CreateTensor<tstring>(TensorShape({}), {"bb"})));
+  // Skip past the end.
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), /*num_to_skip=*/5,
+                               &end_of_sequence, &num_skipped));
+  EXPECT_TRUE(end_of_sequence);
+  EXPECT_EQ(num_skipped, 1);
+}
+
 TEST_F(TFRecordDatasetOpTest, IteratorOutputDtypes) {
   auto dataset_params = TFRecordDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -217,6 +423,18 @@ IteratorSaveAndRestoreTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams5(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
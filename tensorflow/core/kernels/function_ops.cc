@@ -45,7 +45,11 @@ void ArgOp::Compute(OpKernelContext* ctx) {
   auto frame = ctx->call_frame();
   OP_REQUIRES(ctx, frame != nullptr, errors::Internal("no call frame"));
   Tensor val;
-  OP_REQUIRES_OK(ctx, frame->GetArg(index_, &val));
+  if (frame->CanConsumeArg(index_)) {
+    frame->ConsumeArg(index_, &val);
+  } else {
+    OP_REQUIRES_OK(ctx, frame->GetArg(index_, &val));
+  }
   OP_REQUIRES(ctx, val.dtype() == dtype_,
               errors::InvalidArgument("Type mismatch: actual ",
                                       DataTypeString(val.dtype()),
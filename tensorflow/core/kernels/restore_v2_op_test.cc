@@ -13,12 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <atomic>
 #include <complex>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -26,11 +28,16 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -44,6 +51,69 @@ Tensor MakeInput(const TensorShape& shape,
   return input;
 }
 
+// The largest single read from a checkpoint data file opened through
+// CountingFileSystem.
+std::atomic<int64> largest_data_read(0);
+
+class CountingDataFile : public RandomAccessFile {
+ public:
+  explicit CountingDataFile(std::unique_ptr<RandomAccessFile> file)
+      : file_(std::move(file)) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    int64 largest = largest_data_read;
+    while (static_cast<int64>(n) > largest &&
+           !largest_data_read.compare_exchange_weak(largest, n)) {
+    }
+    return file_->Read(offset, n, result, scratch);
+  }
+
+ private:
+  std::unique_ptr<RandomAccessFile> file_;
+};
+
+// Serves "restoretest://<local path>" from the local filesystem, and records
+// the reads of checkpoint data files.
+class CountingFileSystem : public NullFileSystem {
+ public:
+  Status NewRandomAccessFile(
+      const string& fname, std::unique_ptr<RandomAccessFile>* result) override {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(
+        Env::Default()->NewRandomAccessFile(LocalPath(fname), &file));
+    if (absl::StrContains(fname, ".data-")) {
+      result->reset(new CountingDataFile(std::move(file)));
+    } else {
+      *result = std::move(file);
+    }
+    return Status::OK();
+  }
+
+  Status GetFileSize(const string& fname, uint64* file_size) override {
+    return Env::Default()->GetFileSize(LocalPath(fname), file_size);
+  }
+
+  Status GetMatchingPaths(const string& pattern,
+                          std::vector<string>* results) override {
+    TF_RETURN_IF_ERROR(
+        Env::Default()->GetMatchingPaths(LocalPath(pattern), results));
+    for (string& path : *results) {
+      path = io::CreateURI("restoretest", "", path);
+    }
+    return Status::OK();
+  }
+
+ private:
+  static string LocalPath(const string& name) {
+    StringPiece scheme, host, path;
+    io::ParseURI(name, &scheme, &host, &path);
+    return string(path);
+  }
+};
+
+REGISTER_FILE_SYSTEM("restoretest", CountingFileSystem);
+
 class RestoreV2OpTest : public OpsTestBase {
  protected:
   // Makes an operation to restore two tensors
@@ -353,5 +423,74 @@ TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
 
+// Tensors spread over several data file shards are restored shard by shard,
+// each through its own reader.
+TEST_F(RestoreV2OpTest, RestoreFromShardedBundle) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_sharded");
+  const int kNumShards = 3;
+  const int kTensorsPerShard = 2;
+  std::vector<tstring> shard_prefixes;
+  std::vector<tstring> tensor_names;
+  std::vector<Tensor> expected;
+  for (int shard = 0; shard < kNumShards; ++shard) {
+    shard_prefixes.push_back(strings::StrCat(prefix, "_part_", shard));
+    BundleWriter writer(Env::Default(), shard_prefixes.back());
+    for (int i = 0; i < kTensorsPerShard; ++i) {
+      // Sorted by name, the tensors alternate between the shards.
+      tensor_names.push_back(strings::StrCat("tensor_", i, "_", shard));
+      expected.push_back(test::AsTensor<float>(
+          {static_cast<float>(shard), static_cast<float>(i)}));
+      TF_ASSERT_OK(writer.Add(tensor_names.back(), expected.back()));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(), shard_prefixes, prefix));
+
+  const int num_tensors = tensor_names.size();
+  TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", DataTypeVector(num_tensors, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({num_tensors}), tensor_names);
+  AddInputFromArray<tstring>(TensorShape({num_tensors}),
+                             std::vector<tstring>(num_tensors, ""));
+  TF_ASSERT_OK(RunOpKernel());
+  for (int i = 0; i < num_tensors; ++i) {
+    test::ExpectTensorEqual<float>(expected[i], *GetOutput(i));
+  }
+}
+
+// A tensor above both the thread-pool threshold of RestoreV2 and the
+// sectioned-read threshold of BundleReader is restored from the pool, by a
+// reader that reads it in sections.
+TEST_F(RestoreV2OpTest, RestoreLargeTensorInSections) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_large");
+  // More than 16M elements, and more than 64MB.
+  Tensor large(DT_FLOAT, TensorShape({(16 << 20) + 1}));
+  test::FillFn<float>(&large, [](int i) { return static_cast<float>(i % 97); });
+  {
+    BundleWriter writer(Env::Default(), prefix);
+    TF_ASSERT_OK(writer.Add("large", large));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  MakeRestoreOp(DT_FLOAT);
+  AddInputFromArray<tstring>(TensorShape({}),
+                             {io::CreateURI("restoretest", "", prefix)});
+  AddInputFromArray<tstring>(TensorShape({1}), {"large"});
+  AddInputFromArray<tstring>(TensorShape({1}), {""});
+  largest_data_read = 0;
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(large, *GetOutput(0));
+
+  // Read in one piece, the tensor would have taken a single read of its size.
+  EXPECT_GT(largest_data_read, 0);
+  EXPECT_LE(largest_data_read, BundleReader::Options().read_section_bytes);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -256,8 +259,8 @@ struct RestoreOp {
   }
 
   // Run this restore operation using a new BundleReader.
-  void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
+  void run_with_new_reader(const BundleReader::Options& reader_options) {
+    BundleReader reader(Env::Default(), reader_prefix, reader_options);
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -310,9 +313,23 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
 
+  // Where the tensor's bytes are stored, used to order the reads.
+  int32 shard_id = 0;
+  int64 offset = 0;
+
   ::tensorflow::Status status;
 };
 
+// Runs "ops" in order through a single new BundleReader.
+void RunWithNewReader(const string& reader_prefix,
+                      const BundleReader::Options& reader_options,
+                      const std::vector<RestoreOp*>& ops) {
+  BundleReader reader(Env::Default(), reader_prefix, reader_options);
+  for (RestoreOp* op : ops) {
+    op->status = reader.status().ok() ? op->run(&reader) : reader.status();
+  }
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
@@ -366,25 +383,67 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     if (op->should_run_in_pool(&default_reader)) {
       pool_restore_ops.emplace_back(op);
     } else {
+      // Ignore status here; we'll catch the error later.
+      default_reader
+          .LookupDataLocation(tensor_name, &op->shard_id, &op->offset)
+          .IgnoreError();
       direct_restore_ops.emplace_back(op);
     }
   }
 
+  // Group the small tensors by the data file shard holding them, each group in
+  // file order, so that every shard is read front to back.
+  std::map<int32, std::vector<RestoreOp*> > shard_restore_ops;
+  for (auto& op : direct_restore_ops) {
+    shard_restore_ops[op->shard_id].push_back(op.get());
+  }
+  for (auto& shard_ops : shard_restore_ops) {
+    std::stable_sort(shard_ops.second.begin(), shard_ops.second.end(),
+                     [](const RestoreOp* a, const RestoreOp* b) {
+                       return a->offset < b->offset;
+                     });
+  }
+
   {
     // Schedule any threaded operations first, skipping thread pool creation if
-    // we don't have any expensive operations.
+    // we don't have any expensive operations and only a single shard to read.
+    //
+    // The readers on that pool share one pool for the sectioned reads of large
+    // tensors, rather than each starting threads of its own.  It is declared
+    // before "reader_pool" so that it is destroyed after the readers finish.
+    std::unique_ptr<thread::ThreadPool> section_pool;
+    BundleReader::Options reader_options;
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
+    if (!pool_restore_ops.empty() || shard_restore_ops.size() > 1) {
+      section_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensor_sections",
+          reader_options.num_read_threads));
+      reader_options.read_pool = section_pool.get();
       reader_pool.reset(
           new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
       for (auto& op : pool_restore_ops) {
-        reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
+        reader_pool->Schedule([&op, &reader_options]() {
+          op->run_with_new_reader(reader_options);
+        });
+      }
+      // All shards but the first are read concurrently, each through its own
+      // reader.
+      if (shard_restore_ops.size() > 1) {
+        for (auto it = std::next(shard_restore_ops.begin());
+             it != shard_restore_ops.end(); ++it) {
+          const std::vector<RestoreOp*>& ops = it->second;
+          reader_pool->Schedule([&prefix_string, &reader_options, &ops]() {
+            RunWithNewReader(prefix_string, reader_options, ops);
+          });
+        }
       }
     }
 
-    // Read small tensors from the op thread
-    for (auto& op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+    // Read small tensors of the first shard from the op thread.
+    if (!shard_restore_ops.empty()) {
+      for (RestoreOp* op : shard_restore_ops.begin()->second) {
+        op->status = op->run(&default_reader);
+      }
     }
   }
 
@@ -392,6 +451,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto& op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
+  for (auto& op : direct_restore_ops) {
+    TF_RETURN_IF_ERROR(op->status);
+  }
 
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
@@ -28,33 +28,128 @@ namespace tensorflow {
 template <typename T>
 class UnaryOpsComposition;  // forward declare kernel
 
+template <typename T>
+class CwiseOpsComposition;  // forward declare kernel
+
 template <typename T>
 struct UnaryOpsCompositionSupport;
 
+// Register compute function for a binary op whose right operand is a scalar.
+#define REGISTER_SCALAR_COMPUTE_FN_HELPER(name, binary)                  \
+  static inline void ComputeScalar##name(const InputBuffer& in,          \
+                                         const T* scalar,                \
+                                         OutputBuffer* out) {            \
+    *out = in.unaryExpr(                                                 \
+        Eigen::internal::scalar_right<T, T, binary, true>(scalar));      \
+  }                                                                      \
+  static inline int CostScalar##name() {                                 \
+    return Eigen::internal::functor_traits<binary>::Cost;                \
+  }
+
+#define REGISTER_SCALAR_COMPUTE_FN(func) \
+  RegisterScalarComputeFn(#func, ComputeScalar##func, CostScalar##func());
+
 template <typename T>
 struct UnaryOpsCompositionBase {
   using InputBuffer = typename TTypes<T>::ConstFlat;
   using OutputBuffer = typename TTypes<T>::Flat;
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
 
   using ComputeFn = void (*)(const InputBuffer&, OutputBuffer*);
+  using ScalarComputeFn = void (*)(const InputBuffer&, const T*,
+                                   OutputBuffer*);
 
   struct ComputeFnRegistration {
     ComputeFn compute_fn;
     int cost;
   };
 
+  struct ScalarComputeFnRegistration {
+    ScalarComputeFn compute_fn;
+    int cost;
+  };
+
+  // A step of a _CwiseOpsComposition: exactly one of the functions is set.
+  struct Step {
+    ComputeFn compute_fn;
+    ScalarComputeFn scalar_compute_fn;
+  };
+
+  UnaryOpsCompositionBase() {
+    // Binary ops with a scalar right operand, shared by all types.
+    REGISTER_SCALAR_COMPUTE_FN(Add);
+    REGISTER_SCALAR_COMPUTE_FN(AddV2);
+    REGISTER_SCALAR_COMPUTE_FN(Div);
+    REGISTER_SCALAR_COMPUTE_FN(Maximum);
+    REGISTER_SCALAR_COMPUTE_FN(Minimum);
+    REGISTER_SCALAR_COMPUTE_FN(Mul);
+    REGISTER_SCALAR_COMPUTE_FN(RealDiv);
+    REGISTER_SCALAR_COMPUTE_FN(Sub);
+  }
+
   bool HasComputeFn(const string& name) {
     return compute_fns.find(name) != compute_fns.end();
   }
 
+  static inline int64 AlignBlockSize(int64 block_size) {
+    // Align block size to packet size and account for unrolling in run above.
+    if (block_size >= 16 * kPacketSize) {
+      return (block_size + 4 * kPacketSize - 1) & ~(4 * kPacketSize - 1);
+    }
+    // Aligning to 4 * PacketSize would increase block size by more than 25%.
+    return (block_size + kPacketSize - 1) & ~(kPacketSize - 1);
+  }
+
  protected:
   void RegisterComputeFn(const string& name, ComputeFn compute_fn, int cost) {
     VLOG(5) << "Register compute fn: name=" << name << " cost=" << cost;
     compute_fns[name] = {compute_fn, cost};
   }
 
+  void RegisterScalarComputeFn(const string& name, ScalarComputeFn compute_fn,
+                               int cost) {
+    VLOG(5) << "Register scalar compute fn: name=" << name
+            << " cost=" << cost;
+    scalar_compute_fns[name] = {compute_fn, cost};
+  }
+
+  // clang-format off
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(Add,     Eigen::internal::scalar_sum_op<T>);
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(AddV2,   Eigen::internal::scalar_sum_op<T>);
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(Div,     Eigen::internal::scalar_quotient_op<T>);
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(Maximum, Eigen::internal::scalar_max_op<T>);
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(Minimum, Eigen::internal::scalar_min_op<T>);
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(Mul,     Eigen::internal::scalar_product_op<T>);
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(RealDiv, Eigen::internal::scalar_quotient_op<T>);
+  REGISTER_SCALAR_COMPUTE_FN_HELPER(Sub,     Eigen::internal::scalar_difference_op<T>);
+  // clang-format on
+
  private:
   friend class UnaryOpsComposition<T>;
+  friend class CwiseOpsComposition<T>;
+
+  static const int kPacketSize = Eigen::internal::unpacket_traits<Packet>::size;
+
+  Status ExportSteps(const std::vector<string>& op_names,
+                     std::vector<Step>* steps, int* num_scalars, int* cost) {
+    for (const string& op_name : op_names) {
+      auto it = compute_fns.find(op_name);
+      if (it != compute_fns.end()) {
+        steps->push_back({it->second.compute_fn, nullptr});
+        *cost += it->second.cost;
+        continue;
+      }
+      auto scalar_it = scalar_compute_fns.find(op_name);
+      if (scalar_it == scalar_compute_fns.end()) {
+        return errors::InvalidArgument(
+            "Do not have a compute function registered for op: ", op_name);
+      }
+      steps->push_back({nullptr, scalar_it->second.compute_fn});
+      *cost += scalar_it->second.cost;
+      ++*num_scalars;
+    }
+    return Status::OK();
+  }
 
   Status ExportComputeFns(const std::vector<string>& op_names,
                           std::vector<ComputeFn>* fns, int* cost) {
@@ -73,8 +168,12 @@ struct UnaryOpsCompositionBase {
   }
 
   std::unordered_map<string, ComputeFnRegistration> compute_fns;
+  std::unordered_map<string, ScalarComputeFnRegistration> scalar_compute_fns;
 };
 
+#undef REGISTER_SCALAR_COMPUTE_FN
+#undef REGISTER_SCALAR_COMPUTE_FN_HELPER
+
 template <typename T>
 class UnaryOpsComposition : public OpKernel {
  public:
@@ -132,26 +231,103 @@ class UnaryOpsComposition : public OpKernel {
     Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * num_fns,
                              /*bytes_stored=*/sizeof(T) * num_fns,
                              kOverheadCycles + cost_);
-    device.parallelFor(in.NumElements(), cost, AlignBlockSize,
+    device.parallelFor(in.NumElements(), cost, Support::AlignBlockSize,
                        std::move(compute_fn));
   }
 
  private:
-  static const int kPacketSize = Eigen::internal::unpacket_traits<Packet>::size;
+  Support support_;
 
-  static inline int64 AlignBlockSize(int64 block_size) {
-    // Align block size to packet size and account for unrolling in run above.
-    if (block_size >= 16 * kPacketSize) {
-      return (block_size + 4 * kPacketSize - 1) & ~(4 * kPacketSize - 1);
+  std::vector<string> op_names_;
+  std::vector<ComputeFn> fns_;
+  int cost_ = 0;
+};
+
+// Like UnaryOpsComposition, but the chain may also contain binary ops whose
+// right operand is a scalar, e.g. the `x * 0.5 + 1.0` of a chain
+// Mul -> Add -> Relu. Each block of the input is run through the whole chain
+// while it is in cache, so no intermediate tensor is materialized.
+template <typename T>
+class CwiseOpsComposition : public OpKernel {
+ public:
+  using Support = UnaryOpsCompositionSupport<T>;
+
+  using InputBuffer = typename Support::InputBuffer;
+  using OutputBuffer = typename Support::OutputBuffer;
+  using Step = typename Support::Step;
+
+  explicit CwiseOpsComposition(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("op_names", &op_names_));
+
+    OP_REQUIRES(context, !op_names_.empty(),
+                errors::InvalidArgument(
+                    "Cwise op composition must have at least one op"));
+
+    int num_scalars = 0;
+    OP_REQUIRES_OK(context, support_.ExportSteps(op_names_, &steps_,
+                                                 &num_scalars, &cost_));
+    OP_REQUIRES(context, num_scalars == context->num_inputs() - 1,
+                errors::InvalidArgument(
+                    "Cwise op composition has ", num_scalars,
+                    " binary ops but ", context->num_inputs() - 1,
+                    " scalar inputs"));
+
+    VLOG(2) << "Composed cwise op: [" << absl::StrJoin(op_names_, ", ")
+            << "]; cost=" << cost_;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    gtl::InlinedVector<T, 4> scalars;
+    for (int i = 1; i < ctx->num_inputs(); ++i) {
+      const Tensor& scalar = ctx->input(i);
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(scalar.shape()),
+                  errors::InvalidArgument("Input ", i, " must be a scalar: ",
+                                          scalar.shape().DebugString()));
+      scalars.push_back(scalar.scalar<T>()());
     }
-    // Aligning to 4 * PacketSize would increase block size by more than 25%.
-    return (block_size + kPacketSize - 1) & ~(kPacketSize - 1);
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->forward_input_or_allocate_output({0}, 0, in.shape(), &out));
+
+    InputBuffer in_flat = in.flat<T>();
+    OutputBuffer out_flat = out->flat<T>();
+
+    auto compute_fn = [this, &in_flat, &out_flat, &scalars](int64 begin,
+                                                            int64 end) {
+      int64 len = end - begin;
+      const InputBuffer in_slice(in_flat.data() + begin, len);
+      const InputBuffer scratch_slice(out_flat.data() + begin, len);
+      OutputBuffer out_slice(out_flat.data() + begin, len);
+
+      const T* scalar = scalars.data();
+      for (size_t i = 0; i < steps_.size(); ++i) {
+        const InputBuffer& step_in = i == 0 ? in_slice : scratch_slice;
+        const Step& step = steps_[i];
+        if (step.compute_fn != nullptr) {
+          step.compute_fn(step_in, &out_slice);
+        } else {
+          step.scalar_compute_fn(step_in, scalar++, &out_slice);
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int num_steps = static_cast<int>(steps_.size());
+    const int kOverheadCycles = num_steps * 10;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * num_steps,
+                             /*bytes_stored=*/sizeof(T) * num_steps,
+                             kOverheadCycles + cost_);
+    device.parallelFor(in.NumElements(), cost, Support::AlignBlockSize,
+                       std::move(compute_fn));
   }
 
+ private:
   Support support_;
 
   std::vector<string> op_names_;
-  std::vector<ComputeFn> fns_;
+  std::vector<Step> steps_;
   int cost_ = 0;
 };
 
@@ -421,7 +597,10 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
 #define REGISTER_CPU(T)                                                       \
   REGISTER_KERNEL_BUILDER(                                                    \
       Name("_UnaryOpsComposition").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
-      UnaryOpsComposition<T>);
+      UnaryOpsComposition<T>);                                                \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_CwiseOpsComposition").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      CwiseOpsComposition<T>);
 
 REGISTER_CPU(float);
 REGISTER_CPU(Eigen::half);
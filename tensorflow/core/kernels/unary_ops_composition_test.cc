@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -79,6 +80,64 @@ TEST_F(UnaryOpsCompositionTest, Compose_Tanh_Relu6_F) {
   RunComposedOp<float>({"Relu6"}, 11.0f, 6.0f);
 }
 
+class CwiseOpsCompositionTest : public OpsTestBase {
+ protected:
+  template <typename T>
+  void RunComposedOp(const std::vector<string> op_names,
+                     const std::vector<T>& scalars,
+                     const std::vector<T>& input,
+                     const std::vector<T>& expected) {
+    TF_ASSERT_OK(NodeDefBuilder("cwise_op_composition", "_CwiseOpsComposition")
+                     .Input(FakeInput(DataTypeToEnum<T>::v()))
+                     .Input(FakeInput(scalars.size(), DataTypeToEnum<T>::v()))
+                     .Attr("T", DataTypeToEnum<T>::v())
+                     .Attr("op_names", op_names)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    TensorShape shape({static_cast<int64>(input.size())});
+    AddInputFromArray<T>(shape, input);
+    for (T scalar : scalars) {
+      AddInputFromArray<T>(TensorShape({}), {scalar});
+    }
+
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected_tensor(allocator(), DataTypeToEnum<T>::value, shape);
+    test::FillValues<T>(&expected_tensor, expected);
+    test::ExpectClose(expected_tensor, *GetOutput(0));
+  }
+};
+
+TEST_F(CwiseOpsCompositionTest, Compose_Mul_Add_Relu_F) {
+  RunComposedOp<float>({"Mul", "AddV2", "Relu"}, {2.0, -1.0},
+                       {-1.0, 0.0, 1.0, 3.0}, {0.0, 0.0, 1.0, 5.0});
+}
+
+TEST_F(CwiseOpsCompositionTest, Compose_Sub_Sqrt_RealDiv_D) {
+  RunComposedOp<double>({"Sub", "Sqrt", "RealDiv"}, {1.0, 2.0},
+                        {5.0, 10.0, 17.0}, {1.0, 1.5, 2.0});
+}
+
+TEST_F(CwiseOpsCompositionTest, Compose_Unary_Only_F) {
+  RunComposedOp<float>({"Sqrt", "Neg"}, {}, {4.0, 9.0}, {-2.0, -3.0});
+}
+
+TEST_F(CwiseOpsCompositionTest, Compose_Maximum_Minimum_F) {
+  RunComposedOp<float>({"Maximum", "Minimum"}, {0.0, 6.0},
+                       {-1.0, 3.0, 7.0}, {0.0, 3.0, 6.0});
+}
+
+TEST_F(CwiseOpsCompositionTest, ScalarCountMismatch) {
+  TF_ASSERT_OK(NodeDefBuilder("cwise_op_composition", "_CwiseOpsComposition")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("op_names", std::vector<string>({"Relu", "Tanh"}))
+                   .Finalize(node_def()));
+  EXPECT_FALSE(InitOp().ok());
+}
+
 // Performance benchmarks below.
 
 string Function(int i) {
@@ -146,6 +205,60 @@ static Graph* UnaryOpsCompo(int tensor_size, int repeat_graph,
   }                                                                    \
   BENCHMARK(BM_UnaryOpsCompo##_##type##_##N##_##R##_##F);
 
+// Chains of `x * 0.5 + 1.0 -> Tanh`, repeated `num_repeats` times, as
+// separate graph nodes, or fused into one _CwiseOpsComposition.
+static Graph* CwiseOpsChain(int tensor_size, int num_repeats, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor t(DT_FLOAT, TensorShape({tensor_size}));
+  t.flat<float>() = t.flat<float>().setRandom();
+  Tensor half(DT_FLOAT, TensorShape({}));
+  half.scalar<float>()() = 0.5;
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+
+  Node* node = test::graph::Constant(g, t);
+  Node* half_node = test::graph::Constant(g, half);
+  Node* one_node = test::graph::Constant(g, one);
+  if (fused) {
+    std::vector<string> op_names;
+    std::vector<NodeBuilder::NodeOut> scalars;
+    for (int i = 0; i < num_repeats; ++i) {
+      op_names.insert(op_names.end(), {"Mul", "AddV2", "Tanh"});
+      scalars.insert(scalars.end(), {half_node, one_node});
+    }
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_CwiseOpsComposition")
+                    .Input(node)
+                    .Input(scalars)
+                    .Attr("T", DT_FLOAT)
+                    .Attr("op_names", op_names)
+                    .Finalize(g, &node));
+  } else {
+    for (int i = 0; i < num_repeats; ++i) {
+      node = test::graph::Binary(g, "Mul", node, half_node);
+      node = test::graph::Binary(g, "AddV2", node, one_node);
+      node = test::graph::Unary(g, "Tanh", node);
+    }
+  }
+
+  return g;
+}
+
+#define BM_CwiseOpsChain(N, R, F, type)                                     \
+  static void BM_CwiseOpsChain##_##type##_##N##_##R##_##F(int iters) {      \
+    testing::ItemsProcessed(static_cast<int64>(iters) * N * R * 3);         \
+    test::Benchmark(#type, CwiseOpsChain(N, R, F)).Run(iters);              \
+  }                                                                         \
+  BENCHMARK(BM_CwiseOpsChain##_##type##_##N##_##R##_##F);
+
+// BenchmarkName(tensor_size, num_repeats, fused, type)
+
+BM_CwiseOpsChain(1000, 4, 0, cpu);
+BM_CwiseOpsChain(1000, 4, 1, cpu);
+
+BM_CwiseOpsChain(1000000, 4, 0, cpu);
+BM_CwiseOpsChain(1000000, 4, 1, cpu);
+
 // BenchmarkName(tensor_size, repeat_graph, num_ops, type)
 
 BM_UnaryOpsChain(1000, 25, 2, cpu);
@@ -26,6 +26,8 @@ namespace crc32c {
 
 extern bool CanAccelerate();
 extern uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size);
+extern void AcceleratedValueBatch(const char *const *data, const size_t *n,
+                                  size_t count, uint32_t *crcs);
 
 static const uint32 table0_[256] = {
     0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
@@ -263,6 +265,18 @@ uint32 Extend(uint32 crc, const char *buf, size_t size) {
   return l ^ 0xffffffffu;
 }
 
+void ValueBatch(const char *const *data, const size_t *n, size_t count,
+                uint32 *crcs) {
+  static bool can_accelerate = CanAccelerate();
+  if (can_accelerate) {
+    AcceleratedValueBatch(data, n, count, crcs);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    crcs[i] = Value(data[i], n[i]);
+  }
+}
+
 #if defined(PLATFORM_GOOGLE)
 uint32 Extend(uint32 crc, const absl::Cord &cord) {
   absl::CordReader reader(cord);
@@ -35,6 +35,13 @@ extern uint32 Extend(uint32 init_crc, const char* data, size_t n);
 // Return the crc32c of data[0,n-1]
 inline uint32 Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// Stores the crc32c of data[i][0,n[i]-1] in crcs[i] for each i in
+// [0,count-1]. This is faster than calling Value() on each buffer in turn
+// when the buffers are short, e.g. when verifying a batch of small records,
+// because independent buffers are checksummed side by side.
+extern void ValueBatch(const char* const* data, const size_t* n, size_t count,
+                       uint32* crcs);
+
 #if defined(PLATFORM_GOOGLE)
 extern uint32 Extend(uint32 init_crc, const absl::Cord& cord);
 inline uint32 Value(const absl::Cord& cord) { return Extend(0, cord); }
@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/lib/hash/crc32c.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -62,6 +67,62 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+// A bit-at-a-time crc32c, to check the table-driven and accelerated versions.
+static uint32 ReferenceValue(const char* data, size_t n) {
+  uint32 crc = 0xffffffffu;
+  for (size_t i = 0; i < n; i++) {
+    crc ^= static_cast<uint8>(data[i]);
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1)));
+    }
+  }
+  return crc ^ 0xffffffffu;
+}
+
+static std::string RandomString(random::SimplePhilox* rnd, size_t n) {
+  std::string s(n, 0);
+  for (char& c : s) {
+    c = rnd->Uniform(256);
+  }
+  return s;
+}
+
+TEST(CRC, LongValues) {
+  // Lengths around the sizes at which long inputs are split into stripes.
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  const std::string data = RandomString(&rnd, 40000);
+  for (size_t n : {767, 768, 769, 6143, 6144, 6145, 6144 + 768, 32768}) {
+    for (size_t offset = 0; offset < 8; offset++) {
+      EXPECT_EQ(ReferenceValue(data.data() + offset, n),
+                Value(data.data() + offset, n))
+          << "n=" << n << " offset=" << offset;
+    }
+    EXPECT_EQ(Value(data.data(), n),
+              Extend(Value(data.data(), n / 3), data.data() + n / 3,
+                     n - n / 3));
+  }
+}
+
+TEST(CRC, ValueBatch) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  const std::string data = RandomString(&rnd, 10000);
+  for (size_t count = 0; count < 8; count++) {
+    std::vector<const char*> buffers(count);
+    std::vector<size_t> sizes(count);
+    for (size_t i = 0; i < count; i++) {
+      buffers[i] = data.data() + rnd.Uniform(1000);
+      sizes[i] = rnd.Uniform(i % 2 == 0 ? 20 : 2000);
+    }
+    std::vector<uint32> crcs(count);
+    ValueBatch(buffers.data(), sizes.data(), count, crcs.data());
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(Value(buffers[i], sizes[i]), crcs[i]) << "i=" << i;
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -92,5 +153,38 @@ static void BM_CRC(int iters, int len) {
 }
 BENCHMARK(BM_CRC)->Range(1, 256 * 1024);
 
+// Checksums a batch of 96 records of `len` bytes each, either one at a time
+// (batched == 0) or with a single ValueBatch() call (batched == 1).
+static void BM_CRCRecords(int iters, int len, int batched) {
+  constexpr int kNumRecords = 96;
+  std::string input(kNumRecords * len, 'x');
+  std::vector<const char*> records(kNumRecords);
+  std::vector<size_t> sizes(kNumRecords, len);
+  for (int i = 0; i < kNumRecords; i++) {
+    records[i] = input.data() + i * len;
+  }
+  std::vector<uint32> crcs(kNumRecords);
+  uint32 h = 0;
+  for (int i = 0; i < iters; i++) {
+    if (batched) {
+      ValueBatch(records.data(), sizes.data(), kNumRecords, crcs.data());
+    } else {
+      for (int j = 0; j < kNumRecords; j++) {
+        crcs[j] = Value(records[j], sizes[j]);
+      }
+    }
+    h ^= crcs[i % kNumRecords];
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * input.size());
+  VLOG(1) << h;
+}
+BENCHMARK(BM_CRCRecords)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1)
+    ->ArgPair(128, 0)
+    ->ArgPair(128, 1)
+    ->ArgPair(1024, 0)
+    ->ArgPair(1024, 1);
+
 }  // namespace crc32c
 }  // namespace tensorflow
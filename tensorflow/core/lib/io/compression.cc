@@ -22,6 +22,8 @@ namespace compression {
 const char kNone[] = "";
 const char kGzip[] = "GZIP";
 const char kSnappy[] = "SNAPPY";
+const char kZstd[] = "ZSTD";
+const char kLz4[] = "LZ4";
 
 }  // namespace compression
 }  // namespace io
@@ -23,6 +23,8 @@ namespace compression {
 extern const char kNone[];
 extern const char kGzip[];
 extern const char kSnappy[];
+extern const char kZstd[];
+extern const char kLz4[];
 
 }  // namespace compression
 }  // namespace io
@@ -21,27 +21,70 @@ namespace tensorflow {
 namespace io {
 
 InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes)
+    : InputBuffer(file, buffer_bytes, /*read_ahead=*/false) {}
+
+InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes,
+                         bool read_ahead)
     : file_(file),
       file_pos_(0),
       size_(buffer_bytes),
       buf_(new char[size_]),
       pos_(buf_),
-      limit_(buf_) {}
-
-InputBuffer::~InputBuffer() { delete[] buf_; }
+      limit_(buf_),
+      next_buf_(read_ahead && file->SupportsAsyncRead() ? new char[size_]
+                                                        : nullptr) {}
+
+InputBuffer::~InputBuffer() {
+  // The pending read-ahead still writes to "next_buf_".
+  WaitForReadAhead();
+  delete[] buf_;
+  delete[] next_buf_;
+}
 
 Status InputBuffer::FillBuffer() {
   StringPiece data;
-  Status s = file_->Read(file_pos_, size_, &data, buf_);
+  Status s;
+  std::unique_ptr<PendingRead> read_ahead = WaitForReadAhead();
+  if (read_ahead != nullptr && read_ahead->offset == file_pos_) {
+    std::swap(buf_, next_buf_);
+    data = read_ahead->data;
+    s = read_ahead->status;
+  } else {
+    // Either we are not reading ahead, or we seeked away from the data that
+    // was read ahead.
+    s = file_->Read(file_pos_, size_, &data, buf_);
+  }
   if (data.data() != buf_) {
     memmove(buf_, data.data(), data.size());
   }
   pos_ = buf_;
   limit_ = pos_ + data.size();
   file_pos_ += data.size();
+  if (next_buf_ != nullptr && s.ok()) {
+    StartReadAhead();
+  }
   return s;
 }
 
+void InputBuffer::StartReadAhead() {
+  read_ahead_.reset(new PendingRead);
+  read_ahead_->offset = file_pos_;
+  PendingRead* read_ahead = read_ahead_.get();
+  file_->ReadAsync(file_pos_, size_, next_buf_,
+                   [read_ahead](const Status& s, StringPiece data) {
+                     read_ahead->status = s;
+                     read_ahead->data = data;
+                     read_ahead->done.Notify();
+                   });
+}
+
+std::unique_ptr<InputBuffer::PendingRead> InputBuffer::WaitForReadAhead() {
+  if (read_ahead_ != nullptr) {
+    read_ahead_->done.WaitForNotification();
+  }
+  return std::move(read_ahead_);
+}
+
 template <typename T>
 Status InputBuffer::ReadLine(T* result) {
   result->clear();
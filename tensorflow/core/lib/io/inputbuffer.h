@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_LIB_IO_INPUTBUFFER_H_
 #define TENSORFLOW_LIB_IO_INPUTBUFFER_H_
 
+#include <memory>
 #include <string>
 
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -35,6 +37,13 @@ class InputBuffer {
   // Create an InputBuffer for "file" with a buffer size of
   // "buffer_bytes" bytes.  'file' must outlive *this.
   InputBuffer(RandomAccessFile* file, size_t buffer_bytes);
+
+  // Like above, but if "read_ahead" is true, every refill of the buffer
+  // also starts reading the following "buffer_bytes" bytes with
+  // RandomAccessFile::ReadAsync(), so that sequential reads overlap with the
+  // processing of buffered data.  This uses twice the memory.  "read_ahead" is
+  // ignored unless file->SupportsAsyncRead().
+  InputBuffer(RandomAccessFile* file, size_t buffer_bytes, bool read_ahead);
   ~InputBuffer();
 
   // Read one text line of data into "*result" until end-of-file or a
@@ -82,8 +91,22 @@ class InputBuffer {
   RandomAccessFile* file() const { return file_; }
 
  private:
+  // A read of "size_" bytes at "offset" into "next_buf_".
+  struct PendingRead {
+    int64 offset;
+    Status status;
+    StringPiece data;
+    Notification done;
+  };
+
   Status FillBuffer();
 
+  // Starts reading ahead at "file_pos_".
+  void StartReadAhead();
+
+  // Waits for the pending read-ahead, if any, and returns it.
+  std::unique_ptr<PendingRead> WaitForReadAhead();
+
   // Internal slow-path routine used by ReadVarint32().
   Status ReadVarint32Fallback(uint32* result);
 
@@ -104,6 +127,10 @@ class InputBuffer {
   char* pos_;    // Current position in "buf"
   char* limit_;  // Just past end of valid data in "buf"
 
+  // Only used when reading ahead.
+  char* next_buf_;  // The buffer that is being read ahead into
+  std::unique_ptr<PendingRead> read_ahead_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(InputBuffer);
 };
 
@@ -291,6 +291,63 @@ TEST(InputBuffer, Seek) {
   }
 }
 
+// Claims asynchronous reads for the wrapped file, whose ReadAsync() may still
+// complete synchronously.
+class AsyncFile : public RandomAccessFile {
+ public:
+  explicit AsyncFile(std::unique_ptr<RandomAccessFile> file)
+      : file_(std::move(file)) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    return file_->Read(offset, n, result, scratch);
+  }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+    file_->ReadAsync(offset, n, scratch, std::move(done));
+  }
+
+  bool SupportsAsyncRead() const override { return true; }
+
+ private:
+  std::unique_ptr<RandomAccessFile> file_;
+};
+
+TEST(InputBuffer, ReadAhead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/inputbuffer_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> base_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &base_file));
+    AsyncFile file(std::move(base_file));
+    string read;
+    io::InputBuffer in(&file, buf_size, /*read_ahead=*/true);
+
+    TF_CHECK_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "012");
+    TF_CHECK_OK(in.SkipNBytes(2));
+    TF_CHECK_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "567");
+
+    // Seeking away from the data that was read ahead discards it.
+    TF_CHECK_OK(in.Seek(1));
+    TF_CHECK_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "1234");
+    TF_CHECK_OK(in.ReadNBytes(5, &read));
+    EXPECT_EQ(read, "56789");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    EXPECT_EQ(read, "");
+
+    // Destroying the buffer while a read is in flight must be safe.
+    TF_CHECK_OK(in.Seek(0));
+    TF_CHECK_OK(in.ReadNBytes(1, &read));
+    EXPECT_EQ(read, "0");
+  }
+}
+
 TEST(InputBuffer, ReadVarint32) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/inputbuffer_test";
@@ -0,0 +1,176 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/lz4/lz4_compression_options.h"
+#include "tensorflow/core/lib/io/lz4/lz4_inputstream.h"
+#include "tensorflow/core/lib/io/lz4/lz4_outputbuffer.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+std::vector<int> InputBufferSizes() { return {10, 100, 1000, 10000}; }
+
+std::vector<int> OutputBufferSizes() { return {100, 500, 1000}; }
+
+std::vector<int> NumCopies() { return {1, 50, 500}; }
+
+string GetRecord(int i = 0) {
+  return strings::StrCat(
+      "{\"id\": ", i, ", \"name\": \"record ", i * 7919 % 1000,
+      "\", \"tags\": [\"lorem\", \"ipsum\", \"dolor\"], \"score\": ", i % 97,
+      ".5, \"description\": \"Lorem ipsum dolor sit amet, consectetur "
+      "adipiscing elit. Fusce vehicula tincidunt libero sit amet ultrices.\"}");
+}
+
+string GenTestString(int copies = 1) {
+  string result;
+  for (int i = 0; i < copies; i++) {
+    result += GetRecord(i);
+  }
+  return result;
+}
+
+// Writes `data` to `fname` in `num_writes` appends, flushing after each one
+// if `with_flush` is true.
+void WriteCompressed(const string& fname, const string& data,
+                     const Lz4CompressionOptions& options, int input_buf_size,
+                     int output_buf_size, int num_writes = 1,
+                     bool with_flush = false) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  Lz4OutputBuffer out(file_writer.get(), input_buf_size, output_buf_size,
+                      options);
+  TF_ASSERT_OK(out.Init());
+  for (int i = 0; i < num_writes; i++) {
+    TF_ASSERT_OK(out.Append(data));
+    if (with_flush) {
+      TF_ASSERT_OK(out.Flush());
+    }
+  }
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file_writer->Close());
+}
+
+void TestAllBufferSizes(const Lz4CompressionOptions& options) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/lz4_buffers_test";
+  for (auto num_copies : NumCopies()) {
+    string data = GenTestString(num_copies);
+    for (auto input_buf_size : InputBufferSizes()) {
+      for (auto output_buf_size : OutputBufferSizes()) {
+        WriteCompressed(fname, data, options, input_buf_size, output_buf_size);
+
+        std::unique_ptr<RandomAccessFile> file_reader;
+        TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+        RandomAccessInputStream input_stream(file_reader.get());
+        Lz4InputStream in(&input_stream, input_buf_size, output_buf_size,
+                          options, /*owns_input_stream=*/false);
+        tstring result;
+        TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+        EXPECT_EQ(result, data);
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+      }
+    }
+  }
+}
+
+TEST(Lz4Buffers, DefaultOptions) {
+  TestAllBufferSizes(Lz4CompressionOptions());
+}
+
+TEST(Lz4Buffers, HighCompression) {
+  Lz4CompressionOptions options;
+  options.compression_level = 9;
+  options.block_size = 4 << 20;
+  options.linked_blocks = false;
+  options.content_checksum = false;
+  TestAllBufferSizes(options);
+}
+
+TEST(Lz4Buffers, MultipleWritesWithFlush) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/lz4_buffers_test";
+  Lz4CompressionOptions options;
+  string data = GenTestString(10);
+  WriteCompressed(fname, data, options, 200, 100, /*num_writes=*/10,
+                  /*with_flush=*/true);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  Lz4InputStream in(new RandomAccessInputStream(file_reader.get()), 100, 50,
+                    options, /*owns_input_stream=*/true);
+  // Run the test twice, resetting the stream after the first attempt.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    for (int i = 0; i < 10; ++i) {
+      tstring result;
+      TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+      EXPECT_EQ(result, data);
+      EXPECT_EQ(in.Tell(), (i + 1) * data.size());
+    }
+    tstring result;
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+    TF_ASSERT_OK(in.Reset());
+  }
+}
+
+TEST(Lz4Buffers, CorruptStream) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/lz4_buffers_test";
+  string data = GenTestString(100);
+  WriteCompressed(fname, data, Lz4CompressionOptions(), 1000, 1000);
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+  contents[contents.size() / 2] ^= 0x55;
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  Lz4InputStream in(&input_stream, 1000, 1000, Lz4CompressionOptions(),
+                    /*owns_input_stream=*/false);
+  // The corruption is detected at the latest by the checksum at the end of
+  // the frame.
+  tstring result;
+  Status s;
+  do {
+    s = in.ReadNBytes(1000, &result);
+  } while (s.ok());
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+TEST(Lz4Buffers, InvalidBlockSize) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(
+      testing::TmpDir() + "/lz4_buffers_test", &file_writer));
+  Lz4CompressionOptions options;
+  options.block_size = 1000;
+  Lz4OutputBuffer out(file_writer.get(), 1000, 1000, options);
+  EXPECT_TRUE(errors::IsInvalidArgument(out.Init()));
+  EXPECT_TRUE(errors::IsFailedPrecondition(out.Append("data")));
+  TF_EXPECT_OK(out.Close());
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,66 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_COMPRESSION_OPTIONS_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+class Lz4CompressionOptions {
+ public:
+  // Size of the buffer used for caching the data read from source file.
+  int64 input_buffer_size = 256 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // lz4 is cached. `Lz4OutputBuffer` grows it to hold the compressed form of a
+  // full input buffer if needed.
+  int64 output_buffer_size = 256 << 10;
+
+  // From the lz4 frame manual (lz4frame.h):
+  // 0 requests the default fast compression. Values from 3 to 12 use the
+  // slower, high compression (HC) mode, where 9 is the default HC level and
+  // 12 compresses best. Negative values trade compression ratio for even
+  // more speed.
+  //
+  // This option is ignored by `Lz4InputStream`.
+  int32 compression_level = 0;
+
+  // The maximum size of the uncompressed data of a block of the lz4 frame:
+  // 64KB, 256KB, 1MB or 4MB. Larger blocks need more memory to compress and to
+  // decompress.
+  //
+  // This option is ignored by `Lz4InputStream`.
+  int32 block_size = 64 << 10;
+
+  // Whether a block may refer to the data of the blocks before it, which
+  // improves the compression of small blocks.
+  //
+  // This option is ignored by `Lz4InputStream`.
+  bool linked_blocks = true;
+
+  // Whether to end the frame with a checksum of its uncompressed data, as the
+  // lz4 command line tool does. `Lz4InputStream` verifies the checksum of any
+  // frame that has one, whatever the value of this option.
+  bool content_checksum = true;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_COMPRESSION_OPTIONS_H_
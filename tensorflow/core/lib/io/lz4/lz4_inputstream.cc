@@ -0,0 +1,138 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/lib/io/lz4/lz4_inputstream.h"
+
+#include <lz4frame.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+Lz4InputStream::Lz4InputStream(InputStreamInterface* input_stream,
+                               size_t input_buffer_bytes,
+                               size_t output_buffer_bytes,
+                               const Lz4CompressionOptions& lz4_options,
+                               bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      output_(new char[output_buffer_bytes]) {
+  init_status_ = Init();
+}
+
+Lz4InputStream::~Lz4InputStream() {
+  if (context_ != nullptr) {
+    LZ4F_freeDecompressionContext(context_);
+  }
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status Lz4InputStream::Init() {
+  if (input_buffer_capacity_ == 0 || output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument(
+        "input_buffer_bytes and output_buffer_bytes should be greater than 0");
+  }
+  LZ4F_errorCode_t error =
+      LZ4F_createDecompressionContext(&context_, LZ4F_VERSION);
+  if (LZ4F_isError(error)) {
+    context_ = nullptr;
+    return errors::ResourceExhausted(
+        "LZ4F_createDecompressionContext() failed: ",
+        LZ4F_getErrorName(error));
+  }
+  return Status::OK();
+}
+
+Status Lz4InputStream::Reset() {
+  TF_RETURN_IF_ERROR(init_status_);
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  LZ4F_resetDecompressionContext(context_);
+  input_.clear();
+  input_pos_ = 0;
+  output_pos_ = 0;
+  output_size_ = 0;
+  output_full_ = false;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+Status Lz4InputStream::ReadFromStream() {
+  Status s = input_stream_->ReadNBytes(input_buffer_capacity_, &input_);
+  input_pos_ = 0;
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  // As with ZlibInputStream, a stream that ends in the middle of a frame
+  // (e.g. because it is still being written) is reported as OutOfRange rather
+  // than as corrupted.
+  if (input_.empty()) {
+    return errors::OutOfRange("EOF reached");
+  }
+  return Status::OK();
+}
+
+Status Lz4InputStream::Decompress() {
+  size_t input_size = input_.size() - input_pos_;
+  size_t output_size = output_buffer_capacity_;
+  const size_t error =
+      LZ4F_decompress(context_, output_.get(), &output_size,
+                      input_.data() + input_pos_, &input_size,
+                      /*dOptPtr=*/nullptr);
+  input_pos_ += input_size;
+  output_pos_ = 0;
+  output_size_ = output_size;
+  output_full_ = output_size == output_buffer_capacity_;
+  if (LZ4F_isError(error)) {
+    return errors::DataLoss("LZ4F_decompress() failed: ",
+                            LZ4F_getErrorName(error));
+  }
+  return Status::OK();
+}
+
+Status Lz4InputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+  result->clear();
+  while (bytes_to_read > 0) {
+    if (output_pos_ == output_size_) {
+      // The cache is empty, so decompress more data, reading more compressed
+      // data first unless lz4 may still hold some output.
+      if (input_pos_ == input_.size() && !output_full_) {
+        TF_RETURN_IF_ERROR(ReadFromStream());
+      }
+      TF_RETURN_IF_ERROR(Decompress());
+      continue;
+    }
+    const size_t n = std::min(static_cast<size_t>(bytes_to_read),
+                              output_size_ - output_pos_);
+    result->append(output_.get() + output_pos_, n);
+    output_pos_ += n;
+    bytes_read_ += n;
+    bytes_to_read -= n;
+  }
+  return Status::OK();
+}
+
+int64 Lz4InputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tensorflow
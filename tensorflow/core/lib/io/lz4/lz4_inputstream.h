@@ -0,0 +1,117 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_INPUTSTREAM_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/lz4/lz4_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+// Forward declare the decompression context of lz4frame.h, which is only
+// included in the .cc file.
+struct LZ4F_dctx_s;
+
+namespace tensorflow {
+namespace io {
+
+// An Lz4InputStream provides support for reading from a stream compressed
+// using the LZ4 frame format (https://lz4.github.io/lz4/). Buffers the
+// contents of the file.
+//
+// The stream may consist of several concatenated lz4 frames.
+//
+// A given instance of an Lz4InputStream is NOT safe for concurrent use
+// by multiple threads.
+class Lz4InputStream : public InputStreamInterface {
+ public:
+  // Create an Lz4InputStream for `input_stream` with a buffer of size
+  // `input_buffer_bytes` bytes for reading contents from `input_stream` and
+  // another buffer with size `output_buffer_bytes` for caching decompressed
+  // contents.
+  //
+  // The frame parameters are read from the stream, so `lz4_options` are not
+  // used yet.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  Lz4InputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                 size_t output_buffer_bytes,
+                 const Lz4CompressionOptions& lz4_options,
+                 bool owns_input_stream);
+
+  ~Lz4InputStream();
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the stream is corrupted.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Creates the decompression context.
+  Status Init();
+
+  // Replaces the consumed contents of `input_` with the next
+  // `input_buffer_capacity_` bytes of `input_stream_`. Returns OutOfRange if
+  // no data could be read.
+  Status ReadFromStream();
+
+  // Decompresses as much of `input_` as fits into `output_`.
+  Status Decompress();
+
+  const bool owns_input_stream_;
+  InputStreamInterface* input_stream_;
+  const size_t input_buffer_capacity_;
+  const size_t output_buffer_capacity_;
+  Status init_status_;
+  LZ4F_dctx_s* context_ = nullptr;
+
+  // Compressed data read from `input_stream_`, of which the first
+  // `input_pos_` bytes have been decompressed.
+  tstring input_;
+  size_t input_pos_ = 0;
+
+  // Decompressed data, of which the bytes in [output_pos_, output_size_) have
+  // not been read yet. When `output_full_` is true, the last call to lz4
+  // filled `output_`, and lz4 may hold more output without further input.
+  std::unique_ptr<char[]> output_;
+  size_t output_pos_ = 0;
+  size_t output_size_ = 0;
+  bool output_full_ = false;
+
+  int64 bytes_read_ = 0;  // bytes returned by ReadNBytes, for Tell()
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Lz4InputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_INPUTSTREAM_H_
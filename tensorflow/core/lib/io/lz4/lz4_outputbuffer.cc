@@ -0,0 +1,231 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/lib/io/lz4/lz4_outputbuffer.h"
+
+#include <lz4frame.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Returns the lz4 block size id of a maximum block size of `bytes`.
+Status BlockSizeId(int32 bytes, LZ4F_blockSizeID_t* id) {
+  switch (bytes) {
+    case 64 << 10:
+      *id = LZ4F_max64KB;
+      return Status::OK();
+    case 256 << 10:
+      *id = LZ4F_max256KB;
+      return Status::OK();
+    case 1 << 20:
+      *id = LZ4F_max1MB;
+      return Status::OK();
+    case 4 << 20:
+      *id = LZ4F_max4MB;
+      return Status::OK();
+    default:
+      return errors::InvalidArgument(
+          "block_size should be 64KB, 256KB, 1MB or 4MB, got ", bytes);
+  }
+}
+
+}  // namespace
+
+Lz4OutputBuffer::Lz4OutputBuffer(WritableFile* file, int32 input_buffer_bytes,
+                                 int32 output_buffer_bytes,
+                                 const Lz4CompressionOptions& lz4_options)
+    : file_(file),
+      input_buffer_capacity_(input_buffer_bytes),
+      lz4_options_(lz4_options),
+      output_buffer_capacity_(output_buffer_bytes) {}
+
+Lz4OutputBuffer::~Lz4OutputBuffer() {
+  if (context_ != nullptr) {
+    LOG(WARNING) << "Lz4OutputBuffer::Close() not called. Possible data loss";
+    LZ4F_freeCompressionContext(context_);
+  }
+}
+
+Status Lz4OutputBuffer::Init() {
+  if (input_buffer_capacity_ == 0) {
+    return errors::InvalidArgument(
+        "input_buffer_bytes should be greater than 0");
+  }
+  LZ4F_preferences_t preferences;
+  memset(&preferences, 0, sizeof(preferences));
+  TF_RETURN_IF_ERROR(BlockSizeId(lz4_options_.block_size,
+                                 &preferences.frameInfo.blockSizeID));
+  preferences.frameInfo.blockMode =
+      lz4_options_.linked_blocks ? LZ4F_blockLinked : LZ4F_blockIndependent;
+  preferences.frameInfo.contentChecksumFlag =
+      lz4_options_.content_checksum ? LZ4F_contentChecksumEnabled
+                                    : LZ4F_noContentChecksum;
+  preferences.compressionLevel = lz4_options_.compression_level;
+
+  // Bounds from lz4frame.h: `LZ4F_compressUpdate()` needs room for the
+  // bound of its input, and `LZ4F_flush()` and `LZ4F_compressEnd()` need room
+  // for the bound of no input.
+  max_compress_bytes_ =
+      LZ4F_compressBound(input_buffer_capacity_, &preferences);
+  max_flush_bytes_ = LZ4F_compressBound(0, &preferences);
+  output_buffer_capacity_ =
+      std::max({output_buffer_capacity_, max_compress_bytes_,
+                static_cast<size_t>(LZ4F_HEADER_SIZE_MAX)});
+  output_.reset(new char[output_buffer_capacity_]);
+  input_.reserve(input_buffer_capacity_);
+
+  LZ4F_errorCode_t error =
+      LZ4F_createCompressionContext(&context_, LZ4F_VERSION);
+  if (LZ4F_isError(error)) {
+    context_ = nullptr;
+    return errors::ResourceExhausted("LZ4F_createCompressionContext() failed: ",
+                                     LZ4F_getErrorName(error));
+  }
+  const size_t header_size = LZ4F_compressBegin(
+      context_, output_.get(), output_buffer_capacity_, &preferences);
+  if (LZ4F_isError(header_size)) {
+    LZ4F_freeCompressionContext(context_);
+    context_ = nullptr;
+    return errors::InvalidArgument("Invalid lz4 compression options: ",
+                                   LZ4F_getErrorName(header_size));
+  }
+  output_size_ = header_size;
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::Append(StringPiece data) {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Append() called on an uninitialized or closed Lz4OutputBuffer");
+  }
+  // Small appends, like the headers of records, are gathered in `input_` to
+  // save the overhead of a call to lz4 per append.
+  if (input_.size() + data.size() <= input_buffer_capacity_) {
+    input_.append(data.data(), data.size());
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(Compress(input_));
+  input_.clear();
+  while (data.size() > input_buffer_capacity_) {
+    TF_RETURN_IF_ERROR(Compress(data.substr(0, input_buffer_capacity_)));
+    data.remove_prefix(input_buffer_capacity_);
+  }
+  input_.append(data.data(), data.size());
+  return Status::OK();
+}
+
+#if defined(PLATFORM_GOOGLE)
+Status Lz4OutputBuffer::Append(const absl::Cord& cord) {
+  absl::CordReader reader(cord);
+  absl::string_view fragment;
+  while (reader.ReadFragment(&fragment)) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return Status::OK();
+}
+#endif
+
+Status Lz4OutputBuffer::Compress(StringPiece input) {
+  if (input.empty()) return Status::OK();
+  TF_RETURN_IF_ERROR(ReserveOutput(max_compress_bytes_));
+  const size_t size = LZ4F_compressUpdate(
+      context_, output_.get() + output_size_,
+      output_buffer_capacity_ - output_size_, input.data(), input.size(),
+      /*cOptPtr=*/nullptr);
+  if (LZ4F_isError(size)) {
+    return errors::DataLoss("LZ4F_compressUpdate() failed: ",
+                            LZ4F_getErrorName(size));
+  }
+  output_size_ += size;
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::ReserveOutput(size_t bytes) {
+  if (output_buffer_capacity_ - output_size_ < bytes) {
+    return FlushOutputBufferToFile();
+  }
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::FlushOutputBufferToFile() {
+  if (output_size_ > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(StringPiece(output_.get(), output_size_)));
+    output_size_ = 0;
+  }
+  return Status::OK();
+}
+
+Status Lz4OutputBuffer::Flush() {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Flush() called on an uninitialized or closed Lz4OutputBuffer");
+  }
+  TF_RETURN_IF_ERROR(Compress(input_));
+  input_.clear();
+  TF_RETURN_IF_ERROR(ReserveOutput(max_flush_bytes_));
+  const size_t size =
+      LZ4F_flush(context_, output_.get() + output_size_,
+                 output_buffer_capacity_ - output_size_, /*cOptPtr=*/nullptr);
+  if (LZ4F_isError(size)) {
+    return errors::DataLoss("LZ4F_flush() failed: ", LZ4F_getErrorName(size));
+  }
+  output_size_ += size;
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status Lz4OutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status Lz4OutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status Lz4OutputBuffer::Close() {
+  if (context_ == nullptr) return Status::OK();
+  Status s = Compress(input_);
+  input_.clear();
+  if (s.ok()) s = ReserveOutput(max_flush_bytes_);
+  if (s.ok()) {
+    const size_t size = LZ4F_compressEnd(
+        context_, output_.get() + output_size_,
+        output_buffer_capacity_ - output_size_, /*cOptPtr=*/nullptr);
+    if (LZ4F_isError(size)) {
+      s = errors::DataLoss("LZ4F_compressEnd() failed: ",
+                           LZ4F_getErrorName(size));
+    } else {
+      output_size_ += size;
+      s = FlushOutputBufferToFile();
+    }
+  }
+  LZ4F_freeCompressionContext(context_);
+  context_ = nullptr;
+  return s;
+}
+
+Status Lz4OutputBuffer::Tell(int64* position) { return file_->Tell(position); }
+
+}  // namespace io
+}  // namespace tensorflow
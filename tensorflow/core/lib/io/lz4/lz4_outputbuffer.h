@@ -0,0 +1,135 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_OUTPUTBUFFER_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/lz4/lz4_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+// Forward declare the compression context of lz4frame.h, which is only
+// included in the .cc file.
+struct LZ4F_cctx_s;
+
+namespace tensorflow {
+namespace io {
+
+// Provides support for writing compressed output to file using the LZ4 frame
+// format (https://lz4.github.io/lz4/).
+//
+// The output is a single lz4 frame, which can be read by `Lz4InputStream` or
+// by any other lz4 frame decoder.
+//
+// A given instance of an Lz4OutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class Lz4OutputBuffer : public WritableFile {
+ public:
+  // Create an Lz4OutputBuffer for `file` with two buffers that cache the
+  // 1. input data to be compressed
+  // 2. the compressed output
+  // with sizes `input_buffer_bytes` and `output_buffer_bytes` respectively.
+  // The output buffer is grown to the largest possible compressed size of a
+  // full input buffer if it is smaller. Does not take ownership of `file`.
+  Lz4OutputBuffer(WritableFile* file, int32 input_buffer_bytes,
+                  int32 output_buffer_bytes,
+                  const Lz4CompressionOptions& lz4_options);
+
+  ~Lz4OutputBuffer();
+
+  // Creates the compression context and writes the frame header. This call is
+  // required before any other operation on the buffer.
+  Status Init();
+
+  // Adds `data` to the compression pipeline.
+  //
+  // The input data is buffered and is compressed in bulk when the buffer gets
+  // full. The compressed output is buffered as well and gets written to file
+  // when its buffer is full.
+  //
+  // To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(PLATFORM_GOOGLE)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any cached input, ends the current lz4 block so that all data
+  // appended so far can be decompressed, and writes all output to file.
+  Status Flush() override;
+
+  // Compresses any cached input, ends the lz4 frame and writes all output to
+  // file. This must be called before the destructor to avoid any data loss.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  // Compresses `input`, which holds at most `input_buffer_capacity_` bytes,
+  // into `output_`.
+  Status Compress(StringPiece input);
+
+  // Writes `output_` to `file_` unless it has room for `bytes` more bytes.
+  Status ReserveOutput(size_t bytes);
+
+  // Appends the contents of `output_` to `file_`.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+  const size_t input_buffer_capacity_;
+  const Lz4CompressionOptions lz4_options_;
+
+  // Uncompressed data that has not been handed to lz4 yet.
+  string input_;
+
+  // Compressed data that has not been written to `file_` yet.
+  std::unique_ptr<char[]> output_;
+  size_t output_buffer_capacity_;
+  size_t output_size_ = 0;
+
+  // The largest output of compressing a full input buffer, and of ending a
+  // block or the frame.
+  size_t max_compress_bytes_ = 0;
+  size_t max_flush_bytes_ = 0;
+
+  // Null before `Init()` and after `Close()`.
+  LZ4F_cctx_s* context_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Lz4OutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_LZ4_LZ4_OUTPUTBUFFER_H_
@@ -0,0 +1,458 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/parallel_zlib_inputstream.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace io {
+
+struct ZlibInflateStream {
+  z_stream stream;
+};
+
+// A piece of the compressed input, and the result of inflating it.
+struct ZlibPiece {
+  StringPiece input;
+  string output;
+  uint32 check = 0;
+  Status status;
+  // Whether all of `input` was consumed and it ended on a block boundary.
+  bool at_boundary = false;
+  // Whether the deflate stream ended, with `unused` bytes of `input` left.
+  bool end_of_stream = false;
+  size_t unused = 0;
+};
+
+namespace {
+
+// The empty stored block that ends every Z_SYNC_FLUSH, and every block written
+// by `ParallelZlibOutputBuffer` but the last.
+constexpr char kSyncFlushMarker[] = {0, 0, '\xff', '\xff'};
+
+// The size of the deflate history window.
+constexpr size_t kDictionarySize = 32 << 10;
+
+bool IsGzip(const ZlibCompressionOptions& options) {
+  return options.window_bits > MAX_WBITS;
+}
+
+bool IsRaw(const ZlibCompressionOptions& options) {
+  return options.window_bits < 0;
+}
+
+// Returns the window bits for a raw deflate stream with the same window size
+// as `options`, or 0 if `options.window_bits` is not supported.
+int RawWindowBits(const ZlibCompressionOptions& options) {
+  int window_bits = options.window_bits;
+  if (IsGzip(options)) window_bits -= 16;
+  if (!IsRaw(options)) window_bits = -window_bits;
+  if (window_bits > -8 || window_bits < -MAX_WBITS) return 0;
+  return window_bits;
+}
+
+size_t TrailerSize(const ZlibCompressionOptions& options) {
+  if (IsGzip(options)) return 8;
+  if (IsRaw(options)) return 0;
+  return 4;
+}
+
+uint32 Checksum(const ZlibCompressionOptions& options, StringPiece data) {
+  const Bytef* bytes = reinterpret_cast<const Bytef*>(data.data());
+  if (IsGzip(options)) {
+    return crc32(crc32(0L, Z_NULL, 0), bytes, data.size());
+  }
+  return adler32(adler32(0L, Z_NULL, 0), bytes, data.size());
+}
+
+uint32 DecodeLittleEndian32(const char* data) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  return static_cast<uint32>(bytes[0]) | static_cast<uint32>(bytes[1]) << 8 |
+         static_cast<uint32>(bytes[2]) << 16 |
+         static_cast<uint32>(bytes[3]) << 24;
+}
+
+uint32 DecodeBigEndian32(const char* data) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  return static_cast<uint32>(bytes[0]) << 24 |
+         static_cast<uint32>(bytes[1]) << 16 |
+         static_cast<uint32>(bytes[2]) << 8 | static_cast<uint32>(bytes[3]);
+}
+
+// Parses the zlib (RFC 1950) or gzip (RFC 1952) header at the start of `data`
+// and sets `*size` to its size, or to 0 if `data` does not hold all of it.
+Status ParseHeader(const ZlibCompressionOptions& options, StringPiece data,
+                   size_t* size) {
+  *size = 0;
+  if (IsRaw(options)) return Status::OK();
+  const unsigned char* bytes =
+      reinterpret_cast<const unsigned char*>(data.data());
+  if (!IsGzip(options)) {
+    if (data.size() < 2) return Status::OK();
+    if ((bytes[0] & 0x0f) != Z_DEFLATED || (bytes[0] * 256 + bytes[1]) % 31) {
+      return errors::DataLoss("Invalid zlib header");
+    }
+    if (bytes[1] & 0x20) {
+      return errors::DataLoss("Preset dictionaries are not supported");
+    }
+    *size = 2;
+    return Status::OK();
+  }
+  constexpr int kHeaderCrc = 2, kExtra = 4, kName = 8, kComment = 16;
+  size_t pos = 10;
+  if (data.size() < pos) return Status::OK();
+  if (bytes[0] != 0x1f || bytes[1] != 0x8b || bytes[2] != Z_DEFLATED) {
+    return errors::DataLoss("Invalid gzip header");
+  }
+  const int flags = bytes[3];
+  if (flags & kExtra) {
+    if (data.size() < pos + 2) return Status::OK();
+    pos += 2 + (bytes[pos] | bytes[pos + 1] << 8);
+  }
+  for (int flag : {kName, kComment}) {
+    if (flags & flag) {
+      const size_t end = data.find('\0', pos);
+      if (end == StringPiece::npos) return Status::OK();
+      pos = end + 1;
+    }
+  }
+  if (flags & kHeaderCrc) pos += 2;
+  if (data.size() < pos) return Status::OK();
+  *size = pos;
+  return Status::OK();
+}
+
+// Inflates `piece->input` with `stream` and appends the result to `output`,
+// which is grown by `grow_bytes` at a time.
+Status Inflate(z_stream* stream, size_t grow_bytes, ZlibPiece* piece,
+               string* output) {
+  stream->next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(piece->input.data()));
+  stream->avail_in = piece->input.size();
+  size_t produced = output->size();
+  while (true) {
+    if (produced == output->size()) output->resize(produced + grow_bytes);
+    stream->next_out = reinterpret_cast<Bytef*>(&(*output)[produced]);
+    stream->avail_out = output->size() - produced;
+    // Z_BLOCK also returns at the end of every deflate block, which makes
+    // `data_type` tell whether the input ended on a block boundary.
+    const int error = inflate(stream, Z_BLOCK);
+    produced = output->size() - stream->avail_out;
+    if (error == Z_STREAM_END) {
+      piece->end_of_stream = true;
+      break;
+    }
+    if (error != Z_OK && error != Z_BUF_ERROR) {
+      output->resize(produced);
+      string error_string =
+          strings::StrCat("inflate() failed with error ", error);
+      if (stream->msg != nullptr) {
+        strings::StrAppend(&error_string, ": ", stream->msg);
+      }
+      return errors::DataLoss(error_string);
+    }
+    if (stream->avail_in == 0 && stream->avail_out > 0) break;
+  }
+  output->resize(produced);
+  piece->unused = stream->avail_in;
+  // Bit 7 of `data_type` is set at the end of a block, and bits 0-5 hold the
+  // number of unused bits in the last byte of input.
+  piece->at_boundary = !piece->end_of_stream &&
+                       (stream->data_type & 128) != 0 &&
+                       (stream->data_type & 63) == 0;
+  return Status::OK();
+}
+
+// Inflates `piece->input` on its own, as if it started a raw deflate stream.
+void InflatePiece(int window_bits, size_t grow_bytes, bool compute_check,
+                  const ZlibCompressionOptions& options, ZlibPiece* piece) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  if (inflateInit2(&stream, window_bits) != Z_OK) {
+    piece->status = errors::ResourceExhausted("inflateInit failed");
+    return;
+  }
+  piece->status = Inflate(&stream, grow_bytes, piece, &piece->output);
+  inflateEnd(&stream);
+  if (piece->status.ok() && compute_check) {
+    piece->check = Checksum(options, piece->output);
+  }
+}
+
+}  // namespace
+
+ParallelZlibInputStream::ParallelZlibInputStream(
+    InputStreamInterface* input_stream, size_t input_buffer_bytes,
+    size_t output_buffer_bytes, const ZlibCompressionOptions& zlib_options,
+    bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(std::max<size_t>(output_buffer_bytes, 1)),
+      zlib_options_(zlib_options),
+      num_threads_(std::max(zlib_options.num_threads, 1)),
+      head_(new ZlibInflateStream),
+      check_(Checksum(zlib_options, StringPiece())) {
+  if (num_threads_ > 1) {
+    // The calling thread inflates the first piece of every window.
+    thread_pool_ = absl::make_unique<thread::ThreadPool>(
+        Env::Default(), "parallel_zlib_inputstream", num_threads_ - 1);
+  }
+  memset(&head_->stream, 0, sizeof(z_stream));
+  const int window_bits = RawWindowBits(zlib_options_);
+  if (window_bits == 0) {
+    init_status_ = errors::InvalidArgument("Unsupported window_bits: ",
+                                           zlib_options_.window_bits);
+  } else if (inflateInit2(&head_->stream, window_bits) != Z_OK) {
+    init_status_ = errors::ResourceExhausted("inflateInit failed");
+  }
+}
+
+ParallelZlibInputStream::~ParallelZlibInputStream() {
+  if (init_status_.ok()) {
+    inflateEnd(&head_->stream);
+  }
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ParallelZlibInputStream::Reset() {
+  TF_RETURN_IF_ERROR(init_status_);
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  inflateReset(&head_->stream);
+  head_needs_reset_ = false;
+  pending_.clear();
+  end_of_input_ = false;
+  header_read_ = false;
+  end_of_deflate_stream_ = false;
+  end_of_stream_ = false;
+  dictionary_.clear();
+  output_.clear();
+  output_pos_ = 0;
+  check_ = Checksum(zlib_options_, StringPiece());
+  total_out_ = 0;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+Status ParallelZlibInputStream::ReadNBytes(int64 bytes_to_read,
+                                           tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+  result->clear();
+  while (bytes_to_read > 0) {
+    if (output_pos_ == output_.size()) {
+      if (end_of_stream_) {
+        return errors::OutOfRange("EOF reached");
+      }
+      TF_RETURN_IF_ERROR(Fill());
+      continue;
+    }
+    const size_t n = std::min<size_t>(bytes_to_read,
+                                      output_.size() - output_pos_);
+    result->append(output_.data() + output_pos_, n);
+    output_pos_ += n;
+    bytes_read_ += n;
+    bytes_to_read -= n;
+  }
+  return Status::OK();
+}
+
+int64 ParallelZlibInputStream::Tell() const { return bytes_read_; }
+
+Status ParallelZlibInputStream::Fill() {
+  output_.clear();
+  output_pos_ = 0;
+  if (!end_of_input_) {
+    tstring data;
+    Status s = input_stream_->ReadNBytes(num_threads_ * input_buffer_capacity_,
+                                         &data);
+    if (errors::IsOutOfRange(s)) {
+      end_of_input_ = true;
+    } else if (!s.ok()) {
+      return s;
+    }
+    pending_.append(data.data(), data.size());
+  }
+  if (!header_read_) {
+    size_t header_size;
+    TF_RETURN_IF_ERROR(ParseHeader(zlib_options_, pending_, &header_size));
+    if (header_size == 0 && !IsRaw(zlib_options_)) {
+      return end_of_input_ ? errors::OutOfRange("EOF reached") : Status::OK();
+    }
+    pending_.erase(0, header_size);
+    header_read_ = true;
+  }
+  if (end_of_deflate_stream_) {
+    return ReadTrailer();
+  }
+  if (pending_.empty()) {
+    return end_of_input_ ? errors::OutOfRange("EOF reached") : Status::OK();
+  }
+  return InflatePending();
+}
+
+Status ParallelZlibInputStream::InflatePending() {
+  const StringPiece marker(kSyncFlushMarker, sizeof(kSyncFlushMarker));
+  // Unless this is the end of the input, only inflate up to the last block
+  // boundary so that the pieces of the next window start on one too.
+  size_t end = pending_.size();
+  if (!end_of_input_) {
+    const size_t last = StringPiece(pending_).rfind(marker);
+    if (last != StringPiece::npos) end = last + marker.size();
+  }
+  const StringPiece window(pending_.data(), end);
+  std::vector<size_t> starts = {0};
+  for (int i = 1; i < num_threads_; ++i) {
+    const size_t pos = window.find(marker, std::max(i * end / num_threads_,
+                                                    starts.back()));
+    if (pos == StringPiece::npos || pos + marker.size() >= end) break;
+    starts.push_back(pos + marker.size());
+  }
+  starts.push_back(end);
+
+  const int num_pieces = starts.size() - 1;
+  std::vector<ZlibPiece> pieces(num_pieces);
+  for (int i = 0; i < num_pieces; ++i) {
+    pieces[i].input = window.substr(starts[i], starts[i + 1] - starts[i]);
+  }
+  BlockingCounter counter(num_pieces - 1);
+  for (int i = 1; i < num_pieces; ++i) {
+    ZlibPiece* piece = &pieces[i];
+    thread_pool_->Schedule([this, piece, &counter]() {
+      InflatePiece(RawWindowBits(zlib_options_), output_buffer_capacity_,
+                   !IsRaw(zlib_options_), zlib_options_, piece);
+      counter.DecrementCount();
+    });
+  }
+  Status s = InflateInOrder(&pieces[0]);
+  counter.Wait();
+  TF_RETURN_IF_ERROR(s);
+
+  size_t consumed = end;
+  for (int i = 0; i < num_pieces; ++i) {
+    ZlibPiece* piece = &pieces[i];
+    if (i > 0) {
+      if (pieces[i - 1].at_boundary && piece->status.ok() &&
+          (piece->at_boundary || piece->end_of_stream)) {
+        // The previous piece ended where this one starts, and this one did not
+        // refer back to it, so this one was inflated correctly on its own.
+        output_.append(piece->output);
+        UpdateCheck(piece->check, piece->output.size());
+        head_needs_reset_ = true;
+      } else {
+        TF_RETURN_IF_ERROR(InflateInOrder(piece));
+      }
+    }
+    if (piece->end_of_stream) {
+      consumed = starts[i + 1] - piece->unused;
+      end_of_deflate_stream_ = true;
+      break;
+    }
+  }
+  pending_.erase(0, consumed);
+
+  // Keep the last `kDictionarySize` bytes of output for `head_`.
+  if (output_.size() >= kDictionarySize) {
+    dictionary_.assign(output_, output_.size() - kDictionarySize,
+                       kDictionarySize);
+  } else {
+    dictionary_.append(output_);
+    if (dictionary_.size() > kDictionarySize) {
+      dictionary_.erase(0, dictionary_.size() - kDictionarySize);
+    }
+  }
+  return Status::OK();
+}
+
+Status ParallelZlibInputStream::InflateInOrder(ZlibPiece* piece) {
+  z_stream* stream = &head_->stream;
+  if (head_needs_reset_) {
+    // `head_` is at a block boundary, but its history misses the pieces that
+    // were inflated on their own since it was last used.
+    string dictionary = dictionary_;
+    dictionary.append(output_);
+    if (dictionary.size() > kDictionarySize) {
+      dictionary.erase(0, dictionary.size() - kDictionarySize);
+    }
+    inflateReset(stream);
+    if (!dictionary.empty()) {
+      inflateSetDictionary(stream,
+                           reinterpret_cast<const Bytef*>(dictionary.data()),
+                           dictionary.size());
+    }
+    head_needs_reset_ = false;
+  }
+  piece->output.clear();
+  piece->end_of_stream = false;
+  const size_t start = output_.size();
+  TF_RETURN_IF_ERROR(Inflate(stream, output_buffer_capacity_, piece, &output_));
+  const StringPiece output = StringPiece(output_).substr(start);
+  if (!IsRaw(zlib_options_)) {
+    UpdateCheck(Checksum(zlib_options_, output), output.size());
+  } else {
+    total_out_ += output.size();
+  }
+  return Status::OK();
+}
+
+void ParallelZlibInputStream::UpdateCheck(uint32 check, size_t size) {
+  if (IsGzip(zlib_options_)) {
+    check_ = crc32_combine(check_, check, size);
+  } else if (!IsRaw(zlib_options_)) {
+    check_ = adler32_combine(check_, check, size);
+  }
+  total_out_ += size;
+}
+
+Status ParallelZlibInputStream::ReadTrailer() {
+  const size_t trailer_size = TrailerSize(zlib_options_);
+  if (pending_.size() < trailer_size) {
+    if (end_of_input_) {
+      return errors::OutOfRange("EOF reached");
+    }
+    return Status::OK();
+  }
+  if (IsGzip(zlib_options_)) {
+    if (DecodeLittleEndian32(pending_.data()) != check_) {
+      return errors::DataLoss("Incorrect gzip data check");
+    }
+    if (DecodeLittleEndian32(pending_.data() + 4) !=
+        static_cast<uint32>(total_out_)) {
+      return errors::DataLoss("Incorrect gzip length check");
+    }
+  } else if (!IsRaw(zlib_options_)) {
+    if (DecodeBigEndian32(pending_.data()) != check_) {
+      return errors::DataLoss("Incorrect zlib data check");
+    }
+  }
+  pending_.clear();
+  end_of_stream_ = true;
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,143 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_INPUTSTREAM_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Forward declare some members of zlib.h, which is only included in the
+// .cc file.
+struct ZlibInflateStream;
+struct ZlibPiece;
+
+// A ParallelZlibInputStream reads a stream compressed using zlib
+// (http://www.zlib.net/), decompressing on `zlib_options.num_threads` threads.
+//
+// The stream is read in windows of `num_threads * input_buffer_bytes`
+// compressed bytes, which are split after Z_SYNC_FLUSH markers (the empty
+// stored block `00 00 ff ff`) and inflated in parallel. Every piece is then
+// checked to have ended exactly on a deflate block boundary and to not refer
+// back to the data of the previous piece; pieces that fail the check are
+// inflated again in order on the calling thread. Any valid stream is therefore
+// read correctly, but only streams that were split into independent blocks,
+// like those written by `ParallelZlibOutputBuffer`, are read in parallel.
+//
+// Only the formats written by `ZlibOutputBuffer` are supported: zlib, gzip
+// (with a single member) and raw deflate, as selected by
+// `zlib_options.window_bits`.
+//
+// A given instance of a ParallelZlibInputStream is NOT safe for concurrent use
+// by multiple threads.
+class ParallelZlibInputStream : public InputStreamInterface {
+ public:
+  // Create a ParallelZlibInputStream for `input_stream` that reads
+  // `input_buffer_bytes` compressed bytes per thread at a time, and grows the
+  // decompressed output of each piece by `output_buffer_bytes` at a time.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ParallelZlibInputStream(InputStreamInterface* input_stream,
+                          size_t input_buffer_bytes, size_t output_buffer_bytes,
+                          const ZlibCompressionOptions& zlib_options,
+                          bool owns_input_stream);
+
+  ~ParallelZlibInputStream();
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the stream is corrupted.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Reads the next window of compressed data and inflates it into `output_`.
+  Status Fill();
+
+  // Inflates `pending_` into `output_` and removes the consumed bytes.
+  Status InflatePending();
+
+  // Inflates `piece` on `head_`, the stream that holds the decompression state
+  // of everything before `piece`, and appends the result to `output_`.
+  Status InflateInOrder(ZlibPiece* piece);
+
+  // Adds `size` bytes of output with checksum `check` to `check_`.
+  void UpdateCheck(uint32 check, size_t size);
+
+  // Processes the stream trailer once the deflate stream has ended.
+  Status ReadTrailer();
+
+  const bool owns_input_stream_;
+  InputStreamInterface* input_stream_;
+  const size_t input_buffer_capacity_;
+  const size_t output_buffer_capacity_;
+  const ZlibCompressionOptions zlib_options_;
+  const int num_threads_;
+  Status init_status_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  // Compressed data that has been read from `input_stream_` but not yet
+  // inflated.
+  string pending_;
+  bool end_of_input_ = false;
+  bool header_read_ = false;
+  bool end_of_deflate_stream_ = false;
+  bool end_of_stream_ = false;
+
+  // `head_` inflates the pieces that could not be inflated in parallel. When
+  // `head_needs_reset_` is true, the piece before the next one was inflated
+  // separately and `head_` must be reset with `dictionary_` before it is used.
+  std::unique_ptr<ZlibInflateStream> head_;
+  bool head_needs_reset_ = false;
+  // The last 32KB of decompressed data before the window being inflated.
+  string dictionary_;
+
+  // Decompressed data of the current window.
+  string output_;
+  size_t output_pos_ = 0;
+
+  // Checksum (adler32 for zlib, crc32 for gzip) and size of the decompressed
+  // data up to the end of `output_`.
+  uint32 check_;
+  uint64 total_out_ = 0;
+
+  int64 bytes_read_ = 0;  // bytes returned by ReadNBytes, for Tell()
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ParallelZlibInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_INPUTSTREAM_H_
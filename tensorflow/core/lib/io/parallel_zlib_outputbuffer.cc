@@ -0,0 +1,283 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/parallel_zlib_outputbuffer.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+bool IsGzip(const ZlibCompressionOptions& options) {
+  return options.window_bits > MAX_WBITS;
+}
+
+bool IsRaw(const ZlibCompressionOptions& options) {
+  return options.window_bits < 0;
+}
+
+// Returns the window bits for a raw deflate stream with the same window size
+// as `options`.
+int RawWindowBits(const ZlibCompressionOptions& options) {
+  if (IsGzip(options)) return -(options.window_bits - 16);
+  if (IsRaw(options)) return options.window_bits;
+  return -options.window_bits;
+}
+
+// Returns the checksum of `data`: crc32 for gzip and adler32 otherwise.
+uint32 Checksum(const ZlibCompressionOptions& options, StringPiece data) {
+  const Bytef* bytes = reinterpret_cast<const Bytef*>(data.data());
+  if (IsGzip(options)) {
+    return crc32(crc32(0L, Z_NULL, 0), bytes, data.size());
+  }
+  return adler32(adler32(0L, Z_NULL, 0), bytes, data.size());
+}
+
+// Returns the header of a stream written with `options`. See RFC 1950 and RFC
+// 1952 for the zlib and gzip formats.
+string Header(const ZlibCompressionOptions& options) {
+  if (IsRaw(options)) return "";
+  const int level = options.compression_level == Z_DEFAULT_COMPRESSION
+                        ? 6
+                        : options.compression_level;
+  if (IsGzip(options)) {
+    // No file name, modification time or extra fields, and an unknown OS.
+    const char extra_flags = level == 9 ? 2 : (level == 1 ? 4 : 0);
+    const char header[] = {'\x1f', '\x8b', Z_DEFLATED, 0, 0, 0, 0, 0,
+                           extra_flags, '\xff'};
+    return string(header, sizeof(header));
+  }
+  int level_flags = 3;
+  if (options.compression_strategy >= Z_HUFFMAN_ONLY || level < 2) {
+    level_flags = 0;
+  } else if (level < 6) {
+    level_flags = 1;
+  } else if (level == 6) {
+    level_flags = 2;
+  }
+  uint32 header =
+      ((Z_DEFLATED + ((options.window_bits - 8) << 4)) << 8) |
+      (level_flags << 6);
+  header += 31 - header % 31;
+  return string({static_cast<char>(header >> 8), static_cast<char>(header)});
+}
+
+// Deflates `input` into `output` as a raw deflate stream that ends with
+// `flush_mode`, which is Z_SYNC_FLUSH for all but the last block and
+// Z_FINISH for the last one.
+Status DeflateBlock(const ZlibCompressionOptions& options, int flush_mode,
+                    const string& input, string* output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  int error = deflateInit2(&stream, options.compression_level,
+                           options.compression_method, RawWindowBits(options),
+                           options.mem_level, options.compression_strategy);
+  if (error != Z_OK) {
+    return errors::InvalidArgument("deflateInit failed with status ", error);
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  // A Z_SYNC_FLUSH appends an empty stored block of at most 6 bytes to the
+  // bound for Z_FINISH, so this is usually enough output space.
+  output->resize(deflateBound(&stream, input.size()) + 6);
+  size_t produced = 0;
+  do {
+    if (produced == output->size()) output->resize(2 * output->size());
+    stream.next_out = reinterpret_cast<Bytef*>(&(*output)[produced]);
+    stream.avail_out = output->size() - produced;
+    error = deflate(&stream, flush_mode);
+    produced = output->size() - stream.avail_out;
+    if (error != Z_OK && error != Z_BUF_ERROR && error != Z_STREAM_END) {
+      string error_string =
+          strings::StrCat("deflate() failed with error ", error);
+      if (stream.msg != nullptr) {
+        strings::StrAppend(&error_string, ": ", stream.msg);
+      }
+      deflateEnd(&stream);
+      return errors::DataLoss(error_string);
+    }
+  } while (flush_mode == Z_FINISH ? error != Z_STREAM_END
+                                  : stream.avail_out == 0);
+  deflateEnd(&stream);
+  output->resize(produced);
+  return Status::OK();
+}
+
+}  // namespace
+
+struct ParallelZlibOutputBuffer::Block {
+  // Uncompressed data of the block.
+  string input;
+  // Deflated data of the block, set once `done` is notified.
+  string output;
+  // Checksum of `input`, set once `done` is notified.
+  uint32 check = 0;
+  Status status;
+  Notification done;
+};
+
+ParallelZlibOutputBuffer::ParallelZlibOutputBuffer(
+    WritableFile* file, int32 block_bytes,
+    const ZlibCompressionOptions& zlib_options)
+    : file_(file),
+      block_bytes_(block_bytes),
+      zlib_options_(zlib_options),
+      max_blocks_in_flight_(2 * std::max(zlib_options.num_threads, 1)),
+      check_(Checksum(zlib_options, StringPiece())) {}
+
+ParallelZlibOutputBuffer::~ParallelZlibOutputBuffer() {
+  if (!closed_) {
+    LOG(WARNING)
+        << "ParallelZlibOutputBuffer::Close() not called. Possible data loss";
+  }
+  for (const auto& block : blocks_) {
+    block->done.WaitForNotification();
+  }
+}
+
+Status ParallelZlibOutputBuffer::Init() {
+  if (block_bytes_ <= 0) {
+    return errors::InvalidArgument("block_bytes should be greater than 0");
+  }
+  const int window_bits = std::abs(RawWindowBits(zlib_options_));
+  if (window_bits < 8 || window_bits > MAX_WBITS) {
+    return errors::InvalidArgument("Unsupported window_bits: ",
+                                   zlib_options_.window_bits);
+  }
+  input_.reserve(block_bytes_);
+  thread_pool_ = absl::make_unique<thread::ThreadPool>(
+      Env::Default(), "parallel_zlib_outputbuffer",
+      std::max(zlib_options_.num_threads, 1));
+  return file_->Append(Header(zlib_options_));
+}
+
+Status ParallelZlibOutputBuffer::Append(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Append() called after Close()");
+  }
+  while (!data.empty()) {
+    const size_t n = std::min(data.size(), block_bytes_ - input_.size());
+    input_.append(data.data(), n);
+    data.remove_prefix(n);
+    if (input_.size() == static_cast<size_t>(block_bytes_)) {
+      TF_RETURN_IF_ERROR(SubmitBlock(Z_SYNC_FLUSH));
+    }
+  }
+  return Status::OK();
+}
+
+#if defined(PLATFORM_GOOGLE)
+Status ParallelZlibOutputBuffer::Append(const absl::Cord& cord) {
+  absl::CordReader reader(cord);
+  absl::string_view fragment;
+  while (reader.ReadFragment(&fragment)) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return Status::OK();
+}
+#endif
+
+Status ParallelZlibOutputBuffer::SubmitBlock(int flush_mode) {
+  blocks_.push_back(absl::make_unique<Block>());
+  Block* block = blocks_.back().get();
+  block->input.swap(input_);
+  input_.reserve(block_bytes_);
+  thread_pool_->Schedule([this, flush_mode, block]() {
+    block->status =
+        DeflateBlock(zlib_options_, flush_mode, block->input, &block->output);
+    block->check = Checksum(zlib_options_, block->input);
+    block->done.Notify();
+  });
+  return WriteBlocks(max_blocks_in_flight_);
+}
+
+Status ParallelZlibOutputBuffer::WriteBlocks(size_t max_blocks) {
+  while (blocks_.size() > max_blocks) {
+    std::unique_ptr<Block> block = std::move(blocks_.front());
+    blocks_.pop_front();
+    block->done.WaitForNotification();
+    TF_RETURN_IF_ERROR(block->status);
+    TF_RETURN_IF_ERROR(file_->Append(block->output));
+    if (IsGzip(zlib_options_)) {
+      check_ = crc32_combine(check_, block->check, block->input.size());
+    } else {
+      check_ = adler32_combine(check_, block->check, block->input.size());
+    }
+    total_in_ += block->input.size();
+  }
+  return Status::OK();
+}
+
+string ParallelZlibOutputBuffer::Trailer() const {
+  if (IsGzip(zlib_options_)) {
+    // Little-endian crc32 and size modulo 2^32.
+    const uint32 size = static_cast<uint32>(total_in_);
+    return string({static_cast<char>(check_), static_cast<char>(check_ >> 8),
+                   static_cast<char>(check_ >> 16),
+                   static_cast<char>(check_ >> 24), static_cast<char>(size),
+                   static_cast<char>(size >> 8), static_cast<char>(size >> 16),
+                   static_cast<char>(size >> 24)});
+  }
+  if (IsRaw(zlib_options_)) return "";
+  // Big-endian adler32.
+  return string({static_cast<char>(check_ >> 24),
+                 static_cast<char>(check_ >> 16),
+                 static_cast<char>(check_ >> 8), static_cast<char>(check_)});
+}
+
+Status ParallelZlibOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("Flush() called after Close()");
+  }
+  if (!input_.empty()) {
+    TF_RETURN_IF_ERROR(SubmitBlock(Z_SYNC_FLUSH));
+  }
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  return file_->Flush();
+}
+
+Status ParallelZlibOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ParallelZlibOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ParallelZlibOutputBuffer::Close() {
+  if (closed_) return Status::OK();
+  closed_ = true;
+  TF_RETURN_IF_ERROR(SubmitBlock(Z_FINISH));
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  return file_->Append(Trailer());
+}
+
+Status ParallelZlibOutputBuffer::Tell(int64* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,138 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_OUTPUTBUFFER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Provides support for writing compressed output to file using zlib
+// (http://www.zlib.net/), compressing on `zlib_options.num_threads` threads.
+//
+// The input is split into blocks of `block_bytes` bytes, and each block is
+// deflated independently on a thread pool, in the manner of pigz. Every block
+// but the last ends with a Z_SYNC_FLUSH, and the blocks are written in order
+// between a single header and trailer, so the output is one valid zlib, gzip
+// or raw deflate stream (as selected by `zlib_options.window_bits`) that can
+// be read by `ZlibInputStream` or by any other zlib decoder.
+//
+// Because a block does not refer back to the data in earlier blocks, the
+// output can also be decompressed in parallel by `ParallelZlibInputStream`.
+// The price is a slightly worse compression ratio than `ZlibOutputBuffer`,
+// which shrinks as `block_bytes` grows.
+//
+// A given instance of a ParallelZlibOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ParallelZlibOutputBuffer : public WritableFile {
+ public:
+  // Create a ParallelZlibOutputBuffer for `file` that compresses blocks of
+  // `block_bytes` uncompressed bytes. At most `2 * zlib_options.num_threads`
+  // blocks are buffered at any time. Does not take ownership of `file`.
+  ParallelZlibOutputBuffer(WritableFile* file, int32 block_bytes,
+                           const ZlibCompressionOptions& zlib_options);
+
+  ~ParallelZlibOutputBuffer();
+
+  // Validates the options and writes the stream header. This call is required
+  // before any other operation on the buffer.
+  Status Init();
+
+  // Adds `data` to the current block, and hands the block to the thread pool
+  // once it is full. Blocks until there is room for another block in flight.
+  //
+  // To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(PLATFORM_GOOGLE)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses the current block, waits for all blocks in flight and writes
+  // them to file.
+  Status Flush() override;
+
+  // Compresses the current block as the last block of the stream, writes all
+  // output and the stream trailer to file. This must be called before the
+  // destructor to avoid any data loss.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  struct Block;
+
+  // Moves `input_` into a new block and schedules it to be deflated with
+  // `flush_mode`, then writes finished blocks until at most
+  // `max_blocks_in_flight_` remain.
+  Status SubmitBlock(int flush_mode);
+
+  // Waits for the oldest blocks in flight and writes them to file until at
+  // most `max_blocks` remain.
+  Status WriteBlocks(size_t max_blocks);
+
+  // Returns the zlib or gzip trailer for the data written so far.
+  string Trailer() const;
+
+  WritableFile* file_;  // Not owned
+  const int32 block_bytes_;
+  const ZlibCompressionOptions zlib_options_;
+  const size_t max_blocks_in_flight_;
+  bool closed_ = false;
+
+  // Uncompressed data of the block that is being filled.
+  string input_;
+
+  // Blocks handed to `thread_pool_`, in stream order.
+  std::deque<std::unique_ptr<Block>> blocks_;
+
+  // Checksum (adler32 for zlib, crc32 for gzip) and size of the uncompressed
+  // data of all blocks written so far.
+  uint32 check_;
+  uint64 total_in_ = 0;
+
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ParallelZlibOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_OUTPUTBUFFER_H_
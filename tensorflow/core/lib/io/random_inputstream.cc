@@ -20,10 +20,15 @@ namespace tensorflow {
 namespace io {
 
 RandomAccessInputStream::RandomAccessInputStream(RandomAccessFile* file,
-                                                 bool owns_file)
-    : file_(file), owns_file_(owns_file) {}
+                                                 bool owns_file,
+                                                 bool read_ahead)
+    : file_(file),
+      owns_file_(owns_file),
+      read_ahead_(read_ahead && file->SupportsAsyncRead()) {}
 
 RandomAccessInputStream::~RandomAccessInputStream() {
+  // The pending read-ahead still uses 'file_'.
+  WaitForReadAhead();
   if (owns_file_) {
     delete file_;
   }
@@ -38,7 +43,17 @@ Status RandomAccessInputStream::ReadNBytes(int64 bytes_to_read,
   result->resize(bytes_to_read);
   char* result_buffer = &(*result)[0];
   StringPiece data;
-  Status s = file_->Read(pos_, bytes_to_read, &data, result_buffer);
+  Status s;
+  std::unique_ptr<PendingRead> read_ahead = WaitForReadAhead();
+  if (read_ahead != nullptr && read_ahead->offset == pos_ &&
+      read_ahead->bytes_to_read == bytes_to_read) {
+    s = read_ahead->status;
+    data = read_ahead->data;
+  } else {
+    // Either we are not reading ahead, or we moved away from the data that
+    // was read ahead.
+    s = file_->Read(pos_, bytes_to_read, &data, result_buffer);
+  }
   if (data.data() != result_buffer) {
     memmove(result_buffer, data.data(), data.size());
   }
@@ -46,9 +61,34 @@ Status RandomAccessInputStream::ReadNBytes(int64 bytes_to_read,
   if (s.ok() || errors::IsOutOfRange(s)) {
     pos_ += data.size();
   }
+  if (read_ahead_ && s.ok() && bytes_to_read > 0) {
+    StartReadAhead(bytes_to_read);
+  }
   return s;
 }
 
+void RandomAccessInputStream::StartReadAhead(int64 bytes_to_read) {
+  pending_read_.reset(new PendingRead);
+  pending_read_->offset = pos_;
+  pending_read_->bytes_to_read = bytes_to_read;
+  pending_read_->buffer.resize(bytes_to_read);
+  PendingRead* read_ahead = pending_read_.get();
+  file_->ReadAsync(pos_, bytes_to_read, &read_ahead->buffer[0],
+                   [read_ahead](const Status& s, StringPiece data) {
+                     read_ahead->status = s;
+                     read_ahead->data = data;
+                     read_ahead->done.Notify();
+                   });
+}
+
+std::unique_ptr<RandomAccessInputStream::PendingRead>
+RandomAccessInputStream::WaitForReadAhead() {
+  if (pending_read_ != nullptr) {
+    pending_read_->done.WaitForNotification();
+  }
+  return std::move(pending_read_);
+}
+
 #if defined(PLATFORM_GOOGLE)
 Status RandomAccessInputStream::ReadNBytes(int64 bytes_to_read,
                                            absl::Cord* result) {
@@ -71,18 +111,19 @@ Status RandomAccessInputStream::SkipNBytes(int64 bytes_to_skip) {
   if (bytes_to_skip < 0) {
     return errors::InvalidArgument("Can't skip a negative number of bytes");
   }
-  std::unique_ptr<char[]> scratch(new char[kMaxSkipSize]);
   // Try to read 1 bytes first, if we could complete the read then EOF is
   // not reached yet and we could return.
   if (bytes_to_skip > 0) {
+    char last_byte;
     StringPiece data;
-    Status s = file_->Read(pos_ + bytes_to_skip - 1, 1, &data, scratch.get());
+    Status s = file_->Read(pos_ + bytes_to_skip - 1, 1, &data, &last_byte);
     if ((s.ok() || errors::IsOutOfRange(s)) && data.size() == 1) {
       pos_ += bytes_to_skip;
       return Status::OK();
     }
   }
   // Read kDefaultSkipSize at a time till bytes_to_skip.
+  std::unique_ptr<char[]> scratch(new char[kMaxSkipSize]);
   while (bytes_to_skip > 0) {
     int64 bytes_to_read = std::min<int64>(kMaxSkipSize, bytes_to_skip);
     StringPiece data;
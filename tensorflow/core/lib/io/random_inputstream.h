@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RANDOM_INPUTSTREAM_H_
 #define TENSORFLOW_CORE_LIB_IO_RANDOM_INPUTSTREAM_H_
 
+#include <memory>
+
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -29,7 +32,15 @@ class RandomAccessInputStream : public InputStreamInterface {
  public:
   // Does not take ownership of 'file' unless owns_file is set to true. 'file'
   // must outlive *this.
-  RandomAccessInputStream(RandomAccessFile* file, bool owns_file = false);
+  //
+  // If 'read_ahead' is true, every successful ReadNBytes() call also starts
+  // reading the same number of bytes that follow with
+  // RandomAccessFile::ReadAsync(), and the next call uses them if it reads
+  // exactly those bytes. This overlaps the sequential reads of a
+  // BufferedInputStream with the processing of the buffered data.
+  // 'read_ahead' is ignored unless file->SupportsAsyncRead().
+  RandomAccessInputStream(RandomAccessFile* file, bool owns_file = false,
+                          bool read_ahead = false);
 
   ~RandomAccessInputStream();
 
@@ -51,9 +62,27 @@ class RandomAccessInputStream : public InputStreamInterface {
   Status Reset() override { return Seek(0); }
 
  private:
+  // A read of 'bytes_to_read' bytes at 'offset' into 'buffer'.
+  struct PendingRead {
+    int64 offset;
+    int64 bytes_to_read;
+    tstring buffer;
+    Status status;
+    StringPiece data;
+    Notification done;
+  };
+
+  // Starts reading 'bytes_to_read' bytes ahead at 'pos_'.
+  void StartReadAhead(int64 bytes_to_read);
+
+  // Waits for the pending read-ahead, if any, and returns it.
+  std::unique_ptr<PendingRead> WaitForReadAhead();
+
   RandomAccessFile* file_;  // Not owned.
   int64 pos_ = 0;           // Tracks where we are in the file.
   bool owns_file_ = false;
+  const bool read_ahead_ = false;
+  std::unique_ptr<PendingRead> pending_read_;
 };
 
 }  // namespace io
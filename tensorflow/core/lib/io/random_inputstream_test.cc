@@ -109,6 +109,94 @@ TEST(RandomInputStream, Seek) {
   EXPECT_EQ(5, in.Tell());
 }
 
+// Counts the synchronous and asynchronous reads of the wrapped file.
+class CountingFile : public RandomAccessFile {
+ public:
+  CountingFile(std::unique_ptr<RandomAccessFile> file,
+               bool supports_async_read)
+      : file_(std::move(file)), supports_async_read_(supports_async_read) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    ++num_reads_;
+    return file_->Read(offset, n, result, scratch);
+  }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+    ++num_async_reads_;
+    file_->ReadAsync(offset, n, scratch, std::move(done));
+  }
+
+  bool SupportsAsyncRead() const override { return supports_async_read_; }
+
+  int num_reads() const { return num_reads_; }
+  int num_async_reads() const { return num_async_reads_; }
+
+ private:
+  std::unique_ptr<RandomAccessFile> file_;
+  const bool supports_async_read_;
+  mutable int num_reads_ = 0;
+  mutable int num_async_reads_ = 0;
+};
+
+TEST(RandomInputStream, ReadAhead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/random_inputbuffer_read_ahead_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  std::unique_ptr<RandomAccessFile> base_file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &base_file));
+  CountingFile file(std::move(base_file), /*supports_async_read=*/true);
+  tstring read;
+  RandomAccessInputStream in(&file, /*owns_file=*/false, /*read_ahead=*/true);
+
+  // Sequential reads of the same size use the data read ahead.
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "012");
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "345");
+  EXPECT_EQ(6, in.Tell());
+  EXPECT_EQ(1, file.num_reads());
+  EXPECT_EQ(2, file.num_async_reads());
+
+  // A read of another size, or at another position, reads synchronously.
+  TF_ASSERT_OK(in.ReadNBytes(2, &read));
+  EXPECT_EQ(read, "67");
+  TF_ASSERT_OK(in.Seek(1));
+  TF_ASSERT_OK(in.ReadNBytes(2, &read));
+  EXPECT_EQ(read, "12");
+  EXPECT_EQ(3, file.num_reads());
+
+  // The end of the file is reported as it is without reading ahead.
+  TF_ASSERT_OK(in.Seek(6));
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "678");
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(3, &read)));
+  EXPECT_EQ(read, "9");
+  EXPECT_EQ(10, in.Tell());
+}
+
+TEST(RandomInputStream, NoReadAheadWithoutAsyncReads) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/random_inputbuffer_sync_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  std::unique_ptr<RandomAccessFile> base_file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &base_file));
+  CountingFile file(std::move(base_file), /*supports_async_read=*/false);
+  tstring read;
+  RandomAccessInputStream in(&file, /*owns_file=*/false, /*read_ahead=*/true);
+
+  // Every read goes straight to the file.
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "012");
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "345");
+  EXPECT_EQ(2, file.num_reads());
+  EXPECT_EQ(0, file.num_async_reads());
+}
+
 }  // anonymous namespace
 }  // namespace io
 }  // namespace tensorflow
@@ -19,11 +19,17 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/platform.h"
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/lib/io/lz4/lz4_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+#endif  // !IS_SLIM_BUILD && !IS_MOBILE_PLATFORM
 
 namespace tensorflow {
 namespace io {
@@ -47,6 +53,10 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
 #endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
+  } else if (compression_type == compression::kLz4) {
+    options.compression_type = io::RecordReaderOptions::LZ4_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -57,7 +67,8 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
     : options_(options),
-      input_stream_(new RandomAccessInputStream(file)),
+      input_stream_(new RandomAccessInputStream(
+          file, /*owns_file=*/false, /*read_ahead=*/options.buffer_size > 0)),
       last_read_failed_(false) {
   if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
@@ -68,10 +79,34 @@ RecordReader::RecordReader(RandomAccessFile* file,
 #if defined(IS_SLIM_BUILD)
     LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
 #else   // IS_SLIM_BUILD
-    input_stream_.reset(new ZlibInputStream(
-        input_stream_.release(), options.zlib_options.input_buffer_size,
-        options.zlib_options.output_buffer_size, options.zlib_options, true));
+    if (options.zlib_options.num_threads > 1) {
+      input_stream_.reset(new ParallelZlibInputStream(
+          input_stream_.release(), options.zlib_options.input_buffer_size,
+          options.zlib_options.output_buffer_size, options.zlib_options, true));
+    } else {
+      input_stream_.reset(new ZlibInputStream(
+          input_stream_.release(), options.zlib_options.input_buffer_size,
+          options.zlib_options.output_buffer_size, options.zlib_options, true));
+    }
 #endif  // IS_SLIM_BUILD
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZSTD_COMPRESSION) {
+// zstd and lz4 are not built for mobile platforms.
+#if defined(IS_SLIM_BUILD) || defined(IS_MOBILE_PLATFORM)
+    LOG(FATAL) << "Zstd compression is unsupported on mobile platforms.";
+#else
+    input_stream_.reset(new ZstdInputStream(
+        input_stream_.release(), options.zstd_options.input_buffer_size,
+        options.zstd_options.output_buffer_size, options.zstd_options, true));
+#endif  // IS_SLIM_BUILD || IS_MOBILE_PLATFORM
+  } else if (options.compression_type == RecordReaderOptions::LZ4_COMPRESSION) {
+#if defined(IS_SLIM_BUILD) || defined(IS_MOBILE_PLATFORM)
+    LOG(FATAL) << "Lz4 compression is unsupported on mobile platforms.";
+#else
+    input_stream_.reset(new Lz4InputStream(
+        input_stream_.release(), options.lz4_options.input_buffer_size,
+        options.lz4_options.output_buffer_size, options.lz4_options, true));
+#endif  // IS_SLIM_BUILD || IS_MOBILE_PLATFORM
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -202,5 +237,151 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+MappedRecordReader::MappedRecordReader(ReadOnlyMemoryRegion* region,
+                                       bool verify_checksums)
+    : data_(static_cast<const char*>(region->data())),
+      size_(region->length()),
+      verify_checksums_(verify_checksums) {}
+
+// Views n+4 bytes at offset, verifies (if requested) that the checksum of the
+// first n bytes is stored in the last 4 bytes and stores a view of the first n
+// bytes in *result.
+Status MappedRecordReader::ReadChecksummed(uint64 offset, size_t n,
+                                           bool verify_checksum,
+                                           StringPiece* result) const {
+  if (offset >= size_) {
+    return errors::OutOfRange("eof");
+  }
+  if (n > size_ - offset || sizeof(uint32) > size_ - offset - n) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  const char* data = data_ + offset;
+  if (verify_checksum) {
+    const uint32 masked_crc = core::DecodeFixed32(data + n);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(data, n)) {
+      return errors::DataLoss("corrupted record at ", offset);
+    }
+  }
+  *result = StringPiece(data, n);
+  return Status::OK();
+}
+
+Status MappedRecordReader::ReadRecord(uint64* offset,
+                                      StringPiece* record) const {
+  // Read header data.
+  StringPiece header;
+  TF_RETURN_IF_ERROR(ReadChecksummed(*offset, sizeof(uint64),
+                                     /*verify_checksum=*/true, &header));
+  const uint64 length = core::DecodeFixed64(header.data());
+
+  // Read data
+  Status s = ReadChecksummed(*offset + RecordReader::kHeaderSize, length,
+                             verify_checksums_, record);
+  if (!s.ok()) {
+    if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("truncated record at ", *offset);
+    }
+    return s;
+  }
+
+  *offset += RecordReader::kHeaderSize + length + RecordReader::kFooterSize;
+  return Status::OK();
+}
+
+Status MappedRecordReader::ReadRecords(
+    uint64* offset, size_t max_records,
+    std::vector<StringPiece>* records) const {
+  // First walk the headers of as many complete records as fit in the mapping,
+  // then checksum every length and every payload with one batched call. The
+  // lengths are not verified while walking, but every record is bounds
+  // checked, and only records preceding the first checksum mismatch are
+  // returned.
+  if (max_records == 0) return Status::OK();
+  const size_t kHeaderSize = RecordReader::kHeaderSize;
+  const size_t kFooterSize = RecordReader::kFooterSize;
+  gtl::InlinedVector<const char*, 64> buffers;
+  gtl::InlinedVector<size_t, 64> sizes;
+  uint64 pos = *offset;
+  while (buffers.size() < 2 * max_records && pos < size_ &&
+         size_ - pos >= kHeaderSize) {
+    const char* header = data_ + pos;
+    const uint64 length = core::DecodeFixed64(header);
+    const uint64 remaining = size_ - pos - kHeaderSize;
+    if (length > remaining || kFooterSize > remaining - length) break;
+    buffers.push_back(header);
+    sizes.push_back(sizeof(uint64));
+    buffers.push_back(header + kHeaderSize);
+    sizes.push_back(verify_checksums_ ? length : 0);
+    pos += kHeaderSize + length + kFooterSize;
+  }
+  gtl::InlinedVector<uint32, 64> crcs(buffers.size());
+  crc32c::ValueBatch(buffers.data(), sizes.data(), buffers.size(),
+                     crcs.data());
+
+  const size_t num_records = records->size();
+  for (size_t i = 0; i < buffers.size(); i += 2) {
+    const char* header = buffers[i];
+    const uint64 length = core::DecodeFixed64(header);
+    if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+        crcs[i]) {
+      break;
+    }
+    if (verify_checksums_ &&
+        crc32c::Unmask(core::DecodeFixed32(header + kHeaderSize + length)) !=
+            crcs[i + 1]) {
+      break;
+    }
+    records->emplace_back(header + kHeaderSize, length);
+    *offset += kHeaderSize + length + kFooterSize;
+  }
+
+  // Let ReadRecord() report why the first record could not be read.
+  if (records->size() == num_records) {
+    StringPiece record;
+    TF_RETURN_IF_ERROR(ReadRecord(offset, &record));
+    records->push_back(record);
+  }
+  return Status::OK();
+}
+
+RecordIndexReader::RecordIndexReader(RandomAccessFile* file, uint64 file_size)
+    : file_(file), num_records_(file_size / sizeof(uint64)) {}
+
+Status RecordIndexReader::GetOffset(int64 record_index, uint64* offset) const {
+  if (record_index < 0 || record_index >= num_records_) {
+    return errors::OutOfRange("record ", record_index,
+                              " is out of range for an index of ",
+                              num_records_, " records");
+  }
+  char scratch[sizeof(uint64)];
+  StringPiece entry;
+  TF_RETURN_IF_ERROR(file_->Read(record_index * sizeof(uint64), sizeof(uint64),
+                                 &entry, scratch));
+  if (entry.size() != sizeof(uint64)) {
+    return errors::DataLoss("truncated index entry for record ", record_index);
+  }
+  *offset = core::DecodeFixed64(entry.data());
+  return Status::OK();
+}
+
+Status RecordIndexReader::FindRecord(uint64 offset,
+                                     int64* record_index) const {
+  // Binary search for the first record that starts at or after `offset`.
+  int64 low = 0;
+  int64 high = num_records_;
+  while (low < high) {
+    const int64 mid = low + (high - low) / 2;
+    uint64 mid_offset;
+    TF_RETURN_IF_ERROR(GetOffset(mid, &mid_offset));
+    if (mid_offset < offset) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  *record_index = low;
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
@@ -16,10 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/lz4/lz4_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/parallel_zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
@@ -29,17 +34,25 @@ limitations under the License.
 namespace tensorflow {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
 class RecordReaderOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    ZSTD_COMPRESSION = 2,
+    LZ4_COMPRESSION = 3
+  };
   CompressionType compression_type = NONE;
 
   // If buffer_size is non-zero, then all reads must be sequential, and no
   // skipping around is permitted. (Note: this is the same behavior as reading
-  // compressed files.) Consider using SequentialRecordReader.
+  // compressed files.) Consider using SequentialRecordReader. If the file
+  // supports asynchronous reads, the next buffer is then read ahead with
+  // RandomAccessFile::ReadAsync() while the current one is consumed.
   int64 buffer_size = 0;
 
   static RecordReaderOptions CreateRecordReaderOptions(
@@ -49,6 +62,12 @@ class RecordReaderOptions {
   // Options specific to zlib compression.
   ZlibCompressionOptions zlib_options;
 #endif  // IS_SLIM_BUILD
+
+  // Options specific to zstd compression.
+  ZstdCompressionOptions zstd_options;
+
+  // Options specific to lz4 compression.
+  Lz4CompressionOptions lz4_options;
 };
 
 // Low-level interface to read TFRecord files.
@@ -152,6 +171,82 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Low-level interface to read uncompressed TFRecord files that are mapped into
+// memory, e.g. by `Env::NewReadOnlyMemoryRegionFromFile()`.
+//
+// Records are returned as views into the mapping, so reading a record does not
+// copy it and does not make a system call.
+//
+// Note: this class is thread safe.
+class MappedRecordReader {
+ public:
+  // Create a reader that will return records from "*region". "*region" must
+  // remain live while this Reader, or any record it returned, is in use.
+  //
+  // If `verify_checksums` is false, the checksums of record data are not
+  // checked. The checksums of record lengths are always checked.
+  explicit MappedRecordReader(ReadOnlyMemoryRegion* region,
+                              bool verify_checksums = true);
+
+  // Stores a view of the record at "*offset" in *record and updates *offset
+  // to point to the offset of the next record. Returns OK on success,
+  // OUT_OF_RANGE for end of file, or something else for an error.
+  Status ReadRecord(uint64* offset, StringPiece* record) const;
+
+  // Appends views of up to `max_records` records, starting with the one at
+  // "*offset", to *records and updates *offset to point past the last of them.
+  // The checksums of all the records are verified in one pass, which is
+  // faster than calling ReadRecord() for each of them when records are small.
+  //
+  // Stops early before a record that cannot be read, so that its error is
+  // returned by the next call. Returns OK if at least one record was read,
+  // OUT_OF_RANGE for end of file, or something else for an error.
+  Status ReadRecords(uint64* offset, size_t max_records,
+                     std::vector<StringPiece>* records) const;
+
+ private:
+  Status ReadChecksummed(uint64 offset, size_t n, bool verify_checksum,
+                         StringPiece* result) const;
+
+  const char* const data_;
+  const uint64 size_;
+  const bool verify_checksums_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedRecordReader);
+};
+
+// Reads the index of a TFRecord file, as written by `RecordWriter`, which
+// maps record numbers to the offsets that `RecordReader::ReadRecord()` accepts.
+//
+// Each lookup reads a single entry from the index file, so the index is never
+// loaded into memory.
+//
+// Note: this class is thread safe.
+class RecordIndexReader {
+ public:
+  // Create a reader for the index "*file", which has `file_size` bytes.
+  // "*file" must remain live while this Reader is in use.
+  RecordIndexReader(RandomAccessFile* file, uint64 file_size);
+
+  // Returns the number of records in the indexed file.
+  int64 num_records() const { return num_records_; }
+
+  // Stores the offset of record `record_index`, which must be in
+  // `[0, num_records())`, in `*offset`.
+  Status GetOffset(int64 record_index, uint64* offset) const;
+
+  // Stores the number of records that start before `offset` in
+  // `*record_index`, so that if `offset` is the offset of a record, then
+  // `*record_index` is its record number.
+  Status FindRecord(uint64 offset, int64* record_index) const;
+
+ private:
+  RandomAccessFile* const file_;
+  const int64 num_records_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecordIndexReader);
+};
+
 }  // namespace io
 }  // namespace tensorflow
 
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -41,6 +42,12 @@ io::RecordReaderOptions GetMatchingReaderOptions(
   if (options.compression_type == io::RecordWriterOptions::ZLIB_COMPRESSION) {
     return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
   }
+  if (options.compression_type == io::RecordWriterOptions::ZSTD_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD");
+  }
+  if (options.compression_type == io::RecordWriterOptions::LZ4_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("LZ4");
+  }
   return io::RecordReaderOptions::CreateRecordReaderOptions("");
 }
 
@@ -117,6 +124,14 @@ TEST(RecordReaderWriterTest, TestZlibSyncFlush) {
   VerifyFlush(options);
 }
 
+TEST(RecordReaderWriterTest, TestZstdFlush) {
+  VerifyFlush(io::RecordWriterOptions::CreateRecordWriterOptions("ZSTD"));
+}
+
+TEST(RecordReaderWriterTest, TestLz4Flush) {
+  VerifyFlush(io::RecordWriterOptions::CreateRecordWriterOptions("LZ4"));
+}
+
 TEST(RecordReaderWriterTest, TestBasics) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_test";
@@ -196,6 +211,262 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestParallelZlib) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_parallel_zlib_test";
+  std::vector<string> records;
+  for (int i = 0; i < 1000; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i % 100, 'x')));
+  }
+
+  for (auto buf_size : {100, 10000}) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options =
+          io::RecordWriterOptions::CreateRecordWriterOptions("GZIP");
+      options.zlib_options.input_buffer_size = buf_size;
+      options.zlib_options.num_threads = 4;
+      io::RecordWriter writer(file.get(), options);
+      for (const string& record : records) {
+        TF_EXPECT_OK(writer.WriteRecord(record));
+      }
+      TF_CHECK_OK(writer.Close());
+    }
+
+    // The output can be read both serially and in parallel.
+    for (int num_threads : {1, 4}) {
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options =
+          io::RecordReaderOptions::CreateRecordReaderOptions("GZIP");
+      options.zlib_options.input_buffer_size = buf_size;
+      options.zlib_options.num_threads = num_threads;
+      io::SequentialRecordReader reader(read_file.get(), options);
+      tstring record;
+      for (const string& expected : records) {
+        TF_CHECK_OK(reader.ReadRecord(&record));
+        EXPECT_EQ(expected, record);
+      }
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestZstdAndLz4) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zstd_lz4_test";
+  std::vector<string> records;
+  for (int i = 0; i < 1000; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i % 100, 'x')));
+  }
+
+  for (const string& compression_type : {"ZSTD", "LZ4"}) {
+    for (auto buf_size : {100, 10000}) {
+      {
+        std::unique_ptr<WritableFile> file;
+        TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+        io::RecordWriterOptions options =
+            io::RecordWriterOptions::CreateRecordWriterOptions(
+                compression_type);
+        options.zstd_options.input_buffer_size = buf_size;
+        options.lz4_options.input_buffer_size = buf_size;
+        io::RecordWriter writer(file.get(), options);
+        for (const string& record : records) {
+          TF_EXPECT_OK(writer.WriteRecord(record));
+        }
+        TF_CHECK_OK(writer.Close());
+      }
+
+      {
+        std::unique_ptr<RandomAccessFile> read_file;
+        TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+        io::RecordReaderOptions options =
+            io::RecordReaderOptions::CreateRecordReaderOptions(
+                compression_type);
+        options.zstd_options.input_buffer_size = buf_size;
+        options.lz4_options.input_buffer_size = buf_size;
+        io::SequentialRecordReader reader(read_file.get(), options);
+        tstring record;
+        for (const string& expected : records) {
+          TF_CHECK_OK(reader.ReadRecord(&record));
+          EXPECT_EQ(expected, record);
+        }
+        EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+      }
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + ".index";
+  const std::vector<string> records = {"abc", "", "defg", "hijklmnop"};
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+
+    io::RecordWriter writer(file.get(), index_file.get());
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+
+  {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    std::unique_ptr<RandomAccessFile> index_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(index_fname, &index_file));
+    uint64 index_file_size;
+    TF_CHECK_OK(env->GetFileSize(index_fname, &index_file_size));
+    io::RecordIndexReader index(index_file.get(), index_file_size);
+    ASSERT_EQ(records.size(), index.num_records());
+
+    // Read the records in reverse order, seeking with the index.
+    io::RecordReader reader(read_file.get());
+    for (int64 i = records.size() - 1; i >= 0; --i) {
+      uint64 offset;
+      TF_ASSERT_OK(index.GetOffset(i, &offset));
+      int64 record_index;
+      TF_ASSERT_OK(index.FindRecord(offset, &record_index));
+      EXPECT_EQ(i, record_index);
+      tstring record;
+      TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(records[i], record);
+    }
+
+    uint64 offset;
+    EXPECT_EQ(index.GetOffset(records.size(), &offset).code(),
+              error::OUT_OF_RANGE);
+    int64 record_index;
+    TF_ASSERT_OK(index.FindRecord(/*offset=*/1, &record_index));
+    EXPECT_EQ(1, record_index);
+    TF_ASSERT_OK(index.FindRecord(/*offset=*/1 << 20, &record_index));
+    EXPECT_EQ(records.size(), record_index);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestMappedReader) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_mapped_test";
+  const std::vector<string> records = {"abc", "", "defg", "hijklmnop"};
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MappedRecordReader reader(region.get());
+  uint64 offset = 0;
+  StringPiece record;
+  for (const string& expected : records) {
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(expected, record);
+    // The record is a view into the mapping.
+    EXPECT_GE(record.data(), static_cast<const char*>(region->data()));
+  }
+  EXPECT_EQ(region->length(), offset);
+  EXPECT_EQ(reader.ReadRecord(&offset, &record).code(), error::OUT_OF_RANGE);
+
+  // Corrupt the data of the last record and truncate its footer.
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  contents[contents.size() - io::RecordReader::kFooterSize - 1] ^= 1;
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  const uint64 last_offset = contents.size() - io::RecordReader::kHeaderSize -
+                             records.back().size() -
+                             io::RecordReader::kFooterSize;
+  offset = last_offset;
+  EXPECT_EQ(io::MappedRecordReader(region.get())
+                .ReadRecord(&offset, &record)
+                .code(),
+            error::DATA_LOSS);
+  offset = last_offset;
+  TF_ASSERT_OK(io::MappedRecordReader(region.get(), /*verify_checksums=*/false)
+                   .ReadRecord(&offset, &record));
+  EXPECT_EQ(records.back().size(), record.size());
+
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents.substr(0, offset - 1)));
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  offset = last_offset;
+  EXPECT_EQ(io::MappedRecordReader(region.get())
+                .ReadRecord(&offset, &record)
+                .code(),
+            error::DATA_LOSS);
+}
+
+TEST(RecordReaderWriterTest, TestMappedReaderBatches) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_mapped_batch_test";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i % 37, 'x')));
+  }
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MappedRecordReader reader(region.get());
+  for (size_t batch_size : {1, 7, 64, 1000}) {
+    uint64 offset = 0;
+    std::vector<StringPiece> read;
+    while (read.size() < records.size()) {
+      const size_t num_read = read.size();
+      TF_ASSERT_OK(reader.ReadRecords(&offset, batch_size, &read));
+      EXPECT_LE(read.size() - num_read, batch_size);
+    }
+    EXPECT_EQ(records, std::vector<string>(read.begin(), read.end()));
+    EXPECT_EQ(region->length(), offset);
+    EXPECT_EQ(reader.ReadRecords(&offset, batch_size, &read).code(),
+              error::OUT_OF_RANGE);
+  }
+
+  // Corrupt the data of record 50. A batch returns the records before it, and
+  // the next batch reports the corruption.
+  uint64 corrupt_offset = 0;
+  for (int i = 0; i < 50; ++i) {
+    corrupt_offset += io::RecordReader::kHeaderSize + records[i].size() +
+                      io::RecordReader::kFooterSize;
+  }
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  contents[corrupt_offset + io::RecordReader::kHeaderSize] ^= 1;
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MappedRecordReader corrupt_reader(region.get());
+  uint64 offset = 0;
+  std::vector<StringPiece> read;
+  TF_ASSERT_OK(corrupt_reader.ReadRecords(&offset, 64, &read));
+  EXPECT_EQ(50, read.size());
+  EXPECT_EQ(corrupt_offset, offset);
+  EXPECT_EQ(corrupt_reader.ReadRecords(&offset, 64, &read).code(),
+            error::DATA_LOSS);
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -219,4 +490,60 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+static const char* const kBenchmarkCompressionTypes[] = {"", "ZLIB", "ZSTD",
+                                                         "LZ4"};
+
+// Writes 64MB of moderately compressible records with the given compression
+// type into `fname`.
+static void WriteBenchmarkRecords(const string& fname,
+                                  const string& compression_type) {
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+  io::RecordWriter writer(
+      file.get(),
+      io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+  string record(1 << 10, ' ');
+  for (int i = 0; i < 64 << 10; ++i) {
+    for (size_t j = 0; j < record.size(); j += 8) {
+      record[j] = 'a' + (i * 31 + j) % 26;
+    }
+    TF_CHECK_OK(writer.WriteRecord(record));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+}
+
+static void BM_WriteRecords(int iters, int compression) {
+  testing::StopTiming();
+  string fname = testing::TmpDir() + "/record_writer_benchmark";
+  testing::BytesProcessed(static_cast<int64>(iters) * (64 << 20));
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    WriteBenchmarkRecords(fname, kBenchmarkCompressionTypes[compression]);
+  }
+}
+BENCHMARK(BM_WriteRecords)->Arg(0)->Arg(1)->Arg(2)->Arg(3);
+
+static void BM_ReadRecords(int iters, int compression) {
+  testing::StopTiming();
+  const string compression_type = kBenchmarkCompressionTypes[compression];
+  string fname = testing::TmpDir() + "/record_reader_benchmark";
+  WriteBenchmarkRecords(fname, compression_type);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  testing::BytesProcessed(static_cast<int64>(iters) * (64 << 20));
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    io::SequentialRecordReader reader(
+        file.get(),
+        io::RecordReaderOptions::CreateRecordReaderOptions(compression_type));
+    tstring record;
+    Status s;
+    while ((s = reader.ReadRecord(&record)).ok()) {
+    }
+    CHECK(errors::IsOutOfRange(s)) << s;
+  }
+}
+BENCHMARK(BM_ReadRecords)->Arg(0)->Arg(1)->Arg(2)->Arg(3);
+
 }  // namespace tensorflow
@@ -19,6 +19,11 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/platform.h"
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/lib/io/lz4/lz4_outputbuffer.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+#endif  // !IS_SLIM_BUILD && !IS_MOBILE_PLATFORM
 
 namespace tensorflow {
 namespace io {
@@ -26,6 +31,10 @@ namespace {
 bool IsZlibCompressed(RecordWriterOptions options) {
   return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION;
 }
+
+bool IsCompressed(RecordWriterOptions options) {
+  return options.compression_type != RecordWriterOptions::NONE;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -47,6 +56,10 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
 #endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+  } else if (compression_type == compression::kLz4) {
+    options.compression_type = io::RecordWriterOptions::LZ4_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -56,22 +69,66 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 
 RecordWriter::RecordWriter(WritableFile* dest,
                            const RecordWriterOptions& options)
-    : dest_(dest), options_(options) {
+    : RecordWriter(dest, /*index_dest=*/nullptr, options) {}
+
+RecordWriter::RecordWriter(WritableFile* dest, WritableFile* index_dest,
+                           const RecordWriterOptions& options)
+    : dest_(dest), index_dest_(index_dest), options_(options) {
   if (IsZlibCompressed(options)) {
 // We don't have zlib available on all embedded platforms, so fail.
 #if defined(IS_SLIM_BUILD)
     LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
 #else   // IS_SLIM_BUILD
-    ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
-        dest, options.zlib_options.input_buffer_size,
-        options.zlib_options.output_buffer_size, options.zlib_options);
-    Status s = zlib_output_buffer->Init();
+    Status s;
+    if (options.zlib_options.num_threads > 1) {
+      ParallelZlibOutputBuffer* zlib_output_buffer =
+          new ParallelZlibOutputBuffer(dest,
+                                       options.zlib_options.input_buffer_size,
+                                       options.zlib_options);
+      s = zlib_output_buffer->Init();
+      dest_ = zlib_output_buffer;
+    } else {
+      ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
+          dest, options.zlib_options.input_buffer_size,
+          options.zlib_options.output_buffer_size, options.zlib_options);
+      s = zlib_output_buffer->Init();
+      dest_ = zlib_output_buffer;
+    }
     if (!s.ok()) {
       LOG(FATAL) << "Failed to initialize Zlib inputbuffer. Error: "
                  << s.ToString();
     }
-    dest_ = zlib_output_buffer;
 #endif  // IS_SLIM_BUILD
+  } else if (options.compression_type ==
+             RecordWriterOptions::ZSTD_COMPRESSION) {
+// zstd and lz4 are not built for mobile platforms.
+#if defined(IS_SLIM_BUILD) || defined(IS_MOBILE_PLATFORM)
+    LOG(FATAL) << "Zstd compression is unsupported on mobile platforms.";
+#else
+    ZstdOutputBuffer* zstd_output_buffer = new ZstdOutputBuffer(
+        dest, options.zstd_options.input_buffer_size,
+        options.zstd_options.output_buffer_size, options.zstd_options);
+    Status s = zstd_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Zstd outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zstd_output_buffer;
+#endif  // IS_SLIM_BUILD || IS_MOBILE_PLATFORM
+  } else if (options.compression_type == RecordWriterOptions::LZ4_COMPRESSION) {
+#if defined(IS_SLIM_BUILD) || defined(IS_MOBILE_PLATFORM)
+    LOG(FATAL) << "Lz4 compression is unsupported on mobile platforms.";
+#else
+    Lz4OutputBuffer* lz4_output_buffer = new Lz4OutputBuffer(
+        dest, options.lz4_options.input_buffer_size,
+        options.lz4_options.output_buffer_size, options.lz4_options);
+    Status s = lz4_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Lz4 outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = lz4_output_buffer;
+#endif  // IS_SLIM_BUILD || IS_MOBILE_PLATFORM
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -104,7 +161,8 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AppendIndexEntry(data.size());
 }
 
 #if defined(PLATFORM_GOOGLE)
@@ -124,14 +182,25 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AppendIndexEntry(data.size());
 }
 #endif
 
+Status RecordWriter::AppendIndexEntry(size_t n) {
+  if (index_dest_ != nullptr) {
+    char entry[kIndexEntrySize];
+    core::EncodeFixed64(entry, offset_);
+    TF_RETURN_IF_ERROR(index_dest_->Append(StringPiece(entry, sizeof(entry))));
+  }
+  offset_ += kHeaderSize + n + kFooterSize;
+  return Status::OK();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
 #if !defined(IS_SLIM_BUILD)
-  if (IsZlibCompressed(options_)) {
+  if (IsCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -20,7 +20,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/lz4/lz4_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/parallel_zlib_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
@@ -36,7 +39,12 @@ namespace io {
 
 class RecordWriterOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    ZSTD_COMPRESSION = 2,
+    LZ4_COMPRESSION = 3
+  };
   CompressionType compression_type = NONE;
 
   static RecordWriterOptions CreateRecordWriterOptions(
@@ -46,6 +54,12 @@ class RecordWriterOptions {
 #if !defined(IS_SLIM_BUILD)
   tensorflow::io::ZlibCompressionOptions zlib_options;
 #endif  // IS_SLIM_BUILD
+
+  // Options specific to zstd compression.
+  tensorflow::io::ZstdCompressionOptions zstd_options;
+
+  // Options specific to lz4 compression.
+  tensorflow::io::Lz4CompressionOptions lz4_options;
 };
 
 class RecordWriter {
@@ -58,12 +72,25 @@ class RecordWriter {
   static const size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
   static const size_t kFooterSize = sizeof(uint32);
 
+  // Format of an index file:
+  //  uint64    offset[num_records]
+  // where offset[i] is the offset of record i in the uncompressed record
+  // stream. See `RecordIndexReader` for reading index files.
+  static const size_t kIndexEntrySize = sizeof(uint64);
+
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
   RecordWriter(WritableFile* dest,
                const RecordWriterOptions& options = RecordWriterOptions());
 
+  // Create a writer that will append data to "*dest", and the offset of each
+  // record to the index "*index_dest".
+  // "*dest" and "*index_dest" must be initially empty.
+  // "*dest" and "*index_dest" must remain live while this Writer is in use.
+  RecordWriter(WritableFile* dest, WritableFile* index_dest,
+               const RecordWriterOptions& options = RecordWriterOptions());
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -78,7 +105,7 @@ class RecordWriter {
 
   // Flushes any buffered data held by underlying containers of the
   // RecordWriter to the WritableFile. Does *not* flush the
-  // WritableFile.
+  // WritableFile or the index.
   Status Flush();
 
   // Writes all output to the file. Does *not* close the WritableFile.
@@ -101,8 +128,15 @@ class RecordWriter {
 #endif
 
  private:
+  // Appends the offset of the record that was just written, which holds `n`
+  // bytes of data, to `index_dest_` if any, and advances `offset_` past it.
+  Status AppendIndexEntry(size_t n);
+
   WritableFile* dest_;
+  WritableFile* index_dest_;
   RecordWriterOptions options_;
+  // The offset of the next record in the uncompressed record stream.
+  uint64 offset_ = 0;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/parallel_zlib_inputstream.h"
+#include "tensorflow/core/lib/io/parallel_zlib_outputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -330,6 +332,113 @@ void TestSoftErrorOnDecompress(CompressionOptions input_options) {
   }
 }
 
+void TestParallelCombinations(CompressionOptions options) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/parallel_zlib_buffers_test";
+  for (auto file_size : NumCopies()) {
+    string data = GenTestString(file_size);
+    for (int num_threads : {2, 4}) {
+      options.num_threads = num_threads;
+      for (auto block_size : InputBufferSizes()) {
+        std::unique_ptr<WritableFile> file_writer;
+        TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+        ParallelZlibOutputBuffer out(file_writer.get(), block_size, options);
+        TF_ASSERT_OK(out.Init());
+        // Flushing in the middle ends a block early.
+        TF_ASSERT_OK(out.Append(StringPiece(data).substr(0, data.size() / 3)));
+        TF_ASSERT_OK(out.Flush());
+        TF_ASSERT_OK(out.Append(StringPiece(data).substr(data.size() / 3)));
+        TF_ASSERT_OK(out.Close());
+        TF_ASSERT_OK(file_writer->Close());
+
+        std::unique_ptr<RandomAccessFile> file_reader;
+        TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+        tstring result;
+        {
+          // The output is a single stream that `ZlibInputStream` can read.
+          RandomAccessInputStream input_stream(file_reader.get());
+          ZlibInputStream in(&input_stream, 1000, 1000, options);
+          TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+          EXPECT_EQ(result, data);
+        }
+        for (auto input_buf_size : InputBufferSizes()) {
+          RandomAccessInputStream input_stream(file_reader.get());
+          ParallelZlibInputStream in(&input_stream, input_buf_size, 100,
+                                     options, false);
+          TF_ASSERT_OK(in.ReadNBytes(data.size() / 2, &result));
+          EXPECT_EQ(result, data.substr(0, data.size() / 2));
+          EXPECT_EQ(in.Tell(), data.size() / 2);
+          EXPECT_TRUE(
+              errors::IsOutOfRange(in.ReadNBytes(data.size(), &result)));
+          EXPECT_EQ(result, data.substr(data.size() / 2));
+
+          TF_ASSERT_OK(in.Reset());
+          TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+          EXPECT_EQ(result, data);
+        }
+      }
+    }
+  }
+}
+
+TEST(ParallelZlibBuffers, DefaultOptions) {
+  TestParallelCombinations(CompressionOptions::DEFAULT());
+}
+
+TEST(ParallelZlibBuffers, RawDeflate) {
+  TestParallelCombinations(CompressionOptions::RAW());
+}
+
+TEST(ParallelZlibBuffers, Gzip) {
+  TestParallelCombinations(CompressionOptions::GZIP());
+}
+
+// Streams written by `ZlibOutputBuffer` with Z_SYNC_FLUSH have block
+// boundaries, but the blocks refer back to each other.
+TEST(ParallelZlibInputStream, ReadsDependentBlocks) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/parallel_zlib_buffers_test";
+  CompressionOptions options = CompressionOptions::GZIP();
+  options.flush_mode = Z_SYNC_FLUSH;
+  options.num_threads = 4;
+  string data = GenTestString(500);
+  WriteCompressedFile(env, fname, 1000, 1000, options, data);
+
+  for (auto input_buf_size : InputBufferSizes()) {
+    std::unique_ptr<RandomAccessFile> file_reader;
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+    RandomAccessInputStream input_stream(file_reader.get());
+    ParallelZlibInputStream in(&input_stream, input_buf_size, 1000, options,
+                               false);
+    tstring result;
+    TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+    EXPECT_EQ(result, data);
+  }
+}
+
+TEST(ParallelZlibInputStream, DetectsCorruptTrailer) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/parallel_zlib_buffers_test";
+  CompressionOptions options = CompressionOptions::GZIP();
+  options.num_threads = 2;
+  string data = GenTestString(50);
+  WriteCompressedFile(env, fname, 1000, 1000, options, data);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+  // Corrupt the crc32 at the start of the gzip trailer.
+  contents[contents.size() - 8] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ParallelZlibInputStream in(&input_stream, 100, 100, options, false);
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  Status s = in.ReadNBytes(1, &result);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
 TEST(ZlibInputStream, TellDefaultOptions) {
   TestTell(CompressionOptions::DEFAULT(), CompressionOptions::DEFAULT());
 }
@@ -117,6 +117,15 @@ class ZlibCompressionOptions {
   //
   // This option is ignored for `ZlibOutputBuffer`.
   bool soft_fail_on_error = false;  // NOLINT
+
+  // The number of threads used to compress or decompress. When greater than
+  // 1, `RecordWriter` and `RecordReader` use `ParallelZlibOutputBuffer` and
+  // `ParallelZlibInputStream`, which compress blocks of `input_buffer_size`
+  // bytes independently and decompress them in parallel. The output is still
+  // a single stream that any zlib decoder can read.
+  //
+  // Defaults to 1.
+  int32 num_threads = 1;
 };
 
 inline ZlibCompressionOptions ZlibCompressionOptions::DEFAULT() {
@@ -0,0 +1,230 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+std::vector<int> InputBufferSizes() { return {10, 100, 1000, 10000}; }
+
+std::vector<int> OutputBufferSizes() { return {100, 500, 1000}; }
+
+std::vector<int> NumCopies() { return {1, 50, 500}; }
+
+string GetRecord(int i = 0) {
+  return strings::StrCat(
+      "{\"id\": ", i, ", \"name\": \"record ", i * 7919 % 1000,
+      "\", \"tags\": [\"lorem\", \"ipsum\", \"dolor\"], \"score\": ", i % 97,
+      ".5, \"description\": \"Lorem ipsum dolor sit amet, consectetur "
+      "adipiscing elit. Fusce vehicula tincidunt libero sit amet ultrices.\"}");
+}
+
+string GenTestString(int copies = 1) {
+  string result;
+  for (int i = 0; i < copies; i++) {
+    result += GetRecord(i);
+  }
+  return result;
+}
+
+// Writes `data` to `fname` in `num_writes` appends, flushing after each one
+// if `with_flush` is true.
+void WriteCompressed(const string& fname, const string& data,
+                     const ZstdCompressionOptions& options, int input_buf_size,
+                     int output_buf_size, int num_writes = 1,
+                     bool with_flush = false) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), input_buf_size, output_buf_size,
+                       options);
+  TF_ASSERT_OK(out.Init());
+  for (int i = 0; i < num_writes; i++) {
+    TF_ASSERT_OK(out.Append(data));
+    if (with_flush) {
+      TF_ASSERT_OK(out.Flush());
+    }
+  }
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file_writer->Close());
+}
+
+TEST(ZstdBuffers, AllBufferSizes) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/zstd_buffers_test";
+  ZstdCompressionOptions options;
+  for (auto num_copies : NumCopies()) {
+    string data = GenTestString(num_copies);
+    for (auto input_buf_size : InputBufferSizes()) {
+      for (auto output_buf_size : OutputBufferSizes()) {
+        WriteCompressed(fname, data, options, input_buf_size, output_buf_size);
+
+        std::unique_ptr<RandomAccessFile> file_reader;
+        TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+        RandomAccessInputStream input_stream(file_reader.get());
+        ZstdInputStream in(&input_stream, input_buf_size, output_buf_size,
+                           options, /*owns_input_stream=*/false);
+        tstring result;
+        TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+        EXPECT_EQ(result, data);
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+      }
+    }
+  }
+}
+
+TEST(ZstdBuffers, MultipleWritesWithFlush) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/zstd_buffers_test";
+  ZstdCompressionOptions options;
+  options.compression_level = 19;
+  string data = GenTestString(10);
+  WriteCompressed(fname, data, options, 200, 100, /*num_writes=*/10,
+                  /*with_flush=*/true);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  ZstdInputStream in(new RandomAccessInputStream(file_reader.get()), 100, 50,
+                     options, /*owns_input_stream=*/true);
+  // Run the test twice, resetting the stream after the first attempt.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    for (int i = 0; i < 10; ++i) {
+      tstring result;
+      TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+      EXPECT_EQ(result, data);
+      EXPECT_EQ(in.Tell(), (i + 1) * data.size());
+    }
+    tstring result;
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+    TF_ASSERT_OK(in.Reset());
+  }
+}
+
+TEST(ZstdBuffers, ReadFlushedStreamBeforeClose) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/zstd_buffers_test";
+  ZstdCompressionOptions options;
+  string data = GenTestString(20);
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), 1000, 1000, options);
+  TF_ASSERT_OK(out.Init());
+  TF_ASSERT_OK(out.Append(data));
+  TF_ASSERT_OK(out.Flush());
+
+  // Everything appended before the flush can be read, even though the frame
+  // has not ended yet.
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 1000, 1000, options,
+                     /*owns_input_stream=*/false);
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  EXPECT_EQ(result, data);
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+  TF_ASSERT_OK(out.Close());
+}
+
+TEST(ZstdBuffers, Dictionary) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/zstd_buffers_test";
+  std::vector<string> samples;
+  for (int i = 0; i < 1000; ++i) {
+    samples.push_back(GetRecord(i));
+  }
+  ZstdCompressionOptions options;
+  TF_ASSERT_OK(TrainZstdDictionary(samples, 4 << 10, &options.dictionary));
+  EXPECT_FALSE(options.dictionary.empty());
+  EXPECT_LE(options.dictionary.size(), 4 << 10);
+
+  // A single record compresses better with the dictionary than without.
+  string data = GetRecord(1234);
+  uint64 size_without_dictionary;
+  WriteCompressed(fname, data, ZstdCompressionOptions(), 1000, 1000);
+  TF_ASSERT_OK(env->GetFileSize(fname, &size_without_dictionary));
+  uint64 size_with_dictionary;
+  WriteCompressed(fname, data, options, 1000, 1000);
+  TF_ASSERT_OK(env->GetFileSize(fname, &size_with_dictionary));
+  EXPECT_LT(size_with_dictionary, size_without_dictionary);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 1000, 1000, options,
+                     /*owns_input_stream=*/false);
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  EXPECT_EQ(result, data);
+
+  // The stream cannot be read without the dictionary.
+  RandomAccessInputStream other_input_stream(file_reader.get());
+  ZstdInputStream other_in(&other_input_stream, 1000, 1000,
+                           ZstdCompressionOptions(),
+                           /*owns_input_stream=*/false);
+  EXPECT_TRUE(errors::IsDataLoss(other_in.ReadNBytes(data.size(), &result)));
+}
+
+TEST(ZstdBuffers, CorruptStream) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/zstd_buffers_test";
+  string data = GenTestString(100);
+  WriteCompressed(fname, data, ZstdCompressionOptions(), 1000, 1000);
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+  contents[contents.size() / 2] ^= 0x55;
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 1000, 1000, ZstdCompressionOptions(),
+                     /*owns_input_stream=*/false);
+  // The corruption is detected at the latest by the checksum at the end of
+  // the frame.
+  tstring result;
+  Status s;
+  do {
+    s = in.ReadNBytes(1000, &result);
+  } while (s.ok());
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+TEST(ZstdBuffers, InvalidOptions) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(
+      testing::TmpDir() + "/zstd_buffers_test", &file_writer));
+  ZstdCompressionOptions options;
+  options.window_log = 5;
+  ZstdOutputBuffer out(file_writer.get(), 1000, 1000, options);
+  EXPECT_TRUE(errors::IsInvalidArgument(out.Init()));
+  EXPECT_TRUE(errors::IsFailedPrecondition(out.Append("data")));
+  TF_EXPECT_OK(out.Close());
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,71 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include <string>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+class ZstdCompressionOptions {
+ public:
+  // Size of the buffer used for caching the data read from source file.
+  int64 input_buffer_size = 256 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // zstd is cached.
+  int64 output_buffer_size = 256 << 10;
+
+  // From the zstd manual (http://facebook.github.io/zstd/zstd_manual.html):
+  // Compression levels range from 1 to 22, where higher levels are slower and
+  // compress better. Levels 20 to 22 need a lot more memory to compress and to
+  // decompress. Negative levels trade compression ratio for even more speed.
+  // 0 requests the default level, which is currently 3.
+  //
+  // This option is ignored by `ZstdInputStream`.
+  int32 compression_level = 3;
+
+  // The base two logarithm of the maximum distance of a match, i.e. of the
+  // size of the history buffer. Larger windows compress better but need more
+  // memory to compress and to decompress. 0 lets zstd choose a window size
+  // from `compression_level`.
+  //
+  // While decompressing, this is the largest window that is accepted, where 0
+  // accepts windows of up to 128MB (27). Streams written with `window_log` >
+  // 27 must be read with the same or a larger value.
+  int32 window_log = 0;
+
+  // Whether to end the frame with a checksum of its uncompressed data, as the
+  // zstd command line tool does. `ZstdInputStream` verifies the checksum of any
+  // frame that has one, whatever the value of this option.
+  bool content_checksum = true;
+
+  // A dictionary, either trained with `TrainZstdDictionary()` or raw content,
+  // that zstd can refer to before any data has been compressed. This improves
+  // the compression of small files of similar data, such as shards of a few
+  // records each. A stream written with a dictionary can only be read with the
+  // same dictionary.
+  string dictionary;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
@@ -0,0 +1,144 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes,
+                                 const ZstdCompressionOptions& zstd_options,
+                                 bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      zstd_options_(zstd_options),
+      output_(new char[output_buffer_bytes]) {
+  init_status_ = Init();
+}
+
+ZstdInputStream::~ZstdInputStream() {
+  ZSTD_freeDCtx(context_);
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::Init() {
+  if (input_buffer_capacity_ == 0 || output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument(
+        "input_buffer_bytes and output_buffer_bytes should be greater than 0");
+  }
+  context_ = ZSTD_createDCtx();
+  if (context_ == nullptr) {
+    return errors::ResourceExhausted("ZSTD_createDCtx() failed");
+  }
+  size_t error = 0;
+  if (zstd_options_.window_log != 0) {
+    error = ZSTD_DCtx_setParameter(context_, ZSTD_d_windowLogMax,
+                                   zstd_options_.window_log);
+  }
+  if (!ZSTD_isError(error) && !zstd_options_.dictionary.empty()) {
+    error = ZSTD_DCtx_loadDictionary(context_, zstd_options_.dictionary.data(),
+                                     zstd_options_.dictionary.size());
+  }
+  if (ZSTD_isError(error)) {
+    return errors::InvalidArgument("Invalid zstd decompression options: ",
+                                   ZSTD_getErrorName(error));
+  }
+  return Status::OK();
+}
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(init_status_);
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  // Resetting the session keeps the parameters and the dictionary.
+  ZSTD_DCtx_reset(context_, ZSTD_reset_session_only);
+  input_.clear();
+  input_pos_ = 0;
+  output_pos_ = 0;
+  output_size_ = 0;
+  output_full_ = false;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+Status ZstdInputStream::ReadFromStream() {
+  Status s = input_stream_->ReadNBytes(input_buffer_capacity_, &input_);
+  input_pos_ = 0;
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  // As with ZlibInputStream, a stream that ends in the middle of a frame
+  // (e.g. because it is still being written) is reported as OutOfRange rather
+  // than as corrupted.
+  if (input_.empty()) {
+    return errors::OutOfRange("EOF reached");
+  }
+  return Status::OK();
+}
+
+Status ZstdInputStream::Decompress() {
+  ZSTD_inBuffer in = {input_.data(), input_.size(), input_pos_};
+  ZSTD_outBuffer out = {output_.get(), output_buffer_capacity_, 0};
+  const size_t error = ZSTD_decompressStream(context_, &out, &in);
+  input_pos_ = in.pos;
+  output_pos_ = 0;
+  output_size_ = out.pos;
+  output_full_ = out.pos == out.size;
+  if (ZSTD_isError(error)) {
+    return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                            ZSTD_getErrorName(error));
+  }
+  return Status::OK();
+}
+
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+  result->clear();
+  while (bytes_to_read > 0) {
+    if (output_pos_ == output_size_) {
+      // The cache is empty, so decompress more data, reading more compressed
+      // data first unless zstd may still hold some output.
+      if (input_pos_ == input_.size() && !output_full_) {
+        TF_RETURN_IF_ERROR(ReadFromStream());
+      }
+      TF_RETURN_IF_ERROR(Decompress());
+      continue;
+    }
+    const size_t n = std::min(static_cast<size_t>(bytes_to_read),
+                              output_size_ - output_pos_);
+    result->append(output_.get() + output_pos_, n);
+    output_pos_ += n;
+    bytes_read_ += n;
+    bytes_to_read -= n;
+  }
+  return Status::OK();
+}
+
+int64 ZstdInputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tensorflow
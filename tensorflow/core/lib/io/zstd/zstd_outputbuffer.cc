@@ -0,0 +1,196 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   int32 input_buffer_bytes,
+                                   int32 output_buffer_bytes,
+                                   const ZstdCompressionOptions& zstd_options)
+    : file_(file),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      zstd_options_(zstd_options),
+      output_(new char[output_buffer_bytes]) {}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (context_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(context_);
+  }
+}
+
+Status ZstdOutputBuffer::Init() {
+  if (output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument(
+        "output_buffer_bytes should be greater than 0");
+  }
+  context_ = ZSTD_createCCtx();
+  if (context_ == nullptr) {
+    return errors::ResourceExhausted("ZSTD_createCCtx() failed");
+  }
+  size_t error = ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel,
+                                        zstd_options_.compression_level);
+  if (!ZSTD_isError(error)) {
+    error = ZSTD_CCtx_setParameter(context_, ZSTD_c_checksumFlag,
+                                   zstd_options_.content_checksum ? 1 : 0);
+  }
+  if (!ZSTD_isError(error) && zstd_options_.window_log != 0) {
+    error = ZSTD_CCtx_setParameter(context_, ZSTD_c_windowLog,
+                                   zstd_options_.window_log);
+  }
+  if (!ZSTD_isError(error) && !zstd_options_.dictionary.empty()) {
+    error = ZSTD_CCtx_loadDictionary(context_, zstd_options_.dictionary.data(),
+                                     zstd_options_.dictionary.size());
+  }
+  if (ZSTD_isError(error)) {
+    ZSTD_freeCCtx(context_);
+    context_ = nullptr;
+    return errors::InvalidArgument("Invalid zstd compression options: ",
+                                   ZSTD_getErrorName(error));
+  }
+  input_.reserve(input_buffer_capacity_);
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Append() called on an uninitialized or closed ZstdOutputBuffer");
+  }
+  // Small appends, like the headers of records, are gathered in `input_` to
+  // save the overhead of a call to zstd per append.
+  if (input_.size() + data.size() <= input_buffer_capacity_) {
+    input_.append(data.data(), data.size());
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(Compress(input_, ZSTD_e_continue));
+  input_.clear();
+  if (data.size() <= input_buffer_capacity_) {
+    input_.append(data.data(), data.size());
+    return Status::OK();
+  }
+  return Compress(data, ZSTD_e_continue);
+}
+
+#if defined(PLATFORM_GOOGLE)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  absl::CordReader reader(cord);
+  absl::string_view fragment;
+  while (reader.ReadFragment(&fragment)) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return Status::OK();
+}
+#endif
+
+Status ZstdOutputBuffer::Compress(StringPiece input, int end_op) {
+  ZSTD_inBuffer in = {input.data(), input.size(), 0};
+  size_t remaining;
+  do {
+    if (output_size_ == output_buffer_capacity_) {
+      TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    }
+    ZSTD_outBuffer out = {output_.get(), output_buffer_capacity_,
+                          output_size_};
+    remaining = ZSTD_compressStream2(context_, &out, &in,
+                                     static_cast<ZSTD_EndDirective>(end_op));
+    output_size_ = out.pos;
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("ZSTD_compressStream2() failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    // With ZSTD_e_flush and ZSTD_e_end, `remaining` is the number of bytes
+    // that zstd still has to flush.
+  } while (in.pos < in.size || (end_op != ZSTD_e_continue && remaining != 0));
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::FlushOutputBufferToFile() {
+  if (output_size_ > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(StringPiece(output_.get(), output_size_)));
+    output_size_ = 0;
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Flush() {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Flush() called on an uninitialized or closed ZstdOutputBuffer");
+  }
+  TF_RETURN_IF_ERROR(Compress(input_, ZSTD_e_flush));
+  input_.clear();
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (context_ == nullptr) return Status::OK();
+  Status s = Compress(input_, ZSTD_e_end);
+  input_.clear();
+  if (s.ok()) s = FlushOutputBufferToFile();
+  ZSTD_freeCCtx(context_);
+  context_ = nullptr;
+  return s;
+}
+
+Status ZstdOutputBuffer::Tell(int64* position) {
+  return file_->Tell(position);
+}
+
+Status TrainZstdDictionary(const std::vector<string>& samples,
+                           size_t max_dictionary_bytes, string* dictionary) {
+  string samples_buffer;
+  std::vector<size_t> sample_sizes;
+  sample_sizes.reserve(samples.size());
+  for (const string& sample : samples) {
+    samples_buffer.append(sample);
+    sample_sizes.push_back(sample.size());
+  }
+  dictionary->resize(max_dictionary_bytes);
+  const size_t size = ZDICT_trainFromBuffer(
+      &(*dictionary)[0], max_dictionary_bytes, samples_buffer.data(),
+      sample_sizes.data(), sample_sizes.size());
+  if (ZDICT_isError(size)) {
+    dictionary->clear();
+    return errors::InvalidArgument("ZDICT_trainFromBuffer() failed: ",
+                                   ZDICT_getErrorName(size));
+  }
+  dictionary->resize(size);
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
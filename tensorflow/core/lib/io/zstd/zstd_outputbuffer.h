@@ -0,0 +1,135 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+// Forward declare the compression context of zstd.h, which is only included
+// in the .cc file.
+struct ZSTD_CCtx_s;
+
+namespace tensorflow {
+namespace io {
+
+// Provides support for writing compressed output to file using Zstandard
+// (https://facebook.github.io/zstd/).
+//
+// The output is a single zstd frame, which can be read by `ZstdInputStream` or
+// by any other zstd decoder.
+//
+// A given instance of a ZstdOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Create a ZstdOutputBuffer for `file` with two buffers that cache the
+  // 1. input data to be compressed
+  // 2. the compressed output
+  // with sizes `input_buffer_bytes` and `output_buffer_bytes` respectively.
+  // Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file, int32 input_buffer_bytes,
+                   int32 output_buffer_bytes,
+                   const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdOutputBuffer();
+
+  // Creates the compression context and applies the options. This call is
+  // required before any other operation on the buffer.
+  Status Init();
+
+  // Adds `data` to the compression pipeline.
+  //
+  // The input data is buffered and is compressed in bulk when the buffer gets
+  // full. The compressed output is buffered as well and gets written to file
+  // when its buffer is full.
+  //
+  // To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(PLATFORM_GOOGLE)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any cached input, ends the current zstd block so that all data
+  // appended so far can be decompressed, and writes all output to file.
+  Status Flush() override;
+
+  // Compresses any cached input, ends the zstd frame and writes all output to
+  // file. This must be called before the destructor to avoid any data loss.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  // Compresses `input` with the zstd end directive `end_op` until zstd has
+  // consumed all of it and, unless `end_op` is ZSTD_e_continue, has flushed
+  // all of its internal buffers to `output_`.
+  Status Compress(StringPiece input, int end_op);
+
+  // Appends the contents of `output_` to `file_`.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+  const size_t input_buffer_capacity_;
+  const size_t output_buffer_capacity_;
+  const ZstdCompressionOptions zstd_options_;
+
+  // Uncompressed data that has not been handed to zstd yet.
+  string input_;
+
+  // Compressed data that has not been written to `file_` yet.
+  std::unique_ptr<char[]> output_;
+  size_t output_size_ = 0;
+
+  // Null before `Init()` and after `Close()`.
+  ZSTD_CCtx_s* context_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+// Trains a dictionary of at most `max_dictionary_bytes` bytes on `samples`,
+// for use as `ZstdCompressionOptions::dictionary`. A few thousand samples of
+// the records that will be compressed, and a dictionary of about 100KB, are
+// a good start.
+Status TrainZstdDictionary(const std::vector<string>& samples,
+                           size_t max_dictionary_bytes, string* dictionary);
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
@@ -316,6 +316,22 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_CwiseOpsComposition")
+    .Input("x: T")
+    .Input("scalars: N * T")
+    .Output("y: T")
+    .Attr("T: {float, half, double}")
+    .Attr("N: int >= 0")
+    .Attr("op_names: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies a chain of unary ops, and of binary ops whose second operand is one of
+`scalars`, to `x`. Each binary op in `op_names` consumes the next scalar.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
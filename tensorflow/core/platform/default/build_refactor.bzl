@@ -70,6 +70,8 @@ TF_DEFAULT_PLATFORM_LIBRARIES = {
             "//tensorflow/core/platform:file_system_helper.cc",
             "//tensorflow/core/platform:threadpool.cc",
             "//tensorflow/core/platform:default/env.cc",
+            "//tensorflow/core/platform:default/posix_async_io.cc",
+            "//tensorflow/core/platform:default/posix_async_io.h",
             "//tensorflow/core/platform:default/posix_file_system.h",
             "//tensorflow/core/platform:default/posix_file_system.cc",
         ],
@@ -0,0 +1,434 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/default/posix_async_io.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <deque>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TF_POSIX_ASYNC_IO_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr int kDefaultQueueDepth = 256;
+constexpr int kDefaultNumThreads = 16;
+
+// `pread` that retries on EINTR and returns `-errno` on failure.
+ssize_t ReadSync(int fd, uint64 offset, size_t n, char* dst) {
+  ssize_t r;
+  do {
+    r = pread(fd, dst, n, static_cast<off_t>(offset));
+  } while (r < 0 && errno == EINTR);
+  return r < 0 ? -errno : r;
+}
+
+class ThreadReadQueue : public AsyncReadQueue {
+ public:
+  explicit ThreadReadQueue(int num_threads) {
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "tf_async_read", [this]() { WorkerLoop(); }));
+    }
+  }
+
+  ~ThreadReadQueue() override {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+    }
+    threads_.clear();
+  }
+
+  void Read(int fd, uint64 offset, size_t n, char* dst,
+            DoneCallback done) override {
+    mutex_lock l(mu_);
+    requests_.push_back({fd, offset, n, dst, std::move(done)});
+    cond_var_.notify_one();
+  }
+
+ private:
+  struct Request {
+    int fd;
+    uint64 offset;
+    size_t n;
+    char* dst;
+    DoneCallback done;
+  };
+
+  void WorkerLoop() {
+    while (true) {
+      Request request;
+      {
+        mutex_lock l(mu_);
+        while (!cancelled_ && requests_.empty()) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_) return;
+        request = std::move(requests_.front());
+        requests_.pop_front();
+      }
+      request.done(ReadSync(request.fd, request.offset, request.n,
+                            request.dst));
+    }
+  }
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+  std::deque<Request> requests_ GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
+#if defined(TF_POSIX_ASYNC_IO_HAS_IO_URING)
+
+// An io_uring instance used without liburing: the submission and completion
+// rings are mapped directly, and accessed with the same acquire/release
+// ordering that liburing uses.
+//
+// Submission is serialized by `mu_`. At most one thread is inside
+// `io_uring_enter` to submit at a time; reads queued meanwhile are submitted
+// by that thread in the same batch. A single reaper thread waits for
+// completions and runs the callbacks.
+class IoUringReadQueue : public AsyncReadQueue {
+ public:
+  static std::unique_ptr<AsyncReadQueue> Create(int queue_depth) {
+    std::unique_ptr<IoUringReadQueue> queue(new IoUringReadQueue());
+    if (!queue->Init(queue_depth)) return nullptr;
+    return std::move(queue);
+  }
+
+  ~IoUringReadQueue() override {
+    if (reaper_) {
+      // Wake up the reaper with a no-op that has no request attached, once
+      // the completion of an earlier read makes room for it.
+      {
+        mutex_lock l(mu_);
+        while (num_in_flight_ >= sq_entries_) {
+          room_cond_var_.wait(l);
+        }
+        PushLocked(nullptr);
+      }
+      Submit();
+      reaper_.reset();
+    }
+    if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ >= 0) close(ring_fd_);
+  }
+
+  void Read(int fd, uint64 offset, size_t n, char* dst,
+            DoneCallback done) override {
+    Request* request = new Request{fd, offset, {dst, n}, std::move(done)};
+    {
+      mutex_lock l(mu_);
+      if (num_in_flight_ == sq_entries_) {
+        // The reaper submits this read once an earlier one completes.
+        overflow_.push_back(request);
+        return;
+      }
+      PushLocked(request);
+    }
+    Submit();
+  }
+
+ private:
+  struct Request {
+    int fd;
+    uint64 offset;
+    struct iovec iov;
+    DoneCallback done;
+  };
+
+  IoUringReadQueue() {}
+
+  bool Init(int queue_depth) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = syscall(__NR_io_uring_setup, queue_depth, &params);
+    if (ring_fd_ < 0) {
+      VLOG(1) << "io_uring_setup failed: " << strerror(errno);
+      return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    void* sq_ring =
+        mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) return false;
+    sq_ring_ = sq_ring;
+
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    void* cq_ring =
+        mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) return false;
+    cq_ring_ = cq_ring;
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    reaper_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tf_io_uring_reaper", [this]() { ReapLoop(); }));
+    return true;
+  }
+
+  // Appends a read of `request`, or a no-op if `request` is nullptr, to the
+  // submission ring. Requires `num_in_flight_ < sq_entries_`, which bounds
+  // both the unconsumed submission entries and the pending completions, so
+  // neither ring can overflow.
+  void PushLocked(Request* request) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & sq_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    if (request != nullptr) {
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = request->fd;
+      sqe->off = request->offset;
+      sqe->addr = reinterpret_cast<uint64>(&request->iov);
+      sqe->len = 1;
+    } else {
+      sqe->opcode = IORING_OP_NOP;
+    }
+    sqe->user_data = reinterpret_cast<uint64>(request);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++num_in_flight_;
+    ++num_unsubmitted_;
+  }
+
+  // Submits every entry in the submission ring, unless another thread is
+  // already doing so, in which case that thread submits ours as well.
+  void Submit() {
+    unsigned to_submit;
+    {
+      mutex_lock l(mu_);
+      if (submitting_ || num_unsubmitted_ == 0) return;
+      submitting_ = true;
+      to_submit = num_unsubmitted_;
+    }
+    std::vector<Request*> withdrawn;
+    while (true) {
+      const int ret =
+          syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, nullptr, 0);
+      const int error = ret < 0 ? errno : 0;
+      mutex_lock l(mu_);
+      if (ret > 0) {
+        num_unsubmitted_ -= ret;
+      } else if (error != EINTR) {
+        LOG(ERROR) << "io_uring_enter failed: " << strerror(error)
+                   << ". Reading synchronously instead.";
+        WithdrawLocked(&withdrawn);
+        break;
+      }
+      if (num_unsubmitted_ == 0) {
+        submitting_ = false;
+        return;
+      }
+      to_submit = num_unsubmitted_;
+    }
+    // `mu_` is not held here, so that the callbacks can issue more reads.
+    ReadAllSync(withdrawn);
+  }
+
+  // Takes back the entries that the kernel has not consumed, and the overflow,
+  // into `requests`. Only the submitting thread may call this, as the kernel
+  // consumes entries only inside `io_uring_enter`.
+  void WithdrawLocked(std::vector<Request*>* requests)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    const unsigned tail = *sq_tail_;
+    for (unsigned i = head; i != tail; ++i) {
+      requests->push_back(reinterpret_cast<Request*>(
+          sqes_[sq_array_[i & sq_mask_]].user_data));
+    }
+    __atomic_store_n(sq_tail_, head, __ATOMIC_RELEASE);
+    num_in_flight_ -= tail - head;
+    num_unsubmitted_ = 0;
+    requests->insert(requests->end(), overflow_.begin(), overflow_.end());
+    overflow_.clear();
+    submitting_ = false;
+    room_cond_var_.notify_all();
+  }
+
+  // Reads `requests` synchronously, skipping the no-ops.
+  static void ReadAllSync(const std::vector<Request*>& requests) {
+    for (Request* request : requests) {
+      if (request == nullptr) continue;
+      request->done(ReadSync(request->fd, request->offset,
+                             request->iov.iov_len,
+                             static_cast<char*>(request->iov.iov_base)));
+      delete request;
+    }
+  }
+
+  void ReapLoop() {
+    std::vector<std::pair<Request*, int>> completed;
+    while (true) {
+      const int ret = syscall(__NR_io_uring_enter, ring_fd_, 0, 1,
+                              IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0 && errno != EINTR) {
+        LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+        Env::Default()->SleepForMicroseconds(1000);
+      }
+
+      bool cancelled = false;
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != tail; ++head) {
+        const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        Request* request = reinterpret_cast<Request*>(cqe.user_data);
+        if (request == nullptr) {
+          cancelled = true;
+        } else {
+          completed.emplace_back(request, cqe.res);
+        }
+      }
+      const unsigned num_reaped = head - *cq_head_;
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+      {
+        mutex_lock l(mu_);
+        num_in_flight_ -= num_reaped;
+        room_cond_var_.notify_all();
+        while (!overflow_.empty() && num_in_flight_ < sq_entries_) {
+          PushLocked(overflow_.front());
+          overflow_.pop_front();
+        }
+      }
+      Submit();
+
+      for (const auto& request_and_result : completed) {
+        Request* request = request_and_result.first;
+        request->done(request_and_result.second);
+        delete request;
+      }
+      completed.clear();
+      if (cancelled) return;
+    }
+  }
+
+  int ring_fd_ = -1;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  mutex mu_;
+  // Notified when `num_in_flight_` decreases.
+  condition_variable room_cond_var_;
+  // Entries pushed to the submission ring whose completion is not reaped yet.
+  unsigned num_in_flight_ GUARDED_BY(mu_) = 0;
+  // Entries pushed to the submission ring but not consumed by the kernel yet.
+  unsigned num_unsubmitted_ GUARDED_BY(mu_) = 0;
+  bool submitting_ GUARDED_BY(mu_) = false;
+  // Reads waiting for room in the rings.
+  std::deque<Request*> overflow_ GUARDED_BY(mu_);
+  std::unique_ptr<Thread> reaper_;
+};
+
+#endif  // TF_POSIX_ASYNC_IO_HAS_IO_URING
+
+}  // namespace
+
+AsyncReadQueue* AsyncReadQueue::Global() {
+  static AsyncReadQueue* queue = []() -> AsyncReadQueue* {
+    const char* mode = getenv("TF_POSIX_ASYNC_IO");
+    if (mode == nullptr || strcmp(mode, "") == 0 || strcmp(mode, "0") == 0) {
+      return nullptr;
+    }
+    if (strcmp(mode, "threads") != 0) {
+      if (strcmp(mode, "1") != 0 && strcmp(mode, "io_uring") != 0) {
+        LOG(WARNING) << "Unrecognized value TF_POSIX_ASYNC_IO=" << mode
+                     << "; using io_uring.";
+      }
+      std::unique_ptr<AsyncReadQueue> io_uring_queue =
+          NewIoUringQueue(kDefaultQueueDepth);
+      if (io_uring_queue) return io_uring_queue.release();
+      LOG(WARNING) << "io_uring is not available; using threads for "
+                   << "asynchronous reads instead.";
+    }
+    return NewThreadQueue(kDefaultNumThreads).release();
+  }();
+  return queue;
+}
+
+std::unique_ptr<AsyncReadQueue> AsyncReadQueue::NewIoUringQueue(
+    int queue_depth) {
+#if defined(TF_POSIX_ASYNC_IO_HAS_IO_URING)
+  return IoUringReadQueue::Create(queue_depth);
+#else
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<AsyncReadQueue> AsyncReadQueue::NewThreadQueue(
+    int num_threads) {
+  return std::unique_ptr<AsyncReadQueue>(new ThreadReadQueue(num_threads));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_ASYNC_IO_H_
+#define TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_ASYNC_IO_H_
+
+#include <sys/types.h>
+
+#include <functional>
+#include <memory>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An `AsyncReadQueue` performs `pread`-style reads on file descriptors without
+// blocking the threads that issue them.
+//
+// Reads issued concurrently from many threads share one submission queue. The
+// io_uring implementation submits all reads that were queued while another
+// thread was inside `io_uring_enter` with a single system call, and reaps
+// their completions on a single thread, so many outstanding reads cost one
+// thread instead of one blocked thread each.
+class AsyncReadQueue {
+ public:
+  // Called with the number of bytes read (0 at end of file) or, on failure,
+  // with `-errno`. Like `pread`, a read may return fewer bytes than requested.
+  using DoneCallback = std::function<void(ssize_t)>;
+
+  virtual ~AsyncReadQueue() {}
+
+  // Returns the process-wide queue used by `PosixRandomAccessFile::ReadAsync`,
+  // or nullptr if asynchronous reads are disabled.
+  //
+  // Asynchronous reads are opt-in, and are selected by the `TF_POSIX_ASYNC_IO`
+  // environment variable:
+  //   * unset or "0": disabled; `ReadAsync` reads synchronously.
+  //   * "1" or "io_uring": io_uring, falling back to threads if the kernel
+  //     does not support it.
+  //   * "threads": a pool of threads that call `pread`.
+  static AsyncReadQueue* Global();
+
+  // Returns a queue backed by io_uring with room for `queue_depth` reads in
+  // flight, or nullptr if io_uring is not supported by this build or kernel.
+  static std::unique_ptr<AsyncReadQueue> NewIoUringQueue(int queue_depth);
+
+  // Returns a queue backed by `num_threads` threads that call `pread`.
+  static std::unique_ptr<AsyncReadQueue> NewThreadQueue(int num_threads);
+
+  // Reads up to `n` bytes at `offset` from `fd` into `dst`, and calls `done`
+  // with the result. `fd` and `dst` must stay valid until `done` is called,
+  // and the queue must not be destroyed while reads are outstanding. `done`
+  // must not block.
+  virtual void Read(int fd, uint64 offset, size_t n, char* dst,
+                    DoneCallback done) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_ASYNC_IO_H_
@@ -28,7 +28,10 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/default/posix_async_io.h"
 #include "tensorflow/core/platform/default/posix_file_system.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
@@ -88,6 +91,61 @@ class PosixRandomAccessFile : public RandomAccessFile {
     *result = StringPiece(scratch, dst - scratch);
     return s;
   }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+    AsyncReadQueue* queue = AsyncReadQueue::Global();
+    if (queue == nullptr || n == 0) {
+      RandomAccessFile::ReadAsync(offset, n, scratch, std::move(done));
+      return;
+    }
+    IssueAsyncRead(queue,
+                   new AsyncRead{offset, n, scratch, scratch, std::move(done)});
+  }
+
+  bool SupportsAsyncRead() const override {
+    return AsyncReadQueue::Global() != nullptr;
+  }
+
+ private:
+  // The progress of a `ReadAsync` call, which may take several reads.
+  struct AsyncRead {
+    uint64 offset;
+    size_t n;
+    char* scratch;
+    char* dst;
+    ReadDoneCallback done;
+  };
+
+  // Issues the next read of `read`, following the same retry rules as the
+  // loop in `Read`.
+  void IssueAsyncRead(AsyncReadQueue* queue, AsyncRead* read) const {
+    const size_t requested_read_length = std::min<size_t>(read->n, INT32_MAX);
+    queue->Read(fd_, read->offset, requested_read_length, read->dst,
+                [this, queue, read](ssize_t r) {
+                  Status s;
+                  if (r > 0) {
+                    read->dst += r;
+                    read->n -= r;
+                    read->offset += r;
+                    if (read->n > 0) {
+                      IssueAsyncRead(queue, read);
+                      return;
+                    }
+                  } else if (r == 0) {
+                    s = Status(error::OUT_OF_RANGE,
+                               "Read less bytes than requested");
+                  } else if (r == -EINTR || r == -EAGAIN) {
+                    IssueAsyncRead(queue, read);
+                    return;
+                  } else {
+                    s = IOError(filename_, -r);
+                  }
+                  read->done(s, StringPiece(read->scratch,
+                                            read->dst - read->scratch));
+                  delete read;
+                });
+  }
 };
 
 class PosixWritableFile : public WritableFile {
@@ -265,6 +265,34 @@ class RandomAccessFile {
   virtual tensorflow::Status Read(uint64 offset, size_t n, StringPiece* result,
                                   char* scratch) const = 0;
 
+  /// \brief Called when a `ReadAsync` completes, with the status and
+  /// `*result` that the equivalent `Read` call would have produced.
+  typedef std::function<void(const Status&, StringPiece)> ReadDoneCallback;
+
+  /// \brief Reads up to `n` bytes from the file starting at `offset` without
+  /// blocking the caller, and calls `done` when the read completes.
+  ///
+  /// `scratch[0..n-1]` and the file itself must stay live until `done` has
+  /// been called. `done` may be called from any thread, including from the
+  /// calling thread before `ReadAsync` returns.
+  ///
+  /// The default implementation calls `Read` synchronously.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadDoneCallback done) const {
+    StringPiece result;
+    Status s = Read(offset, n, &result, scratch);
+    done(s, result);
+  }
+
+  /// \brief Returns true if `ReadAsync` returns without waiting for the read.
+  ///
+  /// Callers that would read ahead with `ReadAsync` should check this first:
+  /// with the default, synchronous `ReadAsync` a read-ahead only adds a
+  /// blocking read and a copy.
+  virtual bool SupportsAsyncRead() const { return false; }
+
   // TODO(ebrevdo): Remove this ifdef when absl is updated.
 #if defined(PLATFORM_GOOGLE)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
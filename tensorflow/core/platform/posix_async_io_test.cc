@@ -0,0 +1,248 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/default/posix_async_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kIoUring = 0;
+constexpr int kThreads = 1;
+
+std::unique_ptr<AsyncReadQueue> NewQueue(int backend, int queue_depth) {
+  if (backend == kIoUring) {
+    return AsyncReadQueue::NewIoUringQueue(queue_depth);
+  }
+  return AsyncReadQueue::NewThreadQueue(/*num_threads=*/4);
+}
+
+string FileContents(size_t size) {
+  string contents(size, 0);
+  for (size_t i = 0; i < size; ++i) {
+    contents[i] = static_cast<char>(i * 7 + i / 251);
+  }
+  return contents;
+}
+
+// Writes `contents` to a temporary file and returns a descriptor for it.
+int OpenTestFile(const string& name, const string& contents) {
+  const string fname = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), fname, contents));
+  const int fd = open(fname.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0);
+  return fd;
+}
+
+class AsyncReadQueueTest : public ::testing::TestWithParam<int> {};
+
+TEST_P(AsyncReadQueueTest, ConcurrentReads) {
+  // A small queue depth exercises the reads that wait for room in the rings.
+  std::unique_ptr<AsyncReadQueue> queue = NewQueue(GetParam(), 8);
+  if (queue == nullptr) {
+    LOG(INFO) << "io_uring is not supported; skipping test.";
+    return;
+  }
+  const string contents = FileContents(1 << 20);
+  const int fd = OpenTestFile("async_read_concurrent", contents);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumReads = 1000;
+  constexpr size_t kReadSize = 4096;
+  std::vector<string> buffers(kNumReads, string(kReadSize, 0));
+  std::vector<ssize_t> results(kNumReads, -1);
+  BlockingCounter counter(kNumReads);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back(Env::Default()->StartThread(
+        ThreadOptions(), "reader", [&, t]() {
+          for (int i = t; i < kNumReads; i += kNumThreads) {
+            const uint64 offset = (i * 1237) % (contents.size() - kReadSize);
+            queue->Read(fd, offset, kReadSize, &buffers[i][0],
+                        [&, i](ssize_t r) {
+                          results[i] = r;
+                          counter.DecrementCount();
+                        });
+          }
+        }));
+  }
+  threads.clear();
+  counter.Wait();
+
+  for (int i = 0; i < kNumReads; ++i) {
+    const uint64 offset = (i * 1237) % (contents.size() - kReadSize);
+    ASSERT_GT(results[i], 0);
+    EXPECT_EQ(buffers[i].substr(0, results[i]),
+              contents.substr(offset, results[i]));
+  }
+  close(fd);
+}
+
+TEST_P(AsyncReadQueueTest, EndOfFileAndErrors) {
+  std::unique_ptr<AsyncReadQueue> queue = NewQueue(GetParam(), 8);
+  if (queue == nullptr) {
+    LOG(INFO) << "io_uring is not supported; skipping test.";
+    return;
+  }
+  const int fd = OpenTestFile("async_read_eof", "0123456789");
+
+  auto read = [&queue](int fd, uint64 offset, size_t n, string* result) {
+    string buffer(n, 0);
+    ssize_t r = 0;
+    BlockingCounter counter(1);
+    queue->Read(fd, offset, n, &buffer[0], [&](ssize_t result) {
+      r = result;
+      counter.DecrementCount();
+    });
+    counter.Wait();
+    if (r > 0) *result = buffer.substr(0, r);
+    return r;
+  };
+
+  string result;
+  EXPECT_EQ(4, read(fd, 6, 10, &result));
+  EXPECT_EQ("6789", result);
+  EXPECT_EQ(0, read(fd, 10, 10, &result));
+  EXPECT_EQ(-EBADF, read(-1, 0, 10, &result));
+  close(fd);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, AsyncReadQueueTest,
+                         ::testing::Values(kIoUring, kThreads));
+
+TEST(PosixRandomAccessFileTest, ReadAsync) {
+  Env* env = Env::Default();
+  const string fname = io::JoinPath(testing::TmpDir(), "read_async");
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  char scratch[10];
+  Status status;
+  StringPiece data;
+  BlockingCounter counter(1);
+  file->ReadAsync(2, 10, scratch, [&](const Status& s, StringPiece result) {
+    status = s;
+    data = result;
+    counter.DecrementCount();
+  });
+  counter.Wait();
+  EXPECT_TRUE(errors::IsOutOfRange(status));
+  EXPECT_EQ("23456789", data);
+}
+
+// Benchmarks reading `kNumReads` random blocks of `read_size` bytes.
+//
+// The baseline issues blocking `pread`s through `RandomAccessFile::Read` from
+// `kNumReaderThreads` threads, which is how parallel tf.data readers use the
+// filesystem today. The asynchronous queues issue all reads from one thread.
+constexpr int kNumReads = 1024;
+constexpr int kNumReaderThreads = 16;
+constexpr size_t kBenchmarkFileSize = 64 << 20;
+
+const string& BenchmarkFile() {
+  static const string* fname = []() {
+    string* fname =
+        new string(io::JoinPath(testing::TmpDir(), "async_read_benchmark"));
+    TF_CHECK_OK(WriteStringToFile(Env::Default(), *fname,
+                                  FileContents(kBenchmarkFileSize)));
+    return fname;
+  }();
+  return *fname;
+}
+
+uint64 BenchmarkOffset(int i, int read_size) {
+  return (static_cast<uint64>(i) * 7919 * 4096) %
+         (kBenchmarkFileSize - read_size);
+}
+
+void BM_BlockingPRead(int iters, int read_size) {
+  testing::StopTiming();
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(BenchmarkFile(), &file));
+  std::vector<string> buffers(kNumReaderThreads, string(read_size, 0));
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumReads * read_size);
+  testing::StartTiming();
+  for (int iter = 0; iter < iters; ++iter) {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int t = 0; t < kNumReaderThreads; ++t) {
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "reader", [&, t]() {
+            StringPiece data;
+            for (int i = t; i < kNumReads; i += kNumReaderThreads) {
+              TF_CHECK_OK(file->Read(BenchmarkOffset(i, read_size), read_size,
+                                     &data, &buffers[t][0]));
+            }
+          }));
+    }
+  }
+}
+BENCHMARK(BM_BlockingPRead)->Arg(4 << 10)->Arg(64 << 10);
+
+void BenchmarkAsyncReads(int iters, int read_size, AsyncReadQueue* queue) {
+  if (queue == nullptr) return;
+  const int fd = open(BenchmarkFile().c_str(), O_RDONLY);
+  CHECK_GE(fd, 0);
+  std::vector<string> buffers(kNumReads, string(read_size, 0));
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumReads * read_size);
+  testing::StartTiming();
+  for (int iter = 0; iter < iters; ++iter) {
+    BlockingCounter counter(kNumReads);
+    for (int i = 0; i < kNumReads; ++i) {
+      queue->Read(fd, BenchmarkOffset(i, read_size), read_size,
+                  &buffers[i][0], [&counter, read_size](ssize_t r) {
+                    CHECK_EQ(r, read_size);
+                    counter.DecrementCount();
+                  });
+    }
+    counter.Wait();
+  }
+  testing::StopTiming();
+  close(fd);
+}
+
+void BM_IoUringRead(int iters, int read_size) {
+  testing::StopTiming();
+  std::unique_ptr<AsyncReadQueue> queue =
+      AsyncReadQueue::NewIoUringQueue(/*queue_depth=*/256);
+  BenchmarkAsyncReads(iters, read_size, queue.get());
+}
+BENCHMARK(BM_IoUringRead)->Arg(4 << 10)->Arg(64 << 10);
+
+void BM_ThreadQueueRead(int iters, int read_size) {
+  testing::StopTiming();
+  std::unique_ptr<AsyncReadQueue> queue =
+      AsyncReadQueue::NewThreadQueue(kNumReaderThreads);
+  BenchmarkAsyncReads(iters, read_size, queue.get());
+}
+BENCHMARK(BM_ThreadQueueRead)->Arg(4 << 10)->Arg(64 << 10);
+
+}  // namespace
+}  // namespace tensorflow
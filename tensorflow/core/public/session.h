@@ -259,6 +259,26 @@ class Session {
         "RunCallable with threadpool is not supported for this session.");
   }
 
+  /// \brief Invokes the subgraph named by `handle` with the given input
+  /// tensors, and writes its outputs into caller-owned tensors.
+  ///
+  /// Unlike `RunCallable()`, the tensors of `*feed_tensors` are moved into the
+  /// step, so that the graph may use or forward their buffers. Their values
+  /// are unspecified after the call. Each tensor of `*fetch_tensors` must be
+  /// initialized by the caller with the type of the corresponding fetch and
+  /// the shape of its value; fetches on host memory of types that can be
+  /// copied with memcpy are supported. The op that produces a fetch writes its
+  /// output directly into the buffer of that tensor when it can, and the
+  /// output is copied into it otherwise.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallableWithBuffers(
+      CallableHandle handle, std::vector<Tensor>* feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) {
+    return errors::Unimplemented(
+        "RunCallableWithBuffers is not supported for this session.");
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
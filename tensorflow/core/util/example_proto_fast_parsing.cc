@@ -546,7 +546,7 @@ void LogSparseFeatureDataLoss(StringPiece feature_name) {
 }
 
 Status FastParseSerializedExample(
-    const string& serialized_example, const string& example_name,
+    absl::string_view serialized_example, absl::string_view example_name,
     const size_t example_index, const Config& config,
     const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
     SeededHasher hasher, std::vector<Tensor>* output_dense,
@@ -1086,12 +1086,14 @@ void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
   }
 }
 
-}  // namespace
-
-Status FastParseExample(const Config& config,
-                        gtl::ArraySlice<tstring> serialized,
-                        gtl::ArraySlice<tstring> example_names,
-                        thread::ThreadPool* thread_pool, Result* result) {
+// `StringType` is either `tstring` or `absl::string_view`; the latter lets
+// callers parse examples that do not live in a single contiguous array
+// without copying them.
+template <typename StringType>
+Status FastParseExampleImpl(const Config& config,
+                            gtl::ArraySlice<StringType> serialized,
+                            gtl::ArraySlice<StringType> example_names,
+                            thread::ThreadPool* thread_pool, Result* result) {
   DCHECK(result != nullptr);
   // Check config so we can safely CHECK(false) in switches on config.*.dtype
   TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
@@ -1199,7 +1201,9 @@ Status FastParseExample(const Config& config,
       }
       status_of_minibatch[minibatch] = FastParseSerializedExample(
           serialized[e],
-          (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
+          (!example_names.empty() ? absl::string_view(example_names[e])
+                                  : absl::string_view("<unknown>")),
+          e, config,
           config_index, hasher, &fixed_dense_values,
           &varlen_dense_buffers[minibatch], &sparse_buffers[minibatch],
           &ragged_buffers[minibatch], stats);
@@ -1392,6 +1396,24 @@ Status FastParseExample(const Config& config,
   return Status::OK();
 }
 
+}  // namespace
+
+Status FastParseExample(const Config& config,
+                        gtl::ArraySlice<tstring> serialized,
+                        gtl::ArraySlice<tstring> example_names,
+                        thread::ThreadPool* thread_pool, Result* result) {
+  return FastParseExampleImpl(config, serialized, example_names, thread_pool,
+                              result);
+}
+
+Status FastParseExample(const Config& config,
+                        gtl::ArraySlice<absl::string_view> serialized,
+                        gtl::ArraySlice<absl::string_view> example_names,
+                        thread::ThreadPool* thread_pool, Result* result) {
+  return FastParseExampleImpl(config, serialized, example_names, thread_pool,
+                              result);
+}
+
 Status FastParseSingleExample(const Config& config,
                               absl::string_view serialized, Result* result) {
   DCHECK(result != nullptr);
@@ -113,6 +113,14 @@ Status FastParseExample(const FastParseExampleConfig& config,
                         gtl::ArraySlice<tstring> example_names,
                         thread::ThreadPool* thread_pool, Result* result);
 
+// As above, but takes views of the serialized protos so that callers whose
+// inputs are not stored in a single string tensor (e.g. a batch of scalar
+// dataset elements) can parse them without copying.
+Status FastParseExample(const FastParseExampleConfig& config,
+                        gtl::ArraySlice<absl::string_view> serialized,
+                        gtl::ArraySlice<absl::string_view> example_names,
+                        thread::ThreadPool* thread_pool, Result* result);
+
 // TODO(mrry): Move the hash table construction into the config object.
 typedef FastParseExampleConfig FastParseSingleExampleConfig;
 
@@ -321,6 +321,34 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, StringViewsMatchTensorStrings) {
+  const size_t kNumExamples = 13;
+  std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
+  std::vector<absl::string_view> views(serialized.begin(), serialized.end());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("bytes_list", DT_STRING, {2}, false, 2, &config);
+  AddDenseFeature("float_list", DT_FLOAT, {-1}, true, 1, &config);
+  AddSparseFeature("int64_list", DT_INT64, &config);
+
+  Result expected;
+  TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &expected));
+  Result actual;
+  TF_CHECK_OK(FastParseExample(config, views, {}, nullptr, &actual));
+  ASSERT_EQ(expected.dense_values.size(), actual.dense_values.size());
+  for (size_t i = 0; i < expected.dense_values.size(); ++i) {
+    EXPECT_EQ(expected.dense_values[i].DebugString(kNumExamples * 3),
+              actual.dense_values[i].DebugString(kNumExamples * 3));
+  }
+  ASSERT_EQ(expected.sparse_values.size(), actual.sparse_values.size());
+  for (size_t i = 0; i < expected.sparse_values.size(); ++i) {
+    EXPECT_EQ(expected.sparse_indices[i].DebugString(kNumExamples * 6),
+              actual.sparse_indices[i].DebugString(kNumExamples * 6));
+    EXPECT_EQ(expected.sparse_values[i].DebugString(kNumExamples * 3),
+              actual.sparse_values[i].DebugString(kNumExamples * 3));
+  }
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -32,8 +33,10 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -724,13 +727,23 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+BundleReader::BundleReader(Env* env, StringPiece prefix, const Options& options)
     : env_(env),
+      options_(options),
       prefix_(prefix),
       metadata_(nullptr),
       table_(nullptr),
       iter_(nullptr),
       need_to_swap_bytes_(false) {
+  if (options_.parallel_read_threshold_bytes < 0 ||
+      options_.read_section_bytes <= 0 || options_.num_read_threads < 1) {
+    status_ = errors::InvalidArgument(
+        "Invalid BundleReader options: parallel_read_threshold_bytes = ",
+        options_.parallel_read_threshold_bytes,
+        ", read_section_bytes = ", options_.read_section_bytes,
+        ", num_read_threads = ", options_.num_read_threads);
+    return;
+  }
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -809,6 +822,63 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+Status BundleReader::ReadInSections(RandomAccessFile* file, uint64 offset,
+                                    size_t size, char* dest,
+                                    uint32* actual_crc32c) {
+  const size_t section_bytes = options_.read_section_bytes;
+  const int num_sections = (size + section_bytes - 1) / section_bytes;
+  const int num_workers = std::min(num_sections, options_.num_read_threads);
+  thread::ThreadPool* pool = options_.read_pool;
+  if (pool == nullptr) {
+    if (read_pool_ == nullptr) {
+      read_pool_.reset(new thread::ThreadPool(env_, "bundle_reader",
+                                              options_.num_read_threads));
+    }
+    pool = read_pool_.get();
+  }
+
+  // Workers claim sections in file order, so the reads stay close to
+  // sequential, and each section is announced as soon as it lands in "dest".
+  std::atomic<int> next_section(0);
+  std::vector<Status> statuses(num_sections);
+  std::unique_ptr<Notification[]> section_read(new Notification[num_sections]);
+  BlockingCounter workers_done(num_workers);
+  for (int w = 0; w < num_workers; ++w) {
+    pool->Schedule([&]() {
+      for (int i = next_section++; i < num_sections; i = next_section++) {
+        const size_t begin = i * section_bytes;
+        const size_t len = std::min(section_bytes, size - begin);
+        StringPiece sp;
+        statuses[i] = file->Read(offset + begin, len, &sp, dest + begin);
+        if (statuses[i].ok() && sp.data() != dest + begin) {
+          memmove(dest + begin, sp.data(), len);
+        }
+        section_read[i].Notify();
+      }
+      workers_done.DecrementCount();
+    });
+  }
+
+  // Checksums each section on this thread while the later ones are read.
+  Status status;
+  uint32 crc = 0;
+  for (int i = 0; i < num_sections; ++i) {
+    section_read[i].WaitForNotification();
+    if (!statuses[i].ok()) {
+      status = statuses[i];
+      // Stops the workers from claiming any further sections.
+      next_section = num_sections;
+      break;
+    }
+    const size_t begin = i * section_bytes;
+    crc = crc32c::Extend(crc, dest + begin,
+                         std::min(section_bytes, size - begin));
+  }
+  workers_done.Wait();
+  *actual_crc32c = crc;
+  return status;
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -856,7 +926,16 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
-    if (entry.size() > kBufferSize) {
+    const bool read_in_sections =
+        options_.num_read_threads > 1 &&
+        entry.size() >= options_.parallel_read_threshold_bytes &&
+        entry.size() > options_.read_section_bytes;
+    if (read_in_sections) {
+      // Also computes the checksum, overlapped with the reads.
+      TF_RETURN_IF_ERROR(ReadInSections(buffered_file->file(), entry.offset(),
+                                        entry.size(), backing_buffer,
+                                        &actual_crc32c));
+    } else if (entry.size() > kBufferSize) {
       StringPiece sp;
       TF_RETURN_IF_ERROR(buffered_file->file()->Read(
           entry.offset(), entry.size(), &sp, backing_buffer));
@@ -869,7 +948,9 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
     // Note that we compute the checksum *before* byte-swapping. The checksum
     // should be on the bytes in the order they appear in the file.
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    if (!read_in_sections) {
+      actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    }
     if (need_to_swap_bytes_) {
       TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
     }
@@ -1085,6 +1166,15 @@ Status BundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
   return Status::OK();
 }
 
+Status BundleReader::LookupDataLocation(StringPiece key, int32* shard_id,
+                                        int64* offset) {
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  *shard_id = entry.shard_id();
+  *offset = entry.offset();
+  return Status::OK();
+}
+
 Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   DataType ignored;
   return LookupDtypeAndShape(key, &ignored, shape);
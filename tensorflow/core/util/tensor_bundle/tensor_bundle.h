@@ -64,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -71,6 +72,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/table.h"
@@ -181,7 +183,25 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // Memcpy-able tensors of at least this many bytes are read in sections of
+    // "read_section_bytes" bytes from a pool of "num_read_threads" threads.
+    // The checksum of each section is computed while later sections are still
+    // being read.  Setting "num_read_threads" to 1 disables parallel reads.
+    // "read_section_bytes" must be positive and "num_read_threads" at least 1,
+    // or the reader's status() is InvalidArgument.
+    int64 parallel_read_threshold_bytes{64 << 20};
+    int64 read_section_bytes{16 << 20};
+    int num_read_threads{8};
+    // If set, the sections are read from this pool, which may be shared by
+    // several readers and must outlive them, instead of from a pool of
+    // "num_read_threads" threads owned by the reader.  "num_read_threads"
+    // still bounds the sections of one tensor that are read at a time.
+    thread::ThreadPool* read_pool = nullptr;
+  };
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -204,6 +224,13 @@ class BundleReader {
   Status LookupTensorShape(StringPiece key,
                            TensorShape* shape) TF_MUST_USE_RESULT;
 
+  // Looks up the data file shard holding the tensor keyed by "key", and the
+  // offset of the tensor's bytes within that shard.  Partitioned tensors store
+  // no bytes of their own and are reported at offset 0 of shard 0.
+  // REQUIRES: status().ok()
+  Status LookupDataLocation(StringPiece key, int32* shard_id,
+                            int64* offset) TF_MUST_USE_RESULT;
+
   // Looks up the tensor keyed by "key".  If "key" refers to a partitioned
   // tensor, attempts to look up the full contents using all stored slices.
   //
@@ -282,7 +309,14 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Reads "size" bytes at "offset" of "file" into "dest" in sections, issuing
+  // the reads from "options_.read_pool" or else "read_pool_", and checksums
+  // them into "actual_crc32c".
+  Status ReadInSections(RandomAccessFile* file, uint64 offset, size_t size,
+                        char* dest, uint32* actual_crc32c) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
+  const Options options_;
   const string prefix_;
 
   Status status_;
@@ -292,6 +326,10 @@ class BundleReader {
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
 
+  // Issues the sectioned reads of large tensors unless "options_.read_pool" is
+  // set.  Created on first use.
+  std::unique_ptr<thread::ThreadPool> read_pool_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
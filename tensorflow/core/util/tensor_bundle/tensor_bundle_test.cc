@@ -973,6 +973,83 @@ TEST(TensorBundleTest, Checksum) {
   }
 }
 
+TEST(TensorBundleTest, SectionedReads) {
+  // Reads every tensor of at least 1KB in sections of 100 bytes.
+  BundleReader::Options options;
+  options.parallel_read_threshold_bytes = 1024;
+  options.read_section_bytes = 100;
+  options.num_read_threads = 4;
+
+  const Tensor small = Constant(1.5f, TensorShape({2, 3}));
+  Tensor large(DT_FLOAT, TensorShape({1000}));
+  test::FillFn<float>(&large, [](int i) { return i * 0.5f; });
+  {
+    BundleWriter writer(Env::Default(), Prefix("sectioned"));
+    TF_EXPECT_OK(writer.Add("large", large));
+    TF_EXPECT_OK(writer.Add("small", small));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("sectioned"), options);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "large", large);
+    Expect<float>(&reader, "small", small);
+    int32 shard_id;
+    int64 offset;
+    TF_EXPECT_OK(reader.LookupDataLocation("large", &shard_id, &offset));
+    EXPECT_EQ(0, shard_id);
+    EXPECT_EQ(0, offset);
+    TF_EXPECT_OK(reader.LookupDataLocation("small", &shard_id, &offset));
+    EXPECT_EQ(0, shard_id);
+    EXPECT_EQ(4000, offset);
+  }
+
+  // Corrupts a byte in the last section.
+  const string datafile = DataFilename(Prefix("sectioned"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), datafile, &data));
+  data[3950] = ~data[3950];
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile, data));
+  {
+    BundleReader reader(Env::Default(), Prefix("sectioned"), options);
+    TF_ASSERT_OK(reader.status());
+    Tensor val(DT_FLOAT, TensorShape({1000}));
+    Status status = reader.Lookup("large", &val);
+    EXPECT_TRUE(errors::IsDataLoss(status));
+    EXPECT_TRUE(
+        absl::StrContains(status.ToString(), "Checksum does not match"));
+  }
+
+  // Truncates the data file within the large tensor.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile,
+                                 StringPiece(data.data(), 2050)));
+  {
+    BundleReader reader(Env::Default(), Prefix("sectioned"), options);
+    TF_ASSERT_OK(reader.status());
+    Tensor val(DT_FLOAT, TensorShape({1000}));
+    EXPECT_TRUE(errors::IsOutOfRange(reader.Lookup("large", &val)));
+  }
+}
+
+TEST(TensorBundleTest, InvalidReaderOptions) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("options"));
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3(1.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options zero_section_bytes;
+  zero_section_bytes.read_section_bytes = 0;
+  BundleReader::Options zero_threads;
+  zero_threads.num_read_threads = 0;
+  BundleReader::Options negative_threshold;
+  negative_threshold.parallel_read_threshold_bytes = -1;
+  for (const BundleReader::Options& options :
+       {zero_section_bytes, zero_threads, negative_threshold}) {
+    BundleReader reader(Env::Default(), Prefix("options"), options);
+    EXPECT_TRUE(errors::IsInvalidArgument(reader.status()));
+  }
+}
+
 TEST(TensorBundleTest, TruncatedTensorContents) {
   Env* env = Env::Default();
   BundleWriter writer(env, Prefix("end"));
@@ -1147,4 +1224,32 @@ BM_BundleAlignment(4096, 512);
 BM_BundleAlignment(4096, 4096);
 BM_BundleAlignment(4096, 1048576);
 
+// Restores a float tensor of "tensor_bytes" bytes, reading tensors of at least
+// 64MB in 16MB sections from "num_read_threads" threads.
+static void BM_BundleLookupBandwidth(int iters, int tensor_bytes,
+                                     int num_read_threads) {
+  testing::StopTiming();
+  const int num_elements = tensor_bytes / sizeof(float);
+  {
+    BundleWriter writer(Env::Default(), Prefix("bandwidth"));
+    TF_CHECK_OK(writer.Add("big", Constant(1.5f, TensorShape({num_elements}))));
+    TF_CHECK_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.num_read_threads = num_read_threads;
+  BundleReader reader(Env::Default(), Prefix("bandwidth"), options);
+  TF_CHECK_OK(reader.status());
+  Tensor t(DT_FLOAT, TensorShape({num_elements}));
+  testing::BytesProcessed(static_cast<int64>(iters) * t.TotalBytes());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(reader.Lookup("big", &t));
+  }
+  testing::StopTiming();
+}
+BENCHMARK(BM_BundleLookupBandwidth)
+    ->ArgPair(256 << 20, 1)
+    ->ArgPair(256 << 20, 4)
+    ->ArgPair(256 << 20, 8);
+
 }  // namespace tensorflow
@@ -57,6 +57,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@get_next_as_optional
 @@get_single_element
 @@get_structure
+@@global_shuffle
 @@group_by_reducer
 @@group_by_window
 @@ignore_errors
@@ -66,7 +67,9 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@make_saveable_from_iterator
 @@map_and_batch
 @@map_and_batch_with_legacy_function
+@@multi_process
 @@parallel_interleave
+@@parse_example_batch
 @@parse_example_dataset
 @@prefetch_to_device
 @@rejection_resample
@@ -111,8 +114,10 @@ from tensorflow.python.data.experimental.ops.interleave_ops import parallel_inte
 from tensorflow.python.data.experimental.ops.interleave_ops import sample_from_datasets
 from tensorflow.python.data.experimental.ops.iterator_ops import CheckpointInputPipelineHook
 from tensorflow.python.data.experimental.ops.iterator_ops import make_saveable_from_iterator
+from tensorflow.python.data.experimental.ops.multi_process import multi_process
 from tensorflow.python.data.experimental.ops.optimization_options import MapVectorizationOptions
 from tensorflow.python.data.experimental.ops.optimization_options import OptimizationOptions
+from tensorflow.python.data.experimental.ops.parsing_ops import parse_example_batch
 from tensorflow.python.data.experimental.ops.parsing_ops import parse_example_dataset
 from tensorflow.python.data.experimental.ops.prefetching_ops import copy_to_device
 from tensorflow.python.data.experimental.ops.prefetching_ops import prefetch_to_device
@@ -123,6 +128,7 @@ from tensorflow.python.data.experimental.ops.readers import make_csv_dataset
 from tensorflow.python.data.experimental.ops.readers import SqlDataset
 from tensorflow.python.data.experimental.ops.resampling import rejection_resample
 from tensorflow.python.data.experimental.ops.scan_ops import scan
+from tensorflow.python.data.experimental.ops.shuffle_ops import global_shuffle
 from tensorflow.python.data.experimental.ops.shuffle_ops import shuffle_and_repeat
 from tensorflow.python.data.experimental.ops.stats_aggregator import StatsAggregator
 from tensorflow.python.data.experimental.ops.stats_ops import bytes_produced_stats
@@ -0,0 +1,126 @@
+# Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Benchmarks for `tf.data.experimental.parse_example_batch()`."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import time
+
+import numpy as np
+
+from tensorflow.core.example import example_pb2
+from tensorflow.core.example import feature_pb2
+from tensorflow.python.client import session
+from tensorflow.python.data.experimental.ops import parsing_ops as experimental_parsing_ops
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import parsing_ops
+from tensorflow.python.platform import test
+
+_NUM_DENSE_FEATURES = 20
+_DENSE_FEATURE_SIZE = 16
+_NUM_SPARSE_FEATURES = 5
+
+
+def _make_serialized_example():
+  feature = {}
+  for i in range(_NUM_DENSE_FEATURES):
+    feature["dense_%d" % i] = feature_pb2.Feature(
+        float_list=feature_pb2.FloatList(
+            value=np.random.rand(_DENSE_FEATURE_SIZE)))
+  for i in range(_NUM_SPARSE_FEATURES):
+    feature["sparse_%d" % i] = feature_pb2.Feature(
+        int64_list=feature_pb2.Int64List(
+            value=np.random.randint(1000, size=i + 1)))
+  return example_pb2.Example(features=feature_pb2.Features(
+      feature=feature)).SerializeToString()
+
+
+def _features():
+  features = {}
+  for i in range(_NUM_DENSE_FEATURES):
+    features["dense_%d" % i] = parsing_ops.FixedLenFeature(
+        [_DENSE_FEATURE_SIZE], dtypes.float32)
+  for i in range(_NUM_SPARSE_FEATURES):
+    features["sparse_%d" % i] = parsing_ops.VarLenFeature(dtypes.int64)
+  return features
+
+
+class ParseExampleBatchBenchmark(test.Benchmark):
+  """Benchmarks for `tf.data.experimental.parse_example_batch()`."""
+
+  def _benchmark(self, parse_fn, name):
+    batch_sizes = [1, 16, 128, 1024]
+    num_batches = 100
+    examples = [_make_serialized_example() for _ in range(64)]
+    for batch_size in batch_sizes:
+      with ops.Graph().as_default():
+        dataset = dataset_ops.Dataset.from_tensor_slices(examples).repeat(None)
+        dataset = parse_fn(dataset, batch_size)
+        dataset = dataset.skip(num_batches)
+        options = dataset_ops.Options()
+        options.experimental_optimization.apply_default_optimizations = False
+        dataset = dataset.with_options(options)
+        next_element = dataset_ops.make_one_shot_iterator(dataset).get_next()
+
+        with session.Session() as sess:
+          deltas = []
+          for _ in range(5):
+            start = time.time()
+            sess.run(next_element["dense_0"].op)
+            end = time.time()
+            deltas.append((end - start) / (num_batches * batch_size))
+
+      self.report_benchmark(
+          iters=num_batches * batch_size,
+          wall_time=np.median(deltas),
+          name="%s_batch_size_%d" % (name, batch_size))
+
+  def benchmark_map_and_batch(self):
+    features = _features()
+    self._benchmark(
+        lambda dataset, batch_size: dataset.map(
+            lambda x: parsing_ops.parse_single_example(x, features),
+            num_parallel_calls=dataset_ops.AUTOTUNE).batch(batch_size),
+        "map_and_batch")
+
+  def benchmark_batch_and_map(self):
+    features = _features()
+    self._benchmark(
+        lambda dataset, batch_size: dataset.batch(batch_size).map(
+            lambda x: parsing_ops.parse_example(x, features),
+            num_parallel_calls=dataset_ops.AUTOTUNE),
+        "batch_and_map")
+
+  def benchmark_batch_and_parse_example_dataset(self):
+    features = _features()
+    self._benchmark(
+        lambda dataset, batch_size: dataset.batch(batch_size).apply(
+            experimental_parsing_ops.parse_example_dataset(
+                features, num_parallel_calls=dataset_ops.AUTOTUNE)),
+        "batch_and_parse_example_dataset")
+
+  def benchmark_parse_example_batch(self):
+    features = _features()
+    self._benchmark(
+        lambda dataset, batch_size: dataset.apply(
+            experimental_parsing_ops.parse_example_batch(features, batch_size)),
+        "parse_example_batch")
+
+
+if __name__ == "__main__":
+  test.main()
@@ -80,6 +80,22 @@ class SnapshotDatasetBenchmark(benchmark_base.DatasetBenchmarkBase):
     self.run_and_report_benchmark(
         dataset, num_elems, "write_snappy", warmup=False, iters=1)
 
+  def benchmarkWriteSnapshotZstdCompression(self):
+    num_elems = 500000
+    dataset = self._createSimpleDataset(
+        num_elems, compression=snapshot.COMPRESSION_ZSTD)
+
+    self.run_and_report_benchmark(
+        dataset, num_elems, "write_zstd", warmup=False, iters=1)
+
+  def benchmarkWriteSnapshotLz4Compression(self):
+    num_elems = 500000
+    dataset = self._createSimpleDataset(
+        num_elems, compression=snapshot.COMPRESSION_LZ4)
+
+    self.run_and_report_benchmark(
+        dataset, num_elems, "write_lz4", warmup=False, iters=1)
+
   def benchmarkWriteSnapshotSimple(self):
     num_elems = 500000
     dataset = self._createSimpleDataset(num_elems)
@@ -128,6 +144,24 @@ class SnapshotDatasetBenchmark(benchmark_base.DatasetBenchmarkBase):
     self._consumeDataset(dataset, num_elems)
     self.run_and_report_benchmark(dataset, num_elems, "read_snappy")
 
+  def benchmarkReadSnapshotZstdCompression(self):
+    num_elems = 100000
+    tmp_dir = self._makeSnapshotDirectory()
+    dataset = self._createSimpleDataset(
+        num_elems, tmp_dir, compression=snapshot.COMPRESSION_ZSTD)
+
+    self._consumeDataset(dataset, num_elems)
+    self.run_and_report_benchmark(dataset, num_elems, "read_zstd")
+
+  def benchmarkReadSnapshotLz4Compression(self):
+    num_elems = 100000
+    tmp_dir = self._makeSnapshotDirectory()
+    dataset = self._createSimpleDataset(
+        num_elems, tmp_dir, compression=snapshot.COMPRESSION_LZ4)
+
+    self._consumeDataset(dataset, num_elems)
+    self.run_and_report_benchmark(dataset, num_elems, "read_lz4")
+
 
 if __name__ == "__main__":
   test.main()
@@ -0,0 +1,89 @@
+# Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.global_shuffle()`."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.experimental.ops import shuffle_ops
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import test_util
+from tensorflow.python.platform import test
+
+
+@test_util.run_all_in_graph_and_eager_modes
+class GlobalShuffleTest(test_base.DatasetTestBase):
+
+  def _gen_outputs(self, dataset, num_epochs=1):
+    get_next = self.getNext(dataset, requires_initialization=True)
+    epochs = []
+    for _ in range(num_epochs):
+      epoch = []
+      while True:
+        try:
+          epoch.append(self.evaluate(get_next()))
+        except errors.OutOfRangeError:
+          break
+      epochs.append(epoch)
+      get_next = self.getNext(dataset, requires_initialization=True)
+    return epochs
+
+  def testRange(self):
+    dataset = dataset_ops.Dataset.range(100).apply(
+        shuffle_ops.global_shuffle(seed=42))
+    output = self._gen_outputs(dataset)[0]
+    self.assertNotEqual(output, list(range(100)))
+    self.assertCountEqual(output, range(100))
+
+  def testTensorSlices(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices(
+        ([0, 1, 2, 3], ["a", "b", "c", "d"])).apply(
+            shuffle_ops.global_shuffle(seed=42, num_parallel_calls=2))
+    output = self._gen_outputs(dataset)[0]
+    self.assertCountEqual([(0, b"a"), (1, b"b"), (2, b"c"), (3, b"d")],
+                          [(x, y) for x, y in output])
+
+  def testReshuffleEachIteration(self):
+    dataset = dataset_ops.Dataset.range(100).apply(
+        shuffle_ops.global_shuffle(seed=42, reshuffle_each_iteration=True))
+    first, second = self._gen_outputs(dataset, num_epochs=2)
+    self.assertCountEqual(first, second)
+    self.assertNotEqual(first, second)
+
+  def testNoReshuffleEachIteration(self):
+    dataset = dataset_ops.Dataset.range(100).apply(
+        shuffle_ops.global_shuffle(seed=42, reshuffle_each_iteration=False))
+    first, second = self._gen_outputs(dataset, num_epochs=2)
+    self.assertEqual(first, second)
+
+  def testUnsupportedInput(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "supports random access"):
+      dataset = dataset_ops.Dataset.range(10).map(lambda x: x * 2).apply(
+          shuffle_ops.global_shuffle(seed=42))
+      self.evaluate(self.getNext(dataset, requires_initialization=True)())
+
+  def testInfiniteInput(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "known, finite cardinality"):
+      dataset = dataset_ops.Dataset.range(10).repeat().apply(
+          shuffle_ops.global_shuffle(seed=42))
+      self.evaluate(self.getNext(dataset, requires_initialization=True)())
+
+
+if __name__ == "__main__":
+  test.main()
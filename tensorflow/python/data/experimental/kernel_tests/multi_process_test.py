@@ -0,0 +1,58 @@
+# Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.multi_process()`."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import multi_process
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.platform import resource_loader
+from tensorflow.python.platform import test
+
+
+class MultiProcessTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def setUp(self):
+    super(MultiProcessTest, self).setUp()
+    # Points the kernel at the worker binary built for this test.
+    os.environ["TF_DATA_MULTI_PROCESS_WORKER"] = (
+        resource_loader.get_path_to_datafile(
+            "../../../../core/kernels/data/experimental/"
+            "multi_process_dataset_worker"))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testDeterministic(self):
+    dataset = dataset_ops.Dataset.range(20).map(lambda x: x * x)
+    dataset = dataset.apply(multi_process.multi_process(num_workers=2))
+    self.assertDatasetProduces(dataset, [x * x for x in range(20)])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testNonDeterministic(self):
+    dataset = dataset_ops.Dataset.range(20)
+    dataset = dataset.apply(
+        multi_process.multi_process(num_workers=3, deterministic=False))
+    self.assertDatasetProduces(
+        dataset, list(range(20)), assert_items_equal=True)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -44,6 +44,18 @@ class ModelDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
     with self.assertRaises(errors.OutOfRangeError):
       self.evaluate(get_next())
 
+  def testRamBudgetOption(self):
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.map(
+        lambda x: x * x, num_parallel_calls=dataset_ops.AUTOTUNE)
+    dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
+    options = dataset_ops.Options()
+    options.experimental_optimization.apply_default_optimizations = False
+    options.experimental_optimization.autotune = True
+    options.experimental_optimization.autotune_ram_budget = 1 << 20
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(dataset, [x * x for x in range(100)])
+
 
 if __name__ == "__main__":
   test.main()
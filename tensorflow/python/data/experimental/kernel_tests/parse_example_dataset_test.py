@@ -24,6 +24,7 @@ import numpy as np
 
 from tensorflow.core.example import example_pb2
 from tensorflow.core.example import feature_pb2
+from tensorflow.python.data.experimental.ops import cardinality
 from tensorflow.python.data.experimental.ops import parsing_ops as contrib_parsing_ops
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
@@ -1092,6 +1093,81 @@ class ParseExampleDatasetTest(test_base.DatasetTestBase):
         expected_values=expected_output,
         create_iterator_twice=True)
 
+  def _batch_features(self):
+    return {
+        "a": parsing_ops.FixedLenFeature((2,), dtypes.int64,
+                                         default_value=[-1, -1]),
+        "b": parsing_ops.VarLenFeature(dtypes.string),
+        "c": parsing_ops.FixedLenSequenceFeature(
+            (), dtypes.float32, allow_missing=True),
+        "d": parsing_ops.RaggedFeature(dtypes.int64, value_key="b_ints"),
+        "sp": parsing_ops.SparseFeature(["idx"], "val", dtypes.float32, [13]),
+    }
+
+  def _batch_examples(self, num_examples):
+    serialized = []
+    for i in range(num_examples):
+      feature_dict = {
+          "b": bytes_feature([b"x" * j for j in range(i % 3)]),
+          "c": float_feature([float(j) for j in range(i % 4)]),
+          "b_ints": int64_feature(list(range(i % 5))),
+          "idx": int64_feature([i % 13]),
+          "val": float_feature([float(i)]),
+      }
+      if i % 2:
+        feature_dict["a"] = int64_feature([i, -i])
+      serialized.append(
+          example(features=features(feature_dict)).SerializeToString())
+    return serialized
+
+  def testParseExampleBatchMatchesBatchAndParse(self):
+    serialized = self._batch_examples(11)
+    dataset = dataset_ops.Dataset.from_tensor_slices(serialized)
+    expected = dataset.batch(4).apply(
+        contrib_parsing_ops.parse_example_dataset(self._batch_features()))
+    actual = dataset.apply(
+        contrib_parsing_ops.parse_example_batch(self._batch_features(), 4))
+    self.assertEqual(
+        dataset_ops.get_legacy_output_shapes(actual)["a"].as_list(), [None, 2])
+    expected_next = self.getNext(expected)
+    actual_next = self.getNext(actual)
+    for _ in range(3):
+      self._compare_output_to_expected(
+          self.evaluate(actual_next()), self.evaluate(expected_next()))
+    with self.assertRaises(errors_impl.OutOfRangeError):
+      self.evaluate(actual_next())
+
+  def testParseExampleBatchDropRemainder(self):
+    serialized = self._batch_examples(11)
+    dataset = dataset_ops.Dataset.from_tensor_slices(serialized).apply(
+        contrib_parsing_ops.parse_example_batch(
+            self._batch_features(), 4, drop_remainder=True))
+    self.assertEqual(
+        dataset_ops.get_legacy_output_shapes(dataset)["a"].as_list(), [4, 2])
+    self.assertEqual(self.evaluate(cardinality.cardinality(dataset)), 2)
+    get_next = self.getNext(dataset)
+    for i in range(2):
+      self.assertAllEqual(
+          self.evaluate(get_next())["a"],
+          [[j, -j] if j % 2 else [-1, -1] for j in range(4 * i, 4 * i + 4)])
+    with self.assertRaises(errors_impl.OutOfRangeError):
+      self.evaluate(get_next())
+
+  def testParseExampleBatchInvalidInput(self):
+    dataset = dataset_ops.Dataset.from_tensors(self._batch_examples(2))
+    with self.assertRaisesRegexp(TypeError, "scalar strings"):
+      dataset.apply(
+          contrib_parsing_ops.parse_example_batch(self._batch_features(), 2))
+
+  def testParseExampleBatchInvalidExample(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices(
+        self._batch_examples(2) + [b"not an example"]).apply(
+            contrib_parsing_ops.parse_example_batch(self._batch_features(), 3))
+    self.assertDatasetProduces(
+        dataset,
+        expected_error=(errors_impl.InvalidArgumentError,
+                        "Could not parse example input"))
+
 
 if __name__ == "__main__":
   test.main()
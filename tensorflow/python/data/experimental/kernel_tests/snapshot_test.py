@@ -135,7 +135,8 @@ class SnapshotDatasetTest(reader_dataset_ops_test_base.TFRecordDatasetTestBase,
           test_base.default_test_combinations(),
           combinations.combine(compression=[
               snapshot.COMPRESSION_NONE, snapshot.COMPRESSION_GZIP,
-              snapshot.COMPRESSION_SNAPPY
+              snapshot.COMPRESSION_SNAPPY, snapshot.COMPRESSION_ZSTD,
+              snapshot.COMPRESSION_LZ4
           ])))
   def testWriteSnapshotSimpleSuccessful(self, compression):
     tmpdir = self.makeSnapshotDirectory()
@@ -162,7 +163,8 @@ class SnapshotDatasetTest(reader_dataset_ops_test_base.TFRecordDatasetTestBase,
           test_base.default_test_combinations(),
           combinations.combine(compression=[
               snapshot.COMPRESSION_NONE, snapshot.COMPRESSION_GZIP,
-              snapshot.COMPRESSION_SNAPPY
+              snapshot.COMPRESSION_SNAPPY, snapshot.COMPRESSION_ZSTD,
+              snapshot.COMPRESSION_LZ4
           ])))
   def testReadSnapshotBackAfterWrite(self, compression):
     self.setUpTFRecord()
@@ -258,6 +260,72 @@ class SnapshotDatasetTest(reader_dataset_ops_test_base.TFRecordDatasetTestBase,
             reader_buffer_size=10))
     self.assertDatasetProduces(dataset2, expected, assert_items_equal=True)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(reorder_window=[-1, 0, 16])))
+  def testReadSnapshotAutotuneParallelAfterWrite(self, reorder_window):
+    self.setUpTFRecord(10, 1000)
+    filenames = self.test_filenames
+
+    expected = [
+        b"Record %d of file %d" % (r, f)  # pylint:disable=g-complex-comprehension
+        for f in range(0, 10)
+        for r in range(0, 1000)
+    ]
+
+    tmpdir = self.makeSnapshotDirectory()
+    dataset = core_readers._TFRecordDataset(filenames)
+    dataset = dataset.apply(
+        snapshot.snapshot(
+            tmpdir,
+            compression=snapshot.COMPRESSION_SNAPPY,
+            shard_size_bytes=10 * 1024))
+    self.assertDatasetProduces(dataset, expected)
+
+    # remove the original files and try to read the data back only from
+    # snapshot.
+    self.removeTFRecords()
+
+    dataset2 = core_readers._TFRecordDataset(filenames)
+    dataset2 = dataset2.apply(
+        snapshot.snapshot(
+            tmpdir,
+            compression=snapshot.COMPRESSION_SNAPPY,
+            shard_size_bytes=10 * 1024,
+            num_reader_threads=dataset_ops.AUTOTUNE,
+            reader_buffer_size=16,
+            reader_reorder_window=reorder_window))
+    self.assertDatasetProduces(dataset2, expected, assert_items_equal=True)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testReadSnapshotInOrderWithParallelParsing(self):
+    self.setUpTFRecord(10, 100)
+    filenames = self.test_filenames
+
+    expected = [
+        b"Record %d of file %d" % (r, f)  # pylint:disable=g-complex-comprehension
+        for f in range(0, 10)
+        for r in range(0, 100)
+    ]
+
+    tmpdir = self.makeSnapshotDirectory()
+    dataset = core_readers._TFRecordDataset(filenames)
+    dataset = dataset.apply(snapshot.snapshot(tmpdir))
+    self.assertDatasetProduces(dataset, expected)
+
+    # remove the original files and try to read the data back only from
+    # snapshot. With a single reader thread and no reordering, the elements
+    # are produced in order although they are parsed in parallel.
+    self.removeTFRecords()
+
+    dataset2 = core_readers._TFRecordDataset(filenames)
+    dataset2 = dataset2.apply(
+        snapshot.snapshot(
+            tmpdir, num_reader_threads=1, reader_buffer_size=32,
+            reader_reorder_window=0))
+    self.assertDatasetProduces(dataset2, expected)
+
   @combinations.generate(
       combinations.times(
           test_base.default_test_combinations(),
@@ -0,0 +1,91 @@
+# Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Experimental API for producing `tf.data` pipelines in worker processes."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.experimental.ops import distribute_options
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
+from tensorflow.python.util.tf_export import tf_export
+
+
+class _MultiProcessDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` whose input is produced by worker processes."""
+
+  def __init__(self, input_dataset, num_workers, buffer_size_bytes,
+               deterministic, auto_shard_policy):
+    """See `multi_process()` for details."""
+    self._input_dataset = input_dataset
+    self._num_workers = ops.convert_to_tensor(
+        num_workers, dtype=dtypes.int64, name="num_workers")
+    variant_tensor = gen_experimental_dataset_ops.multi_process_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        self._num_workers,
+        buffer_size_bytes=buffer_size_bytes,
+        deterministic=deterministic,
+        auto_shard_policy=int(auto_shard_policy),
+        **self._flat_structure)
+    super(_MultiProcessDataset, self).__init__(input_dataset, variant_tensor)
+
+
+@tf_export("data.experimental.multi_process")
+def multi_process(num_workers,
+                  buffer_size_bytes=64 << 20,
+                  deterministic=True,
+                  auto_shard_policy=None):
+  """Produces the input dataset in `num_workers` worker processes.
+
+  Each worker runs a shard of the input dataset, so that Python-free but
+  CPU-heavy preprocessing is not limited by the threads of one process. The
+  elements come back through shared memory:
+
+  ```python
+  dataset = tf.data.TFRecordDataset(filenames).map(parse_fn)
+  dataset = dataset.apply(tf.data.experimental.multi_process(num_workers=4))
+  ```
+
+  Only numeric, boolean and string components are supported, and the input
+  dataset must be serializable, so it cannot use `tf.py_function`. Restoring
+  a checkpoint makes each worker skip the elements that it had produced
+  before, which takes time proportional to the number of elements consumed.
+
+  Args:
+    num_workers: A `tf.int64` scalar `tf.Tensor`, representing the number of
+      worker processes.
+    buffer_size_bytes: (Optional.) The size in bytes of the shared memory
+      buffer of each worker. Every element must fit in the buffer.
+    deterministic: (Optional.) If `True`, the elements are taken from the
+      workers in turn. Otherwise, they are produced as soon as any worker has
+      one.
+    auto_shard_policy: (Optional.) A
+      `tf.data.experimental.AutoShardPolicy` that selects how the input is
+      sharded between the workers. Defaults to `AutoShardPolicy.AUTO`.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+  if auto_shard_policy is None:
+    auto_shard_policy = distribute_options.AutoShardPolicy.AUTO
+
+  def _apply_fn(dataset):
+    return _MultiProcessDataset(dataset, num_workers, buffer_size_bytes,
+                                deterministic, auto_shard_policy)
+
+  return _apply_fn
@@ -110,6 +110,15 @@ class OptimizationOptions(options.OptionsBase):
       "are allowed but may result in CPU contention. If None, defaults to the "
       "number of schedulable CPU cores.")
 
+  autotune_ram_budget = options.create_option(
+      name="autotune_ram_budget",
+      ty=int,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines the RAM "
+      "budget (in bytes) to use. The autotuner will not choose buffer sizes "
+      "and parallelism whose worst-case memory usage exceeds the budget. If "
+      "None, defaults to half of the available RAM.")
+
   filter_fusion = options.create_option(
       name="filter_fusion",
       ty=bool,
@@ -20,14 +20,61 @@ from __future__ import print_function
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import structure
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.framework import tensor_shape
 from tensorflow.python.framework import tensor_spec
+from tensorflow.python.framework import tensor_util
 from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.ops import parsing_ops
 from tensorflow.python.ops.ragged import ragged_tensor
 from tensorflow.python.util.tf_export import tf_export
 
 
+def _parse_op_params(features):
+  """Returns the `_ParseOpParams` for parsing batches of `features`."""
+  # pylint: disable=protected-access
+  # TODO(b/112859642): Pass sparse_index and sparse_values for SparseFeature
+  return parsing_ops._ParseOpParams.from_features(
+      parsing_ops._prepend_none_dimension(features), [
+          parsing_ops.VarLenFeature, parsing_ops.SparseFeature,
+          parsing_ops.FixedLenFeature, parsing_ops.FixedLenSequenceFeature,
+          parsing_ops.RaggedFeature
+      ])
+  # pylint: enable=protected-access
+
+
+def _parsed_element_spec(params, batch_shape):
+  """Returns the structure of a batch of parsed examples.
+
+  Args:
+    params: The `_ParseOpParams` of the parsed features.
+    batch_shape: A `tf.TensorShape` of rank 1, the shape of the batch.
+
+  Returns:
+    A `dict` mapping feature keys to `TypeSpec`s.
+  """
+  element_spec = {}
+
+  for (key, value_type) in zip(params.sparse_keys, params.sparse_types):
+    element_spec[key] = sparse_tensor.SparseTensorSpec(
+        batch_shape.concatenate([None]), value_type)
+
+  for (key, value_type, dense_shape) in zip(params.dense_keys,
+                                            params.dense_types,
+                                            params.dense_shapes):
+    element_spec[key] = tensor_spec.TensorSpec(
+        batch_shape.concatenate(dense_shape), value_type)
+
+  for (key, value_type, splits_type) in zip(params.ragged_keys,
+                                            params.ragged_value_types,
+                                            params.ragged_split_types):
+    element_spec[key] = ragged_tensor.RaggedTensorSpec(
+        batch_shape.concatenate([None]), value_type, 1, splits_type)
+
+  return element_spec
+
+
 class _ParseExampleDataset(dataset_ops.UnaryDataset):
   """A `Dataset` that parses `example` dataset into a `dict` dataset."""
 
@@ -38,15 +85,7 @@ class _ParseExampleDataset(dataset_ops.UnaryDataset):
         tensor_spec.TensorSpec([None], dtypes.string)):
       raise TypeError("Input dataset should be a dataset of vectors of strings")
     self._num_parallel_calls = num_parallel_calls
-    # pylint: disable=protected-access
-    self._features = parsing_ops._prepend_none_dimension(features)
-    # TODO(b/112859642): Pass sparse_index and sparse_values for SparseFeature
-    params = parsing_ops._ParseOpParams.from_features(self._features, [
-        parsing_ops.VarLenFeature, parsing_ops.SparseFeature,
-        parsing_ops.FixedLenFeature, parsing_ops.FixedLenSequenceFeature,
-        parsing_ops.RaggedFeature
-    ])
-    # pylint: enable=protected-access
+    params = _parse_op_params(features)
     self._sparse_keys = params.sparse_keys
     self._sparse_types = params.sparse_types
     self._ragged_keys = params.ragged_keys
@@ -56,26 +95,8 @@ class _ParseExampleDataset(dataset_ops.UnaryDataset):
     self._dense_defaults = params.dense_defaults_vec
     self._dense_shapes = params.dense_shapes_as_proto
     self._dense_types = params.dense_types
-    input_dataset_shape = dataset_ops.get_legacy_output_shapes(
-        self._input_dataset)
-
-    self._element_spec = {}
-
-    for (key, value_type) in zip(params.sparse_keys, params.sparse_types):
-      self._element_spec[key] = sparse_tensor.SparseTensorSpec(
-          input_dataset_shape.concatenate([None]), value_type)
-
-    for (key, value_type, dense_shape) in zip(params.dense_keys,
-                                              params.dense_types,
-                                              params.dense_shapes):
-      self._element_spec[key] = tensor_spec.TensorSpec(
-          input_dataset_shape.concatenate(dense_shape), value_type)
-
-    for (key, value_type, splits_type) in zip(params.ragged_keys,
-                                              params.ragged_value_types,
-                                              params.ragged_split_types):
-      self._element_spec[key] = ragged_tensor.RaggedTensorSpec(
-          input_dataset_shape.concatenate([None]), value_type, 1, splits_type)
+    self._element_spec = _parsed_element_spec(
+        params, dataset_ops.get_legacy_output_shapes(self._input_dataset))
 
     variant_tensor = (
         gen_experimental_dataset_ops.parse_example_dataset(
@@ -97,6 +118,67 @@ class _ParseExampleDataset(dataset_ops.UnaryDataset):
     return self._element_spec
 
 
+class _ParseExampleBatchDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that batches and parses a dataset of scalar `Example`s."""
+
+  def __init__(self, input_dataset, features, batch_size, drop_remainder):
+    self._input_dataset = input_dataset
+    if not structure.are_compatible(
+        input_dataset.element_spec,
+        tensor_spec.TensorSpec([], dtypes.string)):
+      raise TypeError(
+          "Input dataset should be a dataset of scalar strings, but got %s." %
+          (input_dataset.element_spec,))
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    self._drop_remainder = ops.convert_to_tensor(
+        drop_remainder, dtype=dtypes.bool, name="drop_remainder")
+    params = _parse_op_params(features)
+    # NOTE: `constant_drop_remainder` may be `None` (unknown statically) or
+    # `False` (explicitly retaining the remainder).
+    if tensor_util.constant_value(self._drop_remainder):
+      batch_shape = tensor_shape.TensorShape(
+          [tensor_util.constant_value(self._batch_size)])
+    else:
+      batch_shape = tensor_shape.TensorShape([None])
+    self._element_spec = _parsed_element_spec(params, batch_shape)
+
+    variant_tensor = gen_experimental_dataset_ops.parse_example_batch_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        self._batch_size,
+        self._drop_remainder,
+        params.dense_defaults_vec,
+        params.sparse_keys,
+        params.dense_keys,
+        params.sparse_types,
+        params.dense_shapes_as_proto,
+        ragged_keys=params.ragged_keys,
+        ragged_value_types=params.ragged_value_types,
+        ragged_split_types=params.ragged_split_types,
+        **self._flat_structure)
+    super(_ParseExampleBatchDataset, self).__init__(input_dataset,
+                                                    variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._element_spec
+
+
+def _construct_composite_features(dataset, features, num_parallel_calls):
+  """Assembles `SparseFeature`s and partitioned `RaggedFeature`s, if any."""
+  if any(
+      isinstance(feature, parsing_ops.SparseFeature) or
+      (isinstance(feature, parsing_ops.RaggedFeature) and feature.partitions)
+      for feature in features.values()):
+    # pylint: disable=protected-access
+    # pylint: disable=g-long-lambda
+    dataset = dataset.map(
+        lambda x: parsing_ops._construct_tensors_for_composite_features(
+            features, x),
+        num_parallel_calls=num_parallel_calls)
+  return dataset
+
+
 # TODO(b/111553342): add arguments names and example names as well.
 @tf_export("data.experimental.parse_example_dataset")
 def parse_example_dataset(features, num_parallel_calls=1):
@@ -133,16 +215,52 @@ def parse_example_dataset(features, num_parallel_calls=1):
   def _apply_fn(dataset):
     """Function from `Dataset` to `Dataset` that applies the transformation."""
     out_dataset = _ParseExampleDataset(dataset, features, num_parallel_calls)
-    if any(
-        isinstance(feature, parsing_ops.SparseFeature) or
-        (isinstance(feature, parsing_ops.RaggedFeature) and feature.partitions)
-        for feature in features.values()):
-      # pylint: disable=protected-access
-      # pylint: disable=g-long-lambda
-      out_dataset = out_dataset.map(
-          lambda x: parsing_ops._construct_tensors_for_composite_features(
-              features, x),
-          num_parallel_calls=num_parallel_calls)
-    return out_dataset
+    return _construct_composite_features(out_dataset, features,
+                                         num_parallel_calls)
+
+  return _apply_fn
+
+
+@tf_export("data.experimental.parse_example_batch")
+def parse_example_batch(features, batch_size, drop_remainder=False):
+  """A transformation that batches and parses `Example` protos.
+
+  `dataset.apply(parse_example_batch(features, batch_size))` produces the same
+  elements as `dataset.batch(batch_size).apply(parse_example_dataset(features))`
+  for a dataset of scalar serialized `Example` protos, but parses each batch
+  directly from the input elements: the serialized protos are not copied into
+  an intermediate batched string tensor, and fixed-length dense features are
+  written straight into their batched output tensors. Parsing of a batch is
+  parallelized across the examples in it.
+
+  See `tf.data.experimental.parse_example_dataset` for details about
+  `features`.
+
+  Args:
+    features: A `dict` mapping feature keys to `FixedLenFeature`,
+      `VarLenFeature`, `RaggedFeature`, and `SparseFeature` values.
+    batch_size: A `tf.int64` scalar `tf.Tensor`, representing the number of
+      consecutive serialized `Example` protos to parse into each batch.
+    drop_remainder: (Optional.) A `tf.bool` scalar `tf.Tensor`, representing
+      whether the last batch should be dropped in the case it has fewer than
+      `batch_size` elements; the default behavior is not to drop the smaller
+      batch.
+
+  Returns:
+    A dataset transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+
+  Raises:
+    ValueError: if features argument is None.
+  """
+  if features is None:
+    raise ValueError("Missing: features was %s." % features)
+
+  def _apply_fn(dataset):
+    """Function from `Dataset` to `Dataset` that applies the transformation."""
+    out_dataset = _ParseExampleBatchDataset(dataset, features, batch_size,
+                                            drop_remainder)
+    return _construct_composite_features(out_dataset, features,
+                                         dataset_ops.AUTOTUNE)
 
   return _apply_fn
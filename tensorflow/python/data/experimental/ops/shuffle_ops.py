@@ -23,6 +23,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
 
@@ -107,3 +108,68 @@ def shuffle_and_repeat(buffer_size, count=None, seed=None):
     return _ShuffleAndRepeatDataset(dataset, buffer_size, count, seed)
 
   return _apply_fn
+
+
+class _GlobalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` that shuffles all elements of its random-access input."""
+
+  def __init__(self, input_dataset, seed=None, reshuffle_each_iteration=True,
+               num_parallel_calls=dataset_ops.AUTOTUNE):
+    self._input_dataset = input_dataset
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+    self._num_parallel_calls = ops.convert_to_tensor(
+        num_parallel_calls, dtype=dtypes.int64, name="num_parallel_calls")
+    variant_tensor = gen_experimental_dataset_ops.global_shuffle_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        seed=self._seed,
+        seed2=self._seed2,
+        num_parallel_calls=self._num_parallel_calls,
+        reshuffle_each_iteration=reshuffle_each_iteration,
+        **self._flat_structure)
+    super(_GlobalShuffleDataset, self).__init__(input_dataset, variant_tensor)
+
+
+@tf_export("data.experimental.global_shuffle")
+def global_shuffle(seed=None, reshuffle_each_iteration=True,
+                   num_parallel_calls=dataset_ops.AUTOTUNE):
+  """Uniformly shuffles all elements of a dataset without buffering them.
+
+  `tf.data.Dataset.shuffle` draws elements from a buffer of `buffer_size`
+  elements, so a uniform shuffle requires a buffer as large as the dataset.
+  `global_shuffle` instead reads input elements by index in the order given by
+  a pseudorandom permutation of `[0, cardinality)`, which produces a uniform
+  shuffle using memory that does not depend on the size of the dataset.
+
+  >>> d = tf.data.Dataset.range(5)
+  >>> d = d.apply(tf.data.experimental.global_shuffle(seed=42))
+  >>> sorted([elem.numpy() for elem in d])
+  [0, 1, 2, 3, 4]
+
+  The input dataset must support random access and have a known, finite
+  cardinality. Currently `tf.data.Dataset.range`,
+  `tf.data.Dataset.from_tensor_slices` and indexed `tf.data.TFRecordDataset`
+  support random access, as do `map` with a stateless function and `batch`
+  applied to such a dataset.
+
+  Args:
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the random
+      seed that will be used to create the permutation. See
+      `tf.compat.v1.set_random_seed` for behavior.
+    reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
+      that the dataset should be pseudorandomly reshuffled each time it is
+      iterated over. (Defaults to `True`.)
+    num_parallel_calls: (Optional.) A `tf.int64` scalar `tf.Tensor`,
+      representing the maximum number of input elements to read in parallel.
+      If the value `tf.data.experimental.AUTOTUNE` is used, it is set to the
+      size of the runtime thread pool.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):  # pylint: disable=missing-docstring
+    return _GlobalShuffleDataset(dataset, seed, reshuffle_each_iteration,
+                                 num_parallel_calls)
+
+  return _apply_fn
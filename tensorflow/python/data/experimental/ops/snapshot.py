@@ -26,6 +26,8 @@ from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 
 COMPRESSION_GZIP = "GZIP"
 COMPRESSION_SNAPPY = "SNAPPY"
+COMPRESSION_ZSTD = "ZSTD"
+COMPRESSION_LZ4 = "LZ4"
 COMPRESSION_NONE = None
 
 
@@ -45,7 +47,8 @@ class _SnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
                num_writer_threads=None,
                writer_buffer_size=None,
                shuffle_on_read=None,
-               seed=None):
+               seed=None,
+               reader_reorder_window=None):
 
     self._compression = compression if compression is not None else ""
     self._reader_path_prefix = (
@@ -58,7 +61,12 @@ class _SnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
         pending_snapshot_expiry_seconds
         if pending_snapshot_expiry_seconds is not None else -1)
     self._num_reader_threads = (
-        num_reader_threads if num_reader_threads is not None else -1)
+        num_reader_threads if num_reader_threads is not None else 1)
+    # The kernel treats -1 as one thread, so AUTOTUNE has its own attr.
+    self._autotune_num_reader_threads = (
+        self._num_reader_threads == dataset_ops.AUTOTUNE)
+    if self._autotune_num_reader_threads:
+      self._num_reader_threads = 1
     self._reader_buffer_size = (
         reader_buffer_size if reader_buffer_size is not None else -1)
     self._num_writer_threads = (
@@ -67,6 +75,8 @@ class _SnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
         writer_buffer_size if writer_buffer_size is not None else -1)
     self._shuffle_on_read = (
         shuffle_on_read if shuffle_on_read is not None else False)
+    self._reader_reorder_window = (
+        reader_reorder_window if reader_reorder_window is not None else 0)
 
     self._seed, self._seed2 = random_seed.get_seed(seed)
 
@@ -88,6 +98,8 @@ class _SnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
         shuffle_on_read=self._shuffle_on_read,
         seed=self._seed,
         seed2=self._seed2,
+        reader_reorder_window=self._reader_reorder_window,
+        autotune_num_reader_threads=self._autotune_num_reader_threads,
         **self._flat_structure)
     super(_SnapshotDataset, self).__init__(input_dataset, variant_tensor)
 
@@ -103,7 +115,8 @@ def snapshot(path,
              num_writer_threads=None,
              writer_buffer_size=None,
              shuffle_on_read=None,
-             seed=None):
+             seed=None,
+             reader_reorder_window=None):
   """Writes to/reads from a snapshot of a dataset.
 
   This function attempts to determine whether a valid snapshot exists at the
@@ -115,7 +128,8 @@ def snapshot(path,
     path: A directory where we want to save our snapshots and/or read from a
       previously saved snapshot.
     compression: The type of compression to apply to the Dataset. Currently
-      supports "GZIP" or None. Defaults to None (no compression).
+      supports "GZIP", "SNAPPY", "ZSTD", "LZ4" or None. Defaults to None (no
+      compression).
     reader_path_prefix: A prefix to add to the path when reading from snapshots.
       Defaults to None.
     writer_path_prefix: A prefix to add to the path when writing to snapshots.
@@ -129,9 +143,12 @@ def snapshot(path,
       operation tends to be intensive. Defaults to 1. If > 1, then this might
       introduce non-determinism i.e. the order in which the elements are
       read from the snapshot are different from the order they're written.
+      If set to `tf.data.experimental.AUTOTUNE`, the number of threads is
+      tuned dynamically based on available CPU.
     reader_buffer_size: Maximum number of elements we can prefetch reading from
       the snapshot. Defaults to 1. Increasing this might improve performance
-      but will increase memory consumption.
+      but will increase memory consumption. The buffer always holds at least
+      one element per reader thread.
     num_writer_threads: Number of threads to parallelize writing from snapshot.
       We'll open up `num_writer_threads` files and write to them in parallel.
       Especially useful if compression is turned on since the compression
@@ -145,6 +162,11 @@ def snapshot(path,
       produced when reading from a snapshot will be random. Defaults to False.
     seed: If seed is set, the random number generator is seeded by the given
       seed. Otherwise, it is seeded by a random seed.
+    reader_reorder_window: When reading from a snapshot, elements are
+      deserialized in parallel. An element may be produced ahead of at most
+      this many elements that were read before it. Defaults to 0, which
+      produces elements in the order they are read. If -1, elements are
+      produced as soon as they are deserialized.
   Returns:
     A `Dataset` transformation function, which can be passed to
     `tf.data.Dataset.apply`.
@@ -155,6 +177,7 @@ def snapshot(path,
                             writer_path_prefix, shard_size_bytes,
                             pending_snapshot_expiry_seconds, num_reader_threads,
                             reader_buffer_size, num_writer_threads,
-                            writer_buffer_size, shuffle_on_read, seed)
+                            writer_buffer_size, shuffle_on_read, seed,
+                            reader_reorder_window)
 
   return _apply_fn
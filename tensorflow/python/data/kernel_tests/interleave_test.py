@@ -284,6 +284,26 @@ class InterleaveTest(test_base.DatasetTestBase, parameterized.TestCase):
       actual_output.append(self.evaluate(get_next()))
     self.assertAllEqual(expected_output.sort(), actual_output.sort())
 
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(deterministic=[True, False])))
+  def testInterleaveWithLargeInput(self, deterministic):
+    # The first input is much larger than the others, so idle workers read
+    # ahead for the other inputs while the cycle waits on it.
+    input_values = np.int64([50, 1, 2, 1, 3, 1, 2, 1])
+    dataset = dataset_ops.Dataset.from_tensor_slices(input_values).interleave(
+        lambda x: dataset_ops.Dataset.from_tensors(x).repeat(x),
+        cycle_length=2,
+        block_length=2,
+        num_parallel_calls=2)
+    options = dataset_ops.Options()
+    options.experimental_deterministic = deterministic
+    dataset = dataset.with_options(options)
+    expected_output = list(
+        _interleave(_repeat(input_values, 1), cycle_length=2, block_length=2))
+    self.assertDatasetProduces(
+        dataset, expected_output, assert_items_equal=not deterministic)
+
   @combinations.generate(test_base.default_test_combinations())
   def testInterleaveMap(self):
     dataset = dataset_ops.Dataset.range(100)
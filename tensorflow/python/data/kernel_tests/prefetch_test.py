@@ -25,6 +25,7 @@ from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
 from tensorflow.python.platform import test
 
 
@@ -51,6 +52,22 @@ class PrefetchTest(test_base.DatasetTestBase, parameterized.TestCase):
         dataset, buffer_size, slack_period=slack_period)
     self.assertDatasetProduces(dataset, expected_output=range(100))
 
+  @parameterized.parameters(*[(buffer_size, max_buffer_bytes)
+                              for buffer_size in (-1, None, 0, 5)
+                              for max_buffer_bytes in (1, 64, 1 << 20)])
+  def testPrefetchWithByteBudget(self, buffer_size, max_buffer_bytes):
+    dataset = dataset_ops.Dataset.range(100).map(
+        lambda x: array_ops.fill([x], x))
+    dataset = dataset.prefetch(buffer_size, max_buffer_bytes=max_buffer_bytes)
+    self.assertDatasetProduces(
+        dataset, expected_output=[[i] * i for i in range(100)])
+
+  def testInvalidMaxBufferBytes(self):
+    with self.assertRaises(errors.InvalidArgumentError):
+      dataset = dataset_ops.Dataset.range(10).prefetch(
+          buffer_size=5, max_buffer_bytes=-1)
+      self.evaluate(dataset._variant_tensor)
+
   @test_util.run_v1_only("graph-mode specific test")
   def testSkipEagerPrefetchCancellation(self):
 
@@ -21,12 +21,15 @@ import gzip
 import os
 import zlib
 
+from tensorflow.python.data.experimental.ops import cardinality
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import errors
 from tensorflow.python.framework import test_util
 from tensorflow.python.lib.io import python_io
+from tensorflow.python.lib.io import tf_record
 from tensorflow.python.platform import test
 from tensorflow.python.util import compat
 
@@ -179,5 +182,82 @@ class TFRecordDatasetTest(test_base.DatasetTestBase):
         dataset, expected_output=expected_output * 10, assert_items_equal=True)
 
 
+  def testReadWithIndex(self):
+    for fn in self.test_filenames:
+      tf_record.write_tf_record_index(fn)
+    expected_output = []
+    for j in range(self._num_files):
+      expected_output.extend(
+          [self._record(j, i) for i in range(self._num_records)])
+    dataset = readers.TFRecordDataset(self.test_filenames, use_index=True)
+    self.assertEqual(
+        self._num_files * self._num_records,
+        self.evaluate(cardinality.cardinality(dataset)))
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
+    # Sharding and skipping seek through the index.
+    dataset = readers.TFRecordDataset(
+        self.test_filenames, use_index=True).skip(3).shard(4, 1)
+    self.assertDatasetProduces(
+        dataset, expected_output=expected_output[3:][1::4])
+
+  def testReadWithMmap(self):
+    expected_output = []
+    for j in range(self._num_files):
+      expected_output.extend(
+          [self._record(j, i) for i in range(self._num_records)])
+    dataset = readers.TFRecordDataset(self.test_filenames, use_mmap=True)
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
+    dataset = readers.TFRecordDataset(
+        self.test_filenames, num_parallel_reads=2, use_mmap=True)
+    self.assertDatasetProduces(
+        dataset, expected_output=expected_output, assert_items_equal=True)
+
+    for fn in self.test_filenames:
+      tf_record.write_tf_record_index(fn)
+    dataset = readers.TFRecordDataset(
+        self.test_filenames, use_index=True, use_mmap=True).skip(3).shard(4, 1)
+    self.assertDatasetProduces(
+        dataset, expected_output=expected_output[3:][1::4])
+
+  def testReadWithMmapWithoutVerifyingChecksums(self):
+    fn = self.test_filenames[0]
+    with open(fn, "rb") as f:
+      contents = bytearray(f.read())
+    # Corrupt the first byte of the data of the first record, which follows
+    # its 8-byte length and 4-byte length checksum.
+    contents[12] ^= 0xff
+    with open(fn, "wb") as f:
+      f.write(contents)
+
+    dataset = readers.TFRecordDataset(fn, use_mmap=True)
+    get_next = self.getNext(dataset)
+    with self.assertRaises(errors.DataLossError):
+      self.evaluate(get_next())
+
+    expected_output = [self._record(0, i) for i in range(self._num_records)]
+    corrupted_record = bytearray(expected_output[0])
+    corrupted_record[0] ^= 0xff
+    expected_output[0] = bytes(corrupted_record)
+    dataset = readers.TFRecordDataset(
+        fn, use_mmap=True, verify_checksums=False)
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
+  def testReadWithMmapCompressed(self):
+    with self.assertRaises(errors.InvalidArgumentError):
+      dataset = readers.TFRecordDataset(
+          self.test_filenames, compression_type="GZIP", use_mmap=True)
+      self.evaluate(dataset._variant_tensor)
+
+  def testReadWithIndexErrors(self):
+    files = dataset_ops.Dataset.from_tensor_slices(self.test_filenames)
+    with self.assertRaises(TypeError):
+      readers.TFRecordDataset(files, use_index=True)
+    with self.assertRaises(ValueError):
+      readers.TFRecordDataset(
+          self.test_filenames, num_parallel_reads=2, use_index=True)
+
+
 if __name__ == "__main__":
   test.main()
@@ -383,6 +383,7 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
     autotune = True
     algorithm = AutotuneAlgorithm.HILL_CLIMB
     cpu_budget = 0  # Indicates that all CPU cores should be used.
+    ram_budget = 0  # Indicates that a share of the available RAM can be used.
     if options.experimental_optimization is not None:
       if options.experimental_optimization.autotune is False:  # pylint: disable=g-bool-id-comparison
         autotune = False
@@ -390,9 +391,11 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
         algorithm = options.experimental_optimization.autotune_algorithm
       if options.experimental_optimization.autotune_cpu_budget is not None:
         cpu_budget = options.experimental_optimization.autotune_cpu_budget
+      if options.experimental_optimization.autotune_ram_budget is not None:
+        ram_budget = options.experimental_optimization.autotune_ram_budget
 
     if autotune:
-      dataset = _ModelDataset(dataset, algorithm, cpu_budget)
+      dataset = _ModelDataset(dataset, algorithm, cpu_budget, ram_budget)
 
     if options.experimental_stats and options.experimental_stats.aggregator:  # pylint: disable=line-too-long
       dataset = _SetStatsAggregatorDataset(  # pylint: disable=protected-access
@@ -984,7 +987,7 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
     """
     return ConcatenateDataset(self, dataset)
 
-  def prefetch(self, buffer_size):
+  def prefetch(self, buffer_size, max_buffer_bytes=None):
     """Creates a `Dataset` that prefetches elements from this dataset.
 
     Most dataset input pipelines should end with a call to `prefetch`. This
@@ -998,6 +1001,13 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
     while `examples.batch(20).prefetch(2)` will prefetch 2 elements
     (2 batches, of 20 examples each).
 
+    When elements vary widely in size, `max_buffer_bytes` bounds the memory
+    used by the buffer instead: prefetching pauses while the buffered elements
+    use at least `max_buffer_bytes` bytes, so the buffer exceeds the budget by
+    at most one element. With `buffer_size=tf.data.experimental.AUTOTUNE`, the
+    tuned buffer size is also capped at the number of elements of average
+    size that fit in the budget.
+
     >>> dataset = tf.data.Dataset.range(3)
     >>> dataset = dataset.prefetch(2)
     >>> list(dataset.as_numpy_iterator())
@@ -1006,11 +1016,14 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
     Args:
       buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the maximum
         number of elements that will be buffered when prefetching.
+      max_buffer_bytes: (Optional.) A Python integer, representing the maximum
+        number of bytes of elements that will be buffered when prefetching.
+        If not specified, the buffer is bounded by `buffer_size` only.
 
     Returns:
       Dataset: A `Dataset`.
     """
-    return PrefetchDataset(self, buffer_size)
+    return PrefetchDataset(self, buffer_size, max_buffer_bytes=max_buffer_bytes)
 
   @staticmethod
   def list_files(file_pattern, shuffle=None, seed=None):
@@ -2250,8 +2263,9 @@ class DatasetV1(DatasetV2):
     return DatasetV1Adapter(super(DatasetV1, self).concatenate(dataset))
 
   @functools.wraps(DatasetV2.prefetch)
-  def prefetch(self, buffer_size):
-    return DatasetV1Adapter(super(DatasetV1, self).prefetch(buffer_size))
+  def prefetch(self, buffer_size, max_buffer_bytes=None):
+    return DatasetV1Adapter(
+        super(DatasetV1, self).prefetch(buffer_size, max_buffer_bytes))
 
   @staticmethod
   @functools.wraps(DatasetV2.list_files)
@@ -4094,7 +4108,11 @@ class FilterDataset(UnaryUnchangedStructureDataset):
 class PrefetchDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that asynchronously prefetches its input."""
 
-  def __init__(self, input_dataset, buffer_size, slack_period=None):
+  def __init__(self,
+               input_dataset,
+               buffer_size,
+               slack_period=None,
+               max_buffer_bytes=None):
     """See `Dataset.prefetch()` for details.
 
     Args:
@@ -4106,6 +4124,7 @@ class PrefetchDataset(UnaryUnchangedStructureDataset):
         user should not have to set this manually; enable this behavior
         automatically via `tf.data.Options.experimental_slack` instead. Defaults
         to None.
+      max_buffer_bytes: (Optional.) See `Dataset.prefetch()` for details.
     """
     self._input_dataset = input_dataset
     if buffer_size is None:
@@ -4116,6 +4135,7 @@ class PrefetchDataset(UnaryUnchangedStructureDataset):
         input_dataset._variant_tensor,  # pylint: disable=protected-access
         buffer_size=self._buffer_size,
         slack_period=slack_period,
+        max_buffer_bytes=max_buffer_bytes or 0,
         **self._flat_structure)
     super(PrefetchDataset, self).__init__(input_dataset, variant_tensor)
 
@@ -4176,22 +4196,22 @@ class _OptionsDataset(UnaryUnchangedStructureDataset):
 class _ModelDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that acts as an identity, and models performance."""
 
-  def __init__(self, input_dataset, algorithm, cpu_budget):
+  def __init__(self, input_dataset, algorithm, cpu_budget, ram_budget=0):
     self._input_dataset = input_dataset
     # TODO(jsimsa): This check is introduced for forward compatibility and can
     # be removed after 7/24/2019. At that point, all servers are expected to
     # recognize the `algorithm` attribute.
+    kwargs = self._flat_structure
     if algorithm != AutotuneAlgorithm.HILL_CLIMB:
-      variant_tensor = gen_dataset_ops.model_dataset(
-          input_dataset._variant_tensor,  # pylint: disable=protected-access
-          algorithm=algorithm,
-          cpu_budget=cpu_budget,
-          **self._flat_structure)
-    else:
-      variant_tensor = gen_dataset_ops.model_dataset(
-          input_dataset._variant_tensor,  # pylint: disable=protected-access
-          cpu_budget=cpu_budget,
-          **self._flat_structure)
+      kwargs["algorithm"] = algorithm
+    # The `ram_budget` attribute is only set when it differs from the default
+    # so that graphs remain loadable by servers that do not recognize it.
+    if ram_budget:
+      kwargs["ram_budget"] = ram_budget
+    variant_tensor = gen_dataset_ops.model_dataset(
+        input_dataset._variant_tensor,  # pylint: disable=protected-access
+        cpu_budget=cpu_budget,
+        **kwargs)
     super(_ModelDataset, self).__init__(input_dataset, variant_tensor)
 
 
@@ -202,15 +202,27 @@ class TextLineDatasetV1(dataset_ops.DatasetV1Adapter):
 class _TFRecordDataset(dataset_ops.DatasetSource):
   """A `Dataset` comprising records from one or more TFRecord files."""
 
-  def __init__(self, filenames, compression_type=None, buffer_size=None):
+  def __init__(self,
+               filenames,
+               compression_type=None,
+               buffer_size=None,
+               use_index=False,
+               use_mmap=False,
+               verify_checksums=True):
     """Creates a `TFRecordDataset`.
 
     Args:
       filenames: A `tf.string` tensor containing one or more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, `"ZSTD"`, or `"LZ4"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. 0 means no buffering.
+      use_index: (Optional.) A boolean indicating whether to read the index
+        file of each TFRecord file.
+      use_mmap: (Optional.) A boolean indicating whether to map each TFRecord
+        file into memory.
+      verify_checksums: (Optional.) A boolean indicating whether to verify the
+        checksums of the data of records read from mapped files.
     """
     self._filenames = filenames
     self._compression_type = convert.optional_param_to_tensor(
@@ -222,9 +234,13 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
         "buffer_size",
         buffer_size,
         argument_default=_DEFAULT_READER_BUFFER_SIZE_BYTES)
-    variant_tensor = gen_dataset_ops.tf_record_dataset(self._filenames,
-                                                       self._compression_type,
-                                                       self._buffer_size)
+    variant_tensor = gen_dataset_ops.tf_record_dataset(
+        self._filenames,
+        self._compression_type,
+        self._buffer_size,
+        use_index=use_index,
+        use_mmap=use_mmap,
+        verify_checksums=verify_checksums)
     super(_TFRecordDataset, self).__init__(variant_tensor)
 
   @property
@@ -290,14 +306,17 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
                filenames,
                compression_type=None,
                buffer_size=None,
-               num_parallel_reads=None):
+               num_parallel_reads=None,
+               use_index=False,
+               use_mmap=False,
+               verify_checksums=True):
     """Creates a `TFRecordDataset` to read one or more TFRecord files.
 
     Args:
       filenames: A `tf.string` tensor or `tf.data.Dataset` containing one or
         more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, `"ZSTD"`, or `"LZ4"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. If your input pipeline is I/O bottlenecked,
         consider setting this parameter to a value 1-100 MBs. If `None`, a
@@ -308,23 +327,73 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
         input pipeline is I/O bottlenecked, consider setting this parameter to a
         value greater than one to parallelize the I/O. If `None`, files will be
         read sequentially.
+      use_index: (Optional.) A boolean indicating whether to read the index of
+        each file, named by appending `".index"` to the file name, as written
+        by `tf.io.write_tf_record_index`. With an index, the dataset has a
+        known cardinality, supports random access (e.g. for
+        `tf.data.experimental.global_shuffle`), and `skip` and `shard` move
+        past records without reading them. Requires `filenames` to be a
+        `tf.Tensor`, uncompressed files, and `num_parallel_reads=None`.
+        Defaults to `False`.
+      use_mmap: (Optional.) A boolean indicating whether to map each file into
+        memory instead of reading it through a buffer, which saves a copy of
+        every record and a system call per buffer refill. Intended for files on
+        local disks; files on file systems that do not support mapping are read
+        as usual, and `buffer_size` is ignored for mapped files. Requires
+        uncompressed files. Defaults to `False`.
+      verify_checksums: (Optional.) A boolean indicating whether to verify the
+        checksum of the data of every record read from a mapped file. Setting
+        it to `False` saves a pass over every record, at the cost of not
+        detecting corrupted record data; the checksums of record lengths are
+        still verified. Only affects files mapped with `use_mmap`; records
+        that are read as usual are always fully verified. Defaults to `True`.
 
     Raises:
       TypeError: If any argument does not have the expected type.
       ValueError: If any argument does not have the expected shape.
     """
-    filenames = _create_or_validate_filenames_dataset(filenames)
+    if use_index:
+      if isinstance(filenames, dataset_ops.DatasetV2):
+        raise TypeError("`filenames` must be a `tf.Tensor` when `use_index` "
+                        "is set.")
+      if num_parallel_reads is not None:
+        raise ValueError("`num_parallel_reads` is not supported when "
+                         "`use_index` is set.")
+      filenames = array_ops.reshape(
+          ops.convert_to_tensor(
+              filenames, dtype=dtypes.string, name="filenames"), [-1])
+    else:
+      filenames = _create_or_validate_filenames_dataset(filenames)
 
     self._filenames = filenames
     self._compression_type = compression_type
     self._buffer_size = buffer_size
     self._num_parallel_reads = num_parallel_reads
+    self._use_index = use_index
+    self._use_mmap = use_mmap
+    self._verify_checksums = verify_checksums
 
     def creator_fn(filename):
-      return _TFRecordDataset(filename, compression_type, buffer_size)
-
-    self._impl = _create_dataset_reader(creator_fn, filenames,
-                                        num_parallel_reads)
+      return _TFRecordDataset(
+          filename,
+          compression_type,
+          buffer_size,
+          use_mmap=use_mmap,
+          verify_checksums=verify_checksums)
+
+    if use_index:
+      # A single dataset over all of the files supports random access across
+      # file boundaries.
+      self._impl = _TFRecordDataset(
+          filenames,
+          compression_type,
+          buffer_size,
+          use_index=True,
+          use_mmap=use_mmap,
+          verify_checksums=verify_checksums)
+    else:
+      self._impl = _create_dataset_reader(creator_fn, filenames,
+                                          num_parallel_reads)
     variant_tensor = self._impl._variant_tensor  # pylint: disable=protected-access
     super(TFRecordDatasetV2, self).__init__(variant_tensor)
 
@@ -336,7 +405,8 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
     return TFRecordDatasetV2(filenames or self._filenames, compression_type or
                              self._compression_type, buffer_size or
                              self._buffer_size, num_parallel_reads or
-                             self._num_parallel_reads)
+                             self._num_parallel_reads, self._use_index,
+                             self._use_mmap, self._verify_checksums)
 
   def _inputs(self):
     return self._impl._inputs()  # pylint: disable=protected-access
@@ -354,9 +424,13 @@ class TFRecordDatasetV1(dataset_ops.DatasetV1Adapter):
                filenames,
                compression_type=None,
                buffer_size=None,
-               num_parallel_reads=None):
+               num_parallel_reads=None,
+               use_index=False,
+               use_mmap=False,
+               verify_checksums=True):
     wrapped = TFRecordDatasetV2(filenames, compression_type, buffer_size,
-                                num_parallel_reads)
+                                num_parallel_reads, use_index, use_mmap,
+                                verify_checksums)
     super(TFRecordDatasetV1, self).__init__(wrapped)
 
   __init__.__doc__ = TFRecordDatasetV2.__init__.__doc__
@@ -371,7 +445,8 @@ class TFRecordDatasetV1(dataset_ops.DatasetV1Adapter):
         filenames or self._dataset._filenames, compression_type or
         self._dataset._compression_type, buffer_size or
         self._dataset._buffer_size, num_parallel_reads or
-        self._dataset._num_parallel_reads)
+        self._dataset._num_parallel_reads, self._dataset._use_index,
+        self._dataset._use_mmap, self._dataset._verify_checksums)
 
   @property
   def _filenames(self):
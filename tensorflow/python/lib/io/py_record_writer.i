@@ -41,8 +41,10 @@ typedef signed char int8;
 }
 
 %{
+#include "tensorflow/core/lib/io/lz4/lz4_compression_options.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
 #include "tensorflow/python/lib/io/py_record_writer.h"
 %}
 
@@ -68,9 +70,21 @@ typedef signed char int8;
 %unignore tensorflow::io::RecordWriterOptions;
 %unignore tensorflow::io::RecordWriterOptions::CreateRecordWriterOptions;
 %unignore tensorflow::io::RecordWriterOptions::zlib_options;
+%unignore tensorflow::io::RecordWriterOptions::zstd_options;
+%unignore tensorflow::io::RecordWriterOptions::lz4_options;
+%unignore tensorflow::io::ZstdCompressionOptions;
+%unignore tensorflow::io::ZstdCompressionOptions::input_buffer_size;
+%unignore tensorflow::io::ZstdCompressionOptions::output_buffer_size;
+%unignore tensorflow::io::ZstdCompressionOptions::compression_level;
+%unignore tensorflow::io::Lz4CompressionOptions;
+%unignore tensorflow::io::Lz4CompressionOptions::input_buffer_size;
+%unignore tensorflow::io::Lz4CompressionOptions::output_buffer_size;
+%unignore tensorflow::io::Lz4CompressionOptions::compression_level;
 
 %include "tensorflow/core/lib/io/record_writer.h"
 %include "tensorflow/core/lib/io/zlib_compression_options.h"
+%include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+%include "tensorflow/core/lib/io/lz4/lz4_compression_options.h"
 %include "tensorflow/python/lib/io/py_record_writer.h"
 
 %unignoreall
@@ -19,8 +19,11 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import struct
+
 from tensorflow.python import pywrap_tensorflow
 from tensorflow.python.framework import errors
+from tensorflow.python.lib.io import file_io
 from tensorflow.python.util import compat
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
@@ -35,6 +38,8 @@ class TFRecordCompressionType(object):
   NONE = 0
   ZLIB = 1
   GZIP = 2
+  ZSTD = 3
+  LZ4 = 4
 
 
 @tf_export(
@@ -46,6 +51,8 @@ class TFRecordOptions(object):
   compression_type_map = {
       TFRecordCompressionType.ZLIB: "ZLIB",
       TFRecordCompressionType.GZIP: "GZIP",
+      TFRecordCompressionType.ZSTD: "ZSTD",
+      TFRecordCompressionType.LZ4: "LZ4",
       TFRecordCompressionType.NONE: ""
   }
 
@@ -66,15 +73,22 @@ class TFRecordOptions(object):
     Documentation, details, and defaults can be found in
     [`zlib_compression_options.h`](https://www.tensorflow.org/code/tensorflow/core/lib/io/zlib_compression_options.h)
     and in the [zlib manual](http://www.zlib.net/manual.html).
+    For `"ZSTD"` and `"LZ4"` only `input_buffer_size`, `output_buffer_size`
+    and `compression_level` are used; see
+    [`zstd_compression_options.h`](https://www.tensorflow.org/code/tensorflow/core/lib/io/zstd/zstd_compression_options.h)
+    and
+    [`lz4_compression_options.h`](https://www.tensorflow.org/code/tensorflow/core/lib/io/lz4/lz4_compression_options.h).
     Leaving an option as `None` allows C++ to set a reasonable default.
 
     Args:
-      compression_type: `"GZIP"`, `"ZLIB"`, or `""` (no compression).
+      compression_type: `"GZIP"`, `"ZLIB"`, `"ZSTD"`, `"LZ4"`, or `""` (no
+        compression).
       flush_mode: flush mode or `None`, Default: Z_NO_FLUSH.
       input_buffer_size: int or `None`.
       output_buffer_size: int or `None`.
       window_bits: int or `None`.
-      compression_level: 0 to 9, or `None`.
+      compression_level: 0 to 9 for zlib, 1 to 22 for zstd, 0 to 12 for lz4,
+        or `None`.
       compression_method: compression method or `None`.
       mem_level: 1 to 9, or `None`.
       compression_strategy: strategy or `None`. Default: Z_DEFAULT_STRATEGY.
@@ -107,7 +121,8 @@ class TFRecordOptions(object):
       options: `TFRecordOption`, `TFRecordCompressionType`, or string.
 
     Returns:
-      Compression type as string (e.g. `'ZLIB'`, `'GZIP'`, or `''`).
+      Compression type as string (e.g. `'ZLIB'`, `'GZIP'`, `'ZSTD'`, `'LZ4'`,
+      or `''`).
 
     Raises:
       ValueError: If compression_type is invalid.
@@ -127,9 +142,21 @@ class TFRecordOptions(object):
 
   def _as_record_writer_options(self):
     """Convert to RecordWriterOptions for use with PyRecordWriter."""
+    compression_type = self.get_compression_type_string(self.compression_type)
     options = pywrap_tensorflow.RecordWriterOptions_CreateRecordWriterOptions(
-        compat.as_bytes(
-            self.get_compression_type_string(self.compression_type)))
+        compat.as_bytes(compression_type))
+
+    if compression_type in ("ZSTD", "LZ4"):
+      codec_options = (
+          options.zstd_options
+          if compression_type == "ZSTD" else options.lz4_options)
+      if self.input_buffer_size is not None:
+        codec_options.input_buffer_size = self.input_buffer_size
+      if self.output_buffer_size is not None:
+        codec_options.output_buffer_size = self.output_buffer_size
+      if self.compression_level is not None:
+        codec_options.compression_level = self.compression_level
+      return options
 
     if self.flush_mode is not None:
       options.zlib_options.flush_mode = self.flush_mode
@@ -186,6 +213,57 @@ def tf_record_iterator(path, options=None):
     reader.Close()
 
 
+# Each record is framed by a 12-byte header (uint64 length and its masked
+# crc32c) and a 4-byte footer (masked crc32c of the data).
+_RECORD_HEADER_SIZE = 12
+_RECORD_FOOTER_SIZE = 4
+
+
+@tf_export("io.write_tf_record_index")
+def write_tf_record_index(path, index_path=None):
+  """Writes an index for an existing, uncompressed TFRecords file.
+
+  The index lists the offset of every record in `path` as a little-endian
+  uint64, which lets `tf.data.TFRecordDataset(..., use_index=True)` skip,
+  shard and randomly access records without reading the records before them.
+  Only the record headers are read, so this is cheap even for large files.
+
+  Args:
+    path: The path to the TFRecords file.
+    index_path: (optional) The path of the index to write. Defaults to
+      `path + ".index"`, which is where `tf.data.TFRecordDataset` looks for it.
+
+  Returns:
+    The number of records in `path`.
+
+  Raises:
+    DataLossError: If `path` ends with a truncated record.
+  """
+  if index_path is None:
+    index_path = compat.as_str_any(path) + ".index"
+  file_size = file_io.stat(path).length
+  num_records = 0
+  offset = 0
+  with file_io.FileIO(path, "rb") as reader, \
+      file_io.FileIO(index_path, "wb") as writer:
+    while offset < file_size:
+      reader.seek(offset)
+      header = reader.read(_RECORD_HEADER_SIZE)
+      if len(header) < _RECORD_HEADER_SIZE:
+        raise errors.DataLossError(
+            None, None, "Truncated record header at offset %d in %s" %
+            (offset, path))
+      length, = struct.unpack("<Q", header[:8])
+      end = offset + _RECORD_HEADER_SIZE + length + _RECORD_FOOTER_SIZE
+      if end > file_size:
+        raise errors.DataLossError(
+            None, None, "Truncated record at offset %d in %s" % (offset, path))
+      writer.write(struct.pack("<Q", offset))
+      num_records += 1
+      offset = end
+  return num_records
+
+
 @tf_export(
     "io.TFRecordWriter", v1=["io.TFRecordWriter", "python_io.TFRecordWriter"])
 @deprecation.deprecated_endpoints("python_io.TFRecordWriter")
@@ -22,6 +22,7 @@ import gzip
 import os
 import random
 import string
+import struct
 import zlib
 
 import six
@@ -411,6 +412,18 @@ class TFRecordIteratorTest(TFCompressionTestCase):
     actual = list(tf_record.tf_record_iterator(gzfn))
     self.assertEqual(actual, original)
 
+  def testWriteReadZstdAndLz4(self):
+    """Verify records round-trip through the zstd and lz4 record formats."""
+    original = [b"foo", b"bar", _TEXT * 1024]
+    for compression_type in (TFRecordCompressionType.ZSTD,
+                             TFRecordCompressionType.LZ4):
+      options = tf_record.TFRecordOptions(
+          compression_type, compression_level=1, input_buffer_size=4096)
+      fn = self._WriteRecordsToFile(
+          original, "write_read_%d.tfrecord" % compression_type, options)
+      actual = list(tf_record.tf_record_iterator(fn, options))
+      self.assertEqual(actual, original)
+
   def testBadFile(self):
     """Verify that tf_record_iterator throws an exception on bad TFRecords."""
     fn = os.path.join(self.get_temp_dir(), "bad_file")
@@ -427,6 +440,39 @@ class TFRecordIteratorTest(TFCompressionTestCase):
         pass
 
 
+class TFRecordIndexTest(TFCompressionTestCase):
+  """write_tf_record_index test"""
+
+  def testWriteIndex(self):
+    records = [self._Record(0, i) for i in range(self._num_records)]
+    fn = self._WriteRecordsToFile(records, "indexed_records")
+
+    self.assertEqual(self._num_records, tf_record.write_tf_record_index(fn))
+    with open(fn + ".index", "rb") as f:
+      index = f.read()
+    self.assertEqual(8 * self._num_records, len(index))
+    offsets = struct.unpack("<%dQ" % self._num_records, index)
+    expected_offset = 0
+    for record, offset in zip(records, offsets):
+      self.assertEqual(expected_offset, offset)
+      expected_offset += 12 + len(record) + 4
+
+  def testWriteIndexEmptyFile(self):
+    fn = self._WriteRecordsToFile([], "empty_records")
+    index_fn = os.path.join(self.get_temp_dir(), "empty_records.idx")
+    self.assertEqual(0, tf_record.write_tf_record_index(fn, index_fn))
+    self.assertEqual(0, os.path.getsize(index_fn))
+
+  def testWriteIndexTruncatedFile(self):
+    fn = self._WriteRecordsToFile([b"123", b"456"], "truncated_records")
+    with open(fn, "rb") as f:
+      contents = f.read()
+    with open(fn, "wb") as f:
+      f.write(contents[:-2])
+    with self.assertRaises(errors_impl.DataLossError):
+      tf_record.write_tf_record_index(fn)
+
+
 class TFRecordWriterCloseAndFlushTests(test.TestCase):
   """TFRecordWriter close and flush tests"""
 
@@ -491,5 +537,19 @@ class TFRecordWriterCloseAndFlushZlibTests(TFRecordWriterCloseAndFlushTests):
           self).setUp(TFRecordCompressionType.ZLIB)
 
 
+class TFRecordWriterCloseAndFlushZstdTests(TFRecordWriterCloseAndFlushTests):
+  # pylint: disable=arguments-differ
+  def setUp(self):
+    super(TFRecordWriterCloseAndFlushZstdTests,
+          self).setUp(TFRecordCompressionType.ZSTD)
+
+
+class TFRecordWriterCloseAndFlushLz4Tests(TFRecordWriterCloseAndFlushTests):
+  # pylint: disable=arguments-differ
+  def setUp(self):
+    super(TFRecordWriterCloseAndFlushLz4Tests,
+          self).setUp(TFRecordCompressionType.LZ4)
+
+
 if __name__ == "__main__":
   test.main()
@@ -157,6 +157,13 @@ function prepare_src() {
   mkdir -p ${TMPDIR}/third_party
   cp -R $RUNFILES/third_party/eigen3 ${TMPDIR}/third_party
 
+  # MultiProcessDataset looks for its worker binary next to the library that
+  # contains its kernel.
+  MULTI_PROCESS_WORKER="${TMPDIR}/tensorflow/core/kernels/data/experimental/multi_process_dataset_worker"
+  if [ -f "${MULTI_PROCESS_WORKER}" ]; then
+    mv "${MULTI_PROCESS_WORKER}" "${TMPDIR}/tensorflow/python/"
+  fi
+
   reorganize_includes "${TMPDIR}"
 
   cp tensorflow/tools/pip_package/MANIFEST.in ${TMPDIR}
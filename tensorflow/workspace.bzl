@@ -629,6 +629,30 @@ def tf_repositories(path_prefix = "", tf_repo_name = ""):
         ],
     )
 
+    tf_http_archive(
+        name = "zstd",
+        build_file = clean_dep("//third_party:zstd.BUILD"),
+        sha256 = "a364f5162c7d1a455cc915e8e3cf5f4bd8b75d09bc0f53965b0c9ca1383c52c8",
+        strip_prefix = "zstd-1.4.4",
+        system_build_file = clean_dep("//third_party/systemlibs:zstd.BUILD"),
+        urls = [
+            "https://storage.googleapis.com/mirror.tensorflow.org/github.com/facebook/zstd/archive/v1.4.4.tar.gz",
+            "https://github.com/facebook/zstd/archive/v1.4.4.tar.gz",
+        ],
+    )
+
+    tf_http_archive(
+        name = "lz4",
+        build_file = clean_dep("//third_party:lz4.BUILD"),
+        sha256 = "658ba6191fa44c92280d4aa2c271b0f4fbc0e34d249578dd05e50e76d0e5efcc",
+        strip_prefix = "lz4-1.9.2",
+        system_build_file = clean_dep("//third_party/systemlibs:lz4.BUILD"),
+        urls = [
+            "https://storage.googleapis.com/mirror.tensorflow.org/github.com/lz4/lz4/archive/v1.9.2.tar.gz",
+            "https://github.com/lz4/lz4/archive/v1.9.2.tar.gz",
+        ],
+    )
+
     tf_http_archive(
         name = "nccl_archive",
         build_file = clean_dep("//third_party:nccl/archive.BUILD"),
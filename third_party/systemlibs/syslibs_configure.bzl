@@ -31,6 +31,7 @@ VALID_LIBS = [
     "jsoncpp_git",
     "keras_applications_archive",
     "lmdb",
+    "lz4",
     "nasm",
     "nsync",
     "opt_einsum_archive",
@@ -44,6 +45,7 @@ VALID_LIBS = [
     "termcolor_archive",
     "wrapt",
     "zlib_archive",
+    "zstd",
 ]
 
 def auto_configure_fail(msg):